@@ -0,0 +1,158 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Benchmark of the IPv4 forwarding path, with and without the
+// Ipv4L3Protocol FastForwarding mode.
+//
+// A UDP flow crosses a chain of routers connected by point-to-point links:
+//
+//   source -- router 1 -- router 2 -- ... -- router N -- sink
+//
+// The wall clock time of the simulation and the number of packets forwarded
+// per second of wall clock time are reported.  Run it once with each mode:
+//
+//   ./ns3 run "scratch/ipv4-forwarding-benchmark --fastForwarding=0"
+//   ./ns3 run "scratch/ipv4-forwarding-benchmark --fastForwarding=1"
+//
+// With --routeChanges, a host route to the sink is added and removed on every
+// router during the run, which flushes the next hops cached by the
+// FastForwarding mode: the packets must still all be received.
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * Add, then remove, a host route to a destination on a router.
+ * \param routing the static routing protocol of the router
+ * \param destination the destination of the route
+ * \param nextHop the next hop of the route
+ * \param interface the output interface of the route
+ */
+static void
+ChangeRoute(Ptr<Ipv4StaticRouting> routing,
+            Ipv4Address destination,
+            Ipv4Address nextHop,
+            uint32_t interface)
+{
+    routing->AddHostRouteTo(destination, nextHop, interface);
+    routing->RemoveRoute(routing->GetNRoutes() - 1);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t routers = 8;
+    uint32_t packets = 200000;
+    uint32_t packetSize = 500;
+    bool fastForwarding = true;
+    bool routeChanges = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("routers", "Number of routers between the source and the sink", routers);
+    cmd.AddValue("packets", "Number of packets sent", packets);
+    cmd.AddValue("packetSize", "Size of the UDP payload", packetSize);
+    cmd.AddValue("fastForwarding", "Enable the FastForwarding mode of the routers", fastForwarding);
+    cmd.AddValue("routeChanges", "Change the routes of the routers during the run", routeChanges);
+    cmd.Parse(argc, argv);
+
+    NodeContainer nodes;
+    nodes.Create(routers + 2);
+
+    InternetStackHelper stack;
+    stack.Install(nodes);
+    for (uint32_t i = 1; i <= routers; i++)
+    {
+        nodes.Get(i)->GetObject<Ipv4L3Protocol>()->SetAttribute("FastForwarding",
+                                                                BooleanValue(fastForwarding));
+    }
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("10Gbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("1us"));
+
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    Ipv4InterfaceContainer lastLink;
+    for (uint32_t i = 0; i <= routers; i++)
+    {
+        NetDeviceContainer devices = p2p.Install(nodes.Get(i), nodes.Get(i + 1));
+        lastLink = address.Assign(devices);
+        address.NewNetwork();
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Ptr<Node> sink = nodes.Get(routers + 1);
+    Ipv4Address sinkAddress = lastLink.GetAddress(1);
+    uint16_t port = 9;
+    UdpServerHelper server(port);
+    ApplicationContainer serverApps = server.Install(sink);
+    serverApps.Start(Seconds(0));
+
+    // send at 80% of the link capacity, so that no packet is dropped
+    double interval = (packetSize + 36) * 8 / 8e9;
+    UdpClientHelper client(sinkAddress, port);
+    client.SetAttribute("MaxPackets", UintegerValue(packets));
+    client.SetAttribute("Interval", TimeValue(Seconds(interval)));
+    client.SetAttribute("PacketSize", UintegerValue(packetSize));
+    ApplicationContainer clientApps = client.Install(nodes.Get(0));
+    clientApps.Start(Seconds(0.1));
+
+    Time duration = Seconds(interval * packets);
+    if (routeChanges)
+    {
+        Ipv4StaticRoutingHelper staticRouting;
+        for (uint32_t i = 1; i <= routers; i++)
+        {
+            Ptr<Ipv4> ipv4 = nodes.Get(i)->GetObject<Ipv4>();
+            Ptr<Ipv4StaticRouting> routing = staticRouting.GetStaticRouting(ipv4);
+            // the output interface towards the sink, and its peer address
+            uint32_t interface = ipv4->GetNInterfaces() - 1;
+            Ipv4Address local = ipv4->GetAddress(interface, 0).GetLocal();
+            Ipv4Address nextHop(local.Get() + 1);
+            for (uint32_t j = 1; j < 10; j++)
+            {
+                Simulator::Schedule(Seconds(0.1) + duration * j / 10,
+                                    &ChangeRoute,
+                                    routing,
+                                    sinkAddress,
+                                    nextHop,
+                                    interface);
+            }
+        }
+    }
+
+    Simulator::Stop(Seconds(0.2) + duration);
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t received = DynamicCast<UdpServer>(serverApps.Get(0))->GetReceived();
+    Simulator::Destroy();
+
+    std::cout << "routers " << routers << ", fastForwarding " << fastForwarding
+              << ", routeChanges " << routeChanges << std::endl;
+    std::cout << "received " << received << "/" << packets << " packets" << std::endl;
+    std::cout << "wall clock time " << elapsed.count() << " s, "
+              << received * routers / elapsed.count() << " packets forwarded/s" << std::endl;
+
+    return received == packets ? 0 : 1;
+}
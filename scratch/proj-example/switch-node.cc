@@ -1,8 +1,12 @@
 #include "flow-tuple.h"
 #include "ns3/traffic-control-layer.h"
 #include "ns3/internet-module.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 #include "ns3/point-to-point-net-device.h"
+#include "ns3/flow-hash.h"
 #include "switch-node.h"
+#include <cstring>
 #include <unordered_set>
 
 NS_LOG_COMPONENT_DEFINE("SwitchNode");
@@ -13,6 +17,24 @@ TypeId SwitchNode::GetTypeId() {
     static TypeId tid = TypeId("SwitchNode")
         .SetParent<Node>()
         .AddConstructor<SwitchNode>()
+        .AddAttribute("FlowTableSize",
+                      "Number of slots of the flow table (rounded up to a power of 2)",
+                      UintegerValue(4096),
+                      MakeUintegerAccessor(&SwitchNode::m_flowTableSize),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("FlowIdleTimeout",
+                      "A flow table entry idle for longer than this can be reused by another flow "
+                      "(must be larger than a non-zero FlowletGap)",
+                      TimeValue(MilliSeconds(10)),
+                      MakeTimeAccessor(&SwitchNode::m_flowIdleTimeout),
+                      MakeTimeChecker())
+        .AddAttribute("FlowletGap",
+                      "Idle time after which a flow may be moved to another ECMP member "
+                      "(0 disables flowlets); must be smaller than FlowIdleTimeout, which "
+                      "otherwise frees the entry first",
+                      TimeValue(Time{0}),
+                      MakeTimeAccessor(&SwitchNode::m_flowletGap),
+                      MakeTimeChecker())
     ;
     return tid;
 }
@@ -81,67 +103,112 @@ void SwitchNode::DoInitialize() {
                         "NetDevice must be PointToPointNetDevice or its subclass");
         routeTable[dstIp].insert(devIdx);
     }
+    m_routeTable.reserve(routeTable.size());
     for (const auto &[dstIp, egressSet] : routeTable) {
-        m_routeTable[dstIp] = std::vector<int>{egressSet.begin(), egressSet.end()};
+        m_hostIndex[dstIp] = m_routeTable.size();
+        m_routeTable.emplace_back(egressSet.begin(), egressSet.end());
         NS_LOG_DEBUG(
             "[Switch " << GetId() << "] ns3::GlobalRouting for " << Ipv4Address{dstIp}
-            << " = " << m_routeTable[dstIp]
+            << " = " << m_routeTable.back()
         );
     }
 
+    // an entry idle for FlowIdleTimeout is reused, hence a longer gap never starts a flowlet
+    NS_ABORT_MSG_IF(m_flowletGap.IsStrictlyPositive() && m_flowletGap >= m_flowIdleTimeout,
+                    "FlowletGap (" << m_flowletGap.As(Time::US)
+                    << ") must be smaller than FlowIdleTimeout ("
+                    << m_flowIdleTimeout.As(Time::US) << ")");
+
+    uint32_t flowTableSize = 1;
+    while (flowTableSize < m_flowTableSize) {
+        flowTableSize <<= 1;
+    }
+    m_flowTableSize = flowTableSize;
+    m_flowTable.assign(m_flowTableSize, FlowEntry{});
+
     Node::DoInitialize();
 }
 
-static uint32_t EcmpHash(std::basic_string_view<uint8_t> keyData, uint32_t seed) {
-    auto key = keyData.data();
-    auto len = keyData.size();
-
+/// Same value as the murmur3 of the raw 4-tuple used by HPCC:
 /// https://github.com/alibaba-edu/High-Precision-Congestion-Control/blob/master/simulation/src/point-to-point/model/switch-node.cc#L138
-    uint32_t h = seed;
-    if (len > 3) {
-        auto* key_x4 = (const uint32_t*) key;
-        size_t i = len >> 2;
-        do {
-            uint32_t k = *key_x4++;
-            k *= 0xcc9e2d51;
-            k = (k << 15) | (k >> 17);
-            k *= 0x1b873593;
-            h ^= k;
-            h = (h << 13) | (h >> 19);
-            h += (h << 2) + 0xe6546b64;
-        } while (--i);
-        key = (const uint8_t*) key_x4;
-    }
-    if (len & 3) {
-        size_t i = len & 3;
-        uint32_t k = 0;
-        key = &key[i - 1];
-        do {
-            k <<= 8;
-            k |= *key--;
-        } while (--i);
-        k *= 0xcc9e2d51;
-        k = (k << 15) | (k >> 17);
-        k *= 0x1b873593;
-        h ^= k;
+/// computed by the fixed-width kernel shared with the traffic-control classifiers.
+static uint32_t EcmpHash(const FlowTuple &tuple, uint32_t seed) {
+    uint32_t words[3];
+    auto key = tuple.GetTuple4Raw();
+    std::memcpy(words, key.data(), sizeof(words));
+    return FlowHash<3>(words, seed);
+}
+
+int SwitchNode::SelectEgressDevIndex(const FlowTuple &tuple, uint32_t hash) {
+    auto it = m_hostIndex.find(tuple.dstAddr);
+    NS_ASSERT_MSG(it != m_hostIndex.end(), "[Switch " << GetId() << "] no route to " << Ipv4Address{tuple.dstAddr});
+    const auto &egressNetDevs = m_routeTable[it->second];
+    if (egressNetDevs.size() == 1) {
+        return egressNetDevs[0];
     }
-    h ^= len;
-    h ^= h >> 16;
-    h *= 0x85ebca6b;
-    h ^= h >> 13;
-    h *= 0xc2b2ae35;
-    h ^= h >> 16;
-    return h;
+    return egressNetDevs[hash % egressNetDevs.size()];
 }
 
 int SwitchNode::GetEgressDevIndex(const ParsedPkt &parsedPkt) {
     FlowTuple tuple = parsedPkt.GetFlowTuple();
-    auto &egressNetDevs = m_routeTable[tuple.dstAddr];
-    if (egressNetDevs.size() == 1) {
-        return egressNetDevs[0];
+    uint32_t hash = EcmpHash(tuple, GetId());
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t idleTimeout = m_flowIdleTimeout.GetTimeStep();
+    uint32_t mask = m_flowTableSize - 1;
+
+    // Linear probing over at most MAX_PROBES slots. A slot holding an aged-out
+    // flow is as good as an empty one; if none is found, the least recently
+    // seen flow of the probed slots is evicted.
+    FlowEntry *victim = nullptr;
+    bool victimExpired = false;
+    for (uint32_t i = 0; i < MAX_PROBES; i++) {
+        FlowEntry &entry = m_flowTable[(hash + i) & mask];
+        bool expired = entry.lastSeen < 0 || now - entry.lastSeen > idleTimeout;
+        if (expired) {
+            if (!victimExpired) {
+                victim = &entry;
+                victimExpired = true;
+            }
+            continue;
+        }
+        if (entry.tuple == tuple) {
+            m_flowTableHits++;
+            if (m_flowletGap.IsStrictlyPositive() && now - entry.lastSeen > m_flowletGap.GetTimeStep()) {
+                entry.flowletId++;
+                uint32_t flowletHash = EcmpHash(tuple, GetId() + entry.flowletId);
+                entry.egressDevIdx = SelectEgressDevIndex(tuple, flowletHash);
+            }
+            entry.lastSeen = now;
+            return entry.egressDevIdx;
+        }
+        if (victim == nullptr || (!victimExpired && entry.lastSeen < victim->lastSeen)) {
+            victim = &entry;
+        }
+    }
+
+    m_flowTableMisses++;
+    victim->tuple = tuple;
+    victim->lastSeen = now;
+    victim->flowletId = 0;
+    victim->egressDevIdx = SelectEgressDevIndex(tuple, hash);
+    return victim->egressDevIdx;
+}
+
+double SwitchNode::GetFlowTableHitRate() const {
+    uint64_t lookups = m_flowTableHits + m_flowTableMisses;
+    return lookups == 0 ? 0.0 : static_cast<double>(m_flowTableHits) / lookups;
+}
+
+uint32_t SwitchNode::GetFlowTableOccupancy() const {
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t idleTimeout = m_flowIdleTimeout.GetTimeStep();
+    uint32_t n = 0;
+    for (const auto &entry : m_flowTable) {
+        if (entry.lastSeen >= 0 && now - entry.lastSeen <= idleTimeout) {
+            n++;
+        }
     }
-    uint32_t idx = EcmpHash(tuple.GetTuple4Raw(), GetId()) % egressNetDevs.size();
-    return egressNetDevs[idx];
+    return n;
 }
 
 Ptr<NetDevice> SwitchNode::GetEgressDev(const ParsedPkt &parsedPkt) {
@@ -5,6 +5,9 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/tcp-header.h"
+#include "ns3/nstime.h"
+#include <unordered_map>
+#include <vector>
 #include "flow-tuple.h"
 #include "utils.h"
 
@@ -21,6 +24,13 @@ struct ParsedPkt {
 /**
  * This class implements per-flow ECMP and provides virtual methods for subclasses to process packet.
  * Note: all associated NetDevice MUST be PointToPointNetDevice
+ *
+ * The egress decision of each flow is cached in an open-addressing flow table,
+ * so that a packet of a known flow costs one hash and (usually) one probe.
+ * Entries idle for longer than FlowIdleTimeout are considered free.
+ * If FlowletGap is non-zero, a flow idle for longer than the gap starts a new
+ * flowlet, which may be assigned to another ECMP member. FlowletGap must then
+ * be smaller than FlowIdleTimeout.
  */
 class SwitchNode : public Node
 {
@@ -28,6 +38,11 @@ public:
     static TypeId GetTypeId();
     SwitchNode() = default;
 
+    uint64_t GetFlowTableHits() const { return m_flowTableHits; }
+    uint64_t GetFlowTableMisses() const { return m_flowTableMisses; }
+    double GetFlowTableHitRate() const; // hits / lookups
+    uint32_t GetFlowTableOccupancy() const; // number of entries not yet aged out
+
 protected:
     void DoInitialize() override;
     int GetEgressDevIndex(const ParsedPkt &parsedPkt); // returns ECMP calculated egress port
@@ -39,6 +54,26 @@ protected:
 private:
     bool ReceiveFromDevice(Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
 
+    int SelectEgressDevIndex(const FlowTuple &tuple, uint32_t hash);
+
 private:
-    std::map<uint32_t, std::vector<int>> m_routeTable;
+    struct FlowEntry {
+        FlowTuple tuple;
+        int64_t lastSeen = -1; // timestep of the last packet, -1 if the slot has never been used
+        uint32_t flowletId = 0;
+        int egressDevIdx = -1;
+    };
+
+    static constexpr uint32_t MAX_PROBES = 4;
+
+    /// egress devices for each destination host, indexed by host index
+    std::vector<std::vector<int>> m_routeTable;
+    std::unordered_map<uint32_t, uint32_t> m_hostIndex; // host ipv4 address -> host index
+
+    std::vector<FlowEntry> m_flowTable;
+    uint32_t m_flowTableSize = 0;
+    Time m_flowIdleTimeout;
+    Time m_flowletGap;
+    uint64_t m_flowTableHits = 0;
+    uint64_t m_flowTableMisses = 0;
 };
@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Microbenchmark of the containers of Queue<Packet>.
+//
+// For each occupancy, the container is filled with that many packets, then
+// packets are repeatedly inserted at the back and erased from the front, as
+// Queue::DoEnqueue and Queue::DoDequeue do.  The rate of enqueue/dequeue pairs
+// is reported for std::list, for RingBuffer (the default container) and for
+// a DropTailQueue<Packet> as a whole.
+//
+//   ./ns3 run "scratch/queue-container-benchmark --operations=10000000"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Measure the rate of enqueue/dequeue pairs on a container.
+ * \param packets the packets to enqueue, at least occupancy + 1
+ * \param occupancy the number of packets in the container
+ * \param operations the number of enqueue/dequeue pairs
+ * \return the number of enqueue/dequeue pairs per second
+ */
+template <class Container>
+static double
+MeasureContainer(const std::vector<Ptr<Packet>>& packets, uint32_t occupancy, uint32_t operations)
+{
+    Container container;
+    for (uint32_t i = 0; i < occupancy; i++)
+    {
+        container.insert(container.end(), packets[i]);
+    }
+    std::size_t next = occupancy;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; i++)
+    {
+        container.insert(container.end(), packets[next]);
+        container.erase(container.begin());
+        next = (next + 1 == packets.size() ? 0 : next + 1);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return operations / elapsed.count();
+}
+
+/**
+ * Measure the rate of enqueue/dequeue pairs on a DropTailQueue.
+ * \param packets the packets to enqueue, at least occupancy + 1
+ * \param occupancy the number of packets in the queue
+ * \param operations the number of enqueue/dequeue pairs
+ * \return the number of enqueue/dequeue pairs per second
+ */
+static double
+MeasureQueue(const std::vector<Ptr<Packet>>& packets, uint32_t occupancy, uint32_t operations)
+{
+    Ptr<DropTailQueue<Packet>> queue = CreateObject<DropTailQueue<Packet>>();
+    queue->SetMaxSize(QueueSize(QueueSizeUnit::PACKETS, occupancy + 1));
+    for (uint32_t i = 0; i < occupancy; i++)
+    {
+        queue->Enqueue(packets[i]);
+    }
+    std::size_t next = occupancy;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; i++)
+    {
+        queue->Enqueue(packets[next]);
+        queue->Dequeue();
+        next = (next + 1 == packets.size() ? 0 : next + 1);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return operations / elapsed.count();
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t operations = 2000000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("operations", "Number of enqueue/dequeue pairs per measurement", operations);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> occupancies{0, 10, 100, 1000, 10000, 100000};
+    std::vector<Ptr<Packet>> packets;
+    for (uint32_t i = 0; i <= occupancies.back(); i++)
+    {
+        packets.push_back(Create<Packet>(100));
+    }
+
+    std::cout << "enqueue/dequeue pairs per second (millions)" << std::endl;
+    std::cout << std::setw(10) << "occupancy" << std::setw(12) << "std::list" << std::setw(12)
+              << "RingBuffer" << std::setw(15) << "DropTailQueue" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (uint32_t occupancy : occupancies)
+    {
+        std::cout << std::setw(10) << occupancy << std::setw(12)
+                  << MeasureContainer<std::list<Ptr<Packet>>>(packets, occupancy, operations) / 1e6
+                  << std::setw(12)
+                  << MeasureContainer<RingBuffer<Ptr<Packet>>>(packets, occupancy, operations) / 1e6
+                  << std::setw(15) << MeasureQueue(packets, occupancy, operations) / 1e6
+                  << std::endl;
+    }
+
+    return 0;
+}
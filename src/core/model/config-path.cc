@@ -0,0 +1,433 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "config-path.h"
+
+#include "abort.h"
+#include "config.h"
+#include "log.h"
+#include "object-ptr-container.h"
+#include "object.h"
+#include "pointer.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup config
+ * ns3::Config::CompiledPath implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ConfigPath");
+
+namespace Config
+{
+
+CompiledPath::CompiledPath(std::string path)
+{
+    NS_LOG_FUNCTION(this << path);
+
+    std::vector<std::string> tokens;
+    std::istringstream iss(path);
+    std::string token;
+    while (std::getline(iss, token, '/'))
+    {
+        if (!token.empty())
+        {
+            tokens.push_back(token);
+        }
+    }
+    NS_ABORT_MSG_IF(tokens.empty(), "Empty Config path");
+    m_leaf = tokens.back();
+    tokens.pop_back();
+
+    uint32_t nIndices = 0;
+    for (const auto& text : tokens)
+    {
+        Segment segment;
+        segment.text = text;
+        segment.valid = true;
+        if (text[0] == '$')
+        {
+            segment.kind = GET_OBJECT;
+            segment.valid = TypeId::LookupByNameFailSafe(text.substr(1), &segment.tid);
+            if (!segment.valid)
+            {
+                NS_LOG_WARN("Unknown TypeId " << text.substr(1) << " in path " << path);
+            }
+        }
+        else if (!m_segments.empty() && m_segments.back().kind == ATTRIBUTE &&
+                 ParseIndex(text, &segment.ranges))
+        {
+            segment.kind = INDEX;
+            nIndices++;
+        }
+        else
+        {
+            segment.kind = ATTRIBUTE;
+        }
+        m_segments.push_back(std::move(segment));
+    }
+    NS_ABORT_MSG_IF(nIndices > PathIndex::MAX,
+                    "Too many array elements (" << nIndices << ") in path " << path);
+}
+
+std::string
+CompiledPath::GetPath() const
+{
+    std::string path;
+    for (const auto& segment : m_segments)
+    {
+        path += "/" + segment.text;
+    }
+    return path + "/" + m_leaf;
+}
+
+std::string
+CompiledPath::GetLeaf() const
+{
+    return m_leaf;
+}
+
+std::string
+CompiledPath::GetMatchedPath(const PathIndex& index) const
+{
+    std::ostringstream oss;
+    uint32_t next = 0;
+    for (const auto& segment : m_segments)
+    {
+        oss << "/";
+        if (segment.kind == INDEX && next < index.n)
+        {
+            oss << index[next++];
+        }
+        else
+        {
+            oss << segment.text;
+        }
+    }
+    oss << "/" << m_leaf;
+    return oss.str();
+}
+
+bool
+CompiledPath::ParseIndex(std::string text, std::vector<std::pair<uint32_t, uint32_t>>* ranges)
+{
+    auto parseUint32 = [](const std::string& str, uint32_t* value) {
+        if (str.empty() || str.size() > 10 ||
+            !std::all_of(str.begin(), str.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            return false;
+        }
+        uint64_t v = std::stoull(str);
+        *value = static_cast<uint32_t>(v);
+        return v <= std::numeric_limits<uint32_t>::max();
+    };
+
+    ranges->clear();
+    std::istringstream iss(text);
+    std::string element;
+    while (std::getline(iss, element, '|'))
+    {
+        uint32_t min;
+        uint32_t max;
+        std::string::size_type dash = element.find('-');
+        if (element == "*")
+        {
+            min = 0;
+            max = std::numeric_limits<uint32_t>::max();
+        }
+        else if (element.size() > 2 && element.front() == '[' && element.back() == ']' &&
+                 dash != std::string::npos)
+        {
+            if (!parseUint32(element.substr(1, dash - 1), &min) ||
+                !parseUint32(element.substr(dash + 1, element.size() - dash - 2), &max) ||
+                min > max)
+            {
+                return false;
+            }
+        }
+        else if (parseUint32(element, &min))
+        {
+            max = min;
+        }
+        else
+        {
+            return false;
+        }
+        ranges->emplace_back(min, max);
+    }
+    if (ranges->empty())
+    {
+        return false;
+    }
+
+    // Merge the overlapping ranges, so that each index is visited once and in order
+    std::sort(ranges->begin(), ranges->end());
+    std::size_t last = 0;
+    for (std::size_t i = 1; i < ranges->size(); i++)
+    {
+        auto& merged = (*ranges)[last];
+        const auto& range = (*ranges)[i];
+        if (merged.second == std::numeric_limits<uint32_t>::max() ||
+            range.first <= merged.second + 1)
+        {
+            merged.second = std::max(merged.second, range.second);
+        }
+        else
+        {
+            (*ranges)[++last] = range;
+        }
+    }
+    ranges->resize(last + 1);
+    return true;
+}
+
+bool
+CompiledPath::Matches(const Segment& segment, std::size_t i)
+{
+    for (const auto& range : segment.ranges)
+    {
+        if (i >= range.first && i <= range.second)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<CompiledPath::AttributeMatch>&
+CompiledPath::GetAttributes(const Segment& segment, TypeId tid) const
+{
+    uint16_t uid = tid.GetUid();
+    auto it = segment.attributes.find(uid);
+    if (it != segment.attributes.end())
+    {
+        return it->second;
+    }
+
+    std::vector<AttributeMatch> matches;
+    TypeId nextTid = tid;
+    do
+    {
+        tid = nextTid;
+        for (std::size_t i = 0; i < tid.GetAttributeN(); i++)
+        {
+            TypeId::AttributeInformation info = tid.GetAttribute(i);
+            if (info.name != segment.text && segment.text != "*")
+            {
+                continue;
+            }
+            if (dynamic_cast<const PointerChecker*>(PeekPointer(info.checker)) != nullptr)
+            {
+                matches.push_back({info.accessor, nullptr});
+            }
+            else if (dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker)))
+            {
+                auto accessor =
+                    dynamic_cast<const ObjectPtrContainerAccessor*>(PeekPointer(info.accessor));
+                if (accessor != nullptr)
+                {
+                    matches.push_back({info.accessor, accessor});
+                }
+            }
+        }
+        nextTid = tid.GetParent();
+    } while (nextTid != tid);
+
+    return segment.attributes.emplace(uid, std::move(matches)).first->second;
+}
+
+std::size_t
+CompiledPath::Resolve(const std::function<void(Ptr<Object>, const PathIndex&)>& f) const
+{
+    NS_LOG_FUNCTION(this);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < GetRootNamespaceObjectN(); i++)
+    {
+        PathIndex index;
+        count += DoResolve(0, GetRootNamespaceObject(i), index, f);
+    }
+    return count;
+}
+
+std::size_t
+CompiledPath::DoResolve(std::size_t i,
+                        Ptr<Object> object,
+                        PathIndex& index,
+                        const std::function<void(Ptr<Object>, const PathIndex&)>& f) const
+{
+    if (i == m_segments.size())
+    {
+        f(object, index);
+        return 1;
+    }
+
+    const Segment& segment = m_segments[i];
+    if (segment.kind == GET_OBJECT)
+    {
+        if (!segment.valid)
+        {
+            return 0;
+        }
+        Ptr<Object> aggregated = object->GetObject<Object>(segment.tid);
+        return aggregated ? DoResolve(i + 1, aggregated, index, f) : 0;
+    }
+
+    NS_ASSERT(segment.kind == ATTRIBUTE);
+    bool nextIsIndex = i + 1 < m_segments.size() && m_segments[i + 1].kind == INDEX;
+    std::size_t count = 0;
+    for (const auto& match : GetAttributes(segment, object->GetInstanceTypeId()))
+    {
+        if (match.containerAccessor != nullptr)
+        {
+            if (nextIsIndex)
+            {
+                count += DoArrayResolve(i + 1, object, match.containerAccessor, index, f);
+            }
+        }
+        else if (!nextIsIndex)
+        {
+            PointerValue value;
+            if (match.accessor->Get(PeekPointer(object), value))
+            {
+                Ptr<Object> pointed = value.Get<Object>();
+                if (pointed)
+                {
+                    count += DoResolve(i + 1, pointed, index, f);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+std::size_t
+CompiledPath::DoArrayResolve(std::size_t i,
+                             Ptr<Object> object,
+                             const ObjectPtrContainerAccessor* accessor,
+                             PathIndex& index,
+                             const std::function<void(Ptr<Object>, const PathIndex&)>& f) const
+{
+    const Segment& segment = m_segments[i];
+
+    //
+    // The containers whose elements are fetched by index in constant time
+    // (e.g., the NodeList) are accessed by position: only the matching
+    // elements are fetched. The others (e.g., the member vectors and maps,
+    // whose indices are keys and whose elements are reached by walking the
+    // container) are visited once.
+    //
+    std::size_t count = 0;
+    uint32_t slot = index.n++;
+    if (accessor->IsPositional())
+    {
+        std::size_t n;
+        if (accessor->GetN(PeekPointer(object), &n))
+        {
+            for (const auto& range : segment.ranges)
+            {
+                for (uint64_t k = range.first; k <= range.second && k < n; k++)
+                {
+                    std::size_t key;
+                    Ptr<Object> element = accessor->GetAt(PeekPointer(object), k, &key);
+                    index.values[slot] = k;
+                    count += DoResolve(i + 1, element, index, f);
+                }
+            }
+        }
+    }
+    else
+    {
+        accessor->ForEach(PeekPointer(object), [&](std::size_t key, Ptr<Object> element) {
+            if (Matches(segment, key))
+            {
+                index.values[slot] = key;
+                count += DoResolve(i + 1, element, index, f);
+            }
+        });
+    }
+    index.n--;
+    return count;
+}
+
+Ptr<const TraceSourceAccessor>
+CompiledPath::GetTraceSource(TypeId tid) const
+{
+    auto it = m_traceSources.find(tid.GetUid());
+    if (it == m_traceSources.end())
+    {
+        it = m_traceSources.emplace(tid.GetUid(), tid.LookupTraceSourceByName(m_leaf)).first;
+    }
+    return it->second;
+}
+
+std::size_t
+CompiledPath::DoConnect(const std::function<CallbackBase(const PathIndex&)>& make) const
+{
+    std::size_t count = 0;
+    Resolve([this, &make, &count](Ptr<Object> object, const PathIndex& index) {
+        Ptr<const TraceSourceAccessor> accessor = GetTraceSource(object->GetInstanceTypeId());
+        if (accessor && accessor->ConnectWithoutContext(PeekPointer(object), make(index)))
+        {
+            count++;
+        }
+    });
+    return count;
+}
+
+std::size_t
+CompiledPath::ConnectWithoutContext(const CallbackBase& cb) const
+{
+    NS_LOG_FUNCTION(this << &cb);
+    return DoConnect([&cb](const PathIndex&) { return cb; });
+}
+
+std::size_t
+CompiledPath::Connect(const CallbackBase& cb) const
+{
+    NS_LOG_FUNCTION(this << &cb);
+    std::size_t count = 0;
+    Resolve([this, &cb, &count](Ptr<Object> object, const PathIndex& index) {
+        Ptr<const TraceSourceAccessor> accessor = GetTraceSource(object->GetInstanceTypeId());
+        if (accessor && accessor->Connect(PeekPointer(object), GetMatchedPath(index), cb))
+        {
+            count++;
+        }
+    });
+    return count;
+}
+
+std::size_t
+CompiledPath::Set(const AttributeValue& value) const
+{
+    NS_LOG_FUNCTION(this << &value);
+    std::size_t count = 0;
+    Resolve([this, &value, &count](Ptr<Object> object, const PathIndex&) {
+        if (object->SetAttributeFailSafe(m_leaf, value))
+        {
+            count++;
+        }
+    });
+    return count;
+}
+
+} // namespace Config
+
+} // namespace ns3
@@ -0,0 +1,288 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CONFIG_PATH_H
+#define CONFIG_PATH_H
+
+#include "attribute.h"
+#include "callback.h"
+#include "ptr.h"
+#include "trace-source-accessor.h"
+#include "type-id.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup config
+ * ns3::Config::CompiledPath and ns3::Config::PathIndex declarations.
+ */
+
+namespace ns3
+{
+
+class Object;
+class ObjectPtrContainerAccessor;
+
+namespace Config
+{
+
+/**
+ * \ingroup config
+ * \brief The indices matched by the array elements of a Config path
+ *
+ * For instance, the indices of a match of
+ * "/NodeList/[0-99]/DeviceList/1|2/$ns3::PointToPointNetDevice/MacTx" are the
+ * node id and the device index. This is the compact context passed by
+ * CompiledPath::ConnectWithIndex instead of the matched path string.
+ */
+struct PathIndex
+{
+    static constexpr std::size_t MAX = 4; //!< maximum number of array elements of a path
+
+    std::array<uint32_t, MAX> values{}; //!< the indices, in path order
+    uint32_t n{0};                      //!< the number of indices
+
+    /**
+     * \param [in] i The position of an array element of the path.
+     * \returns The index matched by the array element.
+     */
+    uint32_t operator[](std::size_t i) const
+    {
+        return values[i];
+    }
+
+    /**
+     * \param [in] other Another path index.
+     * \returns \c true if the indices are equal.
+     */
+    bool operator==(const PathIndex& other) const = default;
+};
+
+/**
+ * \ingroup config
+ * \brief A Config path parsed once and resolved without string processing
+ *
+ * Config::Connect and friends parse their path at every call and build a
+ * context string for every object visited. A CompiledPath splits the path
+ * once into segments: GetObject calls (whose TypeId is looked up once),
+ * attributes (whose accessors are cached per TypeId) and array elements
+ * (parsed into sorted index ranges). Array elements with explicit indices
+ * are resolved by position (e.g., "/NodeList/3" fetches node 3 directly),
+ * and the matches are identified by a PathIndex rather than a string.
+ *
+ * ConnectWithIndex connects a single callback to all the matching trace
+ * sources, each connection being bound to the PathIndex of its match:
+ * \code
+ *   void MacTx(Config::PathIndex index, Ptr<const Packet> p); // index[0]: node, index[1]: device
+ *   Config::CompiledPath path("/NodeList/[0-99]/DeviceList/1/$ns3::PointToPointNetDevice/MacTx");
+ *   path.ConnectWithIndex(MakeCallback(&MacTx));
+ * \endcode
+ *
+ * A segment following an attribute is an array element if it is made of
+ * indices, ranges ("[2-5]") and wildcards (an asterisk) separated by '|',
+ * hence a wildcard attribute name cannot follow an attribute. Object names
+ * (see Names) are not looked up: use Config::Connect for paths with names.
+ */
+class CompiledPath
+{
+  public:
+    /**
+     * Parse a path to a trace source or an attribute.
+     *
+     * \param [in] path The Config path, whose last segment is the name of a
+     *             trace source or an attribute.
+     */
+    CompiledPath(std::string path);
+
+    /**
+     * \returns The path, in canonical form (e.g., without a trailing slash).
+     */
+    std::string GetPath() const;
+
+    /**
+     * \returns The name of the trace source or attribute (the last segment).
+     */
+    std::string GetLeaf() const;
+
+    /**
+     * \param [in] index The path index of a match.
+     * \returns The matched path, as the context string passed by Config::Connect.
+     */
+    std::string GetMatchedPath(const PathIndex& index) const;
+
+    /**
+     * Find the objects owning the trace source or attribute.
+     *
+     * \param [in] f The function called with each matching object and its
+     *             path index, in the order of Config::LookupMatches.
+     * \returns The number of matching objects.
+     */
+    std::size_t Resolve(const std::function<void(Ptr<Object>, const PathIndex&)>& f) const;
+
+    /**
+     * Connect a callback to all the matching trace sources.
+     *
+     * \param [in] cb The callback.
+     * \returns The number of trace sources connected.
+     */
+    std::size_t ConnectWithoutContext(const CallbackBase& cb) const;
+
+    /**
+     * Connect a callback to all the matching trace sources, the callback
+     * receiving the matched path as its first argument (as with Config::Connect).
+     *
+     * \param [in] cb The callback.
+     * \returns The number of trace sources connected.
+     */
+    std::size_t Connect(const CallbackBase& cb) const;
+
+    /**
+     * Connect a callback to all the matching trace sources, the callback
+     * receiving the path index of the match as its first argument.
+     *
+     * \tparam Ts \deduced The arguments of the trace source.
+     * \param [in] cb The callback.
+     * \returns The number of trace sources connected.
+     */
+    template <typename... Ts>
+    std::size_t ConnectWithIndex(Callback<void, PathIndex, Ts...> cb) const;
+
+    /**
+     * Set an attribute of all the matching objects.
+     *
+     * \param [in] value The value of the attribute.
+     * \returns The number of objects whose attribute was set.
+     */
+    std::size_t Set(const AttributeValue& value) const;
+
+  private:
+    /** The kind of a segment of the path. */
+    enum SegmentKind
+    {
+        GET_OBJECT, //!< "$ns3::Type": aggregated object
+        ATTRIBUTE,  //!< attribute holding a pointer or a container
+        INDEX       //!< array element following a container attribute
+    };
+
+    /** An attribute matched by a segment. */
+    struct AttributeMatch
+    {
+        Ptr<const AttributeAccessor> accessor;               //!< the accessor
+        const ObjectPtrContainerAccessor* containerAccessor; //!< the accessor of a container
+    };
+
+    /** A segment of the path. */
+    struct Segment
+    {
+        SegmentKind kind;                                  //!< the kind of segment
+        std::string text;                                  //!< the text of the segment
+        TypeId tid;                                        //!< the TypeId (GET_OBJECT)
+        bool valid;                                        //!< whether the TypeId exists
+        std::vector<std::pair<uint32_t, uint32_t>> ranges; //!< sorted disjoint ranges (INDEX)
+        mutable std::unordered_map<uint16_t, std::vector<AttributeMatch>>
+            attributes; //!< matching attributes by TypeId uid (ATTRIBUTE)
+    };
+
+    /**
+     * Parse an array element.
+     *
+     * \param [in] text The text of the segment.
+     * \param [out] ranges The sorted disjoint ranges of indices.
+     * \returns \c true if the text is an array element.
+     */
+    static bool ParseIndex(std::string text, std::vector<std::pair<uint32_t, uint32_t>>* ranges);
+
+    /**
+     * \param [in] segment An array element segment.
+     * \param [in] i An index.
+     * \returns \c true if the index matches the segment.
+     */
+    static bool Matches(const Segment& segment, std::size_t i);
+
+    /**
+     * \param [in] segment An attribute segment.
+     * \param [in] tid The TypeId of an object.
+     * \returns The attributes of the TypeId (and its parents) matching the segment.
+     */
+    const std::vector<AttributeMatch>& GetAttributes(const Segment& segment, TypeId tid) const;
+
+    /**
+     * Resolve the path from a segment.
+     *
+     * \param [in] i The index of the segment.
+     * \param [in] object The object reached by the previous segments.
+     * \param [in,out] index The path index of the previous segments.
+     * \param [in] f The function called with each match.
+     * \returns The number of matches.
+     */
+    std::size_t DoResolve(std::size_t i,
+                          Ptr<Object> object,
+                          PathIndex& index,
+                          const std::function<void(Ptr<Object>, const PathIndex&)>& f) const;
+
+    /**
+     * Resolve the array element following a container attribute.
+     *
+     * \param [in] i The index of the array element segment.
+     * \param [in] object The object holding the container.
+     * \param [in] accessor The accessor of the container.
+     * \param [in,out] index The path index of the previous segments.
+     * \param [in] f The function called with each match.
+     * \returns The number of matches.
+     */
+    std::size_t DoArrayResolve(std::size_t i,
+                               Ptr<Object> object,
+                               const ObjectPtrContainerAccessor* accessor,
+                               PathIndex& index,
+                               const std::function<void(Ptr<Object>, const PathIndex&)>& f) const;
+
+    /**
+     * Connect callbacks to all the matching trace sources.
+     *
+     * \param [in] make The function making the callback of a match.
+     * \returns The number of trace sources connected.
+     */
+    std::size_t DoConnect(const std::function<CallbackBase(const PathIndex&)>& make) const;
+
+    /**
+     * \param [in] tid The TypeId of an object.
+     * \returns The accessor of the trace source of the TypeId, if any.
+     */
+    Ptr<const TraceSourceAccessor> GetTraceSource(TypeId tid) const;
+
+    std::vector<Segment> m_segments; //!< the segments of the path to the objects
+    std::string m_leaf;              //!< the name of the trace source or attribute
+    /** Trace source accessors by TypeId uid. */
+    mutable std::unordered_map<uint16_t, Ptr<const TraceSourceAccessor>> m_traceSources;
+};
+
+template <typename... Ts>
+std::size_t
+CompiledPath::ConnectWithIndex(Callback<void, PathIndex, Ts...> cb) const
+{
+    return DoConnect([&cb](const PathIndex& index) -> CallbackBase { return cb.Bind(index); });
+}
+
+} // namespace Config
+
+} // namespace ns3
+
+#endif /* CONFIG_PATH_H */
@@ -397,4 +397,10 @@ DefaultSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetPendingEventCount() const
+{
+    return m_unscheduledEvents;
+}
+
 } // namespace ns3
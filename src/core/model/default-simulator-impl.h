@@ -77,6 +77,7 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
+    uint64_t GetPendingEventCount() const override;
 
   private:
     void DoDispose() override;
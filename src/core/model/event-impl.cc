@@ -19,6 +19,7 @@
 
 #include "event-impl.h"
 
+#include "live-counter.h"
 #include "log.h"
 
 /**
@@ -32,15 +33,29 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+/**
+ * \ingroup events
+ * Get the counter of live events.
+ * \returns The counter of live events.
+ */
+static LiveCounter&
+GetLiveCounter()
+{
+    static LiveCounter counter("ns3_events_live", "Number of live events.");
+    return counter;
+}
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
+    GetLiveCounter().Decrement();
 }
 
 EventImpl::EventImpl()
     : m_cancel(false)
 {
     NS_LOG_FUNCTION(this);
+    GetLiveCounter().Increment();
 }
 
 void
@@ -186,6 +186,9 @@ sigHandler(int sig)
 void
 FlushStreams()
 {
+    // Write the pending log records, or dump those of the flight recorder
+    LogRecorder::FlushOnFatalError();
+
     NS_LOG_FUNCTION_NOARGS();
     std::list<std::ostream*>** pl = PeekStreamList();
     if (*pl == nullptr)
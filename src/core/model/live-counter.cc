@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::LiveCounter implementation.
+ */
+
+#include "live-counter.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace ns3
+{
+
+namespace
+{
+
+/** The registered counters. */
+struct Registry
+{
+    std::mutex mutex;                         //!< Protects counters.
+    std::vector<const LiveCounter*> counters; //!< The counters, in order of registration.
+};
+
+/**
+ * Get the registry of the counters.
+ * \returns The registry.
+ */
+Registry&
+GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+} // unnamed namespace
+
+LiveCounter::LiveCounter(const std::string& name, const std::string& help)
+    : m_name(name),
+      m_help(help),
+      m_value(0)
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.counters.push_back(this);
+}
+
+LiveCounter::~LiveCounter()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = std::find(registry.counters.begin(), registry.counters.end(), this);
+    if (it != registry.counters.end())
+    {
+        registry.counters.erase(it);
+    }
+}
+
+int64_t
+LiveCounter::Get() const
+{
+    return m_value.load(std::memory_order_relaxed);
+}
+
+std::string
+LiveCounter::GetName() const
+{
+    return m_name;
+}
+
+std::string
+LiveCounter::GetHelp() const
+{
+    return m_help;
+}
+
+/* static */
+std::vector<const LiveCounter*>
+LiveCounter::GetCounters()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.counters;
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIVE_COUNTER_H
+#define LIVE_COUNTER_H
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::LiveCounter declaration.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup core
+ * \ingroup debugging
+ *
+ * Count the live instances of a class.
+ *
+ * The constructors of the class increment the counter and its
+ * destructor decrements it, so that the counter holds the number of
+ * instances alive at any time.  The counters are registered by name
+ * and can be read from any thread, e.g., by a MetricsServer.
+ *
+ * A counter is usually returned by a function-local static, so that
+ * instances created during static initialization are counted:
+ *
+ * \code
+ *     static LiveCounter&
+ *     GetLiveCounter()
+ *     {
+ *         static LiveCounter counter("ns3_events_live", "Number of live events.");
+ *         return counter;
+ *     }
+ *
+ *     EventImpl::EventImpl()
+ *     {
+ *         GetLiveCounter().Increment();
+ *     }
+ * \endcode
+ *
+ * A class without a user-declared destructor can hold a LiveCount
+ * member instead, which keeps its destructor implicit and inline.
+ *
+ * Counters are updated with relaxed atomic operations: a counter read
+ * from another thread is exact but may be slightly out of date.
+ */
+class LiveCounter
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] name The metric name of the counter.
+     * \param [in] help The description of the counter.
+     */
+    LiveCounter(const std::string& name, const std::string& help);
+
+    /** Destructor. */
+    ~LiveCounter();
+
+    /** Count a new instance. */
+    void Increment()
+    {
+        m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Count a destroyed instance. */
+    void Decrement()
+    {
+        m_value.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of live instances.
+     * \returns The number of live instances.
+     */
+    int64_t Get() const;
+
+    /**
+     * Get the metric name of the counter.
+     * \returns The name of the counter.
+     */
+    std::string GetName() const;
+
+    /**
+     * Get the description of the counter.
+     * \returns The description of the counter.
+     */
+    std::string GetHelp() const;
+
+    /**
+     * Get the registered counters.
+     * \returns The counters, in order of registration.
+     */
+    static std::vector<const LiveCounter*> GetCounters();
+
+  private:
+    std::string m_name;           //!< The metric name.
+    std::string m_help;           //!< The description.
+    std::atomic<int64_t> m_value; //!< The number of live instances.
+
+}; // class LiveCounter
+
+/**
+ * \ingroup core
+ * \ingroup debugging
+ *
+ * Count the live instances of the class holding this member in a
+ * LiveCounter.
+ *
+ * Every constructor of the holding class, including the implicit copy
+ * constructor, constructs the member, and its destructor destroys it, so
+ * the class needs no explicit counting code and no user-declared
+ * destructor:
+ *
+ * \code
+ *     class Packet
+ *     {
+ *         static LiveCounter& GetLiveCounter();
+ *         [[no_unique_address]] LiveCount<&Packet::GetLiveCounter> m_liveCount;
+ *     };
+ * \endcode
+ *
+ * \tparam GetCounter \explicit The function returning the counter.
+ */
+template <LiveCounter& (*GetCounter)()>
+class LiveCount
+{
+  public:
+    /** Constructor. */
+    LiveCount()
+    {
+        GetCounter().Increment();
+    }
+
+    /** Copy constructor: the copy is another live instance. */
+    LiveCount(const LiveCount&)
+    {
+        GetCounter().Increment();
+    }
+
+    /**
+     * Assignment operator: the number of live instances is unchanged.
+     * \returns This object.
+     */
+    LiveCount& operator=(const LiveCount&)
+    {
+        return *this;
+    }
+
+    /** Destructor. */
+    ~LiveCount()
+    {
+        GetCounter().Decrement();
+    }
+}; // class LiveCount
+
+} // namespace ns3
+
+#endif /* LIVE_COUNTER_H */
@@ -159,6 +159,40 @@
 #define NS_LOG_CONDITION
 #endif
 
+/**
+ * \ingroup logging
+ * Stringify the expansion of a macro, which may contain commas.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ */
+#define NS_LOG_STRINGIFY(...) NS_LOG_STRINGIFY_IMPL(__VA_ARGS__)
+
+/**
+ * \ingroup logging
+ * Implementation details for NS_LOG_STRINGIFY.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ */
+#define NS_LOG_STRINGIFY_IMPL(...) #__VA_ARGS__
+
+/**
+ * \ingroup logging
+ * Capture the output of NS_LOG_APPEND_CONTEXT into a log record.
+ *
+ * Nothing is done if NS_LOG_APPEND_CONTEXT is empty, as in most files.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] record The ns3::LogRecord.
+ */
+#define NS_LOG_RECORD_CONTEXT(record)                                                              \
+    if constexpr (sizeof(NS_LOG_STRINGIFY(NS_LOG_APPEND_CONTEXT)) > 1)                             \
+    {                                                                                              \
+        record.BeginContext();                                                                     \
+        NS_LOG_APPEND_CONTEXT;                                                                     \
+        record.EndContext();                                                                       \
+    }
+
 /**
  * \ingroup logging
  *
@@ -168,6 +202,9 @@
  * The log message is expected to be a C++ ostream
  * message such as "my string" << aNumber << "my oth stream".
  *
+ * If the ns3::LogRecorder is active, the message is recorded rather
+ * than formatted into \c std::clog.
+ *
  * Typical usage looks like:
  * \code
  * NS_LOG (LOG_DEBUG, "a number="<<aNumber<<", anotherNumber="<<anotherNumber);
@@ -184,14 +221,29 @@
     {                                                                                              \
         if (g_log.IsEnabled(level))                                                                \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            NS_LOG_APPEND_FUNC_PREFIX;                                                             \
-            NS_LOG_APPEND_LEVEL_PREFIX(level);                                                     \
-            auto flags = std::clog.setf(std::ios_base::boolalpha);                                 \
-            std::clog << msg << std::endl;                                                         \
-            std::clog.flags(flags);                                                                \
+            if (ns3::LogRecorder::IsActive())                                                      \
+            {                                                                                      \
+                static const ns3::LogSite ns3LogSite(g_log,                                        \
+                                                     level,                                        \
+                                                     ns3::LogSite::MESSAGE,                        \
+                                                     __FILE__,                                     \
+                                                     __LINE__,                                     \
+                                                     __FUNCTION__);                                \
+                ns3::LogRecord ns3LogRecord(ns3LogSite, g_log);                                    \
+                NS_LOG_RECORD_CONTEXT(ns3LogRecord);                                               \
+                ns3LogRecord << msg;                                                               \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                NS_LOG_APPEND_TIME_PREFIX;                                                         \
+                NS_LOG_APPEND_NODE_PREFIX;                                                         \
+                NS_LOG_APPEND_CONTEXT;                                                             \
+                NS_LOG_APPEND_FUNC_PREFIX;                                                         \
+                NS_LOG_APPEND_LEVEL_PREFIX(level);                                                 \
+                auto flags = std::clog.setf(std::ios_base::boolalpha);                             \
+                std::clog << msg << std::endl;                                                     \
+                std::clog.flags(flags);                                                            \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
@@ -209,10 +261,24 @@
     {                                                                                              \
         if (g_log.IsEnabled(ns3::LOG_FUNCTION))                                                    \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            std::clog << g_log.Name() << ":" << __FUNCTION__ << "()" << std::endl;                 \
+            if (ns3::LogRecorder::IsActive())                                                      \
+            {                                                                                      \
+                static const ns3::LogSite ns3LogSite(g_log,                                        \
+                                                     ns3::LOG_FUNCTION,                            \
+                                                     ns3::LogSite::FUNCTION,                       \
+                                                     __FILE__,                                     \
+                                                     __LINE__,                                     \
+                                                     __FUNCTION__);                                \
+                ns3::LogRecord ns3LogRecord(ns3LogSite, g_log);                                    \
+                NS_LOG_RECORD_CONTEXT(ns3LogRecord);                                               \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                NS_LOG_APPEND_TIME_PREFIX;                                                         \
+                NS_LOG_APPEND_NODE_PREFIX;                                                         \
+                NS_LOG_APPEND_CONTEXT;                                                             \
+                std::clog << g_log.Name() << ":" << __FUNCTION__ << "()" << std::endl;             \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
@@ -243,14 +309,29 @@
     {                                                                                              \
         if (g_log.IsEnabled(ns3::LOG_FUNCTION))                                                    \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            std::clog << g_log.Name() << ":" << __FUNCTION__ << "(";                               \
-            auto flags = std::clog.setf(std::ios_base::boolalpha);                                 \
-            ns3::ParameterLogger(std::clog) << parameters;                                         \
-            std::clog.flags(flags);                                                                \
-            std::clog << ")" << std::endl;                                                         \
+            if (ns3::LogRecorder::IsActive())                                                      \
+            {                                                                                      \
+                static const ns3::LogSite ns3LogSite(g_log,                                        \
+                                                     ns3::LOG_FUNCTION,                            \
+                                                     ns3::LogSite::FUNCTION,                       \
+                                                     __FILE__,                                     \
+                                                     __LINE__,                                     \
+                                                     __FUNCTION__);                                \
+                ns3::LogRecord ns3LogRecord(ns3LogSite, g_log);                                    \
+                NS_LOG_RECORD_CONTEXT(ns3LogRecord);                                               \
+                ns3LogRecord.Parameters() << parameters;                                           \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                NS_LOG_APPEND_TIME_PREFIX;                                                         \
+                NS_LOG_APPEND_NODE_PREFIX;                                                         \
+                NS_LOG_APPEND_CONTEXT;                                                             \
+                std::clog << g_log.Name() << ":" << __FUNCTION__ << "(";                           \
+                auto flags = std::clog.setf(std::ios_base::boolalpha);                             \
+                ns3::ParameterLogger(std::clog) << parameters;                                     \
+                std::clog.flags(flags);                                                            \
+                std::clog << ")" << std::endl;                                                     \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
@@ -259,6 +340,9 @@
  *
  * Output the requested message unconditionally.
  *
+ * The message is formatted into \c std::clog even if the
+ * ns3::LogRecorder is active.
+ *
  * \param [in] msg The message to log
  */
 #define NS_LOG_UNCOND(msg)                                                                         \
@@ -0,0 +1,1365 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-recorder.h"
+
+#include "environment-variable.h"
+#include "fatal-error.h"
+#include "node-printer.h"
+#include "nstime.h"
+#include "simulator.h"
+#include "time-printer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogRecorder, ns3::LogSite, ns3::LogRecord and ns3::LogParameters implementations.
+ *
+ * A record is made of its size (32 bits, including the size), the id of
+ * its call site (32 bits), flags (8 bits), the prefixes selected by the
+ * flags and the tagged values of the message. A binary file is made of
+ * an 8-byte magic string, a 32-bit version, the time resolution (8 bits)
+ * and a sequence of chunks:
+ * - a sites chunk: the type (1, 8 bits), the number of new call sites
+ *   (32 bits) and, for each site by increasing id, the component, file
+ *   and function (strings), the level (32 bits), the kind (8 bits) and
+ *   the line (32 bits);
+ * - a records chunk: the type (2, 8 bits), the size of the records (32
+ *   bits) and the records.
+ *
+ * Strings are stored as their length (32 bits) followed by their
+ * characters, and all integers are in host byte order.
+ */
+
+namespace ns3
+{
+
+namespace
+{
+
+/** The flags of a record, selecting its prefixes. */
+enum RecordFlags : uint8_t
+{
+    HAS_TIME = 0x01,    //!< the time step (64 bits)
+    HAS_NODE = 0x02,    //!< the context (32 bits)
+    HAS_CONTEXT = 0x04, //!< a string (the output of NS_LOG_APPEND_CONTEXT, custom printers)
+    HAS_FUNC = 0x08,    //!< the function prefix is enabled
+    HAS_LEVEL = 0x10    //!< the level prefix is enabled
+};
+
+/** The types of the chunks of a binary file. */
+enum ChunkType : uint8_t
+{
+    SITES_CHUNK = 1,  //!< new call sites
+    RECORDS_CHUNK = 2 //!< records
+};
+
+/** The magic string of a binary file. */
+constexpr char MAGIC[8] = {'N', 'S', '3', 'L', 'O', 'G', 'R', 'C'};
+/** The version of the binary file format. */
+constexpr uint32_t VERSION = 1;
+/** The size of the header of a record: size, site id and flags. */
+constexpr std::size_t HEADER_SIZE = 9;
+
+/** \ingroup logging A call site, as needed to format its records. */
+struct SiteInfo
+{
+    std::string component; //!< the log component
+    std::string file;      //!< the source file
+    std::string function;  //!< the function
+    uint32_t level;        //!< the level of the messages
+    uint8_t kind;          //!< the LogSite::Kind
+    uint32_t line;         //!< the source line
+};
+
+/** \ingroup logging The state of a LogRecord being built. */
+struct Slot
+{
+    std::vector<char> buffer;  //!< the record
+    std::ostringstream stream; //!< formats the values that are not recorded raw
+    std::stringbuf context;    //!< captures the output of NS_LOG_APPEND_CONTEXT
+};
+
+/**
+ * \ingroup logging
+ * \brief The ring of the records of a logging thread
+ *
+ * The logging thread is the only producer. The consumer is the background
+ * thread, or any thread holding the lock of the recorder; in FLIGHT_RECORDER
+ * mode the producer drops the oldest records itself.
+ */
+struct Ring
+{
+    /**
+     * \param [in] size The size in bytes, a power of two.
+     */
+    Ring(uint64_t size)
+        : data(size),
+          mask(size - 1)
+    {
+    }
+
+    /** \returns The number of free bytes. */
+    uint64_t GetFree() const
+    {
+        return data.size() -
+               (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+    /**
+     * Copy bytes out of the ring.
+     *
+     * \param [in] position The position of the first byte.
+     * \param [out] bytes The destination.
+     * \param [in] size The number of bytes.
+     */
+    void Read(uint64_t position, char* bytes, std::size_t size) const
+    {
+        uint64_t offset = position & mask;
+        std::size_t first = std::min<uint64_t>(size, data.size() - offset);
+        std::memcpy(bytes, &data[offset], first);
+        std::memcpy(bytes + first, data.data(), size - first);
+    }
+
+    /**
+     * Push a record, which must fit.
+     *
+     * \param [in] bytes The record.
+     * \param [in] size The size of the record.
+     */
+    void Push(const char* bytes, std::size_t size)
+    {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t offset = h & mask;
+        std::size_t first = std::min<uint64_t>(size, data.size() - offset);
+        std::memcpy(&data[offset], bytes, first);
+        std::memcpy(data.data(), bytes + first, size - first);
+        head.store(h + size, std::memory_order_release);
+    }
+
+    /** Drop the oldest record (FLIGHT_RECORDER mode). */
+    void Pop()
+    {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint32_t size;
+        Read(t, reinterpret_cast<char*>(&size), sizeof(size));
+        tail.store(t + size, std::memory_order_release);
+        count--;
+    }
+
+    std::vector<char> data;          //!< the bytes
+    uint64_t mask;                   //!< data.size () - 1
+    std::atomic<uint64_t> head{0};   //!< the position of the next record pushed
+    std::atomic<uint64_t> tail{0};   //!< the position of the oldest record
+    uint32_t count{0};               //!< the number of records (FLIGHT_RECORDER mode)
+    std::atomic<bool> exited{false}; //!< whether the logging thread has exited
+};
+
+/** \ingroup logging The recording state of a logging thread. */
+struct ThreadState
+{
+    /** Mark the ring as orphaned, to be freed once drained. */
+    ~ThreadState();
+
+    Ring* ring{nullptr};                      //!< the ring of the thread
+    uint64_t generation{0};                   //!< the generation of the ring
+    std::vector<std::unique_ptr<Slot>> slots; //!< the slots, by nesting depth
+    std::size_t depth{0};                     //!< the number of records being built
+};
+
+/** The recording state of the current thread. */
+thread_local ThreadState t_state;
+
+/**
+ * \ingroup logging
+ * Reads the fields of a record or of a binary file.
+ */
+class RecordReader
+{
+  public:
+    /**
+     * \param [in] begin The first byte.
+     * \param [in] end Past the last byte.
+     */
+    RecordReader(const char* begin, const char* end)
+        : m_current(begin),
+          m_end(end)
+    {
+    }
+
+    /** \returns \c true if all the bytes were read. */
+    bool AtEnd() const
+    {
+        return m_current == m_end;
+    }
+
+    /**
+     * \tparam T \deduced The type of the field.
+     * \param [out] value The field.
+     * \returns \c false if the record is truncated.
+     */
+    template <typename T>
+    bool Get(T& value)
+    {
+        if (static_cast<std::size_t>(m_end - m_current) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, m_current, sizeof(T));
+        m_current += sizeof(T);
+        return true;
+    }
+
+    /**
+     * \param [out] value The string.
+     * \returns \c false if the record is truncated.
+     */
+    bool GetString(std::string_view& value)
+    {
+        uint32_t size;
+        if (!Get(size) || static_cast<std::size_t>(m_end - m_current) < size)
+        {
+            return false;
+        }
+        value = std::string_view(m_current, size);
+        m_current += size;
+        return true;
+    }
+
+  private:
+    const char* m_current; //!< the next byte
+    const char* m_end;     //!< past the last byte
+};
+
+/**
+ * \ingroup logging
+ * Format a time as DefaultTimePrinter does.
+ *
+ * \param [in] os The output stream.
+ * \param [in] timeStep The time step.
+ * \param [in] resolution The time resolution.
+ */
+void
+FormatTime(std::ostream& os, int64_t timeStep, Time::Unit resolution)
+{
+    // The number of seconds of the units coarser than a second
+    static const double SECONDS[] = {365 * 86400.0, 86400.0, 3600.0, 60.0, 1.0};
+    // The number of units per second of the other units
+    static const double PER_SECOND[] = {1e3, 1e6, 1e9, 1e12, 1e15};
+
+    double seconds;
+    if (resolution <= Time::S)
+    {
+        seconds = timeStep * SECONDS[resolution];
+    }
+    else
+    {
+        seconds = timeStep / PER_SECOND[resolution - Time::MS];
+    }
+
+    int precision;
+    switch (resolution)
+    {
+    case Time::US:
+        precision = 6;
+        break;
+    case Time::NS:
+        precision = 9;
+        break;
+    case Time::PS:
+        precision = 12;
+        break;
+    case Time::FS:
+        precision = 15;
+        break;
+    default:
+        // default C++ precision of 5
+        precision = 5;
+    }
+
+    std::ios_base::fmtflags ff = os.flags();
+    std::streamsize oldPrecision = os.precision();
+    os << std::fixed << std::setprecision(precision) << std::showpos << seconds << "s";
+    os.precision(oldPrecision);
+    os.flags(ff);
+}
+
+/**
+ * \ingroup logging
+ * Format a record as the NS_LOG macros do.
+ *
+ * \param [in] record The record, including its size.
+ * \param [in] size The size of the record.
+ * \param [in] sites The call sites, by id.
+ * \param [in] resolution The time resolution.
+ * \param [in] os The output stream.
+ * \returns \c false if the record is corrupted.
+ */
+bool
+FormatRecord(const char* record,
+             std::size_t size,
+             const std::vector<SiteInfo>& sites,
+             Time::Unit resolution,
+             std::ostream& os)
+{
+    RecordReader reader(record + sizeof(uint32_t), record + size);
+    uint32_t id;
+    uint8_t flags;
+    if (!reader.Get(id) || !reader.Get(flags) || id >= sites.size())
+    {
+        return false;
+    }
+    const SiteInfo& site = sites[id];
+
+    if (flags & HAS_TIME)
+    {
+        int64_t timeStep;
+        if (!reader.Get(timeStep))
+        {
+            return false;
+        }
+        FormatTime(os, timeStep, resolution);
+        os << " ";
+    }
+    if (flags & HAS_NODE)
+    {
+        uint32_t context;
+        if (!reader.Get(context))
+        {
+            return false;
+        }
+        if (context == Simulator::NO_CONTEXT)
+        {
+            os << "-1 ";
+        }
+        else
+        {
+            os << context << " ";
+        }
+    }
+    if (flags & HAS_CONTEXT)
+    {
+        std::string_view context;
+        if (!reader.GetString(context))
+        {
+            return false;
+        }
+        os << context;
+    }
+
+    if (site.kind == LogSite::FUNCTION)
+    {
+        os << site.component << ":" << site.function << "(";
+    }
+    else
+    {
+        if (flags & HAS_FUNC)
+        {
+            os << site.component << ":" << site.function << "(): ";
+        }
+        if (flags & HAS_LEVEL)
+        {
+            os << "[" << LogComponent::GetLevelLabel(static_cast<LogLevel>(site.level)) << "] ";
+        }
+    }
+
+    auto ff = os.setf(std::ios_base::boolalpha);
+    bool ok = true;
+    while (ok && !reader.AtEnd())
+    {
+        uint8_t tag = 0;
+        reader.Get(tag);
+        if (tag & LogRecord::SEPARATED)
+        {
+            os << ", ";
+        }
+        if (tag & LogRecord::QUOTED)
+        {
+            os << "\"";
+        }
+        switch (tag & LogRecord::TYPE)
+        {
+        case LogRecord::BOOL: {
+            uint8_t value = 0;
+            ok = reader.Get(value);
+            os << (value != 0);
+            break;
+        }
+        case LogRecord::CHAR: {
+            uint8_t value = 0;
+            ok = reader.Get(value);
+            os << static_cast<char>(value);
+            break;
+        }
+        case LogRecord::INT: {
+            int64_t value = 0;
+            ok = reader.Get(value);
+            os << value;
+            break;
+        }
+        case LogRecord::UINT: {
+            uint64_t value = 0;
+            ok = reader.Get(value);
+            os << value;
+            break;
+        }
+        case LogRecord::DOUBLE: {
+            double value = 0;
+            ok = reader.Get(value);
+            os << value;
+            break;
+        }
+        case LogRecord::STRING: {
+            std::string_view value;
+            ok = reader.GetString(value);
+            os << value;
+            break;
+        }
+        case LogRecord::POINTER: {
+            uint64_t value = 0;
+            ok = reader.Get(value);
+            os << reinterpret_cast<const void*>(static_cast<uintptr_t>(value));
+            break;
+        }
+        default:
+            ok = false;
+        }
+        if (tag & LogRecord::QUOTED)
+        {
+            os << "\"";
+        }
+    }
+    os.flags(ff);
+
+    if (site.kind == LogSite::FUNCTION)
+    {
+        os << ")";
+    }
+    os << "\n";
+    return ok;
+}
+
+/**
+ * \ingroup logging
+ * \brief The records of all the logging threads, and the background thread
+ *
+ * The recorder is never deleted: threads may log during static destruction.
+ */
+class Recorder
+{
+  public:
+    /** \returns The recorder. */
+    static Recorder* Get()
+    {
+        static Recorder* recorder = new Recorder();
+        return recorder;
+    }
+
+    /**
+     * Start recording.
+     *
+     * \param [in] mode The mode (not TEXT).
+     * \param [in] fileName The name of the file (BINARY).
+     * \param [in] nRecords The number of records kept (FLIGHT_RECORDER).
+     * \param [in] ringSize The size of the rings.
+     */
+    void Enable(LogRecorder::Mode mode,
+                const std::string& fileName,
+                uint32_t nRecords,
+                uint32_t ringSize)
+    {
+        Disable();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t size = 4096;
+        while (size < ringSize)
+        {
+            size <<= 1;
+        }
+        m_ringSize = size;
+        m_nRecords = std::max<uint32_t>(nRecords, 1);
+        m_mode = mode;
+        m_headerWritten = false;
+        m_writtenSites = 0;
+        if (mode == LogRecorder::BINARY)
+        {
+            m_file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!m_file.is_open())
+            {
+                m_mode = LogRecorder::TEXT;
+                lock.unlock();
+                NS_FATAL_ERROR("Unable to open log file " << fileName);
+            }
+        }
+        if (mode == LogRecorder::ASYNC)
+        {
+            m_text = std::make_unique<std::ostream>(std::clog.rdbuf());
+        }
+        m_generation.fetch_add(1, std::memory_order_relaxed);
+        if (mode != LogRecorder::FLIGHT_RECORDER)
+        {
+            m_stop = false;
+            m_thread = std::thread(&Recorder::Run, this);
+        }
+
+        if (!m_atExit)
+        {
+            m_atExit = true;
+            std::atexit([] { LogRecorder::Disable(); });
+        }
+    }
+
+    /** Stop recording, writing the pending records. */
+    void Disable()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_mode == LogRecorder::TEXT)
+            {
+                return;
+            }
+            m_stop = true;
+        }
+        m_wakeCv.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_mode != LogRecorder::FLIGHT_RECORDER)
+        {
+            DrainAll();
+        }
+        m_rings.clear();
+        m_generation.fetch_add(1, std::memory_order_relaxed);
+        m_text.reset();
+        if (m_file.is_open())
+        {
+            m_file.close();
+        }
+        m_mode = LogRecorder::TEXT;
+    }
+
+    /** \returns The mode. */
+    LogRecorder::Mode GetMode()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_mode;
+    }
+
+    /**
+     * Register a call site.
+     *
+     * \param [in] site The call site.
+     * \returns The id of the call site.
+     */
+    uint32_t RegisterSite(SiteInfo site)
+    {
+        std::lock_guard<std::mutex> lock(m_siteMutex);
+        m_sites.push_back(std::move(site));
+        return m_sites.size() - 1;
+    }
+
+    /**
+     * Push a record into the ring of the current thread.
+     *
+     * \param [in] record The record.
+     */
+    void Commit(const std::vector<char>& record)
+    {
+        ThreadState& state = t_state;
+        if (state.ring == nullptr ||
+            state.generation != m_generation.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_mode == LogRecorder::TEXT)
+            {
+                return;
+            }
+            m_rings.push_back(std::make_unique<Ring>(m_ringSize));
+            state.ring = m_rings.back().get();
+            state.generation = m_generation.load(std::memory_order_relaxed);
+        }
+        Ring* ring = state.ring;
+        std::size_t size = record.size();
+
+        if (m_mode == LogRecorder::FLIGHT_RECORDER)
+        {
+            if (size > ring->data.size())
+            {
+                return;
+            }
+            while (ring->count > 0 && (ring->GetFree() < size || ring->count >= m_nRecords))
+            {
+                ring->Pop();
+            }
+            ring->Push(record.data(), size);
+            ring->count++;
+            return;
+        }
+
+        if (ring->GetFree() < size)
+        {
+            // Make room by writing the ring from this thread
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Drain(ring);
+            if (size > ring->data.size())
+            {
+                Write(record.data(), size);
+                return;
+            }
+        }
+        uint64_t quarter = ring->data.size() / 4;
+        bool wasBelow = ring->data.size() - ring->GetFree() < quarter;
+        ring->Push(record.data(), size);
+
+        // Wake the thread up once per quarter of the ring rather than at each record
+        if (wasBelow && ring->data.size() - ring->GetFree() >= quarter)
+        {
+            m_wake.store(true, std::memory_order_relaxed);
+            m_wakeCv.notify_one();
+        }
+    }
+
+    /** Write the pending records. */
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_mode == LogRecorder::ASYNC || m_mode == LogRecorder::BINARY)
+        {
+            DrainAll();
+        }
+    }
+
+    /**
+     * Format and drop the records of the flight recorder.
+     *
+     * \param [in] os The output stream.
+     * \returns The number of records formatted.
+     */
+    uint64_t Dump(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return DoDump(os);
+    }
+
+    /** Write the pending records, or dump the flight recorder, unless the lock is held. */
+    void FlushOnFatalError()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return;
+        }
+        if (m_mode == LogRecorder::FLIGHT_RECORDER)
+        {
+            DoDump(std::clog);
+        }
+        else if (m_mode != LogRecorder::TEXT)
+        {
+            DrainAll();
+        }
+    }
+
+    /**
+     * Mark the ring of an exiting thread as orphaned.
+     *
+     * \param [in] state The state of the thread.
+     */
+    void Orphan(const ThreadState& state)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (state.ring != nullptr &&
+            state.generation == m_generation.load(std::memory_order_relaxed))
+        {
+            state.ring->exited.store(true, std::memory_order_release);
+        }
+    }
+
+  private:
+    Recorder() = default;
+
+    /**
+     * Write the records of a ring (the lock being held).
+     *
+     * \param [in] ring The ring.
+     * \returns \c true if there were records.
+     */
+    bool Drain(Ring* ring)
+    {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head == tail)
+        {
+            return false;
+        }
+        if (m_mode == LogRecorder::BINARY)
+        {
+            WriteSites();
+            m_scratch.resize(head - tail);
+            ring->Read(tail, m_scratch.data(), m_scratch.size());
+            uint32_t size = m_scratch.size();
+            m_file.put(RECORDS_CHUNK);
+            m_file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            m_file.write(m_scratch.data(), size);
+        }
+        else
+        {
+            while (tail != head)
+            {
+                uint32_t size;
+                ring->Read(tail, reinterpret_cast<char*>(&size), sizeof(size));
+                m_scratch.resize(size);
+                ring->Read(tail, m_scratch.data(), size);
+                Write(m_scratch.data(), size);
+                tail += size;
+            }
+            WriteText();
+        }
+        ring->tail.store(head, std::memory_order_release);
+        m_dirty = true;
+        return true;
+    }
+
+    /** Write the records of all the rings and flush the output (the lock being held). */
+    void DrainAll()
+    {
+        for (auto& ring : m_rings)
+        {
+            Drain(ring.get());
+        }
+        FlushOutput();
+    }
+
+    /**
+     * Write a record (the lock being held).
+     *
+     * \param [in] record The record.
+     * \param [in] size The size of the record.
+     */
+    void Write(const char* record, std::size_t size)
+    {
+        if (m_mode == LogRecorder::BINARY)
+        {
+            WriteSites();
+            uint32_t chunkSize = size;
+            m_file.put(RECORDS_CHUNK);
+            m_file.write(reinterpret_cast<const char*>(&chunkSize), sizeof(chunkSize));
+            m_file.write(record, size);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_siteMutex);
+            FormatRecord(record, size, m_sites, Time::GetResolution(), m_formatted);
+        }
+        m_dirty = true;
+    }
+
+    /** Write the header of the binary file and the new call sites (the lock being held). */
+    void WriteSites()
+    {
+        if (!m_headerWritten)
+        {
+            m_file.write(MAGIC, sizeof(MAGIC));
+            m_file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+            m_file.put(static_cast<char>(Time::GetResolution()));
+            m_headerWritten = true;
+        }
+
+        // The sites of the records pushed so far were registered before
+        std::lock_guard<std::mutex> lock(m_siteMutex);
+        if (m_writtenSites == m_sites.size())
+        {
+            return;
+        }
+        auto putString = [this](const std::string& s) {
+            uint32_t size = s.size();
+            m_file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            m_file.write(s.data(), size);
+        };
+        uint32_t n = m_sites.size() - m_writtenSites;
+        m_file.put(SITES_CHUNK);
+        m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (; m_writtenSites < m_sites.size(); m_writtenSites++)
+        {
+            const SiteInfo& site = m_sites[m_writtenSites];
+            putString(site.component);
+            putString(site.file);
+            putString(site.function);
+            m_file.write(reinterpret_cast<const char*>(&site.level), sizeof(site.level));
+            m_file.put(site.kind);
+            m_file.write(reinterpret_cast<const char*>(&site.line), sizeof(site.line));
+        }
+    }
+
+    /**
+     * Write the formatted records (the lock being held): std::clog is
+     * usually unbuffered, hence a batch of records is written at once.
+     */
+    void WriteText()
+    {
+        std::string text = m_formatted.str();
+        m_text->write(text.data(), text.size());
+        m_formatted.str("");
+    }
+
+    /** Flush the output if records were written (the lock being held). */
+    void FlushOutput()
+    {
+        if (!m_dirty)
+        {
+            return;
+        }
+        if (m_text)
+        {
+            WriteText();
+            m_text->flush();
+        }
+        if (m_file.is_open())
+        {
+            m_file.flush();
+        }
+        m_dirty = false;
+    }
+
+    /**
+     * Format and drop the records of the flight recorder (the lock being held).
+     *
+     * \param [in] os The output stream.
+     * \returns The number of records formatted.
+     */
+    uint64_t DoDump(std::ostream& os)
+    {
+        if (m_mode != LogRecorder::FLIGHT_RECORDER)
+        {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(m_siteMutex);
+        uint64_t n = 0;
+        for (auto& ring : m_rings)
+        {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            while (tail != head)
+            {
+                uint32_t size;
+                ring->Read(tail, reinterpret_cast<char*>(&size), sizeof(size));
+                m_scratch.resize(size);
+                ring->Read(tail, m_scratch.data(), size);
+                FormatRecord(m_scratch.data(), size, m_sites, Time::GetResolution(), os);
+                tail += size;
+                n++;
+            }
+            ring->tail.store(head, std::memory_order_release);
+            ring->count = 0;
+        }
+        os.flush();
+        return n;
+    }
+
+    /** The body of the background thread. */
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop)
+        {
+            bool busy = false;
+            for (auto it = m_rings.begin(); it != m_rings.end();)
+            {
+                busy |= Drain(it->get());
+                if ((*it)->exited.load(std::memory_order_acquire) && (*it)->GetFree() == m_ringSize)
+                {
+                    it = m_rings.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            if (busy)
+            {
+                // Let the producers waiting for the lock in
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+                continue;
+            }
+            FlushOutput();
+            m_wakeCv.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return m_wake.load(std::memory_order_relaxed) || m_stop;
+            });
+            m_wake.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    std::mutex m_mutex;                          //!< protects the rings and the output
+    std::condition_variable m_wakeCv;            //!< wakes the background thread up
+    std::atomic<bool> m_wake{false};             //!< whether a producer asked for a drain
+    bool m_stop{false};                          //!< whether the background thread must stop
+    std::thread m_thread;                        //!< the background thread
+    LogRecorder::Mode m_mode{LogRecorder::TEXT}; //!< the mode
+    uint64_t m_ringSize{0};                      //!< the size of the rings
+    uint32_t m_nRecords{0};                      //!< the number of records kept (FLIGHT_RECORDER)
+    std::vector<std::unique_ptr<Ring>> m_rings;  //!< the rings of the logging threads
+    std::atomic<uint64_t> m_generation{0};       //!< incremented when the rings are replaced
+    bool m_atExit{false};                        //!< whether Disable is registered with atexit
+    std::vector<char> m_scratch;                 //!< a record copied out of a ring
+    std::unique_ptr<std::ostream> m_text;        //!< the text output (ASYNC)
+    std::ostringstream m_formatted;              //!< the records formatted for m_text
+    std::ofstream m_file;                        //!< the binary output (BINARY)
+    bool m_headerWritten{false};                 //!< whether the file header was written
+    bool m_dirty{false};                         //!< whether the output needs a flush
+
+    std::mutex m_siteMutex;        //!< protects the call sites
+    std::vector<SiteInfo> m_sites; //!< the call sites, by id
+    uint32_t m_writtenSites{0};    //!< the number of call sites written to the file
+};
+
+ThreadState::~ThreadState()
+{
+    Recorder::Get()->Orphan(*this);
+}
+
+/**
+ * \ingroup logging
+ * Handler for the \c NS_LOG_BACKEND environment variable.
+ *
+ * A static instance of this class is instantiated below, so the
+ * recorder is enabled before any other logging action can take place.
+ */
+class BackendEnvironment
+{
+  public:
+    BackendEnvironment(); //!< Constructor, enables the recorder.
+};
+
+/** Invoke the handler for the \c NS_LOG_BACKEND environment variable. */
+BackendEnvironment g_backendEnvironment;
+
+BackendEnvironment::BackendEnvironment()
+{
+    auto [found, value] = EnvironmentVariable::Get("NS_LOG_BACKEND");
+    if (!found || value.empty() || value == "text")
+    {
+        return;
+    }
+    std::string::size_type equal = value.find('=');
+    std::string backend = value.substr(0, equal);
+    std::string argument = equal == std::string::npos ? "" : value.substr(equal + 1);
+    if (backend == "async")
+    {
+        LogRecorder::EnableAsync();
+    }
+    else if (backend == "binary")
+    {
+        LogRecorder::EnableBinary(argument.empty() ? "ns3-log.bin" : argument);
+    }
+    else if (backend == "flight")
+    {
+        LogRecorder::EnableFlightRecorder(argument.empty() ? 1000 : std::stoul(argument));
+    }
+    else
+    {
+        NS_FATAL_ERROR("Invalid NS_LOG_BACKEND value \"" << value << "\"");
+    }
+}
+
+} // unnamed namespace
+
+std::atomic<bool> LogRecorder::m_active{false};
+
+void
+LogRecorder::EnableAsync(uint32_t ringSize)
+{
+    Recorder::Get()->Enable(ASYNC, "", 0, ringSize);
+    m_active.store(true, std::memory_order_relaxed);
+}
+
+void
+LogRecorder::EnableBinary(const std::string& fileName, uint32_t ringSize)
+{
+    Recorder::Get()->Enable(BINARY, fileName, 0, ringSize);
+    m_active.store(true, std::memory_order_relaxed);
+}
+
+void
+LogRecorder::EnableFlightRecorder(uint32_t nRecords, uint32_t ringSize)
+{
+    Recorder::Get()->Enable(FLIGHT_RECORDER, "", nRecords, ringSize);
+    m_active.store(true, std::memory_order_relaxed);
+}
+
+void
+LogRecorder::Disable()
+{
+    m_active.store(false, std::memory_order_relaxed);
+    Recorder::Get()->Disable();
+}
+
+LogRecorder::Mode
+LogRecorder::GetMode()
+{
+    return Recorder::Get()->GetMode();
+}
+
+void
+LogRecorder::Flush()
+{
+    Recorder::Get()->Flush();
+}
+
+uint64_t
+LogRecorder::Dump(std::ostream& os)
+{
+    return Recorder::Get()->Dump(os);
+}
+
+void
+LogRecorder::FlushOnFatalError()
+{
+    if (IsActive())
+    {
+        Recorder::Get()->FlushOnFatalError();
+    }
+}
+
+bool
+LogRecorder::Decode(std::istream& is, std::ostream& os)
+{
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    char resolution;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char*>(&version), sizeof(version));
+    is.get(resolution);
+    if (!is || !std::equal(magic, magic + sizeof(magic), MAGIC) || version != VERSION ||
+        resolution < Time::Y || resolution >= Time::LAST)
+    {
+        return false;
+    }
+
+    std::vector<SiteInfo> sites;
+    std::vector<char> chunk;
+    char type;
+    while (is.get(type))
+    {
+        uint32_t n;
+        if (!is.read(reinterpret_cast<char*>(&n), sizeof(n)))
+        {
+            return false;
+        }
+        if (type == SITES_CHUNK)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                SiteInfo site;
+                for (std::string* s : {&site.component, &site.file, &site.function})
+                {
+                    uint32_t size = 0;
+                    is.read(reinterpret_cast<char*>(&size), sizeof(size));
+                    s->resize(is ? size : 0);
+                    is.read(s->data(), s->size());
+                }
+                is.read(reinterpret_cast<char*>(&site.level), sizeof(site.level));
+                site.kind = is.get();
+                is.read(reinterpret_cast<char*>(&site.line), sizeof(site.line));
+                if (!is)
+                {
+                    return false;
+                }
+                sites.push_back(std::move(site));
+            }
+        }
+        else if (type == RECORDS_CHUNK)
+        {
+            chunk.resize(n);
+            if (!is.read(chunk.data(), n))
+            {
+                return false;
+            }
+            std::size_t offset = 0;
+            while (offset < n)
+            {
+                uint32_t size = 0;
+                if (n - offset >= sizeof(size))
+                {
+                    std::memcpy(&size, &chunk[offset], sizeof(size));
+                }
+                if (size < HEADER_SIZE || size > n - offset ||
+                    !FormatRecord(&chunk[offset],
+                                  size,
+                                  sites,
+                                  static_cast<Time::Unit>(resolution),
+                                  os))
+                {
+                    return false;
+                }
+                offset += size;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return is.eof();
+}
+
+LogSite::LogSite(const LogComponent& component,
+                 LogLevel level,
+                 Kind kind,
+                 const char* file,
+                 int line,
+                 const char* function)
+{
+    m_id = Recorder::Get()->RegisterSite(
+        {component.Name(), file, function, static_cast<uint32_t>(level), kind, uint32_t(line)});
+}
+
+/**
+ * \ingroup logging
+ * Get the slot of a record being started on the current thread.
+ *
+ * \returns The slot.
+ */
+static Slot&
+AcquireSlot()
+{
+    ThreadState& state = t_state;
+    // Records nest when a value formatted in place logs itself
+    if (state.depth == state.slots.size())
+    {
+        state.slots.push_back(std::make_unique<Slot>());
+    }
+    return *state.slots[state.depth++];
+}
+
+/**
+ * \ingroup logging
+ * \returns The slot of the innermost record being built on the current thread.
+ */
+static Slot&
+GetSlot()
+{
+    return *t_state.slots[t_state.depth - 1];
+}
+
+/**
+ * \ingroup logging
+ * Append a string to a record.
+ *
+ * \param [in,out] buffer The record.
+ * \param [in] data The characters.
+ * \param [in] size The number of characters.
+ */
+static void
+AppendString(std::vector<char>& buffer, const char* data, std::size_t size)
+{
+    uint32_t length = size;
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(length) + size);
+    std::memcpy(&buffer[offset], &length, sizeof(length));
+    std::memcpy(&buffer[offset + sizeof(length)], data, size);
+}
+
+/**
+ * \ingroup logging
+ * Reset a stream to the state of std::clog in the NS_LOG macros.
+ *
+ * \param [in] stream The stream.
+ * \returns The stream.
+ */
+static std::ostream&
+ResetStream(std::ostringstream& stream)
+{
+    stream.str("");
+    stream.clear();
+    stream.flags(std::ios_base::dec | std::ios_base::skipws | std::ios_base::boolalpha);
+    stream.precision(6);
+    stream.width(0);
+    stream.fill(' ');
+    return stream;
+}
+
+LogRecord::LogRecord(const LogSite& site, const LogComponent& component)
+    : m_buffer(AcquireSlot().buffer),
+      m_eager(nullptr),
+      m_clogBuffer(nullptr),
+      m_contextOffset(0)
+{
+    uint32_t id = site.GetId();
+    uint8_t flags = 0;
+    m_buffer.resize(HEADER_SIZE);
+    std::memcpy(&m_buffer[sizeof(uint32_t)], &id, sizeof(id));
+
+    TimePrinter timePrinter = component.IsEnabled(LOG_PREFIX_TIME) ? LogGetTimePrinter() : nullptr;
+    NodePrinter nodePrinter = component.IsEnabled(LOG_PREFIX_NODE) ? LogGetNodePrinter() : nullptr;
+    if (timePrinter == &DefaultTimePrinter)
+    {
+        flags |= HAS_TIME;
+        int64_t timeStep = Simulator::Now().GetTimeStep();
+        m_buffer.insert(m_buffer.end(),
+                        reinterpret_cast<const char*>(&timeStep),
+                        reinterpret_cast<const char*>(&timeStep + 1));
+        timePrinter = nullptr;
+    }
+    // The node is formatted after a custom time printer, to keep the order
+    if (nodePrinter == &DefaultNodePrinter && timePrinter == nullptr)
+    {
+        flags |= HAS_NODE;
+        uint32_t context = Simulator::GetContext();
+        m_buffer.insert(m_buffer.end(),
+                        reinterpret_cast<const char*>(&context),
+                        reinterpret_cast<const char*>(&context + 1));
+        nodePrinter = nullptr;
+    }
+    if (component.IsEnabled(LOG_PREFIX_FUNC))
+    {
+        flags |= HAS_FUNC;
+    }
+    if (component.IsEnabled(LOG_PREFIX_LEVEL))
+    {
+        flags |= HAS_LEVEL;
+    }
+    m_buffer[2 * sizeof(uint32_t)] = static_cast<char>(flags);
+
+    if (timePrinter != nullptr || nodePrinter != nullptr)
+    {
+        std::ostream& os = BeginFormat();
+        if (timePrinter != nullptr)
+        {
+            (*timePrinter)(os);
+            os << " ";
+        }
+        if (nodePrinter != nullptr)
+        {
+            (*nodePrinter)(os);
+            os << " ";
+        }
+        std::string prefix = GetSlot().stream.str();
+        m_buffer[2 * sizeof(uint32_t)] |= HAS_CONTEXT;
+        m_contextOffset = m_buffer.size();
+        AppendString(m_buffer, prefix.data(), prefix.size());
+    }
+}
+
+LogRecord::~LogRecord()
+{
+    if (m_eager != nullptr)
+    {
+        std::string text = GetSlot().stream.str();
+        PutString(STRING, text.data(), text.size());
+    }
+    uint32_t size = m_buffer.size();
+    std::memcpy(m_buffer.data(), &size, sizeof(size));
+    Recorder::Get()->Commit(m_buffer);
+    t_state.depth--;
+}
+
+void
+LogRecord::BeginContext()
+{
+    Slot& slot = GetSlot();
+    slot.context.str("");
+    m_clogBuffer = std::clog.rdbuf(&slot.context);
+}
+
+void
+LogRecord::EndContext()
+{
+    std::clog.rdbuf(m_clogBuffer);
+    std::string context = GetSlot().context.str();
+    if (context.empty())
+    {
+        return;
+    }
+    if (m_contextOffset == 0)
+    {
+        m_buffer[2 * sizeof(uint32_t)] |= HAS_CONTEXT;
+        m_contextOffset = m_buffer.size();
+        AppendString(m_buffer, context.data(), context.size());
+        return;
+    }
+    // The context follows the prefixes formatted by custom printers
+    uint32_t size;
+    std::memcpy(&size, &m_buffer[m_contextOffset], sizeof(size));
+    size += context.size();
+    std::memcpy(&m_buffer[m_contextOffset], &size, sizeof(size));
+    m_buffer.insert(m_buffer.end(), context.begin(), context.end());
+}
+
+LogRecord&
+LogRecord::operator<<(std::ostream& (*manipulator)(std::ostream&))
+{
+    GetEagerStream() << manipulator;
+    return *this;
+}
+
+LogRecord&
+LogRecord::operator<<(std::ios_base& (*manipulator)(std::ios_base&))
+{
+    GetEagerStream() << manipulator;
+    return *this;
+}
+
+LogParameters
+LogRecord::Parameters()
+{
+    return LogParameters(*this);
+}
+
+void
+LogRecord::PutString(uint8_t tag, const char* data, std::size_t size)
+{
+    m_buffer.push_back(static_cast<char>(tag));
+    AppendString(m_buffer, data, size);
+}
+
+std::ostream&
+LogRecord::GetEagerStream()
+{
+    if (m_eager == nullptr)
+    {
+        m_eager = &ResetStream(GetSlot().stream);
+    }
+    return *m_eager;
+}
+
+std::ostream&
+LogRecord::BeginFormat()
+{
+    return ResetStream(GetSlot().stream);
+}
+
+void
+LogRecord::EndFormat(uint8_t modifiers)
+{
+    std::string text = GetSlot().stream.str();
+    PutString(STRING | modifiers, text.data(), text.size());
+}
+
+} // namespace ns3
@@ -0,0 +1,573 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_RECORDER_H
+#define NS3_LOG_RECORDER_H
+
+#include "log.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogRecorder, ns3::LogSite, ns3::LogRecord and ns3::LogParameters declarations.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup logging
+ * \brief Record log messages rather than format them on the logging thread
+ *
+ * By default the NS_LOG macros format their messages into \c std::clog
+ * as they are logged. Once the recorder is enabled, the macros instead
+ * record the id of their call site (see LogSite) and the raw values of
+ * their arguments into a ring buffer owned by the logging thread; the
+ * formatting is deferred, according to the mode:
+ * - ASYNC: a background thread formats the records into \c std::clog;
+ * - BINARY: a background thread writes the records to a binary file,
+ *   to be formatted offline by Decode();
+ * - FLIGHT_RECORDER: the ring only keeps the last records, which are
+ *   formatted into \c std::clog on a fatal error (NS_FATAL_ERROR,
+ *   NS_ABORT_MSG, NS_ASSERT_MSG...) or by Dump(), and dropped otherwise.
+ *
+ * The recorder can also be enabled with the \c NS_LOG_BACKEND environment
+ * variable, set to \c async, \c binary=<file> or \c flight=<records>.
+ *
+ * The booleans, characters, integers, floating point numbers, strings
+ * and pointers are recorded as they are; the other values (and every
+ * value following a manipulator or a value of another type in a message)
+ * are formatted when logged, since they may not outlive the message.
+ * The time and node prefixes are recorded as integers if they are printed
+ * by DefaultTimePrinter and DefaultNodePrinter, and formatted otherwise.
+ * The formatted output is the same as without the recorder, except that
+ * the time is formatted with the resolution of the simulation writing a
+ * binary file and, in ASYNC mode, that \c std::clog is the stream at the
+ * time the recorder was enabled.
+ *
+ * NS_LOG_UNCOND is never recorded. The mode must be changed while no
+ * other thread is logging.
+ */
+class LogRecorder
+{
+  public:
+    /** The recording modes. */
+    enum Mode
+    {
+        TEXT,           //!< disabled: the messages are formatted into std::clog
+        ASYNC,          //!< formatted into std::clog by a background thread
+        BINARY,         //!< written to a binary file by a background thread
+        FLIGHT_RECORDER //!< the last records are formatted on a fatal error
+    };
+
+    /**
+     * Format the records into \c std::clog from a background thread.
+     *
+     * \param [in] ringSize The size in bytes of the ring of each logging thread.
+     */
+    static void EnableAsync(uint32_t ringSize = 1 << 20);
+
+    /**
+     * Write the records to a binary file from a background thread.
+     *
+     * \param [in] fileName The name of the file (which is truncated).
+     * \param [in] ringSize The size in bytes of the ring of each logging thread.
+     */
+    static void EnableBinary(const std::string& fileName, uint32_t ringSize = 1 << 20);
+
+    /**
+     * Keep the last records, to be formatted on a fatal error.
+     *
+     * \param [in] nRecords The number of records kept by each logging thread.
+     * \param [in] ringSize The size in bytes of the ring of each logging
+     *             thread, which bounds the number of records kept if the
+     *             records are large.
+     */
+    static void EnableFlightRecorder(uint32_t nRecords, uint32_t ringSize = 1 << 20);
+
+    /**
+     * Write the pending records and go back to formatting the messages as
+     * they are logged. The records of a flight recorder are dropped.
+     */
+    static void Disable();
+
+    /** \returns The current mode. */
+    static Mode GetMode();
+
+    /**
+     * \returns \c true if the messages are recorded rather than formatted.
+     */
+    static bool IsActive()
+    {
+        return m_active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Write the pending records (ASYNC and BINARY modes).
+     */
+    static void Flush();
+
+    /**
+     * Format the records kept by the flight recorder, and drop them.
+     *
+     * \param [in] os The output stream.
+     * \returns The number of records formatted.
+     */
+    static uint64_t Dump(std::ostream& os);
+
+    /**
+     * Format the records of a file written in BINARY mode.
+     *
+     * \param [in] is The input stream, opened in binary mode.
+     * \param [in] os The output stream.
+     * \returns \c false if the input is not a log file or is truncated.
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+    /**
+     * \internal
+     * Write the pending records, or dump those of the flight recorder,
+     * before the program stops on a fatal error. This is called by
+     * FatalImpl::FlushStreams().
+     */
+    static void FlushOnFatalError();
+
+  private:
+    /** Whether the messages are recorded. */
+    static std::atomic<bool> m_active;
+};
+
+/**
+ * \ingroup logging
+ * \brief A call site of the NS_LOG macros, identified by a small integer
+ *
+ * The macros define a static LogSite the first time the site logs while
+ * the recorder is active, so that the constant parts of a message (the
+ * component, level, function and kind of message) are recorded once.
+ */
+class LogSite
+{
+  public:
+    /** The kinds of call sites. */
+    enum Kind : uint8_t
+    {
+        MESSAGE, //!< NS_LOG and the level macros
+        FUNCTION //!< NS_LOG_FUNCTION and NS_LOG_FUNCTION_NOARGS
+    };
+
+    /**
+     * Register a call site.
+     *
+     * \param [in] component The log component.
+     * \param [in] level The level of the messages.
+     * \param [in] kind The kind of call site.
+     * \param [in] file The source file.
+     * \param [in] line The source line.
+     * \param [in] function The name of the function.
+     */
+    LogSite(const LogComponent& component,
+            LogLevel level,
+            Kind kind,
+            const char* file,
+            int line,
+            const char* function);
+
+    /** \returns The id of the call site. */
+    uint32_t GetId() const
+    {
+        return m_id;
+    }
+
+  private:
+    uint32_t m_id; //!< The id of the call site.
+};
+
+class LogParameters;
+
+/**
+ * \ingroup logging
+ * \brief A log message being recorded
+ *
+ * A LogRecord is created by the NS_LOG macros for each message logged
+ * while the recorder is active. The message is streamed into it, and the
+ * record is pushed into the ring of the thread when it is destroyed.
+ */
+class LogRecord
+{
+  public:
+    /**
+     * Start a record, with the time and node prefixes enabled for the component.
+     *
+     * \param [in] site The call site.
+     * \param [in] component The log component.
+     */
+    LogRecord(const LogSite& site, const LogComponent& component);
+
+    /** Push the record. */
+    ~LogRecord();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    LogRecord(const LogRecord&) = delete;
+    LogRecord& operator=(const LogRecord&) = delete;
+
+    /**
+     * Capture the output of NS_LOG_APPEND_CONTEXT, which is written to
+     * \c std::clog, until EndContext().
+     */
+    void BeginContext();
+
+    /** Stop capturing the output of NS_LOG_APPEND_CONTEXT. */
+    void EndContext();
+
+    /**
+     * Record a value of the message.
+     *
+     * The value is taken by forwarding reference, as some types
+     * only provide an output operator for non-const references.
+     *
+     * \tparam T \deduced The type of the value.
+     * \param [in] value The value.
+     * \returns This record, so it's chainable.
+     */
+    template <typename T>
+    LogRecord& operator<<(T&& value);
+
+    /**
+     * Apply a manipulator (e.g., std::endl) to the rest of the message.
+     *
+     * \param [in] manipulator The manipulator.
+     * \returns This record, so it's chainable.
+     */
+    LogRecord& operator<<(std::ostream& (*manipulator)(std::ostream&));
+
+    /**
+     * Apply a manipulator (e.g., std::hex) to the rest of the message.
+     *
+     * \param [in] manipulator The manipulator.
+     * \returns This record, so it's chainable.
+     */
+    LogRecord& operator<<(std::ios_base& (*manipulator)(std::ios_base&));
+
+    /**
+     * \returns A stream recording the parameters of NS_LOG_FUNCTION,
+     *          formatted as by ParameterLogger.
+     */
+    LogParameters Parameters();
+
+    /**
+     * The tags preceding the values of a record: the type of the value in
+     * the low bits, and how it is formatted in the high bits.
+     */
+    enum Tag : uint8_t
+    {
+        NONE = 0,         //!< formatted when logged
+        BOOL = 1,         //!< 8 bits
+        CHAR = 2,         //!< 8 bits
+        INT = 3,          //!< 64 bits, signed
+        UINT = 4,         //!< 64 bits, unsigned
+        DOUBLE = 5,       //!< 64 bits
+        STRING = 6,       //!< 32-bit length followed by the characters
+        POINTER = 7,      //!< 64 bits
+        TYPE = 0x3f,      //!< mask of the type
+        SEPARATED = 0x40, //!< preceded by ", "
+        QUOTED = 0x80     //!< enclosed in double quotes
+    };
+
+  private:
+    friend class LogParameters;
+
+    /**
+     * \tparam T The type of a value.
+     * \param [in] parameter Whether the value is a parameter of NS_LOG_FUNCTION.
+     * \returns The tag of the value, NONE if it is formatted when logged.
+     */
+    template <typename T>
+    static constexpr uint8_t GetTag(bool parameter);
+
+    /**
+     * Record a value.
+     *
+     * \tparam Type The type of the value (not NONE).
+     * \tparam T \deduced The C++ type of the value.
+     * \param [in] value The value.
+     * \param [in] modifiers The SEPARATED and QUOTED bits of the tag.
+     */
+    template <uint8_t Type, typename T>
+    void Put(const T& value, uint8_t modifiers);
+
+    /**
+     * Record a string.
+     *
+     * \param [in] tag The tag.
+     * \param [in] data The characters.
+     * \param [in] size The number of characters.
+     */
+    void PutString(uint8_t tag, const char* data, std::size_t size);
+
+    /**
+     * \returns The stream formatting the rest of the message, which is
+     *          recorded as a string.
+     */
+    std::ostream& GetEagerStream();
+
+    /**
+     * \returns A stream formatting a single parameter, to be recorded by EndFormat().
+     */
+    std::ostream& BeginFormat();
+
+    /**
+     * Record the parameter formatted into the stream returned by BeginFormat().
+     *
+     * \param [in] modifiers The SEPARATED and QUOTED bits of the tag.
+     */
+    void EndFormat(uint8_t modifiers);
+
+    std::vector<char>& m_buffer;  //!< The record being built.
+    std::ostream* m_eager;        //!< The stream formatting the rest of the message, if any.
+    std::streambuf* m_clogBuffer; //!< The buffer of std::clog while capturing the context.
+    std::size_t m_contextOffset;  //!< The offset of the context in the record, if any.
+};
+
+/**
+ * \ingroup logging
+ * \brief Record the parameters of NS_LOG_FUNCTION, separated by `, `
+ */
+class LogParameters
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] record The record.
+     */
+    LogParameters(LogRecord& record)
+        : m_record(record)
+    {
+    }
+
+    /**
+     * Record a function parameter, formatted as by ParameterLogger.
+     *
+     * \tparam T \deduced The type of the parameter.
+     * \param [in] param The function parameter.
+     * \returns This LogParameters, so it's chainable.
+     */
+    template <typename T>
+    LogParameters& operator<<(const T& param);
+
+    /**
+     * Overload for vectors, to record each element.
+     *
+     * \tparam T \deduced The type of the elements.
+     * \param [in] vector The vector of parameters.
+     * \returns This LogParameters, so it's chainable.
+     */
+    template <typename T>
+    LogParameters& operator<<(const std::vector<T>& vector);
+
+  private:
+    LogRecord& m_record; //!< The record.
+    bool m_first{true};  //!< First argument flag, doesn't get `, `.
+};
+
+/**
+ * \ingroup logging
+ * Whether a type is recorded as a string.
+ * \tparam T The decayed type.
+ */
+template <typename T>
+inline constexpr bool LogIsString =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+/**
+ * \ingroup logging
+ * Whether a type is a character type printed as a character by std::ostream.
+ * \tparam T The decayed type.
+ */
+template <typename T>
+inline constexpr bool LogIsChar = std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                                  std::is_same_v<T, unsigned char>;
+
+template <typename T>
+constexpr uint8_t
+LogRecord::GetTag(bool parameter)
+{
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>)
+    {
+        // ParameterLogger prints +param, hence an integer
+        return parameter ? INT : BOOL;
+    }
+    else if constexpr (LogIsChar<U>)
+    {
+        return parameter ? INT : CHAR;
+    }
+    else if constexpr (std::is_integral_v<U>)
+    {
+        if (parameter)
+        {
+            return std::is_signed_v<decltype(+U{})> ? INT : UINT;
+        }
+        if (std::is_same_v<U, wchar_t> || std::is_same_v<U, char8_t> ||
+            std::is_same_v<U, char16_t> || std::is_same_v<U, char32_t>)
+        {
+            return NONE;
+        }
+        return std::is_signed_v<U> ? INT : UINT;
+    }
+    else if constexpr (std::is_same_v<U, float> || std::is_same_v<U, double>)
+    {
+        return DOUBLE;
+    }
+    else if constexpr (LogIsString<U>)
+    {
+        return STRING;
+    }
+    else if constexpr (std::is_pointer_v<U>)
+    {
+        // Pointers to other character types are printed as strings, and
+        // function and volatile pointers as booleans
+        using P = std::remove_pointer_t<U>;
+        if (LogIsChar<std::remove_cv_t<P>> || std::is_volatile_v<P> || std::is_function_v<P>)
+        {
+            return NONE;
+        }
+        return POINTER;
+    }
+    else
+    {
+        return NONE;
+    }
+}
+
+template <uint8_t Type, typename T>
+void
+LogRecord::Put(const T& value, uint8_t modifiers)
+{
+    auto putRaw = [this, modifiers](auto raw) {
+        std::size_t offset = m_buffer.size();
+        m_buffer.resize(offset + 1 + sizeof(raw));
+        m_buffer[offset] = static_cast<char>(Type | modifiers);
+        std::memcpy(&m_buffer[offset + 1], &raw, sizeof(raw));
+    };
+
+    using U = std::decay_t<T>;
+    if constexpr (Type == STRING)
+    {
+        if constexpr (std::is_pointer_v<U>)
+        {
+            const char* s = value;
+            PutString(Type | modifiers, s, s != nullptr ? std::strlen(s) : 0);
+        }
+        else
+        {
+            PutString(Type | modifiers, value.data(), value.size());
+        }
+    }
+    else if constexpr (Type == POINTER)
+    {
+        putRaw(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    }
+    else if constexpr (Type == DOUBLE)
+    {
+        putRaw(static_cast<double>(value));
+    }
+    else if constexpr (Type == BOOL || Type == CHAR)
+    {
+        putRaw(static_cast<uint8_t>(value));
+    }
+    else if constexpr (Type == INT)
+    {
+        putRaw(static_cast<int64_t>(value));
+    }
+    else
+    {
+        putRaw(static_cast<uint64_t>(value));
+    }
+}
+
+template <typename T>
+LogRecord&
+LogRecord::operator<<(T&& value)
+{
+    constexpr uint8_t type = GetTag<T>(false);
+    if constexpr (type != NONE)
+    {
+        if (m_eager == nullptr)
+        {
+            Put<type>(value, 0);
+            return *this;
+        }
+    }
+    GetEagerStream() << value;
+    return *this;
+}
+
+template <typename T>
+LogParameters&
+LogParameters::operator<<(const T& param)
+{
+    uint8_t modifiers = m_first ? 0 : LogRecord::SEPARATED;
+    m_first = false;
+
+    constexpr uint8_t type = LogRecord::GetTag<T>(true);
+    if constexpr (std::is_convertible_v<T, std::string>)
+    {
+        modifiers |= LogRecord::QUOTED;
+    }
+    if constexpr (type != LogRecord::NONE)
+    {
+        m_record.Put<type>(param, modifiers);
+    }
+    else
+    {
+        std::ostream& os = m_record.BeginFormat();
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            os << +param;
+        }
+        else
+        {
+            os << param;
+        }
+        m_record.EndFormat(modifiers);
+    }
+    return *this;
+}
+
+template <typename T>
+LogParameters&
+LogParameters::operator<<(const std::vector<T>& vector)
+{
+    for (const auto& i : vector)
+    {
+        *this << i;
+    }
+    return *this;
+}
+
+} // namespace ns3
+
+#endif /* NS3_LOG_RECORDER_H */
@@ -509,4 +509,7 @@ ParameterLogger::operator<<(const std::vector<T>& vector)
 
 /**@}*/ // \ingroup logging
 
+// The macros refer to the recorder, which refers to LogComponent
+#include "log-recorder.h"
+
 #endif /* NS3_LOG_H */
@@ -0,0 +1,477 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::MetricsServer implementation.
+ */
+
+#include "metrics-server.h"
+
+#include "abort.h"
+#include "live-counter.h"
+#include "log.h"
+#include "simulator.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#ifndef __WIN32__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MetricsServer");
+
+/* static */
+const int64x64_t MetricsServer::MAXGAIN = 2.0;
+
+namespace
+{
+
+/** Time to wait for a request, in milliseconds. */
+constexpr int REQUEST_TIMEOUT = 100;
+/** Time between checks of the stop flag by the serving thread, in milliseconds. */
+constexpr int STOP_POLL_INTERVAL = 100;
+
+/**
+ * Format a value as in the Prometheus text format.
+ * \param [in] value The value.
+ * \returns The formatted value.
+ */
+std::string
+FormatValue(double value)
+{
+    if (std::isnan(value))
+    {
+        return "NaN";
+    }
+    if (std::isinf(value))
+    {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
+
+/**
+ * Write a metric family with a single unlabeled metric.
+ * \param [in] os The stream to write on.
+ * \param [in] name The metric name.
+ * \param [in] help The description of the metric.
+ * \param [in] type The type of the metric.
+ * \param [in] value The value.
+ */
+void
+WriteMetric(std::ostream& os,
+            const std::string& name,
+            const std::string& help,
+            const std::string& type,
+            double value)
+{
+    os << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n'
+       << name << ' ' << FormatValue(value) << '\n';
+}
+
+} // unnamed namespace
+
+MetricsServer::MetricsServer(const std::string& address, const Time interval /* = Seconds (1.0) */)
+    : m_interval(interval),
+      m_vtime(Time(1)),
+      m_event(),
+      m_start(Clock::now()),
+      m_last(m_start),
+      m_lastNow(Simulator::Now()),
+      m_families(),
+      m_snapshot(),
+      m_sampled(m_start),
+      m_fd(-1),
+      m_path(),
+      m_port(0),
+      m_stop(false)
+{
+    NS_LOG_FUNCTION(this << address << interval);
+    Listen(address);
+    m_thread = std::thread(&MetricsServer::Serve, this);
+    ScheduleSample();
+}
+
+MetricsServer::~MetricsServer()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_event);
+    m_stop = true;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+#ifndef __WIN32__
+    close(m_fd);
+    if (!m_path.empty())
+    {
+        unlink(m_path.c_str());
+    }
+#endif
+}
+
+void
+MetricsServer::SetInterval(const Time interval)
+{
+    NS_LOG_FUNCTION(this << interval);
+    const int64x64_t ratio = interval / m_interval;
+    m_interval = interval;
+    if (m_vtime > Time(1))
+    {
+        m_vtime = m_vtime * ratio;
+    }
+}
+
+void
+MetricsServer::AddGauge(const std::string& name, const std::string& help, Callback<double> gauge)
+{
+    NS_LOG_FUNCTION(this << name);
+    AddMetric(name, help, "gauge", gauge);
+}
+
+void
+MetricsServer::AddCounter(const std::string& name,
+                          const std::string& help,
+                          Callback<double> counter)
+{
+    NS_LOG_FUNCTION(this << name);
+    AddMetric(name, help, "counter", counter);
+}
+
+void
+MetricsServer::AddMetric(const std::string& name,
+                         const std::string& help,
+                         const std::string& type,
+                         Callback<double> value)
+{
+    NS_ABORT_MSG_IF(value.IsNull(), "MetricsServer: null callback for " << name);
+    const std::string family = name.substr(0, name.find('{'));
+    NS_ABORT_MSG_IF(family.empty(), "MetricsServer: invalid metric name " << name);
+    for (auto& f : m_families)
+    {
+        if (f.name == family)
+        {
+            NS_ABORT_MSG_IF(f.type != type,
+                            "MetricsServer: " << name << " is not a " << f.type);
+            f.metrics.push_back(name);
+            f.values.push_back(value);
+            return;
+        }
+    }
+    m_families.push_back({family, help, type, {name}, {value}});
+}
+
+uint16_t
+MetricsServer::GetPort() const
+{
+    return m_port;
+}
+
+std::string
+MetricsServer::GetMetrics() const
+{
+    std::ostringstream os;
+    Clock::time_point sampled;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        os << m_snapshot;
+        sampled = m_sampled;
+    }
+    for (const auto counter : LiveCounter::GetCounters())
+    {
+        WriteMetric(os, counter->GetName(), counter->GetHelp(), "gauge", counter->Get());
+    }
+    WriteMetric(os,
+                "ns3_metrics_sample_age_seconds",
+                "Wall clock time since the metrics were sampled.",
+                "gauge",
+                std::chrono::duration<double>(Clock::now() - sampled).count());
+    return os.str();
+}
+
+void
+MetricsServer::ScheduleSample()
+{
+    NS_LOG_FUNCTION(this);
+    m_event = Simulator::Schedule(m_vtime, &MetricsServer::Sample, this);
+}
+
+void
+MetricsServer::Sample()
+{
+    const Clock::time_point now = Clock::now();
+    const Time simNow = Simulator::Now();
+    const double elapsed = std::chrono::duration<double>(now - m_last).count();
+    NS_LOG_FUNCTION(this << elapsed);
+
+    // Steer m_vtime to sample approximately every m_interval
+    // in wall clock time, bounding the change to MAXGAIN.
+    double speed = 0;
+    if (elapsed > 0)
+    {
+        speed = (simNow - m_lastNow).GetSeconds() / elapsed;
+        int64x64_t f = m_interval.GetSeconds() / elapsed;
+        if (f > MAXGAIN)
+        {
+            f = MAXGAIN;
+        }
+        else if (f < 1 / MAXGAIN)
+        {
+            f = 1 / MAXGAIN;
+        }
+        m_vtime = m_vtime * f;
+    }
+    else
+    {
+        m_vtime = m_vtime * MAXGAIN;
+    }
+    if (m_vtime < Time(1))
+    {
+        m_vtime = Time(1);
+    }
+    m_last = now;
+    m_lastNow = simNow;
+
+    std::ostringstream os;
+    WriteMetric(os,
+                "ns3_events_total",
+                "Number of events executed.",
+                "counter",
+                Simulator::GetEventCount());
+    WriteMetric(os,
+                "ns3_scheduler_events",
+                "Number of events pending in the scheduler.",
+                "gauge",
+                Simulator::GetPendingEventCount());
+    WriteMetric(os,
+                "ns3_simulation_time_seconds",
+                "Simulation time.",
+                "gauge",
+                simNow.GetSeconds());
+    WriteMetric(os,
+                "ns3_wall_time_seconds",
+                "Wall clock time since the metrics server started.",
+                "gauge",
+                std::chrono::duration<double>(now - m_start).count());
+    WriteMetric(os,
+                "ns3_speed_ratio",
+                "Simulation time per wall clock time over the last sampling interval.",
+                "gauge",
+                speed);
+    for (const auto& f : m_families)
+    {
+        os << "# HELP " << f.name << ' ' << f.help << "\n# TYPE " << f.name << ' ' << f.type
+           << '\n';
+        for (std::size_t i = 0; i < f.metrics.size(); ++i)
+        {
+            os << f.metrics[i] << ' ' << FormatValue(f.values[i]()) << '\n';
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshot = os.str();
+        m_sampled = now;
+    }
+
+    ScheduleSample();
+}
+
+#ifndef __WIN32__
+
+void
+MetricsServer::Listen(const std::string& address)
+{
+    NS_LOG_FUNCTION(this << address);
+    if (address.compare(0, 4, "tcp:") == 0)
+    {
+        const std::string port = address.substr(4);
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(port.c_str(), &end, 10);
+        NS_ABORT_MSG_IF(port.empty() || *end != '\0' || value > 65535,
+                        "MetricsServer: invalid port in " << address);
+
+        m_fd = socket(AF_INET, SOCK_STREAM, 0);
+        NS_ABORT_MSG_IF(m_fd < 0, "MetricsServer: socket failed: " << std::strerror(errno));
+        int reuse = 1;
+        setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(value));
+        NS_ABORT_MSG_IF(bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0,
+                        "MetricsServer: cannot bind " << address << ": " << std::strerror(errno));
+
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+    }
+    else
+    {
+        m_path = address.compare(0, 5, "unix:") == 0 ? address.substr(5) : address;
+
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        NS_ABORT_MSG_IF(m_path.empty() || m_path.size() >= sizeof(addr.sun_path),
+                        "MetricsServer: invalid socket path in " << address);
+        std::strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+        // Remove a socket left by a previous run, but nothing else
+        struct stat st;
+        if (stat(m_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        {
+            unlink(m_path.c_str());
+        }
+
+        m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        NS_ABORT_MSG_IF(m_fd < 0, "MetricsServer: socket failed: " << std::strerror(errno));
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            const int error = errno;
+            m_path.clear();
+            NS_FATAL_ERROR("MetricsServer: cannot bind " << address << ": "
+                                                         << std::strerror(error));
+        }
+    }
+    NS_ABORT_MSG_IF(listen(m_fd, SOMAXCONN) < 0,
+                    "MetricsServer: listen failed: " << std::strerror(errno));
+    NS_LOG_INFO("listening on " << address << (m_port ? " port " + std::to_string(m_port) : ""));
+}
+
+void
+MetricsServer::Serve()
+{
+    // No logging here: the log prefixes are not thread safe
+    while (!m_stop)
+    {
+        pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, STOP_POLL_INTERVAL) <= 0)
+        {
+            continue;
+        }
+        const int fd = accept(m_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        Answer(fd);
+        close(fd);
+    }
+}
+
+void
+MetricsServer::Answer(int fd)
+{
+#ifdef SO_NOSIGPIPE
+    int noSigPipe = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    // Raw clients may send nothing: wait only briefly for a request
+    char request[1024];
+    ssize_t n = 0;
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, REQUEST_TIMEOUT) > 0)
+    {
+        n = recv(fd, request, sizeof(request), 0);
+    }
+    const bool http = n >= 4 && std::memcmp(request, "GET ", 4) == 0;
+
+    const std::string body = GetMetrics();
+    std::string response;
+    if (http)
+    {
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: " +
+                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    }
+    else
+    {
+        response = body;
+    }
+
+    std::size_t sent = 0;
+    while (sent < response.size())
+    {
+        const ssize_t written = send(fd, response.data() + sent, response.size() - sent, flags);
+        if (written <= 0)
+        {
+            return;
+        }
+        sent += written;
+    }
+
+    // Let the client read the response before closing: closing with
+    // unread request data would reset the connection.
+    shutdown(fd, SHUT_WR);
+    while (poll(&pfd, 1, REQUEST_TIMEOUT) > 0 && recv(fd, request, sizeof(request), 0) > 0)
+    {
+    }
+}
+
+#else /* __WIN32__ */
+
+void
+MetricsServer::Listen(const std::string& address)
+{
+    NS_FATAL_ERROR("MetricsServer: cannot listen on " << address << ", not supported on Windows");
+}
+
+void
+MetricsServer::Serve()
+{
+}
+
+void
+MetricsServer::Answer(int /* fd */)
+{
+}
+
+#endif /* __WIN32__ */
+
+} // namespace ns3
@@ -0,0 +1,225 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::MetricsServer declaration.
+ */
+
+#include "callback.h"
+#include "event-id.h"
+#include "nstime.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup core
+ * \ingroup debugging
+ *
+ * Serve live simulation metrics in the Prometheus text format.
+ *
+ * While it exists, the server listens on a Unix domain socket or on a
+ * TCP port of the loopback interface, and answers each connection with
+ * the current metrics.  A request starting with "GET " (e.g., from
+ * Prometheus or curl) is answered with an HTTP response; any other
+ * client (e.g., \c socat or <tt>nc -U</tt>) receives the metrics alone.
+ *
+ * The metrics are:
+ * - \c ns3_events_total: the number of events executed;
+ * - \c ns3_scheduler_events: the number of events pending in the scheduler;
+ * - \c ns3_simulation_time_seconds: the simulation time;
+ * - \c ns3_wall_time_seconds: the wall clock time since the server started;
+ * - \c ns3_speed_ratio: the simulation time elapsed per second of wall
+ *   clock time, over the last sampling interval;
+ * - the gauges and counters added with AddGauge() and AddCounter();
+ * - the number of live instances counted by each LiveCounter
+ *   (e.g., \c ns3_packets_live, \c ns3_events_live, \c ns3_objects_live);
+ * - \c ns3_metrics_sample_age_seconds: the wall clock time since the
+ *   metrics were sampled.
+ *
+ * The simulator and the gauges are not thread safe, so they are sampled
+ * by a periodic event in the simulation, which is scheduled to run
+ * approximately every \c interval of wall clock time, as in ShowProgress.
+ * The connections are served by a separate thread from the last sample,
+ * so that the simulation is never blocked by a client.  As with
+ * ShowProgress, the periodic event keeps the simulation running: use
+ * Simulator::Stop to end it.
+ *
+ * The address is either \c unix:<path> (or simply a path), or
+ * \c tcp:<port>.  Port 0 selects an ephemeral port, which can be
+ * retrieved with GetPort().
+ *
+ * Example usage:
+ *
+ * \code
+ *     MetricsServer metrics("unix:/tmp/ns3-metrics.sock");
+ *     // double GetQueueBytes(Ptr<QueueDisc> queue);
+ *     metrics.AddGauge("ns3_queue_bytes{device=\"1\"}",
+ *                      "Bytes in the queue.",
+ *                      MakeBoundCallback(&GetQueueBytes, queue));
+ *     Simulator::Stop(Seconds(100));
+ *     Simulator::Run();
+ * \endcode
+ *
+ * and, while the simulation is running:
+ *
+ * \code
+ *     curl --unix-socket /tmp/ns3-metrics.sock http://localhost/metrics
+ * \endcode
+ *
+ * The server is only available on POSIX systems.
+ */
+class MetricsServer
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] address The address to listen on.
+     * \param [in] interval The target wallclock interval between samples.
+     */
+    MetricsServer(const std::string& address, const Time interval = Seconds(1.0));
+
+    /** Destructor. */
+    ~MetricsServer();
+
+    /**
+     * Set the target sampling interval, in wallclock time.
+     * \param [in] interval The target wallclock interval between samples.
+     */
+    void SetInterval(const Time interval);
+
+    /**
+     * Add a gauge, a value which can go up and down.
+     *
+     * The name can include labels, e.g. <tt>ns3_queue_bytes{device="1"}</tt>:
+     * the metrics sharing the name before the labels form a family,
+     * described once.
+     *
+     * \param [in] name The metric name, with optional labels.
+     * \param [in] help The description of the metric family.
+     * \param [in] gauge The callback returning the value.
+     */
+    void AddGauge(const std::string& name, const std::string& help, Callback<double> gauge);
+
+    /**
+     * Add a counter, a value which only goes up.
+     *
+     * \param [in] name The metric name, with optional labels.
+     * \param [in] help The description of the metric family.
+     * \param [in] counter The callback returning the value.
+     */
+    void AddCounter(const std::string& name, const std::string& help, Callback<double> counter);
+
+    /**
+     * Get the TCP port listened on.
+     * \returns The port, or 0 for a Unix domain socket.
+     */
+    uint16_t GetPort() const;
+
+    /**
+     * Get the metrics, as served to the clients.
+     * \returns The metrics in the Prometheus text format.
+     */
+    std::string GetMetrics() const;
+
+  private:
+    /** A metric family. */
+    struct Family
+    {
+        std::string name;                     //!< The name, without labels.
+        std::string help;                     //!< The description.
+        std::string type;                     //!< "gauge" or "counter".
+        std::vector<std::string> metrics;     //!< The names, with labels.
+        std::vector<Callback<double>> values; //!< The callbacks returning the values.
+    };
+
+    /**
+     * Add a metric.
+     * \param [in] name The metric name, with optional labels.
+     * \param [in] help The description of the metric family.
+     * \param [in] type The type of the metric family.
+     * \param [in] value The callback returning the value.
+     */
+    void AddMetric(const std::string& name,
+                   const std::string& help,
+                   const std::string& type,
+                   Callback<double> value);
+
+    /**
+     * Open the listening socket.
+     * \param [in] address The address to listen on.
+     */
+    void Listen(const std::string& address);
+
+    /** Schedule the next Sample. */
+    void ScheduleSample();
+
+    /**
+     * Sample the simulator and the metrics added.
+     * This function is executed periodically in the simulation.
+     */
+    void Sample();
+
+    /** Accept and answer connections until stopped, in the serving thread. */
+    void Serve();
+
+    /**
+     * Answer a connection.
+     * \param [in] fd The connected socket.
+     */
+    void Answer(int fd);
+
+    /** Maximum growth factor of the sampling interval. */
+    static const int64x64_t MAXGAIN;
+
+    /// The clock used to measure wall clock time.
+    using Clock = std::chrono::steady_clock;
+
+    Time m_interval;                //!< The target sampling interval, in wallclock time.
+    Time m_vtime;                   //!< The virtual time interval.
+    EventId m_event;                //!< The next sampling event.
+    Clock::time_point m_start;      //!< When the server started.
+    Clock::time_point m_last;       //!< When the last sample was taken.
+    Time m_lastNow;                 //!< The simulation time of the last sample.
+    std::vector<Family> m_families; //!< The metric families added.
+
+    mutable std::mutex m_mutex;  //!< Protects m_snapshot and m_sampled.
+    std::string m_snapshot;      //!< The text of the last sample.
+    Clock::time_point m_sampled; //!< When m_snapshot was taken.
+
+    int m_fd;                 //!< The listening socket.
+    std::string m_path;       //!< The path of the Unix domain socket.
+    uint16_t m_port;          //!< The TCP port.
+    std::atomic<bool> m_stop; //!< Whether the serving thread should stop.
+    std::thread m_thread;     //!< The serving thread.
+
+}; // class MetricsServer
+
+} // namespace ns3
+
+#endif /* METRICS_SERVER_H */
@@ -109,6 +109,21 @@ MakeObjectMapAccessor(U T::*memberVector)
             return nullptr;
         }
 
+        bool DoForEach(const ObjectBase* object,
+                       const std::function<void(std::size_t, Ptr<Object>)>& f) const override
+        {
+            const T* obj = dynamic_cast<const T*>(object);
+            if (obj == nullptr)
+            {
+                return false;
+            }
+            for (const auto& [index, element] : obj->*m_memberVector)
+            {
+                f(index, element);
+            }
+            return true;
+        }
+
         U T::*m_memberVector;
     }* spec = new MemberStdContainer();
 
@@ -121,9 +121,43 @@ ObjectPtrContainerAccessor::Get(const ObjectBase* object, AttributeValue& value)
         return false;
     }
     v->m_objects.clear();
+    return DoForEach(object, [v](std::size_t index, Ptr<Object> o) { v->m_objects[index] = o; });
+}
+
+bool
+ObjectPtrContainerAccessor::GetN(const ObjectBase* object, std::size_t* n) const
+{
+    NS_LOG_FUNCTION(this << object);
+    return DoGetN(object, n);
+}
+
+Ptr<Object>
+ObjectPtrContainerAccessor::GetAt(const ObjectBase* object, std::size_t i, std::size_t* index) const
+{
+    NS_LOG_FUNCTION(this << object << i);
+    return DoGet(object, i, index);
+}
+
+bool
+ObjectPtrContainerAccessor::ForEach(const ObjectBase* object,
+                                    const std::function<void(std::size_t, Ptr<Object>)>& f) const
+{
+    NS_LOG_FUNCTION(this << object);
+    return DoForEach(object, f);
+}
+
+bool
+ObjectPtrContainerAccessor::IsPositional() const
+{
+    return DoIsPositional();
+}
+
+bool
+ObjectPtrContainerAccessor::DoForEach(const ObjectBase* object,
+                                      const std::function<void(std::size_t, Ptr<Object>)>& f) const
+{
     std::size_t n;
-    bool ok = DoGetN(object, &n);
-    if (!ok)
+    if (!DoGetN(object, &n))
     {
         return false;
     }
@@ -131,11 +165,17 @@ ObjectPtrContainerAccessor::Get(const ObjectBase* object, AttributeValue& value)
     {
         std::size_t index;
         Ptr<Object> o = DoGet(object, i, &index);
-        v->m_objects[index] = o;
+        f(index, o);
     }
     return true;
 }
 
+bool
+ObjectPtrContainerAccessor::DoIsPositional() const
+{
+    return false;
+}
+
 bool
 ObjectPtrContainerAccessor::HasGetter() const
 {
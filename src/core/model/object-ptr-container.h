@@ -23,6 +23,7 @@
 #include "object.h"
 #include "ptr.h"
 
+#include <functional>
 #include <map>
 
 /**
@@ -233,6 +234,46 @@ class ObjectPtrContainerAccessor : public AttributeAccessor
     bool HasGetter() const override;
     bool HasSetter() const override;
 
+    /**
+     * Get the number of instances in the container, without building an
+     * ObjectPtrContainerValue.
+     *
+     * \param [in] object The container object.
+     * \param [out] n The number of instances in the container.
+     * \returns true if the value could be obtained successfully.
+     */
+    bool GetN(const ObjectBase* object, std::size_t* n) const;
+    /**
+     * Get an instance from the container by position, without building an
+     * ObjectPtrContainerValue.
+     *
+     * \param [in] object The container object.
+     * \param [in] i The position of the instance, in [0, n).
+     * \param [out] index The index of the instance (e.g., the key of an
+     *             ObjectMapValue, which may differ from the position).
+     * \returns The instance.
+     */
+    Ptr<Object> GetAt(const ObjectBase* object, std::size_t i, std::size_t* index) const;
+    /**
+     * Visit the instances of the container in a single pass, without building
+     * an ObjectPtrContainerValue.
+     *
+     * \param [in] object The container object.
+     * \param [in] f The function called with the index and the instance of
+     *             each element, in order of position.
+     * 
+eturns true if the container could be visited successfully.
+     */
+    bool ForEach(const ObjectBase* object,
+                 const std::function<void(std::size_t, Ptr<Object>)>& f) const;
+    /**
+     * 
+eturns true if the index of each instance is its position and GetAt
+     *          takes constant time, i.e., the instances matching an index can
+     *          be fetched without visiting the container.
+     */
+    bool IsPositional() const;
+
   private:
     /**
      * Get the number of instances in the container.
@@ -253,6 +294,25 @@ class ObjectPtrContainerAccessor : public AttributeAccessor
     virtual Ptr<Object> DoGet(const ObjectBase* object,
                               std::size_t i,
                               std::size_t* index) const = 0;
+    /**
+     * Visit the instances of the container. The default implementation
+     * calls DoGet for each position, which containers that are not indexed
+     * in constant time should override.
+     *
+     * \param [in] object The container object.
+     * \param [in] f The function called with the index and the instance of
+     *             each element.
+     * 
+eturns true if the container could be visited successfully.
+     */
+    virtual bool DoForEach(const ObjectBase* object,
+                           const std::function<void(std::size_t, Ptr<Object>)>& f) const;
+    /**
+     * 
+eturns true if the index of each instance is its position and DoGet
+     *          takes constant time.
+     */
+    virtual bool DoIsPositional() const;
 };
 
 template <typename T, typename U, typename INDEX>
@@ -281,6 +341,11 @@ MakeObjectPtrContainerAccessor(Ptr<U> (T::*get)(INDEX) const, INDEX (T::*getN)()
             return (obj->*m_get)(i);
         }
 
+        bool DoIsPositional() const override
+        {
+            return true;
+        }
+
         Ptr<U> (T::*m_get)(INDEX) const;
         INDEX (T::*m_getN)() const;
     }* spec = new MemberGetters();
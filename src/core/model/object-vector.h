@@ -109,6 +109,22 @@ MakeObjectVectorAccessor(U T::*memberVector)
             return nullptr;
         }
 
+        bool DoForEach(const ObjectBase* object,
+                       const std::function<void(std::size_t, Ptr<Object>)>& f) const override
+        {
+            const T* obj = dynamic_cast<const T*>(object);
+            if (obj == nullptr)
+            {
+                return false;
+            }
+            std::size_t k = 0;
+            for (const auto& element : obj->*m_memberVector)
+            {
+                f(k++, element);
+            }
+            return true;
+        }
+
         U T::*m_memberVector;
     }* spec = new MemberStdContainer();
 
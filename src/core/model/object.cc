@@ -22,6 +22,7 @@
 
 #include "assert.h"
 #include "attribute.h"
+#include "live-counter.h"
 #include "log.h"
 #include "object-factory.h"
 #include "string.h"
@@ -48,6 +49,18 @@ NS_LOG_COMPONENT_DEFINE("Object");
 
 NS_OBJECT_ENSURE_REGISTERED(Object);
 
+/**
+ * \ingroup object
+ * Get the counter of live objects.
+ * \returns The counter of live objects.
+ */
+static LiveCounter&
+GetLiveCounter()
+{
+    static LiveCounter counter("ns3_objects_live", "Number of live objects.");
+    return counter;
+}
+
 Object::AggregateIterator::AggregateIterator()
     : m_object(nullptr),
       m_current(0)
@@ -102,12 +115,14 @@ Object::Object()
     NS_LOG_FUNCTION(this);
     m_aggregates->n = 1;
     m_aggregates->buffer[0] = this;
+    GetLiveCounter().Increment();
 }
 
 Object::~Object()
 {
     // remove this object from the aggregate list
     NS_LOG_FUNCTION(this);
+    GetLiveCounter().Decrement();
     uint32_t n = m_aggregates->n;
     for (uint32_t i = 0; i < n; i++)
     {
@@ -138,6 +153,7 @@ Object::Object(const Object& o)
 {
     m_aggregates->n = 1;
     m_aggregates->buffer[0] = this;
+    GetLiveCounter().Increment();
 }
 
 void
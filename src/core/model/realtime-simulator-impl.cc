@@ -802,6 +802,12 @@ RealtimeSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+uint64_t
+RealtimeSimulatorImpl::GetPendingEventCount() const
+{
+    return m_unscheduledEvents;
+}
+
 void
 RealtimeSimulatorImpl::SetSynchronizationMode(SynchronizationMode mode)
 {
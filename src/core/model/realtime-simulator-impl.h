@@ -107,6 +107,7 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
+    uint64_t GetPendingEventCount() const override;
 
     /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
     void ScheduleRealtimeWithContext(uint32_t context, const Time& delay, EventImpl* event);
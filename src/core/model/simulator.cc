@@ -326,6 +326,12 @@ Simulator::GetEventCount()
     return GetImpl()->GetEventCount();
 }
 
+uint64_t
+Simulator::GetPendingEventCount()
+{
+    return GetImpl()->GetPendingEventCount();
+}
+
 uint32_t
 Simulator::GetSystemId()
 {
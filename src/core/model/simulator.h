@@ -216,6 +216,16 @@ class Simulator
      */
     static uint64_t GetEventCount();
 
+    /**
+     * Get the number of events waiting in the event scheduler.
+     *
+     * Cancelled events are counted until they are removed from the
+     * scheduler, and events scheduled with ScheduleDestroy are not counted.
+     *
+     * \returns The number of events pending in the scheduler.
+     */
+    static uint64_t GetPendingEventCount();
+
     /**
      * @name Schedule events (in the same context) to run at a future time.
      */
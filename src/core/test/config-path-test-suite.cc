@@ -0,0 +1,368 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config-path.h"
+#include "ns3/config.h"
+#include "ns3/integer.h"
+#include "ns3/object-map.h"
+#include "ns3/object-vector.h"
+#include "ns3/object.h"
+#include "ns3/test.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traced-value.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief Object of the tree resolved by the CompiledPath tests
+ *
+ * Its children are stored in three kinds of containers: a vector, a map with
+ * sparse keys, and a vector accessed through getters.
+ */
+class PathTestObject : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief Add children to the containers of this object
+     * \param nChildren the number of children of the vector and of the getters
+     * \param keys the keys of the children of the map
+     */
+    void AddChildren(uint32_t nChildren, const std::vector<uint32_t>& keys);
+
+    /// \return the number of children accessed through the getters
+    std::size_t GetNGetterChildren() const;
+
+    /**
+     * \param i the index of a child
+     * \return the child accessed through the getters
+     */
+    Ptr<PathTestObject> GetGetterChild(std::size_t i) const;
+
+    /// \return the value traced by the Trace trace source
+    TracedValue<int32_t>& GetTracedValue();
+
+  private:
+    void DoDispose() override;
+
+    std::vector<Ptr<PathTestObject>> m_children;       //!< the children of the vector
+    std::map<uint32_t, Ptr<PathTestObject>> m_map;     //!< the children of the map
+    std::vector<Ptr<PathTestObject>> m_getterChildren; //!< the children of the getters
+    int32_t m_value;                                   //!< the attribute value
+    TracedValue<int32_t> m_trace;                      //!< the traced value
+};
+
+NS_OBJECT_ENSURE_REGISTERED(PathTestObject);
+
+TypeId
+PathTestObject::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PathTestObject")
+            .SetParent<Object>()
+            .SetGroupName("Core")
+            .AddConstructor<PathTestObject>()
+            .AddAttribute("Children",
+                          "The children of the vector.",
+                          ObjectVectorValue(),
+                          MakeObjectVectorAccessor(&PathTestObject::m_children),
+                          MakeObjectVectorChecker<PathTestObject>())
+            .AddAttribute("Map",
+                          "The children of the map.",
+                          ObjectMapValue(),
+                          MakeObjectMapAccessor(&PathTestObject::m_map),
+                          MakeObjectMapChecker<PathTestObject>())
+            .AddAttribute("Getters",
+                          "The children accessed through getters.",
+                          ObjectVectorValue(),
+                          MakeObjectVectorAccessor(&PathTestObject::GetNGetterChildren,
+                                                   &PathTestObject::GetGetterChild),
+                          MakeObjectVectorChecker<PathTestObject>())
+            .AddAttribute("Value",
+                          "An integer value.",
+                          IntegerValue(0),
+                          MakeIntegerAccessor(&PathTestObject::m_value),
+                          MakeIntegerChecker<int32_t>())
+            .AddTraceSource("Trace",
+                            "A traced value.",
+                            MakeTraceSourceAccessor(&PathTestObject::m_trace),
+                            "ns3::TracedValueCallback::Int32");
+    return tid;
+}
+
+void
+PathTestObject::AddChildren(uint32_t nChildren, const std::vector<uint32_t>& keys)
+{
+    for (uint32_t i = 0; i < nChildren; i++)
+    {
+        m_children.push_back(CreateObject<PathTestObject>());
+        m_getterChildren.push_back(CreateObject<PathTestObject>());
+    }
+    for (auto key : keys)
+    {
+        m_map[key] = CreateObject<PathTestObject>();
+    }
+}
+
+std::size_t
+PathTestObject::GetNGetterChildren() const
+{
+    return m_getterChildren.size();
+}
+
+Ptr<PathTestObject>
+PathTestObject::GetGetterChild(std::size_t i) const
+{
+    return m_getterChildren[i];
+}
+
+TracedValue<int32_t>&
+PathTestObject::GetTracedValue()
+{
+    return m_trace;
+}
+
+void
+PathTestObject::DoDispose()
+{
+    m_children.clear();
+    m_map.clear();
+    m_getterChildren.clear();
+    Object::DoDispose();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief CompiledPath test against Config::LookupMatches
+ *
+ * Paths with wildcards, indices and ranges are resolved by CompiledPath and
+ * by Config::LookupMatches: the objects found and their matched paths must
+ * be the same, in the same order.
+ */
+class CompiledPathMatchTestCase : public TestCase
+{
+  public:
+    CompiledPathMatchTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Compare the matches of a path
+     * \param path the path to the Value attribute of some objects
+     * \param expected the expected number of matches
+     */
+    void CheckMatches(std::string path, std::size_t expected);
+};
+
+CompiledPathMatchTestCase::CompiledPathMatchTestCase()
+    : TestCase("Compare the matches of CompiledPath and Config::LookupMatches")
+{
+}
+
+void
+CompiledPathMatchTestCase::CheckMatches(std::string path, std::size_t expected)
+{
+    Config::CompiledPath compiled(path);
+    std::vector<Ptr<Object>> objects;
+    std::vector<std::string> matchedPaths;
+    std::size_t n = compiled.Resolve([&](Ptr<Object> object, const Config::PathIndex& index) {
+        objects.push_back(object);
+        matchedPaths.push_back(compiled.GetMatchedPath(index));
+    });
+    NS_TEST_EXPECT_MSG_EQ(n, objects.size(), "Wrong number of matches returned for " << path);
+    NS_TEST_EXPECT_MSG_EQ(n, expected, "Wrong number of matches of " << path);
+
+    std::string leaf = compiled.GetLeaf();
+    Config::MatchContainer matches =
+        Config::LookupMatches(path.substr(0, path.size() - leaf.size()));
+    NS_TEST_ASSERT_MSG_EQ(matches.GetN(), n, "Different numbers of matches for " << path);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(objects[i], matches.Get(i), "Different match of " << path);
+        NS_TEST_EXPECT_MSG_EQ(matchedPaths[i],
+                              matches.GetMatchedPath(i) + leaf,
+                              "Different matched path of " << path);
+    }
+}
+
+void
+CompiledPathMatchTestCase::DoRun()
+{
+    Ptr<PathTestObject> root = CreateObject<PathTestObject>();
+    root->AddChildren(5, {1, 5, 9});
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        ObjectVectorValue children;
+        root->GetAttribute("Children", children);
+        children.Get(i)->GetObject<PathTestObject>()->AddChildren(3, {0, 4});
+    }
+    Config::RegisterRootNamespaceObject(root);
+
+    CheckMatches("/Children/*/Value", 5);
+    CheckMatches("/Children/2/Value", 1);
+    CheckMatches("/Children/7/Value", 0);
+    CheckMatches("/Children/[1-3]/Children/0|2/Value", 6);
+    CheckMatches("/Children/4|[0-1]/Children/*/Value", 9);
+    CheckMatches("/Children/*/$ns3::PathTestObject/Children/1/Value", 5);
+    // map keys are not positions
+    CheckMatches("/Map/5/Value", 1);
+    CheckMatches("/Map/2/Value", 0);
+    CheckMatches("/Map/[2-9]/Value", 2);
+    CheckMatches("/Map/*/Value", 3);
+    CheckMatches("/Children/*/Map/4/Value", 5);
+    // containers accessed through getters
+    CheckMatches("/Getters/*/Value", 5);
+    CheckMatches("/Getters/3|[0-1]/Value", 3);
+    CheckMatches("/Getters/[3-8]/Value", 2);
+
+    Config::UnregisterRootNamespaceObject(root);
+    root->Dispose();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief CompiledPath test of the connections to trace sources and of Set
+ */
+class CompiledPathConnectTestCase : public TestCase
+{
+  public:
+    CompiledPathConnectTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Trace sink with a path index
+     * \param index the path index of the trace source
+     * \param oldValue the old value
+     * \param newValue the new value
+     */
+    void TraceWithIndex(Config::PathIndex index, int32_t oldValue, int32_t newValue);
+
+    /**
+     * \brief Trace sink with a context
+     * \param context the matched path of the trace source
+     * \param oldValue the old value
+     * \param newValue the new value
+     */
+    void TraceWithContext(std::string context, int32_t oldValue, int32_t newValue);
+
+    std::vector<Config::PathIndex> m_indices; //!< the path indices received
+    std::vector<std::string> m_contexts;      //!< the contexts received
+};
+
+CompiledPathConnectTestCase::CompiledPathConnectTestCase()
+    : TestCase("Connect to trace sources and set attributes through a CompiledPath")
+{
+}
+
+void
+CompiledPathConnectTestCase::TraceWithIndex(Config::PathIndex index,
+                                            int32_t oldValue,
+                                            int32_t newValue)
+{
+    m_indices.push_back(index);
+}
+
+void
+CompiledPathConnectTestCase::TraceWithContext(std::string context,
+                                              int32_t oldValue,
+                                              int32_t newValue)
+{
+    m_contexts.push_back(context);
+}
+
+void
+CompiledPathConnectTestCase::DoRun()
+{
+    Ptr<PathTestObject> root = CreateObject<PathTestObject>();
+    root->AddChildren(3, {2, 7});
+    ObjectMapValue map;
+    root->GetAttribute("Map", map);
+    for (auto it = map.Begin(); it != map.End(); it++)
+    {
+        it->second->GetObject<PathTestObject>()->AddChildren(2, {});
+    }
+    Config::RegisterRootNamespaceObject(root);
+
+    Config::CompiledPath path("/Map/*/Children/1/Trace");
+    NS_TEST_ASSERT_MSG_EQ(path.GetLeaf(), "Trace", "Wrong leaf");
+    std::size_t n = path.ConnectWithIndex(
+        MakeCallback(&CompiledPathConnectTestCase::TraceWithIndex, this));
+    NS_TEST_ASSERT_MSG_EQ(n, 2, "Wrong number of connections");
+    n = path.Connect(MakeCallback(&CompiledPathConnectTestCase::TraceWithContext, this));
+    NS_TEST_ASSERT_MSG_EQ(n, 2, "Wrong number of connections");
+
+    Config::MatchContainer matches = Config::LookupMatches("/Map/*/Children/1");
+    for (std::size_t i = 0; i < matches.GetN(); i++)
+    {
+        matches.Get(i)->GetObject<PathTestObject>()->GetTracedValue() = 1;
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_indices.size(), 2, "Wrong number of traces");
+    NS_TEST_EXPECT_MSG_EQ(m_indices[0].n, 2, "Wrong number of indices");
+    NS_TEST_EXPECT_MSG_EQ(m_indices[0][0], 2, "Wrong map key");
+    NS_TEST_EXPECT_MSG_EQ(m_indices[0][1], 1, "Wrong child index");
+    NS_TEST_EXPECT_MSG_EQ(m_indices[1][0], 7, "Wrong map key");
+    NS_TEST_ASSERT_MSG_EQ(m_contexts.size(), 2, "Wrong number of traces");
+    NS_TEST_EXPECT_MSG_EQ(m_contexts[0], "/Map/2/Children/1/Trace", "Wrong context");
+    NS_TEST_EXPECT_MSG_EQ(m_contexts[1], "/Map/7/Children/1/Trace", "Wrong context");
+
+    n = Config::CompiledPath("/Map/7|2/Children/*/Value").Set(IntegerValue(42));
+    NS_TEST_ASSERT_MSG_EQ(n, 4, "Wrong number of attributes set");
+    matches = Config::LookupMatches("/Map/*/Children/*");
+    for (std::size_t i = 0; i < matches.GetN(); i++)
+    {
+        IntegerValue value;
+        matches.Get(i)->GetAttribute("Value", value);
+        NS_TEST_EXPECT_MSG_EQ(value.Get(), 42, "Attribute not set");
+    }
+
+    Config::UnregisterRootNamespaceObject(root);
+    root->Dispose();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief CompiledPath test suite
+ */
+class CompiledPathTestSuite : public TestSuite
+{
+  public:
+    CompiledPathTestSuite();
+};
+
+CompiledPathTestSuite::CompiledPathTestSuite()
+    : TestSuite("config-path", UNIT)
+{
+    AddTestCase(new CompiledPathMatchTestCase, TestCase::QUICK);
+    AddTestCase(new CompiledPathConnectTestCase, TestCase::QUICK);
+}
+
+static CompiledPathTestSuite g_compiledPathTestSuite; //!< Static variable for test initialization
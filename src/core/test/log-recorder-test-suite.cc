@@ -0,0 +1,211 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log-recorder.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logging
+ * LogRecorder test suite.
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+NS_LOG_COMPONENT_DEFINE("LogRecorderTestSuite");
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief LogRecorder test of the formatting of the records
+ *
+ * The same messages are logged with and without the recorder, and the
+ * formatted outputs are compared.
+ */
+class LogRecorderFormatTestCase : public TestCase
+{
+  public:
+    LogRecorderFormatTestCase();
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /**
+     * \brief Log messages with values of all the recorded types, and
+     * values formatted when logged
+     * \param n the number of messages logged by the loop
+     */
+    void LogMessages(uint32_t n);
+
+    /**
+     * \param mode the mode of the recorder
+     * \param n the number of messages logged by the loop
+     * \return the messages formatted into std::clog
+     */
+    std::string CaptureClog(LogRecorder::Mode mode, uint32_t n);
+};
+
+LogRecorderFormatTestCase::LogRecorderFormatTestCase()
+    : TestCase("Compare the messages formatted with and without the LogRecorder")
+{
+}
+
+void
+LogRecorderFormatTestCase::DoSetup()
+{
+    LogComponentEnable("LogRecorderTestSuite",
+                       LogLevel(LOG_LEVEL_ALL | LOG_PREFIX_FUNC | LOG_PREFIX_LEVEL));
+}
+
+void
+LogRecorderFormatTestCase::DoTeardown()
+{
+    LogRecorder::Disable();
+    LogComponentDisable("LogRecorderTestSuite", LOG_LEVEL_ALL);
+}
+
+void
+LogRecorderFormatTestCase::LogMessages(uint32_t n)
+{
+    NS_LOG_FUNCTION(this << n << "name" << 1.5 << true);
+    NS_LOG_FUNCTION_NOARGS();
+    int32_t negative = -42;
+    uint64_t large = 0xffffffffffffffffULL;
+    std::string text = "a string";
+    std::string_view view = "a string view";
+    NS_LOG_DEBUG("integers " << negative << " " << large << " " << uint16_t(7));
+    NS_LOG_INFO("floating point " << 0.1 << " " << -2.5e-9 << " " << 3.0f);
+    NS_LOG_LOGIC("characters " << 'x' << " bool " << false << " " << text << " " << view);
+    NS_LOG_WARN("time " << Seconds(1.5) << " manipulators " << std::hex << 255 << " " << 16);
+    NS_LOG_ERROR("pointer " << static_cast<const void*>(this) << " null " << nullptr);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NS_LOG_INFO("message " << i << " of " << n);
+    }
+}
+
+std::string
+LogRecorderFormatTestCase::CaptureClog(LogRecorder::Mode mode, uint32_t n)
+{
+    std::ostringstream oss;
+    std::streambuf* buf = std::clog.rdbuf(oss.rdbuf());
+    if (mode == LogRecorder::ASYNC)
+    {
+        LogRecorder::EnableAsync(4096);
+    }
+    LogMessages(n);
+    LogRecorder::Disable();
+    std::clog.rdbuf(buf);
+    return oss.str();
+}
+
+void
+LogRecorderFormatTestCase::DoRun()
+{
+    const uint32_t n = 1000;
+    std::string expected = CaptureClog(LogRecorder::TEXT, n);
+    NS_TEST_ASSERT_MSG_NE(expected.find("[DEBUG] integers -42"),
+                          std::string::npos,
+                          "Message not logged");
+
+    // ASYNC mode, with a ring smaller than the messages logged
+    std::string async = CaptureClog(LogRecorder::ASYNC, n);
+    NS_TEST_EXPECT_MSG_EQ(async, expected, "Different messages formatted in ASYNC mode");
+
+    // BINARY mode, decoded afterwards
+    std::string fileName = CreateTempDirFilename("log-recorder.bin");
+    LogRecorder::EnableBinary(fileName, 4096);
+    NS_TEST_ASSERT_MSG_EQ(LogRecorder::GetMode(), LogRecorder::BINARY, "Wrong mode");
+    NS_TEST_ASSERT_MSG_EQ(LogRecorder::IsActive(), true, "Recorder not active");
+    LogMessages(n);
+    LogRecorder::Disable();
+    NS_TEST_ASSERT_MSG_EQ(LogRecorder::GetMode(), LogRecorder::TEXT, "Wrong mode");
+    NS_TEST_ASSERT_MSG_EQ(LogRecorder::IsActive(), false, "Recorder still active");
+
+    std::ifstream is(fileName, std::ios::binary);
+    std::ostringstream decoded;
+    NS_TEST_ASSERT_MSG_EQ(LogRecorder::Decode(is, decoded), true, "The file was not decoded");
+    NS_TEST_EXPECT_MSG_EQ(decoded.str(), expected, "Different messages decoded");
+    is.close();
+
+    // a truncated file is decoded up to the truncated record
+    std::ifstream whole(fileName, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(whole)), std::istreambuf_iterator<char>());
+    std::istringstream truncated(content.substr(0, content.size() - 3));
+    std::ostringstream partial;
+    NS_TEST_EXPECT_MSG_EQ(LogRecorder::Decode(truncated, partial), false, "Truncation missed");
+    NS_TEST_EXPECT_MSG_EQ(expected.compare(0, partial.str().size(), partial.str()),
+                          0,
+                          "Wrong messages decoded from a truncated file");
+
+    std::istringstream notALog("not a log file");
+    std::ostringstream none;
+    NS_TEST_EXPECT_MSG_EQ(LogRecorder::Decode(notALog, none), false, "Wrong file decoded");
+    std::remove(fileName.c_str());
+
+    // FLIGHT_RECORDER mode: only the last records are formatted by Dump
+    LogRecorder::EnableFlightRecorder(3);
+    LogMessages(n);
+    std::ostringstream dumped;
+    NS_TEST_EXPECT_MSG_EQ(LogRecorder::Dump(dumped), 3, "Wrong number of records dumped");
+    std::size_t lastLines = expected.find("message " + std::to_string(n - 3) + " of");
+    lastLines = expected.rfind('\n', lastLines) + 1;
+    NS_TEST_EXPECT_MSG_EQ(dumped.str(), expected.substr(lastLines), "Wrong records dumped");
+    NS_TEST_EXPECT_MSG_EQ(LogRecorder::Dump(dumped), 0, "Records dumped twice");
+    LogRecorder::Disable();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief LogRecorder test suite
+ */
+class LogRecorderTestSuite : public TestSuite
+{
+  public:
+    LogRecorderTestSuite();
+};
+
+LogRecorderTestSuite::LogRecorderTestSuite()
+    : TestSuite("log-recorder", UNIT)
+{
+    AddTestCase(new LogRecorderFormatTestCase, TestCase::QUICK);
+}
+
+/**
+ * \ingroup core-tests
+ * LogRecorderTestSuite instance variable.
+ */
+static LogRecorderTestSuite g_logRecorderTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
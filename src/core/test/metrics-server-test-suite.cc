@@ -0,0 +1,281 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/live-counter.h"
+#include "ns3/metrics-server.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#ifndef __WIN32__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup debugging
+ * LiveCounter and MetricsServer test suite.
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief Class whose live instances are counted by a LiveCount member
+ */
+class LiveTestObject
+{
+  public:
+    /**
+     * \brief Get the counter of the live instances
+     * \return the counter
+     */
+    static LiveCounter& GetLiveCounter()
+    {
+        static LiveCounter counter("ns3_test_objects_live", "Number of live test objects.");
+        return counter;
+    }
+
+  private:
+    /// Counts the live instances
+    [[no_unique_address]] LiveCount<&LiveTestObject::GetLiveCounter> m_liveCount;
+};
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief LiveCounter test of the instances counted by a LiveCount member
+ */
+class LiveCounterTestCase : public TestCase
+{
+  public:
+    LiveCounterTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LiveCounterTestCase::LiveCounterTestCase()
+    : TestCase("Count the live instances of a class with a LiveCount member")
+{
+}
+
+void
+LiveCounterTestCase::DoRun()
+{
+    LiveCounter& counter = LiveTestObject::GetLiveCounter();
+    NS_TEST_ASSERT_MSG_EQ(counter.Get(), 0, "Wrong initial count");
+    NS_TEST_ASSERT_MSG_EQ(counter.GetName(), "ns3_test_objects_live", "Wrong name");
+    auto counters = LiveCounter::GetCounters();
+    NS_TEST_ASSERT_MSG_EQ((std::find(counters.begin(), counters.end(), &counter) !=
+                           counters.end()),
+                          true,
+                          "Counter not registered");
+    {
+        LiveTestObject a;
+        LiveTestObject b(a);
+        NS_TEST_ASSERT_MSG_EQ(counter.Get(), 2, "Copy not counted");
+        auto c = std::make_unique<LiveTestObject>();
+        b = *c;
+        NS_TEST_ASSERT_MSG_EQ(counter.Get(), 3, "Assignment counted");
+        LiveTestObject d(std::move(b));
+        NS_TEST_ASSERT_MSG_EQ(counter.Get(), 4, "Move not counted");
+        c.reset();
+        NS_TEST_ASSERT_MSG_EQ(counter.Get(), 3, "Destruction not counted");
+    }
+    NS_TEST_ASSERT_MSG_EQ(counter.Get(), 0, "Wrong count after the destructions");
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief MetricsServer test of the metrics sampled during a simulation
+ */
+class MetricsServerTestCase : public TestCase
+{
+  public:
+    MetricsServerTestCase();
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /// \return the value of the test gauge
+    double GetGauge() const;
+
+    /// \return the value of the test counter
+    double GetTicks() const;
+
+    /**
+     * \brief Connect to the server and read its response
+     * \param port the TCP port of the server
+     * \param request the request sent
+     * \return the response
+     */
+    static std::string Query(uint16_t port, const std::string& request);
+
+    /// \brief Increment the test counter and reschedule itself
+    void Tick();
+
+    uint32_t m_ticks; //!< the number of calls to Tick
+};
+
+MetricsServerTestCase::MetricsServerTestCase()
+    : TestCase("Sample and serve the metrics of a simulation"),
+      m_ticks(0)
+{
+}
+
+double
+MetricsServerTestCase::GetGauge() const
+{
+    return 42.5;
+}
+
+double
+MetricsServerTestCase::GetTicks() const
+{
+    return m_ticks;
+}
+
+void
+MetricsServerTestCase::Tick()
+{
+    m_ticks++;
+    Simulator::Schedule(MilliSeconds(1), &MetricsServerTestCase::Tick, this);
+}
+
+std::string
+MetricsServerTestCase::Query(uint16_t port, const std::string& request)
+{
+    std::string response;
+#ifndef __WIN32__
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+    {
+        if (!request.empty())
+        {
+            send(fd, request.data(), request.size(), 0);
+        }
+        char buffer[4096];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+        {
+            response.append(buffer, n);
+        }
+    }
+    close(fd);
+#endif
+    return response;
+}
+
+void
+MetricsServerTestCase::DoRun()
+{
+    LiveTestObject object;
+    MetricsServer server("tcp:0", MilliSeconds(1));
+    server.AddGauge("ns3_test_gauge{label=\"a\"}",
+                    "A test gauge.",
+                    MakeCallback(&MetricsServerTestCase::GetGauge, this));
+    server.AddCounter("ns3_test_ticks_total",
+                      "A test counter.",
+                      MakeCallback(&MetricsServerTestCase::GetTicks, this));
+    NS_TEST_ASSERT_MSG_NE(server.GetPort(), 0, "No port selected");
+
+    Simulator::Schedule(Seconds(0), &MetricsServerTestCase::Tick, this);
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_ticks, 1000, "Wrong number of ticks");
+
+    std::string metrics = server.GetMetrics();
+    for (std::string line : {"# TYPE ns3_events_total counter\n",
+                             "# HELP ns3_test_gauge A test gauge.\n",
+                             "# TYPE ns3_test_gauge gauge\n",
+                             "ns3_test_gauge{label=\"a\"} 42.5\n",
+                             "# TYPE ns3_test_ticks_total counter\n",
+                             "ns3_test_objects_live 1\n",
+                             "ns3_simulation_time_seconds "})
+    {
+        NS_TEST_EXPECT_MSG_NE(metrics.find(line), std::string::npos, "Missing " << line);
+    }
+
+#ifndef __WIN32__
+    // an HTTP client receives the metrics sampled last, with a header
+    std::string response = Query(server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n");
+    NS_TEST_EXPECT_MSG_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0, "Wrong HTTP response");
+    NS_TEST_EXPECT_MSG_NE(response.find("\r\n\r\n# HELP ns3_events_total"),
+                          std::string::npos,
+                          "Wrong HTTP body");
+    // any other client receives the metrics alone
+    response = Query(server.GetPort(), "");
+    NS_TEST_EXPECT_MSG_EQ(response.compare(0, 24, "# HELP ns3_events_total "),
+                          0,
+                          "Wrong raw response");
+    NS_TEST_EXPECT_MSG_NE(response.find("ns3_test_gauge{label=\"a\"} 42.5\n"),
+                          std::string::npos,
+                          "Missing gauge");
+#endif
+}
+
+void
+MetricsServerTestCase::DoTeardown()
+{
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief LiveCounter and MetricsServer test suite
+ */
+class MetricsServerTestSuite : public TestSuite
+{
+  public:
+    MetricsServerTestSuite();
+};
+
+MetricsServerTestSuite::MetricsServerTestSuite()
+    : TestSuite("metrics-server", UNIT)
+{
+    AddTestCase(new LiveCounterTestCase, TestCase::QUICK);
+    AddTestCase(new MetricsServerTestCase, TestCase::QUICK);
+}
+
+/**
+ * \ingroup core-tests
+ * MetricsServerTestSuite instance variable.
+ */
+static MetricsServerTestSuite g_metricsServerTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -31,6 +31,11 @@ FlowClassifier::~FlowClassifier()
 {
 }
 
+void
+FlowClassifier::ForgetFlow(FlowId /* flowId */)
+{
+}
+
 FlowId
 FlowClassifier::GetNewFlowId()
 {
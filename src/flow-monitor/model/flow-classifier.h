@@ -68,6 +68,12 @@ class FlowClassifier : public SimpleRefCount<FlowClassifier>
     /// \param indent number of spaces to use as base indentation level
     virtual void SerializeToXmlStream(std::ostream& os, uint16_t indent) const = 0;
 
+    /// Forget a flow, whose statistics are no longer kept (e.g., because
+    /// FlowMonitor has written them to its streaming file).  A later packet
+    /// with the same classification starts a new flow, with a new FlowId.
+    /// \param flowId the identifier of the flow to forget
+    virtual void ForgetFlow(FlowId flowId);
+
   protected:
     /// Returns a new, unique Flow Identifier
     /// \returns a new FlowId
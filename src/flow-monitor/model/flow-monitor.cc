@@ -19,11 +19,20 @@
 
 #include "flow-monitor.h"
 
+#include "flow-stats-file.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/double.h"
+#include "ns3/flow-hash.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds(1))
@@ -80,7 +89,26 @@ FlowMonitor::GetTypeId()
                 ("The minimum inter-arrival time that is considered a flow interruption."),
                 TimeValue(Seconds(0.5)),
                 MakeTimeAccessor(&FlowMonitor::m_flowInterruptionsMinTime),
-                MakeTimeChecker());
+                MakeTimeChecker())
+            .AddAttribute("SamplingRate",
+                          "Track one packet out of SamplingRate packets of each flow to measure "
+                          "delays, jitters and packet sizes (1 tracks every packet). Packets "
+                          "and bytes are counted exactly regardless of this value.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&FlowMonitor::m_samplingRate),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("UseQuantileSketches",
+                          "Record the delays, jitters and packet sizes in mergeable quantile "
+                          "sketches instead of fixed-width histograms.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&FlowMonitor::m_useQuantileSketches),
+                          MakeBooleanChecker())
+            .AddAttribute("SketchRelativeAccuracy",
+                          "The relative accuracy of the quantiles estimated by the sketches.",
+                          DoubleValue(0.01),
+                          MakeDoubleAccessor(&FlowMonitor::m_sketchAccuracy),
+                          MakeDoubleChecker<double>(std::numeric_limits<double>::min(),
+                                                    std::nextafter(1.0, 0.0)));
     return tid;
 }
 
@@ -96,12 +124,21 @@ FlowMonitor::FlowMonitor()
     NS_LOG_FUNCTION(this);
 }
 
+FlowMonitor::~FlowMonitor()
+{
+    NS_LOG_FUNCTION(this);
+}
+
 void
 FlowMonitor::DoDispose()
 {
     NS_LOG_FUNCTION(this);
     Simulator::Cancel(m_startEvent);
     Simulator::Cancel(m_stopEvent);
+    if (m_streamWriter)
+    {
+        FlushStreaming();
+    }
     for (auto iter = m_classifiers.begin(); iter != m_classifiers.end(); iter++)
     {
         *iter = nullptr;
@@ -129,12 +166,20 @@ FlowMonitor::GetStatsForFlow(FlowId flowId)
         ref.rxBytes = 0;
         ref.txPackets = 0;
         ref.rxPackets = 0;
+        ref.rxSampledPackets = 0;
         ref.lostPackets = 0;
         ref.timesForwarded = 0;
         ref.delayHistogram.SetDefaultBinWidth(m_delayBinWidth);
         ref.jitterHistogram.SetDefaultBinWidth(m_jitterBinWidth);
         ref.packetSizeHistogram.SetDefaultBinWidth(m_packetSizeBinWidth);
         ref.flowInterruptionsHistogram.SetDefaultBinWidth(m_flowInterruptionsBinWidth);
+        ref.delaySketch.SetRelativeAccuracy(m_sketchAccuracy);
+        ref.jitterSketch.SetRelativeAccuracy(m_sketchAccuracy);
+        ref.packetSizeSketch.SetRelativeAccuracy(m_sketchAccuracy);
+        if (m_streamWriter && m_flowIdleTimeout.IsStrictlyPositive())
+        {
+            m_flowDeadlines.emplace(Simulator::Now() + m_flowIdleTimeout, flowId);
+        }
         return ref;
     }
     else
@@ -143,6 +188,17 @@ FlowMonitor::GetStatsForFlow(FlowId flowId)
     }
 }
 
+inline bool
+FlowMonitor::IsSampled(FlowId flowId, FlowPacketId packetId) const
+{
+    if (m_samplingRate <= 1)
+    {
+        return true;
+    }
+    uint32_t key[2] = {flowId, packetId};
+    return FlowHash<2>(key, 0) % m_samplingRate == 0;
+}
+
 void
 FlowMonitor::ReportFirstTx(Ptr<FlowProbe> probe,
                            uint32_t flowId,
@@ -156,14 +212,14 @@ FlowMonitor::ReportFirstTx(Ptr<FlowProbe> probe,
         return;
     }
     Time now = Simulator::Now();
-    TrackedPacket& tracked = m_trackedPackets[std::make_pair(flowId, packetId)];
-    tracked.firstSeenTime = now;
-    tracked.lastSeenTime = tracked.firstSeenTime;
-    tracked.timesForwarded = 0;
-    NS_LOG_DEBUG("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId="
-                                                                 << packetId << ").");
+    if (IsSampled(flowId, packetId))
+    {
+        m_trackedPackets.Insert(flowId, packetId, now);
+        NS_LOG_DEBUG("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId="
+                                                                     << packetId << ").");
 
-    probe->AddPacketStats(flowId, packetSize, Seconds(0));
+        probe->AddPacketStats(flowId, packetSize, Seconds(0));
+    }
 
     FlowStats& stats = GetStatsForFlow(flowId);
     stats.txBytes += packetSize;
@@ -187,19 +243,22 @@ FlowMonitor::ReportForwarding(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    std::pair<FlowId, FlowPacketId> key(flowId, packetId);
-    auto tracked = m_trackedPackets.find(key);
-    if (tracked == m_trackedPackets.end())
+    if (!IsSampled(flowId, packetId))
+    {
+        return;
+    }
+    TrackedPacketTable::Entry* tracked = m_trackedPackets.Find(flowId, packetId);
+    if (tracked == nullptr)
     {
         NS_LOG_WARN("Received packet forward report (flowId="
                     << flowId << ", packetId=" << packetId << ") but not known to be transmitted.");
         return;
     }
 
-    tracked->second.timesForwarded++;
-    tracked->second.lastSeenTime = Simulator::Now();
+    tracked->timesForwarded++;
+    m_trackedPackets.Touch(tracked, Simulator::Now());
 
-    Time delay = (Simulator::Now() - tracked->second.firstSeenTime);
+    Time delay = (Simulator::Now() - tracked->firstSeenTime);
     probe->AddPacketStats(flowId, packetSize, delay);
 }
 
@@ -215,39 +274,73 @@ FlowMonitor::ReportLastRx(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    auto tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
-    if (tracked == m_trackedPackets.end())
+    TrackedPacketTable::Entry* tracked = nullptr;
+    if (IsSampled(flowId, packetId))
     {
-        NS_LOG_WARN("Received packet last-tx report (flowId="
-                    << flowId << ", packetId=" << packetId << ") but not known to be transmitted.");
-        return;
+        tracked = m_trackedPackets.Find(flowId, packetId);
+        if (tracked == nullptr)
+        {
+            NS_LOG_WARN("Received packet last-tx report (flowId="
+                        << flowId << ", packetId=" << packetId
+                        << ") but not known to be transmitted.");
+            return;
+        }
     }
 
     Time now = Simulator::Now();
-    Time delay = (now - tracked->second.firstSeenTime);
-    probe->AddPacketStats(flowId, packetSize, delay);
-
     FlowStats& stats = GetStatsForFlow(flowId);
-    stats.delaySum += delay;
-    stats.delayHistogram.AddValue(delay.GetSeconds());
-    if (stats.rxPackets > 0)
+
+    if (tracked != nullptr)
     {
-        Time jitter = stats.lastDelay - delay;
-        if (jitter > Seconds(0))
+        Time delay = (now - tracked->firstSeenTime);
+        probe->AddPacketStats(flowId, packetSize, delay);
+
+        stats.delaySum += delay;
+        if (m_useQuantileSketches)
+        {
+            stats.delaySketch.AddValue(delay.GetSeconds());
+        }
+        else
         {
+            stats.delayHistogram.AddValue(delay.GetSeconds());
+        }
+        if (stats.rxSampledPackets > 0)
+        {
+            Time jitter = stats.lastDelay - delay;
+            if (jitter < Seconds(0))
+            {
+                jitter = delay - stats.lastDelay;
+            }
             stats.jitterSum += jitter;
-            stats.jitterHistogram.AddValue(jitter.GetSeconds());
+            if (m_useQuantileSketches)
+            {
+                stats.jitterSketch.AddValue(jitter.GetSeconds());
+            }
+            else
+            {
+                stats.jitterHistogram.AddValue(jitter.GetSeconds());
+            }
+        }
+        stats.lastDelay = delay;
+
+        if (m_useQuantileSketches)
+        {
+            stats.packetSizeSketch.AddValue(packetSize);
         }
         else
         {
-            stats.jitterSum -= jitter;
-            stats.jitterHistogram.AddValue(-jitter.GetSeconds());
+            stats.packetSizeHistogram.AddValue((double)packetSize);
         }
+        stats.rxSampledPackets++;
+        stats.timesForwarded += tracked->timesForwarded;
+
+        NS_LOG_DEBUG("ReportLastTx: removing tracked packet (flowId=" << flowId << ", packetId="
+                                                                      << packetId << ").");
+
+        m_trackedPackets.Erase(tracked); // we don't need to track this packet anymore
     }
-    stats.lastDelay = delay;
 
     stats.rxBytes += packetSize;
-    stats.packetSizeHistogram.AddValue((double)packetSize);
     stats.rxPackets++;
     if (stats.rxPackets == 1)
     {
@@ -263,12 +356,6 @@ FlowMonitor::ReportLastRx(Ptr<FlowProbe> probe,
         }
     }
     stats.timeLastRxPacket = now;
-    stats.timesForwarded += tracked->second.timesForwarded;
-
-    NS_LOG_DEBUG("ReportLastTx: removing tracked packet (flowId=" << flowId << ", packetId="
-                                                                  << packetId << ").");
-
-    m_trackedPackets.erase(tracked); // we don't need to track this packet anymore
 }
 
 void
@@ -299,14 +386,15 @@ FlowMonitor::ReportDrop(Ptr<FlowProbe> probe,
     NS_LOG_DEBUG("++stats.packetsDropped["
                  << reasonCode << "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-    auto tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
-    if (tracked != m_trackedPackets.end())
+    TrackedPacketTable::Entry* tracked =
+        IsSampled(flowId, packetId) ? m_trackedPackets.Find(flowId, packetId) : nullptr;
+    if (tracked != nullptr)
     {
         // we don't need to track this packet anymore
         // FIXME: this will not necessarily be true with broadcast/multicast
         NS_LOG_DEBUG("ReportDrop: removing tracked packet (flowId=" << flowId << ", packetId="
                                                                     << packetId << ").");
-        m_trackedPackets.erase(tracked);
+        m_trackedPackets.Erase(tracked);
     }
 }
 
@@ -322,35 +410,168 @@ FlowMonitor::CheckForLostPackets(Time maxDelay)
     NS_LOG_FUNCTION(this << maxDelay.As(Time::S));
     Time now = Simulator::Now();
 
-    for (auto iter = m_trackedPackets.begin(); iter != m_trackedPackets.end();)
+    // only the packets not seen since now - maxDelay are visited; they are
+    // considered lost, added to the loss statistics and no longer tracked.
+    // A sampled packet stands for m_samplingRate packets of its flow, but no
+    // more packets than those neither received nor already lost are counted
+    m_trackedPackets.Expire(now - maxDelay, [this](FlowId flowId) {
+        auto flow = m_flowStats.find(flowId);
+        if (flow == m_flowStats.end())
+        {
+            // the flow has been written to the streaming file already, hence
+            // the number of its missing packets is unknown
+            m_pendingLosses[flowId] += m_samplingRate;
+            return;
+        }
+        FlowStats& stats = flow->second;
+        uint64_t missing = stats.txPackets - std::min(stats.txPackets, stats.rxPackets);
+        missing -= std::min<uint64_t>(missing, stats.lostPackets);
+        stats.lostPackets += std::min<uint64_t>(m_samplingRate, missing);
+    });
+}
+
+void
+FlowMonitor::CheckForLostPackets()
+{
+    CheckForLostPackets(m_maxPerHopDelay);
+}
+
+void
+FlowMonitor::ReportFlowEnd(Ptr<FlowProbe> probe, FlowId flowId)
+{
+    NS_LOG_FUNCTION(this << probe << flowId);
+    if (m_streamWriter)
+    {
+        m_endedFlows.push_back(flowId);
+    }
+}
+
+void
+FlowMonitor::EnableStreaming(std::string fileName, bool binary, Time idleTimeout)
+{
+    NS_LOG_FUNCTION(this << fileName << binary << idleTimeout.As(Time::S));
+    NS_ABORT_MSG_IF(m_useQuantileSketches,
+                    "The quantile sketches cannot be streamed; disable UseQuantileSketches");
+    m_streamWriter = std::make_unique<FlowStatsWriter>(fileName,
+                                                       binary ? FlowStatsWriter::BINARY
+                                                              : FlowStatsWriter::CSV);
+    m_flowIdleTimeout = idleTimeout;
+    m_endedFlows.clear();
+    m_pendingLosses.clear();
+    m_flowDeadlines = {};
+    if (m_flowIdleTimeout.IsStrictlyPositive())
     {
-        if (now - iter->second.lastSeenTime >= maxDelay)
+        for (const auto& flow : m_flowStats)
         {
-            // packet is considered lost, add it to the loss statistics
-            auto flow = m_flowStats.find(iter->first.first);
-            NS_ASSERT(flow != m_flowStats.end());
-            flow->second.lostPackets++;
+            m_flowDeadlines.emplace(Simulator::Now() + m_flowIdleTimeout, flow.first);
+        }
+    }
+}
 
-            // we won't track it anymore
-            m_trackedPackets.erase(iter++);
+bool
+FlowMonitor::IsStreaming() const
+{
+    return m_streamWriter != nullptr;
+}
+
+void
+FlowMonitor::ExportCompletedFlows()
+{
+    NS_LOG_FUNCTION(this);
+    for (FlowId flowId : m_endedFlows)
+    {
+        auto flow = m_flowStats.find(flowId);
+        if (flow != m_flowStats.end())
+        {
+            ExportFlow(flow);
+        }
+    }
+    m_endedFlows.clear();
+    ExportPendingLosses();
+
+    // only the flows whose deadline has expired are visited. The deadline of
+    // a flow written since then is simply discarded
+    Time now = Simulator::Now();
+    while (!m_flowDeadlines.empty() && m_flowDeadlines.top().first <= now)
+    {
+        FlowId flowId = m_flowDeadlines.top().second;
+        m_flowDeadlines.pop();
+        auto flow = m_flowStats.find(flowId);
+        if (flow == m_flowStats.end())
+        {
+            continue;
+        }
+        Time lastActivity = std::max(flow->second.timeLastTxPacket, flow->second.timeLastRxPacket);
+        if (now - lastActivity >= m_flowIdleTimeout)
+        {
+            NS_LOG_DEBUG("Writing idle flow " << flowId);
+            ExportFlow(flow);
         }
         else
         {
-            iter++;
+            m_flowDeadlines.emplace(lastActivity + m_flowIdleTimeout, flowId);
         }
     }
 }
 
 void
-FlowMonitor::CheckForLostPackets()
+FlowMonitor::ExportFlow(FlowStatsContainerI flow)
 {
-    CheckForLostPackets(m_maxPerHopDelay);
+    FlowId flowId = flow->first;
+    m_streamWriter->Write(flowId, flow->second);
+    m_flowStats.erase(flow);
+    for (const auto& probe : m_flowProbes)
+    {
+        probe->ForgetFlow(flowId);
+    }
+    for (const auto& classifier : m_classifiers)
+    {
+        classifier->ForgetFlow(flowId);
+    }
+}
+
+void
+FlowMonitor::ExportPendingLosses()
+{
+    // the losses are written as records of their own, which
+    // FlowStatsReader::ReadAll adds to the previous records of the flows
+    for (const auto& [flowId, lostPackets] : m_pendingLosses)
+    {
+        FlowStats stats{};
+        stats.lostPackets = lostPackets;
+        m_streamWriter->Write(flowId, stats);
+    }
+    m_pendingLosses.clear();
+}
+
+void
+FlowMonitor::FlushStreaming()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_streamWriter)
+    {
+        return;
+    }
+    CheckForLostPackets();
+    while (!m_flowStats.empty())
+    {
+        ExportFlow(m_flowStats.begin());
+    }
+    ExportPendingLosses();
+    m_endedFlows.clear();
+    m_flowDeadlines = {};
+    m_streamWriter->Close();
+    m_streamWriter.reset();
 }
 
 void
 FlowMonitor::PeriodicCheckForLostPackets()
 {
     CheckForLostPackets();
+    if (m_streamWriter)
+    {
+        ExportCompletedFlows();
+    }
     Simulator::Schedule(PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
@@ -449,7 +670,7 @@ FlowMonitor::SerializeToXmlStream(std::ostream& os,
            << "\"" ATTRIB_TIME(timeFirstTxPacket) ATTRIB_TIME(timeFirstRxPacket)
                   ATTRIB_TIME(timeLastTxPacket) ATTRIB_TIME(timeLastRxPacket) ATTRIB_TIME(delaySum)
                       ATTRIB_TIME(jitterSum) ATTRIB_TIME(lastDelay) ATTRIB(txBytes) ATTRIB(rxBytes)
-                          ATTRIB(txPackets) ATTRIB(rxPackets) ATTRIB(lostPackets)
+                          ATTRIB(txPackets) ATTRIB(rxPackets) ATTRIB(rxSampledPackets) ATTRIB(lostPackets)
                               ATTRIB(timesForwarded)
            << ">\n";
 #undef ATTRIB_TIME
@@ -469,7 +690,17 @@ FlowMonitor::SerializeToXmlStream(std::ostream& os,
             os << "<bytesDropped reasonCode=\"" << reasonCode << "\""
                << " bytes=\"" << flowI->second.bytesDropped[reasonCode] << "\" />\n";
         }
-        if (enableHistograms)
+        if (enableHistograms && m_useQuantileSketches)
+        {
+            flowI->second.delaySketch.SerializeToXmlStream(os, indent, "delaySketch");
+            flowI->second.jitterSketch.SerializeToXmlStream(os, indent, "jitterSketch");
+            flowI->second.packetSizeSketch.SerializeToXmlStream(os, indent, "packetSizeSketch");
+            flowI->second.flowInterruptionsHistogram.SerializeToXmlStream(
+                os,
+                indent,
+                "flowInterruptionsHistogram");
+        }
+        else if (enableHistograms)
         {
             flowI->second.delayHistogram.SerializeToXmlStream(os, indent, "delayHistogram");
             flowI->second.jitterHistogram.SerializeToXmlStream(os, indent, "jitterHistogram");
@@ -543,6 +774,7 @@ FlowMonitor::ResetAllStats()
         flowStat.rxBytes = 0;
         flowStat.txPackets = 0;
         flowStat.rxPackets = 0;
+        flowStat.rxSampledPackets = 0;
         flowStat.lostPackets = 0;
         flowStat.timesForwarded = 0;
         flowStat.bytesDropped.clear();
@@ -552,6 +784,9 @@ FlowMonitor::ResetAllStats()
         flowStat.jitterHistogram.Clear();
         flowStat.packetSizeHistogram.Clear();
         flowStat.flowInterruptionsHistogram.Clear();
+        flowStat.delaySketch.Clear();
+        flowStat.jitterSketch.Clear();
+        flowStat.packetSizeSketch.Clear();
     }
 }
 
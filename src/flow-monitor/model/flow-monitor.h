@@ -22,19 +22,26 @@
 
 #include "flow-classifier.h"
 #include "flow-probe.h"
+#include "tracked-packet-table.h"
 
 #include "ns3/event-id.h"
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
+#include "ns3/quantile-sketch.h"
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <queue>
 #include <vector>
 
 namespace ns3
 {
 
+class FlowStatsWriter;
+
 /**
  * \defgroup flow-monitor Flow Monitor
  * \brief  Collect and store performance data from a simulation
@@ -47,6 +54,21 @@ namespace ns3
  * The FlowMonitor class is responsible for coordinating efforts
  * regarding probes, and collects end-to-end flow statistics.
  *
+ * By default every packet is tracked from its first transmission to its
+ * reception. If the SamplingRate attribute is set to N > 1, only one packet
+ * out of N (chosen deterministically by hashing its flow and packet
+ * identifiers) is tracked, and the delays, jitters, packet sizes, forwarding
+ * counts and per-probe statistics are measured on the sampled packets only.
+ * The timeout losses are detected on the sampled packets and scaled by N,
+ * so lostPackets is then an estimate. The transmitted and received bytes and
+ * packets, the drops and the reception times are still counted for every
+ * packet. The memory used to track the packets in flight is then divided by
+ * N, and the cost of a non-sampled packet is a few counter updates.
+ *
+ * If the UseQuantileSketches attribute is true, the delays, jitters and
+ * packet sizes are recorded in QuantileSketch objects instead of the
+ * fixed-width histograms; the memory used by a sketch is bounded and
+ * sketches can be merged across flows and simulation runs.
  */
 class FlowMonitor : public Object
 {
@@ -98,12 +120,17 @@ class FlowMonitor : public Object
         uint32_t txPackets;
         /// Total number of received packets for the flow
         uint32_t rxPackets;
+        /// Number of received packets whose delay was measured, i.e.,
+        /// rxPackets unless FlowMonitor samples the packets
+        uint32_t rxSampledPackets;
 
         /// Total number of packets that are assumed to be lost,
         /// i.e. those that were transmitted but have not been reportedly
         /// received or forwarded for a long time.  By default, packets
         /// missing for a period of over 10 seconds are assumed to be
-        /// lost, although this value can be easily configured in runtime
+        /// lost, although this value can be easily configured in runtime.
+        /// With a SamplingRate of N > 1, each sampled packet found lost
+        /// counts for N packets, at most the packets not yet received
         uint32_t lostPackets;
 
         /// Contains the number of times a packet has been reportedly
@@ -116,6 +143,12 @@ class FlowMonitor : public Object
         Histogram jitterHistogram;
         /// Histogram of the packet sizes
         Histogram packetSizeHistogram;
+        /// Sketch of the packet delays (only used with quantile sketches)
+        QuantileSketch delaySketch;
+        /// Sketch of the packet jitters (only used with quantile sketches)
+        QuantileSketch jitterSketch;
+        /// Sketch of the packet sizes (only used with quantile sketches)
+        QuantileSketch packetSizeSketch;
 
         /// This attribute also tracks the number of lost packets and
         /// bytes, but discriminates the losses by a _reason code_.  This
@@ -146,6 +179,7 @@ class FlowMonitor : public Object
     static TypeId GetTypeId();
     TypeId GetInstanceTypeId() const override;
     FlowMonitor();
+    ~FlowMonitor() override;
 
     /// Add a FlowClassifier to be used by the flow monitor.
     /// \param classifier the FlowClassifier
@@ -216,6 +250,13 @@ class FlowMonitor : public Object
                     uint32_t packetSize,
                     uint32_t reasonCode);
 
+    /// FlowProbe implementations are supposed to call this method to
+    /// report that the last packet of a flow (e.g., a TCP FIN segment)
+    /// has been received.
+    /// \param probe the reporting probe
+    /// \param flowId flow identification
+    void ReportFlowEnd(Ptr<FlowProbe> probe, FlowId flowId);
+
     /// Check right now for packets that appear to be lost
     void CheckForLostPackets();
 
@@ -277,27 +318,50 @@ class FlowMonitor : public Object
     /// Reset all the statistics
     void ResetAllStats();
 
+    // --- streaming export ---
+
+    /// Write the statistics of the completed flows to a file while the
+    /// simulation runs, and drop them from memory, together with their
+    /// per-probe statistics and their classification.  A flow is completed
+    /// when its end has been reported (see ReportFlowEnd) or when no packet
+    /// of the flow has been transmitted or received for idleTimeout, which
+    /// should be larger than the MaxPerHopDelay attribute.  The flows are
+    /// checked every second, in a time depending on the number of flows
+    /// reaching their idle deadline rather than on the number of flows.
+    /// GetFlowStats(), the XML serialization and the flow classifiers (e.g.,
+    /// Ipv4FlowClassifier::FindFlow) then only cover the active flows.
+    /// Packets of a flow already in flight when the flow is written start a
+    /// new record with the same FlowId, which FlowStatsReader::ReadAll merges
+    /// with the previous ones; new packets with the same classification
+    /// start a new flow, with a new FlowId.  The sampled packets of a flow
+    /// found lost after the flow was written are written in records holding
+    /// only lostPackets.  The histograms are not written, and the quantile
+    /// sketches cannot be streamed: the simulation is aborted if the
+    /// UseQuantileSketches attribute is true.
+    /// \param fileName name or path of the output file that will be created
+    /// \param binary true to use the columnar binary format, false to use CSV
+    /// \param idleTimeout the inactivity time after which a flow is completed
+    ///        (zero to only write the flows whose end has been reported)
+    void EnableStreaming(std::string fileName, bool binary, Time idleTimeout);
+
+    /// \returns true if the completed flows are written to a file
+    bool IsStreaming() const;
+
+    /// Write the statistics of all the flows, completed or not, to the
+    /// streaming file and close it
+    void FlushStreaming();
+
   protected:
     void NotifyConstructionCompleted() override;
     void DoDispose() override;
 
   private:
-    /// Structure to represent a single tracked packet data
-    struct TrackedPacket
-    {
-        Time firstSeenTime;      //!< absolute time when the packet was first seen by a probe
-        Time lastSeenTime;       //!< absolute time when the packet was last seen by a probe
-        uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
-    };
-
     /// FlowId --> FlowStats
     FlowStatsContainer m_flowStats;
 
-    /// (FlowId,PacketId) --> TrackedPacket
-    typedef std::map<std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
-    TrackedPacketMap m_trackedPackets; //!< Tracked packets
-    Time m_maxPerHopDelay;             //!< Minimum per-hop delay
-    FlowProbeContainer m_flowProbes;   //!< all the FlowProbes
+    TrackedPacketTable m_trackedPackets; //!< Tracked packets, by (FlowId,PacketId)
+    Time m_maxPerHopDelay;               //!< Minimum per-hop delay
+    FlowProbeContainer m_flowProbes;     //!< all the FlowProbes
 
     // note: this is needed only for serialization
     std::list<Ptr<FlowClassifier>> m_classifiers; //!< the FlowClassifiers
@@ -310,6 +374,38 @@ class FlowMonitor : public Object
     double m_packetSizeBinWidth;        //!< packet size bin width (for histograms)
     double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
     Time m_flowInterruptionsMinTime;    //!< Flow interruptions minimum time
+    uint32_t m_samplingRate;            //!< One packet out of m_samplingRate is tracked
+    bool m_useQuantileSketches;         //!< Record distributions in sketches, not histograms
+    double m_sketchAccuracy;            //!< Relative accuracy of the quantile sketches
+
+    std::unique_ptr<FlowStatsWriter> m_streamWriter; //!< Writer of the completed flows
+    Time m_flowIdleTimeout;                          //!< Inactivity time completing a flow
+    std::vector<FlowId> m_endedFlows;                //!< Flows whose end has been reported
+    std::map<FlowId, uint32_t> m_pendingLosses;      //!< Losses of written flows, not yet written
+
+    /// A FlowId and the time at which the flow is idle unless it had some activity
+    typedef std::pair<Time, FlowId> FlowDeadline;
+    /// The idle deadlines of the flows, earliest first.  When a deadline
+    /// expires, the flow is written if it is idle, or given a new deadline
+    std::priority_queue<FlowDeadline, std::vector<FlowDeadline>, std::greater<>> m_flowDeadlines;
+
+    /// Write the completed flows to the streaming file and forget them
+    void ExportCompletedFlows();
+
+    /// Write a flow to the streaming file and forget it, in the probes and
+    /// in the classifiers as well
+    /// \param flow the flow
+    void ExportFlow(FlowStatsContainerI flow);
+
+    /// Write the packets found lost after their flow was written to the
+    /// streaming file
+    void ExportPendingLosses();
+
+    /// Check whether a packet is tracked
+    /// \param flowId the Flow identification
+    /// \param packetId the Packet identification
+    /// \returns true if the packet is sampled
+    bool IsSampled(FlowId flowId, FlowPacketId packetId) const;
 
     /// Get the stats for a given flow
     /// \param flowId the Flow identification
@@ -21,6 +21,8 @@
 
 #include "flow-monitor.h"
 
+#include "ns3/packet.h"
+
 namespace ns3
 {
 
@@ -61,6 +63,19 @@ FlowProbe::AddPacketStats(FlowId flowId, uint32_t packetSize, Time delayFromFirs
     ++flow.packets;
 }
 
+bool
+FlowProbe::IsTcpFin(Ptr<const Packet> l4Packet)
+{
+    // the flags are carried in the 14th octet of the TCP header
+    uint8_t data[14];
+    if (l4Packet->GetSize() < sizeof(data))
+    {
+        return false;
+    }
+    l4Packet->CopyData(data, sizeof(data));
+    return (data[13] & 0x01) != 0;
+}
+
 void
 FlowProbe::AddPacketDropStats(FlowId flowId, uint32_t packetSize, uint32_t reasonCode)
 {
@@ -81,6 +96,12 @@ FlowProbe::GetStats() const
     return m_stats;
 }
 
+void
+FlowProbe::ForgetFlow(FlowId flowId)
+{
+    m_stats.erase(flowId);
+}
+
 void
 FlowProbe::SerializeToXmlStream(std::ostream& os, uint16_t indent, uint32_t index) const
 {
@@ -32,6 +32,7 @@ namespace ns3
 {
 
 class FlowMonitor;
+class Packet;
 
 /// The FlowProbe class is responsible for listening for packet events
 /// in a specific point of the simulated space, report those events to
@@ -99,6 +100,11 @@ class FlowProbe : public Object
     /// \returns the partial flow statistics
     Stats GetStats() const;
 
+    /// Remove the statistics of a flow, e.g., once FlowMonitor has written
+    /// them to its streaming file
+    /// \param flowId the flow Identifier
+    void ForgetFlow(FlowId flowId);
+
     /// Serializes the results to an std::ostream in XML format
     /// \param os the output stream
     /// \param indent number of spaces to use as base indentation level
@@ -106,6 +112,11 @@ class FlowProbe : public Object
     void SerializeToXmlStream(std::ostream& os, uint16_t indent, uint32_t index) const;
 
   protected:
+    /// Check whether a packet is a TCP segment with the FIN flag set
+    /// \param l4Packet the packet, starting with the TCP header
+    /// \returns true if the FIN flag is set
+    static bool IsTcpFin(Ptr<const Packet> l4Packet);
+
     Ptr<FlowMonitor> m_flowMonitor; //!< the FlowMonitor instance
     Stats m_stats;                  //!< The flow stats
 };
@@ -0,0 +1,537 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "flow-stats-file.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsFile");
+
+namespace
+{
+
+const char MAGIC[8] = {'N', 'S', '3', 'F', 'L', 'O', 'W', 'S'}; //!< magic string of binary files
+const uint32_t VERSION = 1;                                      //!< version of the binary format
+
+/// Header line of CSV files
+const char CSV_HEADER[] =
+    "flowId,timeFirstTxPacket,timeFirstRxPacket,timeLastTxPacket,timeLastRxPacket,delaySum,"
+    "jitterSum,lastDelay,txBytes,rxBytes,txPackets,rxPackets,rxSampledPackets,lostPackets,"
+    "timesForwarded,packetsDropped,bytesDropped";
+
+/**
+ * \brief Apply a function to each column of a block that has one element per record
+ * \param c the columns
+ * \param f the function
+ */
+template <typename C, typename F>
+void
+ForEachRecordColumn(C& c, F f)
+{
+    f(c.flowId);
+    f(c.timeFirstTxPacket);
+    f(c.timeFirstRxPacket);
+    f(c.timeLastTxPacket);
+    f(c.timeLastRxPacket);
+    f(c.delaySum);
+    f(c.jitterSum);
+    f(c.lastDelay);
+    f(c.txBytes);
+    f(c.rxBytes);
+    f(c.txPackets);
+    f(c.rxPackets);
+    f(c.rxSampledPackets);
+    f(c.lostPackets);
+    f(c.timesForwarded);
+    f(c.nDropReasons);
+}
+
+/**
+ * \brief Write a column in little endian order
+ * \param os the output stream
+ * \param column the column
+ */
+template <typename T>
+void
+WriteColumn(std::ostream& os, const std::vector<T>& column)
+{
+    std::vector<char> buf(column.size() * sizeof(T));
+    for (std::size_t i = 0; i < column.size(); i++)
+    {
+        auto value = static_cast<uint64_t>(column[i]);
+        for (std::size_t b = 0; b < sizeof(T); b++)
+        {
+            buf[i * sizeof(T) + b] = static_cast<char>((value >> (8 * b)) & 0xff);
+        }
+    }
+    os.write(buf.data(), buf.size());
+}
+
+/**
+ * \brief Read a column stored in little endian order
+ * \param is the input stream
+ * \param column the column
+ * \param n the number of elements
+ * \return false if the stream ended
+ */
+template <typename T>
+bool
+ReadColumn(std::istream& is, std::vector<T>& column, std::size_t n)
+{
+    std::vector<unsigned char> buf(n * sizeof(T));
+    if (!is.read(reinterpret_cast<char*>(buf.data()), buf.size()))
+    {
+        return false;
+    }
+    column.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        uint64_t value = 0;
+        for (std::size_t b = 0; b < sizeof(T); b++)
+        {
+            value |= static_cast<uint64_t>(buf[i * sizeof(T) + b]) << (8 * b);
+        }
+        column[i] = static_cast<T>(value);
+    }
+    return true;
+}
+
+/**
+ * \brief Write a list of counters separated by semicolons
+ * \param os the output stream
+ * \param values the counters
+ */
+template <typename T>
+void
+WriteList(std::ostream& os, const std::vector<T>& values)
+{
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        os << (i > 0 ? ";" : "") << values[i];
+    }
+}
+
+/**
+ * \brief Parse a list of counters separated by semicolons
+ * \param field the list
+ * \param values the counters
+ */
+template <typename T>
+void
+ParseList(const std::string& field, std::vector<T>& values)
+{
+    values.clear();
+    std::istringstream is(field);
+    std::string value;
+    while (std::getline(is, value, ';'))
+    {
+        values.push_back(static_cast<T>(std::stoull(value)));
+    }
+}
+
+/**
+ * \brief Merge the statistics of two records of the same flow
+ * \param stats the statistics of the first record, updated
+ * \param other the statistics of the second record
+ */
+void
+MergeStats(FlowMonitor::FlowStats& stats, const FlowMonitor::FlowStats& other)
+{
+    if (other.txPackets > 0)
+    {
+        stats.timeFirstTxPacket = stats.txPackets > 0
+                                      ? std::min(stats.timeFirstTxPacket, other.timeFirstTxPacket)
+                                      : other.timeFirstTxPacket;
+        stats.timeLastTxPacket = std::max(stats.timeLastTxPacket, other.timeLastTxPacket);
+    }
+    if (other.rxPackets > 0)
+    {
+        stats.timeFirstRxPacket = stats.rxPackets > 0
+                                      ? std::min(stats.timeFirstRxPacket, other.timeFirstRxPacket)
+                                      : other.timeFirstRxPacket;
+        stats.timeLastRxPacket = std::max(stats.timeLastRxPacket, other.timeLastRxPacket);
+    }
+    if (other.rxSampledPackets > 0)
+    {
+        stats.lastDelay = other.lastDelay;
+    }
+    stats.delaySum += other.delaySum;
+    stats.jitterSum += other.jitterSum;
+    stats.txBytes += other.txBytes;
+    stats.rxBytes += other.rxBytes;
+    stats.txPackets += other.txPackets;
+    stats.rxPackets += other.rxPackets;
+    stats.rxSampledPackets += other.rxSampledPackets;
+    stats.lostPackets += other.lostPackets;
+    stats.timesForwarded += other.timesForwarded;
+    if (stats.packetsDropped.size() < other.packetsDropped.size())
+    {
+        stats.packetsDropped.resize(other.packetsDropped.size(), 0);
+        stats.bytesDropped.resize(other.packetsDropped.size(), 0);
+    }
+    for (std::size_t i = 0; i < other.packetsDropped.size(); i++)
+    {
+        stats.packetsDropped[i] += other.packetsDropped[i];
+        stats.bytesDropped[i] += other.bytesDropped[i];
+    }
+}
+
+} // namespace
+
+void
+FlowStatsColumns::Append(FlowId id, const FlowMonitor::FlowStats& stats)
+{
+    flowId.push_back(id);
+    timeFirstTxPacket.push_back(stats.timeFirstTxPacket.GetNanoSeconds());
+    timeFirstRxPacket.push_back(stats.timeFirstRxPacket.GetNanoSeconds());
+    timeLastTxPacket.push_back(stats.timeLastTxPacket.GetNanoSeconds());
+    timeLastRxPacket.push_back(stats.timeLastRxPacket.GetNanoSeconds());
+    delaySum.push_back(stats.delaySum.GetNanoSeconds());
+    jitterSum.push_back(stats.jitterSum.GetNanoSeconds());
+    lastDelay.push_back(stats.lastDelay.GetNanoSeconds());
+    txBytes.push_back(stats.txBytes);
+    rxBytes.push_back(stats.rxBytes);
+    txPackets.push_back(stats.txPackets);
+    rxPackets.push_back(stats.rxPackets);
+    rxSampledPackets.push_back(stats.rxSampledPackets);
+    lostPackets.push_back(stats.lostPackets);
+    timesForwarded.push_back(stats.timesForwarded);
+    nDropReasons.push_back(stats.packetsDropped.size());
+    packetsDropped.insert(packetsDropped.end(),
+                          stats.packetsDropped.begin(),
+                          stats.packetsDropped.end());
+    bytesDropped.insert(bytesDropped.end(), stats.bytesDropped.begin(), stats.bytesDropped.end());
+}
+
+void
+FlowStatsColumns::Get(std::size_t index,
+                      std::size_t& dropOffset,
+                      FlowId& id,
+                      FlowMonitor::FlowStats& stats) const
+{
+    id = flowId[index];
+    stats.timeFirstTxPacket = NanoSeconds(timeFirstTxPacket[index]);
+    stats.timeFirstRxPacket = NanoSeconds(timeFirstRxPacket[index]);
+    stats.timeLastTxPacket = NanoSeconds(timeLastTxPacket[index]);
+    stats.timeLastRxPacket = NanoSeconds(timeLastRxPacket[index]);
+    stats.delaySum = NanoSeconds(delaySum[index]);
+    stats.jitterSum = NanoSeconds(jitterSum[index]);
+    stats.lastDelay = NanoSeconds(lastDelay[index]);
+    stats.txBytes = txBytes[index];
+    stats.rxBytes = rxBytes[index];
+    stats.txPackets = txPackets[index];
+    stats.rxPackets = rxPackets[index];
+    stats.rxSampledPackets = rxSampledPackets[index];
+    stats.lostPackets = lostPackets[index];
+    stats.timesForwarded = timesForwarded[index];
+    std::size_t n = nDropReasons[index];
+    stats.packetsDropped.assign(packetsDropped.begin() + dropOffset,
+                                packetsDropped.begin() + dropOffset + n);
+    stats.bytesDropped.assign(bytesDropped.begin() + dropOffset,
+                              bytesDropped.begin() + dropOffset + n);
+    dropOffset += n;
+}
+
+std::size_t
+FlowStatsColumns::GetSize() const
+{
+    return flowId.size();
+}
+
+void
+FlowStatsColumns::Clear()
+{
+    ForEachRecordColumn(*this, [](auto& column) { column.clear(); });
+    packetsDropped.clear();
+    bytesDropped.clear();
+}
+
+FlowStatsWriter::FlowStatsWriter(const std::string& fileName, Format format)
+    : m_os(fileName, std::ios::out | std::ios::binary | std::ios::trunc),
+      m_format(format),
+      m_nRecords(0)
+{
+    NS_LOG_FUNCTION(this << fileName << format);
+    NS_ABORT_MSG_UNLESS(m_os.is_open(), "Cannot open file " << fileName);
+    if (m_format == CSV)
+    {
+        m_os << CSV_HEADER << "\n";
+    }
+    else
+    {
+        m_os.write(MAGIC, sizeof(MAGIC));
+        WriteColumn(m_os, std::vector<uint32_t>{VERSION});
+    }
+}
+
+FlowStatsWriter::~FlowStatsWriter()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+void
+FlowStatsWriter::Write(FlowId flowId, const FlowMonitor::FlowStats& stats)
+{
+    NS_LOG_FUNCTION(this << flowId);
+    NS_ASSERT_MSG(m_os.is_open(), "The file has been closed");
+    m_nRecords++;
+    if (m_format == BINARY)
+    {
+        m_block.Append(flowId, stats);
+        if (m_block.GetSize() >= BLOCK_SIZE)
+        {
+            Flush();
+        }
+        return;
+    }
+
+    m_os << flowId << "," << stats.timeFirstTxPacket.GetNanoSeconds() << ","
+         << stats.timeFirstRxPacket.GetNanoSeconds() << ","
+         << stats.timeLastTxPacket.GetNanoSeconds() << ","
+         << stats.timeLastRxPacket.GetNanoSeconds() << "," << stats.delaySum.GetNanoSeconds()
+         << "," << stats.jitterSum.GetNanoSeconds() << "," << stats.lastDelay.GetNanoSeconds()
+         << "," << stats.txBytes << "," << stats.rxBytes << "," << stats.txPackets << ","
+         << stats.rxPackets << "," << stats.rxSampledPackets << "," << stats.lostPackets << ","
+         << stats.timesForwarded << ",";
+    WriteList(m_os, stats.packetsDropped);
+    m_os << ",";
+    WriteList(m_os, stats.bytesDropped);
+    m_os << "\n";
+}
+
+void
+FlowStatsWriter::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_os.is_open())
+    {
+        return;
+    }
+    if (m_format == BINARY && m_block.GetSize() > 0)
+    {
+        WriteColumn(m_os, std::vector<uint32_t>{static_cast<uint32_t>(m_block.GetSize())});
+        ForEachRecordColumn(m_block, [this](const auto& column) { WriteColumn(m_os, column); });
+        WriteColumn(m_os, m_block.packetsDropped);
+        WriteColumn(m_os, m_block.bytesDropped);
+        m_block.Clear();
+    }
+    m_os.flush();
+}
+
+void
+FlowStatsWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_os.is_open())
+    {
+        Flush();
+        m_os.close();
+    }
+}
+
+uint64_t
+FlowStatsWriter::GetNRecords() const
+{
+    return m_nRecords;
+}
+
+FlowStatsReader::FlowStatsReader(const std::string& fileName)
+    : m_is(fileName, std::ios::in | std::ios::binary),
+      m_open(false),
+      m_format(FlowStatsWriter::CSV),
+      m_next(0),
+      m_dropOffset(0)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    char magic[sizeof(MAGIC)];
+    if (!m_is.read(magic, sizeof(magic)))
+    {
+        NS_LOG_WARN("Cannot read file " << fileName);
+        return;
+    }
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0)
+    {
+        std::vector<uint32_t> version;
+        if (!ReadColumn(m_is, version, 1) || version[0] != VERSION)
+        {
+            NS_LOG_WARN("Unsupported version of file " << fileName);
+            return;
+        }
+        m_format = FlowStatsWriter::BINARY;
+        m_open = true;
+        return;
+    }
+
+    m_is.seekg(0);
+    std::string header;
+    if (std::getline(m_is, header) && header == CSV_HEADER)
+    {
+        m_format = FlowStatsWriter::CSV;
+        m_open = true;
+        return;
+    }
+    NS_LOG_WARN("Unknown format of file " << fileName);
+}
+
+bool
+FlowStatsReader::IsOpen() const
+{
+    return m_open;
+}
+
+FlowStatsWriter::Format
+FlowStatsReader::GetFormat() const
+{
+    return m_format;
+}
+
+bool
+FlowStatsReader::ReadBlock()
+{
+    std::vector<uint32_t> size;
+    if (!ReadColumn(m_is, size, 1))
+    {
+        return false;
+    }
+    bool ok = true;
+    ForEachRecordColumn(m_block, [this, &ok, &size](auto& column) {
+        ok = ok && ReadColumn(m_is, column, size[0]);
+    });
+    if (!ok)
+    {
+        NS_LOG_WARN("Truncated block");
+        return false;
+    }
+    std::size_t nDrops = 0;
+    for (auto n : m_block.nDropReasons)
+    {
+        nDrops += n;
+    }
+    if (!ReadColumn(m_is, m_block.packetsDropped, nDrops) ||
+        !ReadColumn(m_is, m_block.bytesDropped, nDrops))
+    {
+        NS_LOG_WARN("Truncated block");
+        return false;
+    }
+    m_next = 0;
+    m_dropOffset = 0;
+    return true;
+}
+
+bool
+FlowStatsReader::ReadLine(FlowId& flowId, FlowMonitor::FlowStats& stats)
+{
+    std::string line;
+    while (std::getline(m_is, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream is(line);
+        std::string field;
+        while (std::getline(is, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (line.back() == ',')
+        {
+            fields.emplace_back();
+        }
+        if (fields.size() != 17)
+        {
+            NS_LOG_WARN("Malformed line: " << line);
+            return false;
+        }
+        // a truncated line, e.g., the last line of a file being written,
+        // is not a valid record
+        try
+        {
+            flowId = std::stoul(fields[0]);
+            stats.timeFirstTxPacket = NanoSeconds(std::stoll(fields[1]));
+            stats.timeFirstRxPacket = NanoSeconds(std::stoll(fields[2]));
+            stats.timeLastTxPacket = NanoSeconds(std::stoll(fields[3]));
+            stats.timeLastRxPacket = NanoSeconds(std::stoll(fields[4]));
+            stats.delaySum = NanoSeconds(std::stoll(fields[5]));
+            stats.jitterSum = NanoSeconds(std::stoll(fields[6]));
+            stats.lastDelay = NanoSeconds(std::stoll(fields[7]));
+            stats.txBytes = std::stoull(fields[8]);
+            stats.rxBytes = std::stoull(fields[9]);
+            stats.txPackets = std::stoul(fields[10]);
+            stats.rxPackets = std::stoul(fields[11]);
+            stats.rxSampledPackets = std::stoul(fields[12]);
+            stats.lostPackets = std::stoul(fields[13]);
+            stats.timesForwarded = std::stoul(fields[14]);
+            ParseList(fields[15], stats.packetsDropped);
+            ParseList(fields[16], stats.bytesDropped);
+        }
+        catch (const std::logic_error&)
+        {
+            NS_LOG_WARN("Malformed line: " << line);
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool
+FlowStatsReader::Read(FlowId& flowId, FlowMonitor::FlowStats& stats)
+{
+    if (!m_open)
+    {
+        return false;
+    }
+    if (m_format == FlowStatsWriter::CSV)
+    {
+        return ReadLine(flowId, stats);
+    }
+    if (m_next >= m_block.GetSize() && !ReadBlock())
+    {
+        return false;
+    }
+    m_block.Get(m_next++, m_dropOffset, flowId, stats);
+    return true;
+}
+
+FlowMonitor::FlowStatsContainer
+FlowStatsReader::ReadAll()
+{
+    FlowMonitor::FlowStatsContainer flows;
+    FlowId flowId;
+    FlowMonitor::FlowStats stats;
+    while (Read(flowId, stats))
+    {
+        auto [it, inserted] = flows.emplace(flowId, stats);
+        if (!inserted)
+        {
+            MergeStats(it->second, stats);
+        }
+    }
+    return flows;
+}
+
+} // namespace ns3
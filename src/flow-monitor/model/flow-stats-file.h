@@ -0,0 +1,219 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef FLOW_STATS_FILE_H
+#define FLOW_STATS_FILE_H
+
+#include "flow-monitor.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup flow-monitor
+ * \brief Columns of a block of flow records
+ *
+ * The scalar fields of FlowMonitor::FlowStats, one vector per field. The
+ * histograms and sketches are not exported.
+ */
+struct FlowStatsColumns
+{
+    std::vector<uint32_t> flowId;           //!< flow identifiers
+    std::vector<int64_t> timeFirstTxPacket; //!< times of the first tx (ns)
+    std::vector<int64_t> timeFirstRxPacket; //!< times of the first rx (ns)
+    std::vector<int64_t> timeLastTxPacket;  //!< times of the last tx (ns)
+    std::vector<int64_t> timeLastRxPacket;  //!< times of the last rx (ns)
+    std::vector<int64_t> delaySum;          //!< sums of the delays (ns)
+    std::vector<int64_t> jitterSum;         //!< sums of the jitters (ns)
+    std::vector<int64_t> lastDelay;         //!< last delays (ns)
+    std::vector<uint64_t> txBytes;          //!< transmitted bytes
+    std::vector<uint64_t> rxBytes;          //!< received bytes
+    std::vector<uint32_t> txPackets;        //!< transmitted packets
+    std::vector<uint32_t> rxPackets;        //!< received packets
+    std::vector<uint32_t> rxSampledPackets; //!< received packets whose delay was measured
+    std::vector<uint32_t> lostPackets;      //!< lost packets
+    std::vector<uint32_t> timesForwarded;   //!< forwarding counts
+    std::vector<uint32_t> nDropReasons;     //!< number of drop reason codes of each flow
+    std::vector<uint32_t> packetsDropped;   //!< dropped packets, by flow and reason code
+    std::vector<uint64_t> bytesDropped;     //!< dropped bytes, by flow and reason code
+
+    /**
+     * \brief Append a flow record
+     * \param flowId the flow identifier
+     * \param stats the flow statistics
+     */
+    void Append(FlowId flowId, const FlowMonitor::FlowStats& stats);
+
+    /**
+     * \brief Get a flow record
+     * \param index the index of the record
+     * \param dropOffset the index of the first drop counter of the record,
+     *        updated to that of the next record
+     * \param flowId the flow identifier
+     * \param stats the flow statistics
+     */
+    void Get(std::size_t index,
+             std::size_t& dropOffset,
+             FlowId& flowId,
+             FlowMonitor::FlowStats& stats) const;
+
+    /// \return the number of flow records
+    std::size_t GetSize() const;
+
+    /// Remove all the records
+    void Clear();
+};
+
+/**
+ * \ingroup flow-monitor
+ * \brief Writes the statistics of completed flows to a file, one flow at a time
+ *
+ * Two formats are supported:
+ * - CSV: a header line followed by one line per flow. Times are in
+ *   nanoseconds. The per-reason drop counters are written as lists of
+ *   numbers separated by semicolons.
+ * - BINARY: a columnar format. After an 8-byte magic string and a 32-bit
+ *   version, the records are written in blocks: a 32-bit number of records
+ *   followed by each column of FlowStatsColumns stored contiguously, all
+ *   integers being little endian. The drop counter columns hold the sum of
+ *   nDropReasons elements.
+ *
+ * Records are buffered in memory until a block is full (BINARY) or the
+ * stream buffer is flushed (CSV), hence the memory used by the writer does
+ * not depend on the number of flows written. Use FlowStatsReader to load
+ * the records back.
+ */
+class FlowStatsWriter
+{
+  public:
+    /// File format
+    enum Format
+    {
+        CSV,
+        BINARY
+    };
+
+    static constexpr uint32_t BLOCK_SIZE = 4096; //!< maximum number of records of a block
+
+    /**
+     * \brief Open the file (the file is truncated)
+     * \param fileName the name of the file
+     * \param format the format
+     */
+    FlowStatsWriter(const std::string& fileName, Format format);
+    ~FlowStatsWriter();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    FlowStatsWriter(const FlowStatsWriter&) = delete;
+    FlowStatsWriter& operator=(const FlowStatsWriter&) = delete;
+
+    /**
+     * \brief Write the statistics of a flow
+     * \param flowId the flow identifier
+     * \param stats the flow statistics
+     */
+    void Write(FlowId flowId, const FlowMonitor::FlowStats& stats);
+
+    /// \brief Write the buffered records to the file
+    void Flush();
+
+    /// \brief Write the buffered records and close the file
+    void Close();
+
+    /// \return the number of records written so far
+    uint64_t GetNRecords() const;
+
+  private:
+    std::ofstream m_os;       //!< the output file
+    Format m_format;          //!< the format
+    FlowStatsColumns m_block; //!< the buffered records (BINARY)
+    uint64_t m_nRecords;      //!< number of records written
+};
+
+/**
+ * \ingroup flow-monitor
+ * \brief Reads the flow records written by a FlowStatsWriter
+ *
+ * The format of the file is detected when it is opened.
+ */
+class FlowStatsReader
+{
+  public:
+    /**
+     * \brief Open the file
+     * \param fileName the name of the file
+     */
+    FlowStatsReader(const std::string& fileName);
+
+    /**
+     * \return true if the file was opened and its format recognized
+     */
+    bool IsOpen() const;
+
+    /**
+     * \return the format of the file
+     */
+    FlowStatsWriter::Format GetFormat() const;
+
+    /**
+     * \brief Read the next flow record
+     * \param flowId the flow identifier
+     * \param stats the flow statistics
+     * \return false if there are no more records (or the file is corrupted)
+     */
+    bool Read(FlowId& flowId, FlowMonitor::FlowStats& stats);
+
+    /**
+     * \brief Read all the remaining flow records
+     *
+     * If a flow has several records (i.e., packets of the flow were reported
+     * after the flow had been written), the records are merged: counters and
+     * sums are added, and the first and last times are the earliest and the
+     * latest ones.
+     *
+     * \return the flow statistics, by flow identifier
+     */
+    FlowMonitor::FlowStatsContainer ReadAll();
+
+  private:
+    /**
+     * \brief Load the next block of a binary file
+     * \return false if there are no more blocks
+     */
+    bool ReadBlock();
+
+    /**
+     * \brief Parse the next line of a CSV file
+     * \param flowId the flow identifier
+     * \param stats the flow statistics
+     * \return false if there are no more lines or the line is malformed
+     */
+    bool ReadLine(FlowId& flowId, FlowMonitor::FlowStats& stats);
+
+    std::ifstream m_is;               //!< the input file
+    bool m_open;                      //!< whether the file is open and recognized
+    FlowStatsWriter::Format m_format; //!< the format
+    FlowStatsColumns m_block;         //!< the current block (BINARY)
+    std::size_t m_next;               //!< index of the next record of the block
+    std::size_t m_dropOffset;         //!< index of the drop counters of the next record
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_FILE_H */
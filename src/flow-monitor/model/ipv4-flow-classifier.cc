@@ -152,6 +152,7 @@ Ipv4FlowClassifier::Classify(const Ipv4Header& ipHeader,
     {
         FlowId newFlowId = GetNewFlowId();
         insert.first->second = newFlowId;
+        m_flowTuples[newFlowId] = tuple;
         m_flowPktIdMap[newFlowId] = 0;
         m_flowDscpMap[newFlowId];
     }
@@ -180,16 +181,26 @@ Ipv4FlowClassifier::Classify(const Ipv4Header& ipHeader,
 Ipv4FlowClassifier::FiveTuple
 Ipv4FlowClassifier::FindFlow(FlowId flowId) const
 {
-    for (auto iter = m_flowMap.begin(); iter != m_flowMap.end(); iter++)
+    auto flow = m_flowTuples.find(flowId);
+    if (flow == m_flowTuples.end())
     {
-        if (iter->second == flowId)
-        {
-            return iter->first;
-        }
+        NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
+    }
+    return flow->second;
+}
+
+void
+Ipv4FlowClassifier::ForgetFlow(FlowId flowId)
+{
+    auto flow = m_flowTuples.find(flowId);
+    if (flow == m_flowTuples.end())
+    {
+        return;
     }
-    NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
-    FiveTuple retval = {Ipv4Address::GetZero(), Ipv4Address::GetZero(), 0, 0, 0};
-    return retval;
+    m_flowMap.erase(flow->second);
+    m_flowTuples.erase(flow);
+    m_flowPktIdMap.erase(flowId);
+    m_flowDscpMap.erase(flowId);
 }
 
 bool
@@ -92,9 +92,13 @@ class Ipv4FlowClassifier : public FlowClassifier
 
     void SerializeToXmlStream(std::ostream& os, uint16_t indent) const override;
 
+    void ForgetFlow(FlowId flowId) override;
+
   private:
     /// Map to Flows Identifiers to FlowIds
     std::map<FiveTuple, FlowId> m_flowMap;
+    /// Map FlowIds to their Flows Identifiers, to forget the flows
+    std::map<FlowId, FiveTuple> m_flowTuples;
     /// Map to FlowIds to FlowPacketId
     std::map<FlowId, FlowPacketId> m_flowPktIdMap;
     /// Map FlowIds to (DSCP value, packet count) pairs
@@ -414,6 +414,12 @@ Ipv4FlowProbe::ForwardUpLogger(const Ipv4Header& ipHeader,
         NS_LOG_DEBUG("ReportLastRx (" << this << ", " << flowId << ", " << packetId << ", " << size
                                       << "); " << ipHeader << *ipPayload);
         m_flowMonitor->ReportLastRx(this, flowId, packetId, size);
+
+        // a FIN segment completes the flow (for the streaming export)
+        if (m_flowMonitor->IsStreaming() && ipHeader.GetProtocol() == 6 && IsTcpFin(ipPayload))
+        {
+            m_flowMonitor->ReportFlowEnd(this, flowId);
+        }
     }
 }
 
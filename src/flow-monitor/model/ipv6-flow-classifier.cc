@@ -153,6 +153,7 @@ Ipv6FlowClassifier::Classify(const Ipv6Header& ipHeader,
     {
         FlowId newFlowId = GetNewFlowId();
         insert.first->second = newFlowId;
+        m_flowTuples[newFlowId] = tuple;
         m_flowPktIdMap[newFlowId] = 0;
         m_flowDscpMap[newFlowId];
     }
@@ -181,16 +182,26 @@ Ipv6FlowClassifier::Classify(const Ipv6Header& ipHeader,
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow(FlowId flowId) const
 {
-    for (auto iter = m_flowMap.begin(); iter != m_flowMap.end(); iter++)
+    auto flow = m_flowTuples.find(flowId);
+    if (flow == m_flowTuples.end())
     {
-        if (iter->second == flowId)
-        {
-            return iter->first;
-        }
+        NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
+    }
+    return flow->second;
+}
+
+void
+Ipv6FlowClassifier::ForgetFlow(FlowId flowId)
+{
+    auto flow = m_flowTuples.find(flowId);
+    if (flow == m_flowTuples.end())
+    {
+        return;
     }
-    NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
-    FiveTuple retval = {Ipv6Address::GetZero(), Ipv6Address::GetZero(), 0, 0, 0};
-    return retval;
+    m_flowMap.erase(flow->second);
+    m_flowTuples.erase(flow);
+    m_flowPktIdMap.erase(flowId);
+    m_flowDscpMap.erase(flowId);
 }
 
 bool
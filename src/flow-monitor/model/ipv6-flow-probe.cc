@@ -336,6 +336,12 @@ Ipv6FlowProbe::ForwardUpLogger(const Ipv6Header& ipHeader,
         NS_LOG_DEBUG("ReportLastRx (" << this << ", " << flowId << ", " << packetId << ", " << size
                                       << ");");
         m_flowMonitor->ReportLastRx(this, flowId, packetId, size);
+
+        // a FIN segment completes the flow (for the streaming export)
+        if (m_flowMonitor->IsStreaming() && ipHeader.GetNextHeader() == 6 && IsTcpFin(ipPayload))
+        {
+            m_flowMonitor->ReportFlowEnd(this, flowId);
+        }
     }
 }
 
@@ -0,0 +1,230 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "tracked-packet-table.h"
+
+#include "ns3/assert.h"
+#include "ns3/flow-hash.h"
+
+namespace ns3
+{
+
+TrackedPacketTable::TrackedPacketTable()
+    : m_slots(MIN_CAPACITY, Slot{0, NONE}),
+      m_free(NONE),
+      m_oldest(NONE),
+      m_newest(NONE),
+      m_size(0)
+{
+}
+
+uint32_t
+TrackedPacketTable::Hash(FlowId flowId, FlowPacketId packetId)
+{
+    uint32_t key[2] = {flowId, packetId};
+    return FlowHash<2>(key, 0);
+}
+
+TrackedPacketTable::Entry*
+TrackedPacketTable::Find(FlowId flowId, FlowPacketId packetId)
+{
+    uint32_t hash = Hash(flowId, packetId);
+    std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = hash & mask; m_slots[i].entry != NONE; i = (i + 1) & mask)
+    {
+        if (m_slots[i].hash == hash)
+        {
+            Entry& entry = m_entries[m_slots[i].entry];
+            if (entry.flowId == flowId && entry.packetId == packetId)
+            {
+                return &entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+TrackedPacketTable::Entry*
+TrackedPacketTable::Insert(FlowId flowId, FlowPacketId packetId, Time now)
+{
+    Entry* entry = Find(flowId, packetId);
+    if (entry == nullptr)
+    {
+        // keep the load factor below 1/2
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            Rehash(2 * m_slots.size());
+        }
+
+        uint32_t index;
+        if (m_free != NONE)
+        {
+            index = m_free;
+            m_free = m_entries[index].prev;
+        }
+        else
+        {
+            index = m_entries.size();
+            m_entries.emplace_back();
+        }
+
+        uint32_t hash = Hash(flowId, packetId);
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = hash & mask;
+        while (m_slots[i].entry != NONE)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = Slot{hash, index};
+        m_size++;
+
+        entry = &m_entries[index];
+        entry->flowId = flowId;
+        entry->packetId = packetId;
+    }
+    else
+    {
+        Unlink(entry - m_entries.data());
+    }
+
+    entry->firstSeenTime = now;
+    entry->lastSeenTime = now;
+    entry->timesForwarded = 0;
+    Link(entry - m_entries.data());
+    return entry;
+}
+
+void
+TrackedPacketTable::Touch(Entry* entry, Time now)
+{
+    uint32_t index = entry - m_entries.data();
+    NS_ASSERT(m_newest == NONE || m_entries[m_newest].lastSeenTime <= now);
+    entry->lastSeenTime = now;
+    if (index != m_newest)
+    {
+        Unlink(index);
+        Link(index);
+    }
+}
+
+void
+TrackedPacketTable::Erase(Entry* entry)
+{
+    uint32_t index = entry - m_entries.data();
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t i = Hash(entry->flowId, entry->packetId) & mask;
+    while (m_slots[i].entry != index)
+    {
+        NS_ASSERT(m_slots[i].entry != NONE);
+        i = (i + 1) & mask;
+    }
+
+    // backward-shift deletion: move back the entries of the probe sequence
+    // that would not be found anymore once the slot is emptied
+    for (std::size_t j = (i + 1) & mask; m_slots[j].entry != NONE; j = (j + 1) & mask)
+    {
+        std::size_t home = m_slots[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+    m_slots[i].entry = NONE;
+    m_size--;
+
+    Unlink(index);
+    entry->prev = m_free;
+    m_free = index;
+}
+
+std::size_t
+TrackedPacketTable::GetSize() const
+{
+    return m_size;
+}
+
+void
+TrackedPacketTable::Clear()
+{
+    m_slots.assign(MIN_CAPACITY, Slot{0, NONE});
+    m_entries.clear();
+    m_free = NONE;
+    m_oldest = NONE;
+    m_newest = NONE;
+    m_size = 0;
+}
+
+void
+TrackedPacketTable::Link(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    entry.prev = m_newest;
+    entry.next = NONE;
+    if (m_newest != NONE)
+    {
+        m_entries[m_newest].next = index;
+    }
+    else
+    {
+        m_oldest = index;
+    }
+    m_newest = index;
+}
+
+void
+TrackedPacketTable::Unlink(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.prev != NONE)
+    {
+        m_entries[entry.prev].next = entry.next;
+    }
+    else
+    {
+        m_oldest = entry.next;
+    }
+    if (entry.next != NONE)
+    {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    else
+    {
+        m_newest = entry.prev;
+    }
+}
+
+void
+TrackedPacketTable::Rehash(std::size_t capacity)
+{
+    std::vector<Slot> old(capacity, Slot{0, NONE});
+    old.swap(m_slots);
+    std::size_t mask = m_slots.size() - 1;
+    for (const Slot& slot : old)
+    {
+        if (slot.entry == NONE)
+        {
+            continue;
+        }
+        std::size_t i = slot.hash & mask;
+        while (m_slots[i].entry != NONE)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = slot;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,170 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef TRACKED_PACKET_TABLE_H
+#define TRACKED_PACKET_TABLE_H
+
+#include "flow-classifier.h"
+
+#include "ns3/nstime.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup flow-monitor
+ *
+ * \brief The packets in flight tracked by a FlowMonitor
+ *
+ * Packets are indexed by (FlowId, FlowPacketId) in an open-addressing hash
+ * table (linear probing, backward-shift deletion), whose slots refer to
+ * entries stored in a single array and recycled through a free list.
+ *
+ * The entries are also linked in order of last seen time. A packet is always
+ * seen "now", hence touching an entry simply moves it to the newest end of
+ * the list: this is a timing wheel whose buckets are as fine as the
+ * simulation clock. Expiring the packets not seen for a given time visits
+ * the expired entries only, from the oldest end of the list.
+ */
+class TrackedPacketTable
+{
+  public:
+    /// A tracked packet
+    struct Entry
+    {
+        FlowId flowId;           //!< flow identifier
+        FlowPacketId packetId;   //!< packet identifier
+        Time firstSeenTime;      //!< absolute time when the packet was first seen by a probe
+        Time lastSeenTime;       //!< absolute time when the packet was last seen by a probe
+        uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
+        uint32_t prev;           //!< previous (older) entry, or next free entry
+        uint32_t next;           //!< next (newer) entry
+    };
+
+    TrackedPacketTable();
+
+    /**
+     * \brief Find a tracked packet
+     * \param flowId the flow identifier
+     * \param packetId the packet identifier
+     * \return the entry of the packet, or nullptr if the packet is not tracked
+     */
+    Entry* Find(FlowId flowId, FlowPacketId packetId);
+
+    /**
+     * \brief Start tracking a packet
+     *
+     * If the packet is already tracked, its entry is reset. The pointers to
+     * the entries previously returned are invalidated.
+     *
+     * \param flowId the flow identifier
+     * \param packetId the packet identifier
+     * \param now the current time
+     * \return the entry of the packet
+     */
+    Entry* Insert(FlowId flowId, FlowPacketId packetId, Time now);
+
+    /**
+     * \brief Record that a tracked packet has been seen
+     * \param entry the entry of the packet
+     * \param now the current time (not less than the last seen time of any entry)
+     */
+    void Touch(Entry* entry, Time now);
+
+    /**
+     * \brief Stop tracking a packet
+     * \param entry the entry of the packet
+     */
+    void Erase(Entry* entry);
+
+    /**
+     * \brief Stop tracking the packets not seen since the given time
+     * \param deadline the time
+     * \param expired the function called with the flow identifier of every
+     *        packet whose last seen time is not later than the deadline
+     */
+    template <typename F>
+    void Expire(Time deadline, F expired);
+
+    /**
+     * \return the number of tracked packets
+     */
+    std::size_t GetSize() const;
+
+    /// \brief Stop tracking all the packets
+    void Clear();
+
+  private:
+    /// A slot of the hash table
+    struct Slot
+    {
+        uint32_t hash;  //!< hash of the key of the entry
+        uint32_t entry; //!< index of the entry, or NONE
+    };
+
+    static constexpr uint32_t NONE = 0xffffffff;      //!< invalid entry index
+    static constexpr std::size_t MIN_CAPACITY = 1024; //!< initial number of slots (a power of 2)
+
+    /**
+     * \param flowId the flow identifier
+     * \param packetId the packet identifier
+     * \return the hash of the key
+     */
+    static uint32_t Hash(FlowId flowId, FlowPacketId packetId);
+
+    /**
+     * \brief Append an entry to the newest end of the list
+     * \param index the index of an entry
+     */
+    void Link(uint32_t index);
+
+    /**
+     * \brief Remove an entry from the list
+     * \param index the index of an entry
+     */
+    void Unlink(uint32_t index);
+
+    /**
+     * \brief Rebuild the hash table
+     * \param capacity the new number of slots (a power of 2)
+     */
+    void Rehash(std::size_t capacity);
+
+    std::vector<Slot> m_slots;    //!< the hash table
+    std::vector<Entry> m_entries; //!< the entries
+    uint32_t m_free;              //!< first free entry
+    uint32_t m_oldest;            //!< entry with the oldest last seen time
+    uint32_t m_newest;            //!< entry with the newest last seen time
+    std::size_t m_size;           //!< number of tracked packets
+};
+
+template <typename F>
+void
+TrackedPacketTable::Expire(Time deadline, F expired)
+{
+    while (m_oldest != NONE && m_entries[m_oldest].lastSeenTime <= deadline)
+    {
+        Entry* entry = &m_entries[m_oldest];
+        expired(entry->flowId);
+        Erase(entry);
+    }
+}
+
+} // namespace ns3
+
+#endif /* TRACKED_PACKET_TABLE_H */
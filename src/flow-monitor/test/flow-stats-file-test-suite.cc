@@ -0,0 +1,297 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/flow-stats-file.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \param i the index of a flow
+ * \return statistics whose fields all depend on the index
+ */
+static FlowMonitor::FlowStats
+MakeStats(uint32_t i)
+{
+    FlowMonitor::FlowStats stats{};
+    stats.timeFirstTxPacket = NanoSeconds(1000 + i);
+    stats.timeFirstRxPacket = NanoSeconds(2000 + i);
+    stats.timeLastTxPacket = NanoSeconds(3000 + i);
+    stats.timeLastRxPacket = NanoSeconds(4000 + i);
+    stats.delaySum = NanoSeconds(5000 + i);
+    stats.jitterSum = NanoSeconds(6000 + i);
+    stats.lastDelay = NanoSeconds(7000 + i);
+    stats.txBytes = 8000000000ULL + i;
+    stats.rxBytes = 9000 + i;
+    stats.txPackets = 10 + i;
+    stats.rxPackets = 9 + i;
+    stats.rxSampledPackets = i % 5;
+    stats.lostPackets = 1;
+    stats.timesForwarded = 2 * i;
+    // a variable number of drop reasons, including none
+    for (uint32_t j = 0; j < i % 4; j++)
+    {
+        stats.packetsDropped.push_back(i + j);
+        stats.bytesDropped.push_back(1000 * (i + j));
+    }
+    return stats;
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief FlowStatsWriter and FlowStatsReader round trip test
+ *
+ * Flow records are written in a given format and read back; the BINARY
+ * records span several blocks.
+ */
+class FlowStatsFileRoundTripTestCase : public TestCase
+{
+  public:
+    /**
+     * \param format the format of the file
+     */
+    FlowStatsFileRoundTripTestCase(FlowStatsWriter::Format format);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check a flow record read back
+     * \param i the index of the flow
+     * \param stats the statistics read
+     */
+    void CheckStats(uint32_t i, const FlowMonitor::FlowStats& stats);
+
+    FlowStatsWriter::Format m_format; //!< the format of the file
+};
+
+FlowStatsFileRoundTripTestCase::FlowStatsFileRoundTripTestCase(FlowStatsWriter::Format format)
+    : TestCase(std::string("Write and read back flow records in ") +
+               (format == FlowStatsWriter::CSV ? "CSV" : "BINARY") + " format"),
+      m_format(format)
+{
+}
+
+void
+FlowStatsFileRoundTripTestCase::CheckStats(uint32_t i, const FlowMonitor::FlowStats& stats)
+{
+    FlowMonitor::FlowStats expected = MakeStats(i);
+    NS_TEST_EXPECT_MSG_EQ(stats.timeFirstTxPacket, expected.timeFirstTxPacket, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.timeFirstRxPacket, expected.timeFirstRxPacket, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.timeLastTxPacket, expected.timeLastTxPacket, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.timeLastRxPacket, expected.timeLastRxPacket, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.delaySum, expected.delaySum, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.jitterSum, expected.jitterSum, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.lastDelay, expected.lastDelay, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.txBytes, expected.txBytes, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.rxBytes, expected.rxBytes, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.txPackets, expected.txPackets, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.rxPackets, expected.rxPackets, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.rxSampledPackets, expected.rxSampledPackets, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.lostPackets, expected.lostPackets, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ(stats.timesForwarded, expected.timesForwarded, "Flow " << i);
+    NS_TEST_EXPECT_MSG_EQ((stats.packetsDropped == expected.packetsDropped),
+                          true,
+                          "Wrong dropped packets of flow " << i);
+    NS_TEST_EXPECT_MSG_EQ((stats.bytesDropped == expected.bytesDropped),
+                          true,
+                          "Wrong dropped bytes of flow " << i);
+}
+
+void
+FlowStatsFileRoundTripTestCase::DoRun()
+{
+    const uint32_t n = 2 * FlowStatsWriter::BLOCK_SIZE + 10;
+    std::string fileName = CreateTempDirFilename("flow-stats");
+
+    FlowStatsWriter writer(fileName, m_format);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        writer.Write(i, MakeStats(i));
+    }
+    writer.Close();
+    NS_TEST_ASSERT_MSG_EQ(writer.GetNRecords(), n, "Wrong number of records written");
+
+    FlowStatsReader reader(fileName);
+    NS_TEST_ASSERT_MSG_EQ(reader.IsOpen(), true, "File not recognized");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetFormat(), m_format, "Wrong format detected");
+    FlowId flowId;
+    FlowMonitor::FlowStats stats;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(reader.Read(flowId, stats), true, "Record " << i << " not read");
+        NS_TEST_ASSERT_MSG_EQ(flowId, i, "Wrong flow identifier");
+        CheckStats(i, stats);
+    }
+    NS_TEST_ASSERT_MSG_EQ(reader.Read(flowId, stats), false, "Unexpected record read");
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief FlowStatsReader::ReadAll test of flows with several records
+ *
+ * The packets of a flow lost after the flow was written are reported in a
+ * record with only a loss count, which must be merged into the flow.
+ */
+class FlowStatsFileMergeTestCase : public TestCase
+{
+  public:
+    /**
+     * \param format the format of the file
+     */
+    FlowStatsFileMergeTestCase(FlowStatsWriter::Format format);
+
+  private:
+    void DoRun() override;
+
+    FlowStatsWriter::Format m_format; //!< the format of the file
+};
+
+FlowStatsFileMergeTestCase::FlowStatsFileMergeTestCase(FlowStatsWriter::Format format)
+    : TestCase(std::string("Merge the records of a flow in ") +
+               (format == FlowStatsWriter::CSV ? "CSV" : "BINARY") + " format"),
+      m_format(format)
+{
+}
+
+void
+FlowStatsFileMergeTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("flow-stats-merge");
+
+    FlowStatsWriter writer(fileName, m_format);
+    writer.Write(1, MakeStats(1));
+    writer.Write(2, MakeStats(2));
+    FlowMonitor::FlowStats loss{};
+    loss.lostPackets = 3;
+    writer.Write(1, loss);
+    // a flow whose packets were all lost
+    writer.Write(3, loss);
+    FlowMonitor::FlowStats late = MakeStats(5);
+    writer.Write(2, late);
+    writer.Close();
+
+    FlowStatsReader reader(fileName);
+    FlowMonitor::FlowStatsContainer flows = reader.ReadAll();
+    NS_TEST_ASSERT_MSG_EQ(flows.size(), 3, "Wrong number of flows");
+
+    const FlowMonitor::FlowStats& flow1 = flows[1];
+    NS_TEST_ASSERT_MSG_EQ(flow1.lostPackets, 4, "Loss not merged");
+    NS_TEST_ASSERT_MSG_EQ(flow1.txPackets, 11, "Wrong merged tx packets");
+    NS_TEST_ASSERT_MSG_EQ(flow1.timeFirstTxPacket,
+                          NanoSeconds(1001),
+                          "Loss record changed the first tx time");
+    NS_TEST_ASSERT_MSG_EQ(flow1.timeLastRxPacket,
+                          NanoSeconds(4001),
+                          "Loss record changed the last rx time");
+
+    const FlowMonitor::FlowStats& flow2 = flows[2];
+    NS_TEST_ASSERT_MSG_EQ(flow2.txPackets, 12 + 15, "Wrong merged tx packets");
+    NS_TEST_ASSERT_MSG_EQ(flow2.timeFirstTxPacket, NanoSeconds(1002), "Wrong first tx time");
+    NS_TEST_ASSERT_MSG_EQ(flow2.timeLastTxPacket, NanoSeconds(3005), "Wrong last tx time");
+    NS_TEST_ASSERT_MSG_EQ(flow2.packetsDropped.size(), 2, "Wrong number of drop reasons");
+    NS_TEST_ASSERT_MSG_EQ(flow2.packetsDropped[0], 2 + 5, "Wrong merged dropped packets");
+    NS_TEST_ASSERT_MSG_EQ(flow2.packetsDropped[1], 3, "Wrong merged dropped packets");
+
+    const FlowMonitor::FlowStats& flow3 = flows[3];
+    NS_TEST_ASSERT_MSG_EQ(flow3.lostPackets, 3, "Wrong lost packets");
+    NS_TEST_ASSERT_MSG_EQ(flow3.txPackets, 0, "Wrong tx packets");
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief FlowStatsReader test of malformed CSV lines
+ *
+ * Reading stops at a truncated or malformed line, e.g., the last line of a
+ * file still being written.
+ */
+class FlowStatsFileMalformedTestCase : public TestCase
+{
+  public:
+    FlowStatsFileMalformedTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+FlowStatsFileMalformedTestCase::FlowStatsFileMalformedTestCase()
+    : TestCase("Stop reading a CSV file at a malformed line")
+{
+}
+
+void
+FlowStatsFileMalformedTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("flow-stats-malformed.csv");
+
+    // a truncated line, and a line with a field that is not a number
+    std::vector<std::string> lines{"7,1000,2000,30",
+                                   "7,1000,2000,3000,4000,5000,6000,7000,x,9000,10,9,0,1,0,,"};
+    for (const auto& line : lines)
+    {
+        {
+            FlowStatsWriter writer(fileName, FlowStatsWriter::CSV);
+            writer.Write(1, MakeStats(1));
+        }
+        std::ofstream os(fileName, std::ios::app);
+        os << line;
+        os.close();
+
+        FlowStatsReader reader(fileName);
+        NS_TEST_ASSERT_MSG_EQ(reader.IsOpen(), true, "File not recognized");
+        FlowId flowId;
+        FlowMonitor::FlowStats stats;
+        NS_TEST_ASSERT_MSG_EQ(reader.Read(flowId, stats), true, "Valid record not read");
+        NS_TEST_ASSERT_MSG_EQ(flowId, 1, "Wrong flow identifier");
+        NS_TEST_ASSERT_MSG_EQ(reader.Read(flowId, stats), false, "Malformed line read");
+    }
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief FlowStatsWriter and FlowStatsReader test suite
+ */
+class FlowStatsFileTestSuite : public TestSuite
+{
+  public:
+    FlowStatsFileTestSuite();
+};
+
+FlowStatsFileTestSuite::FlowStatsFileTestSuite()
+    : TestSuite("flow-stats-file", UNIT)
+{
+    AddTestCase(new FlowStatsFileRoundTripTestCase(FlowStatsWriter::CSV), TestCase::QUICK);
+    AddTestCase(new FlowStatsFileRoundTripTestCase(FlowStatsWriter::BINARY), TestCase::QUICK);
+    AddTestCase(new FlowStatsFileMergeTestCase(FlowStatsWriter::CSV), TestCase::QUICK);
+    AddTestCase(new FlowStatsFileMergeTestCase(FlowStatsWriter::BINARY), TestCase::QUICK);
+    AddTestCase(new FlowStatsFileMalformedTestCase, TestCase::QUICK);
+}
+
+static FlowStatsFileTestSuite g_flowStatsFileTestSuite; //!< Static variable for test initialization
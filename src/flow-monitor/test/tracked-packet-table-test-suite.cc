@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/tracked-packet-table.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief TrackedPacketTable insertion, lookup and removal test
+ *
+ * Enough packets are tracked to grow the hash table beyond its initial
+ * capacity, and every other packet is then erased: the remaining packets
+ * must still be found, with the timestamps they were inserted with.
+ */
+class TrackedPacketTableInsertEraseTestCase : public TestCase
+{
+  public:
+    TrackedPacketTableInsertEraseTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TrackedPacketTableInsertEraseTestCase::TrackedPacketTableInsertEraseTestCase()
+    : TestCase("Insert, find and erase tracked packets, with rehashes")
+{
+}
+
+void
+TrackedPacketTableInsertEraseTestCase::DoRun()
+{
+    const uint32_t n = 5000;
+    TrackedPacketTable table;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TrackedPacketTable::Entry* entry = table.Insert(i % 10, i / 10, MicroSeconds(i));
+        NS_TEST_ASSERT_MSG_EQ(entry->flowId, i % 10, "Wrong flow identifier");
+        NS_TEST_ASSERT_MSG_EQ(entry->packetId, i / 10, "Wrong packet identifier");
+        NS_TEST_ASSERT_MSG_EQ(entry->timesForwarded, 0, "Wrong forwarding count");
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Wrong number of tracked packets");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TrackedPacketTable::Entry* entry = table.Find(i % 10, i / 10);
+        NS_TEST_ASSERT_MSG_NE(entry, nullptr, "Tracked packet not found");
+        NS_TEST_ASSERT_MSG_EQ(entry->firstSeenTime, MicroSeconds(i), "Wrong first seen time");
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.Find(10, 0), nullptr, "Unexpected packet found");
+    NS_TEST_ASSERT_MSG_EQ(table.Find(0, n), nullptr, "Unexpected packet found");
+
+    for (uint32_t i = 0; i < n; i += 2)
+    {
+        table.Erase(table.Find(i % 10, i / 10));
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n / 2, "Wrong number of tracked packets");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TrackedPacketTable::Entry* entry = table.Find(i % 10, i / 10);
+        if (i % 2 == 0)
+        {
+            NS_TEST_ASSERT_MSG_EQ(entry, nullptr, "Erased packet found");
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_NE(entry, nullptr, "Tracked packet not found");
+            NS_TEST_ASSERT_MSG_EQ(entry->lastSeenTime, MicroSeconds(i), "Wrong last seen time");
+        }
+    }
+
+    // the entries of the erased packets are reused
+    for (uint32_t i = 0; i < n; i += 2)
+    {
+        table.Insert(i % 10, i / 10, MicroSeconds(n + i));
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Wrong number of tracked packets");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NS_TEST_ASSERT_MSG_NE(table.Find(i % 10, i / 10), nullptr, "Tracked packet not found");
+    }
+
+    // inserting a tracked packet resets its entry
+    TrackedPacketTable::Entry* entry = table.Find(3, 7);
+    entry->timesForwarded = 2;
+    entry = table.Insert(3, 7, MicroSeconds(3 * n));
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Packet tracked twice");
+    NS_TEST_ASSERT_MSG_EQ(entry->timesForwarded, 0, "Entry not reset");
+    NS_TEST_ASSERT_MSG_EQ(entry->firstSeenTime, MicroSeconds(3 * n), "Entry not reset");
+
+    table.Clear();
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 0, "The table is not empty");
+    NS_TEST_ASSERT_MSG_EQ(table.Find(3, 7), nullptr, "Packet found after clear");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief TrackedPacketTable expiration test
+ *
+ * The packets must expire in the order of their last seen time, a packet
+ * being moved to the newest end of the list when it is touched.
+ */
+class TrackedPacketTableExpireTestCase : public TestCase
+{
+  public:
+    TrackedPacketTableExpireTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TrackedPacketTableExpireTestCase::TrackedPacketTableExpireTestCase()
+    : TestCase("Expire tracked packets in the order of their last seen time")
+{
+}
+
+void
+TrackedPacketTableExpireTestCase::DoRun()
+{
+    TrackedPacketTable table;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        table.Insert(i, 0, Seconds(i));
+    }
+    // packets 2 and 5 are seen again, after all the others
+    table.Touch(table.Find(2, 0), Seconds(20));
+    table.Touch(table.Find(5, 0), Seconds(21));
+    NS_TEST_ASSERT_MSG_EQ(table.Find(2, 0)->firstSeenTime, Seconds(2), "Wrong first seen time");
+    NS_TEST_ASSERT_MSG_EQ(table.Find(2, 0)->lastSeenTime, Seconds(20), "Wrong last seen time");
+    // packet 7 is no longer tracked
+    table.Erase(table.Find(7, 0));
+
+    std::vector<FlowId> expired;
+    table.Expire(Seconds(4), [&expired](FlowId flowId) { expired.push_back(flowId); });
+    NS_TEST_ASSERT_MSG_EQ(expired.size(), 4, "Wrong number of expired packets");
+    NS_TEST_ASSERT_MSG_EQ((expired == std::vector<FlowId>{0, 1, 3, 4}), true, "Wrong order");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 5, "Wrong number of tracked packets");
+    NS_TEST_ASSERT_MSG_EQ(table.Find(3, 0), nullptr, "Expired packet found");
+
+    expired.clear();
+    table.Expire(Seconds(20), [&expired](FlowId flowId) { expired.push_back(flowId); });
+    NS_TEST_ASSERT_MSG_EQ((expired == std::vector<FlowId>{6, 8, 9, 2}), true, "Wrong order");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 1, "Wrong number of tracked packets");
+    NS_TEST_ASSERT_MSG_NE(table.Find(5, 0), nullptr, "Tracked packet not found");
+
+    expired.clear();
+    table.Expire(Seconds(19), [&expired](FlowId flowId) { expired.push_back(flowId); });
+    NS_TEST_ASSERT_MSG_EQ(expired.empty(), true, "A packet expired before its deadline");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief TrackedPacketTable test suite
+ */
+class TrackedPacketTableTestSuite : public TestSuite
+{
+  public:
+    TrackedPacketTableTestSuite();
+};
+
+TrackedPacketTableTestSuite::TrackedPacketTableTestSuite()
+    : TestSuite("tracked-packet-table", UNIT)
+{
+    AddTestCase(new TrackedPacketTableInsertEraseTestCase, TestCase::QUICK);
+    AddTestCase(new TrackedPacketTableExpireTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static TrackedPacketTableTestSuite g_trackedPacketTableTestSuite;
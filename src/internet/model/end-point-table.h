@@ -0,0 +1,304 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef END_POINT_TABLE_H
+#define END_POINT_TABLE_H
+
+#include "ns3/assert.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup internet
+ *
+ * \brief Open-addressing hash table of endpoints keyed on the full 4-tuple
+ *
+ * This table is used by Ipv4EndPointDemux and Ipv6EndPointDemux to find the
+ * endpoint of an established connection with a single hash computation and,
+ * in the common case, a single probe.  Endpoints bound to a wildcard local or
+ * peer address are not meant to be stored here; they are looked up by the
+ * demux through its own (slower) fallback path.
+ *
+ * The 4-tuple of an endpoint is copied into the table when the endpoint is
+ * inserted.  It may change afterwards (e.g., when Connect is called again on
+ * a connected socket): Find() checks the current 4-tuple of the endpoints it
+ * returns, Insert() moves an endpoint already in the table under its new
+ * 4-tuple, and Remove() finds the endpoint by pointer, whatever its current
+ * 4-tuple.  Several endpoints may share a 4-tuple (e.g., when bound to
+ * different NetDevices); Find() then returns the first one accepted by the
+ * caller-provided predicate.
+ *
+ * \tparam Address the address type (Ipv4Address or Ipv6Address)
+ * \tparam AddressHash the hash function class for Address
+ * \tparam EndPoint the endpoint type (Ipv4EndPoint or Ipv6EndPoint)
+ */
+template <class Address, class AddressHash, class EndPoint>
+class EndPointTable
+{
+  public:
+    EndPointTable()
+        : m_slots(MIN_CAPACITY),
+          m_size(0),
+          m_used(0)
+    {
+    }
+
+    /**
+     * \brief Insert an endpoint, using its current 4-tuple as the key
+     *
+     * An endpoint already in the table is moved under its current 4-tuple.
+     *
+     * \param endPoint the endpoint
+     */
+    void Insert(EndPoint* endPoint)
+    {
+        Remove(endPoint);
+        if ((m_used + 1) * 2 > m_slots.size())
+        {
+            Rehash(m_size * 4 > m_slots.size() ? m_slots.size() * 2 : m_slots.size());
+        }
+        Key key = MakeKey(endPoint);
+        uint64_t hash = Hash(key);
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            Slot& slot = m_slots[i];
+            if (slot.endPoint == nullptr || slot.endPoint == Tombstone())
+            {
+                if (slot.endPoint == nullptr)
+                {
+                    m_used++;
+                }
+                slot.endPoint = endPoint;
+                slot.hash = hash;
+                slot.key = key;
+                m_size++;
+                m_hashes[endPoint] = hash;
+                return;
+            }
+        }
+    }
+
+    /**
+     * \brief Remove an endpoint
+     * \param endPoint the endpoint
+     * \return true if the endpoint was in the table
+     */
+    bool Remove(EndPoint* endPoint)
+    {
+        auto it = m_hashes.find(endPoint);
+        if (it == m_hashes.end())
+        {
+            return false;
+        }
+        // the slot is found from the hash of the 4-tuple the endpoint was
+        // inserted with, which may differ from its current 4-tuple
+        std::size_t i = FindSlot(endPoint, it->second);
+        m_hashes.erase(it);
+        Erase(i);
+        return true;
+    }
+
+    /**
+     * \param endPoint the endpoint
+     * \return true if the endpoint is stored under its current 4-tuple
+     */
+    bool Contains(EndPoint* endPoint) const
+    {
+        auto it = m_hashes.find(endPoint);
+        return it != m_hashes.end() &&
+               m_slots[FindSlot(endPoint, it->second)].key == MakeKey(endPoint);
+    }
+
+    /**
+     * \brief Find an endpoint matching exactly a 4-tuple
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     * \param accept predicate called on each endpoint with a matching 4-tuple
+     * \return the first endpoint accepted by the predicate, or nullptr
+     */
+    template <class Predicate>
+    EndPoint* Find(Address localAddress,
+                   uint16_t localPort,
+                   Address peerAddress,
+                   uint16_t peerPort,
+                   Predicate accept) const
+    {
+        Key key{localAddress, peerAddress, localPort, peerPort};
+        uint64_t hash = Hash(key);
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = hash & mask; m_slots[i].endPoint != nullptr; i = (i + 1) & mask)
+        {
+            const Slot& slot = m_slots[i];
+            if (slot.hash == hash && slot.endPoint != Tombstone() && slot.key == key &&
+                MakeKey(slot.endPoint) == key && accept(slot.endPoint))
+            {
+                return slot.endPoint;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * \return the number of endpoints in the table
+     */
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+  private:
+    /// The 4-tuple an endpoint is stored under
+    struct Key
+    {
+        Address localAddress; //!< local address
+        Address peerAddress;  //!< peer address
+        uint16_t localPort;   //!< local port
+        uint16_t peerPort;    //!< peer port
+
+        /**
+         * \param other the other key
+         * \return true if the keys are equal
+         */
+        bool operator==(const Key& other) const
+        {
+            return localPort == other.localPort && peerPort == other.peerPort &&
+                   localAddress == other.localAddress && peerAddress == other.peerAddress;
+        }
+    };
+
+    /// A table slot; an empty slot has a null endpoint
+    struct Slot
+    {
+        EndPoint* endPoint{nullptr}; //!< the endpoint, nullptr or Tombstone()
+        uint64_t hash{0};            //!< hash of the key
+        Key key{};                   //!< the 4-tuple
+    };
+
+    static constexpr std::size_t MIN_CAPACITY = 16; //!< initial number of slots (a power of 2)
+
+    /**
+     * \return the marker of a slot whose endpoint has been removed
+     */
+    static EndPoint* Tombstone()
+    {
+        return reinterpret_cast<EndPoint*>(alignof(EndPoint));
+    }
+
+    /**
+     * \param endPoint the endpoint
+     * \return the current 4-tuple of the endpoint
+     */
+    static Key MakeKey(const EndPoint* endPoint)
+    {
+        return Key{endPoint->GetLocalAddress(),
+                   endPoint->GetPeerAddress(),
+                   endPoint->GetLocalPort(),
+                   endPoint->GetPeerPort()};
+    }
+
+    /**
+     * \param key the 4-tuple
+     * \return the hash of the 4-tuple
+     */
+    static uint64_t Hash(const Key& key)
+    {
+        AddressHash addressHash;
+        uint64_t h = addressHash(key.localAddress);
+        h = (h ^ (static_cast<uint64_t>(addressHash(key.peerAddress)) << 1)) * 0x9e3779b97f4a7c15ULL;
+        h ^= (static_cast<uint64_t>(key.localPort) << 16) | key.peerPort;
+        h *= 0xff51afd7ed558ccdULL;
+        return h ^ (h >> 32);
+    }
+
+    /**
+     * \param endPoint an endpoint in the table
+     * \param hash the hash the endpoint was inserted with
+     * \return the index of the slot of the endpoint
+     */
+    std::size_t FindSlot(const EndPoint* endPoint, uint64_t hash) const
+    {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = hash & mask;
+        while (m_slots[i].endPoint != endPoint)
+        {
+            NS_ASSERT_MSG(m_slots[i].endPoint != nullptr, "Endpoint not found in its slot chain");
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    /**
+     * \brief Remove the endpoint of a slot
+     * \param i the slot index
+     */
+    void Erase(std::size_t i)
+    {
+        std::size_t mask = m_slots.size() - 1;
+        m_size--;
+        if (m_slots[(i + 1) & mask].endPoint == nullptr)
+        {
+            // end of a probe sequence, no tombstone needed
+            m_slots[i].endPoint = nullptr;
+            m_used--;
+        }
+        else
+        {
+            m_slots[i].endPoint = Tombstone();
+        }
+    }
+
+    /**
+     * \brief Rebuild the table without tombstones
+     * \param capacity the new number of slots (a power of 2)
+     */
+    void Rehash(std::size_t capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(m_slots);
+        std::size_t mask = m_slots.size() - 1;
+        m_used = m_size;
+        for (const Slot& slot : old)
+        {
+            if (slot.endPoint == nullptr || slot.endPoint == Tombstone())
+            {
+                continue;
+            }
+            std::size_t i = slot.hash & mask;
+            while (m_slots[i].endPoint != nullptr)
+            {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> m_slots; //!< the slots
+    std::size_t m_size;        //!< number of endpoints
+    std::size_t m_used;        //!< number of non-empty slots (endpoints and tombstones)
+    /// hash of the 4-tuple each endpoint in the table was inserted with
+    std::unordered_map<const EndPoint*, uint64_t> m_hashes;
+};
+
+} // namespace ns3
+
+#endif /* END_POINT_TABLE_H */
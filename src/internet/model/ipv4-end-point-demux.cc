@@ -29,20 +29,6 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Ipv4EndPointDemux");
 
-static uint64_t
-MakeTuple4Key(uint32_t localAddr, uint16_t localPort, uint32_t peerAddr, uint16_t peerPort) {
-    return ((uint64_t)((localPort << 16) ^ localAddr) << 32) | ((peerPort << 16) ^ peerAddr);
-}
-
-static uint64_t
-MakeTuple4Key(Ipv4EndPoint* endPoint) {
-    uint32_t localAddr = endPoint->GetLocalAddress().Get();
-    uint16_t localPort = endPoint->GetLocalPort();
-    uint32_t peerAddr = endPoint->GetPeerAddress().Get();
-    uint16_t peerPort = endPoint->GetPeerPort();
-    return MakeTuple4Key(localAddr, localPort, peerAddr, peerPort);
-}
-
 Ipv4EndPointDemux::Ipv4EndPointDemux()
     : m_ephemeral(49152),
       m_portLast(65535),
@@ -60,7 +46,6 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
         }
     }
     m_lportEndPointsMap.clear();
-    m_tuple4EndPointsMap.clear();
 }
 
 bool
@@ -154,7 +139,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     auto endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
     m_lportEndPointsMap[localPort].push_back(endPoint);
-    m_tuple4EndPointsMap[MakeTuple4Key(endPoint)].push_back(endPoint);
+    m_tuple4EndPoints.Insert(endPoint);
     return endPoint;
 }
 
@@ -170,19 +155,7 @@ Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
         }
     }
 
-    auto tuple4SlotIt = m_tuple4EndPointsMap.find(MakeTuple4Key(endPoint));
-    if (tuple4SlotIt != m_tuple4EndPointsMap.end()) {
-        EndPoints& slot = tuple4SlotIt->second;
-        for (auto i = slot.begin(); i != slot.end(); i++) {
-            if (*i == endPoint) {
-                slot.erase(i);
-                break;
-            }
-        }
-        if (slot.empty()) {
-            m_tuple4EndPointsMap.erase(tuple4SlotIt);
-        }
-    }
+    m_tuple4EndPoints.Remove(endPoint);
 
     delete endPoint;
 }
@@ -206,21 +179,11 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval3; // Matches all but local address
     EndPoints retval4; // Exact match on all 4
 
-    auto tuple4Key = MakeTuple4Key(daddr.Get(), dport, saddr.Get(), sport);
-    if (auto slotIt = m_tuple4EndPointsMap.find(tuple4Key); slotIt != m_tuple4EndPointsMap.end()) {
-        for (Ipv4EndPoint* endP : slotIt->second) {
-            if (!endP->IsRxEnabled()) {
-                continue;
-            }
-            Ptr<NetDevice> dev = endP->GetBoundNetDevice();
-            if (dev && dev != incomingInterface->GetDevice()) {
-                continue;
-            }
-
-            EndPoints ret;
-            ret.push_back(endP);
-            return ret;
-        }
+    if (Ipv4EndPoint* endP = LookupEstablished(daddr, dport, saddr, sport, incomingInterface))
+    {
+        EndPoints ret;
+        ret.push_back(endP);
+        return ret;
     }
 
     for (Ipv4EndPoint* endP : m_lportEndPointsMap[dport]) {
@@ -330,8 +293,13 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     if (!retval4.empty())
     {
         retval = retval4;
+        // The peer of this endpoint has been set after its allocation (e.g., by
+        // Connect), move it to the fast path for the next packets.
         Ipv4EndPoint* endP = retval.front();
-        m_tuple4EndPointsMap[MakeTuple4Key(endP)].push_back(endP);
+        if (!m_tuple4EndPoints.Contains(endP))
+        {
+            m_tuple4EndPoints.Insert(endP);
+        }
     }
     else if (!retval3.empty())
     {
@@ -352,6 +320,24 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     return retval; // might be empty if no matches
 }
 
+Ipv4EndPoint*
+Ipv4EndPointDemux::LookupEstablished(Ipv4Address daddr,
+                                     uint16_t dport,
+                                     Ipv4Address saddr,
+                                     uint16_t sport,
+                                     Ptr<Ipv4Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << daddr << dport << saddr << sport << incomingInterface);
+    return m_tuple4EndPoints.Find(daddr, dport, saddr, sport, [&](Ipv4EndPoint* endP) {
+        if (!endP->IsRxEnabled())
+        {
+            return false;
+        }
+        Ptr<NetDevice> dev = endP->GetBoundNetDevice();
+        return !dev || dev == incomingInterface->GetDevice();
+    });
+}
+
 Ipv4EndPoint*
 Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
                                 uint16_t dport,
@@ -20,12 +20,12 @@
 #ifndef IPV4_END_POINT_DEMUX_H
 #define IPV4_END_POINT_DEMUX_H
 
+#include "end-point-table.h"
 #include "ipv4-interface.h"
 
 #include "ns3/ipv4-address.h"
 
 #include <list>
-#include <map>
 #include <unordered_map>
 #include <stdint.h>
 
@@ -102,6 +102,28 @@ class Ipv4EndPointDemux
                      uint16_t sport,
                      Ptr<Ipv4Interface> incomingInterface);
 
+    /**
+     * \brief Lookup for the endpoint of an established connection.
+     *
+     * This is the fast path of Lookup(): only endpoints whose 4-tuple exactly
+     * matches the parameters are considered, and a single hash table probe
+     * is usually enough to find them.
+     *
+     * EndPoint with disabled Rx are skipped.
+     *
+     * \param daddr destination address to test
+     * \param dport destination port to test
+     * \param saddr source address to test
+     * \param sport source port to test
+     * \param incomingInterface the incoming interface
+     * \return the matching IPv4EndPoint (nullptr if not found)
+     */
+    Ipv4EndPoint* LookupEstablished(Ipv4Address daddr,
+                                    uint16_t dport,
+                                    Ipv4Address saddr,
+                                    uint16_t sport,
+                                    Ptr<Ipv4Interface> incomingInterface);
+
     /**
      * \brief simple lookup for a match with all the parameters.
      * \param daddr destination address to test
@@ -188,8 +210,15 @@ class Ipv4EndPointDemux
      */
     uint16_t m_portFirst;
 
+    /**
+     * \brief All the endpoints, by local port (wildcard and listening endpoints fallback).
+     */
     std::unordered_map<uint16_t, EndPoints> m_lportEndPointsMap;
-    std::map<uint64_t, EndPoints> m_tuple4EndPointsMap;
+
+    /**
+     * \brief Endpoints of established connections, by full 4-tuple.
+     */
+    EndPointTable<Ipv4Address, Ipv4AddressHash, Ipv4EndPoint> m_tuple4EndPoints;
 };
 
 } // namespace ns3
@@ -69,6 +69,7 @@ Ipv4GlobalRouting::Ipv4GlobalRouting()
     NS_LOG_FUNCTION(this);
 
     m_rand = CreateObject<UniformRandomVariable>();
+    NotifyRoutesChanged();
 }
 
 Ipv4GlobalRouting::~Ipv4GlobalRouting()
@@ -83,6 +84,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    NotifyRoutesChanged();
 }
 
 void
@@ -92,6 +94,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    NotifyRoutesChanged();
 }
 
 void
@@ -104,6 +107,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    NotifyRoutesChanged();
 }
 
 void
@@ -113,6 +117,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    NotifyRoutesChanged();
 }
 
 void
@@ -125,6 +130,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    NotifyRoutesChanged();
 }
 
 Ptr<Ipv4Route>
@@ -299,6 +305,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
                 delete *i;
                 m_hostRoutes.erase(i);
+                NotifyRoutesChanged();
                 NS_LOG_LOGIC("Done removing host route "
                              << index << "; host route remaining size = " << m_hostRoutes.size());
                 return;
@@ -315,6 +322,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
             delete *j;
             m_networkRoutes.erase(j);
+            NotifyRoutesChanged();
             NS_LOG_LOGIC("Done removing network route "
                          << index << "; network route remaining size = " << m_networkRoutes.size());
             return;
@@ -330,6 +338,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
             delete *k;
             m_ASexternalRoutes.erase(k);
+            NotifyRoutesChanged();
             NS_LOG_LOGIC("Done removing network route "
                          << index << "; network route remaining size = " << m_networkRoutes.size());
             return;
@@ -24,6 +24,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-header.h"
 #include "ipv4-interface.h"
+#include "ipv4-queue-disc-item.h"
 #include "ipv4-raw-socket-impl.h"
 #include "ipv4-route.h"
 #include "loopback-net-device.h"
@@ -87,6 +88,14 @@ Ipv4L3Protocol::GetTypeId()
                           TimeValue(Seconds(1)),
                           MakeTimeAccessor(&Ipv4L3Protocol::m_purge),
                           MakeTimeChecker(Seconds(0)))
+            .AddAttribute("FastForwarding",
+                          "Cache the next hop of forwarded destinations and forward the "
+                          "subsequent packets to these destinations bypassing the routing "
+                          "protocol. Only next hops reached through devices not needing "
+                          "ARP are cached.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&Ipv4L3Protocol::m_fastForwarding),
+                          MakeBooleanChecker())
             .AddTraceSource("Tx",
                             "Send ipv4 packet to outgoing interface.",
                             MakeTraceSourceAccessor(&Ipv4L3Protocol::m_txTrace),
@@ -301,6 +310,7 @@ Ipv4L3Protocol::SetRoutingProtocol(Ptr<Ipv4RoutingProtocol> routingProtocol)
     NS_LOG_FUNCTION(this << routingProtocol);
     m_routingProtocol = routingProtocol;
     m_routingProtocol->SetIpv4(this);
+    FlushForwardingCache();
 }
 
 Ptr<Ipv4RoutingProtocol>
@@ -328,6 +338,7 @@ Ipv4L3Protocol::DoDispose()
     m_reverseInterfacesContainer.clear();
 
     m_sockets.clear();
+    m_forwardingCache.clear();
     m_node = nullptr;
     m_routingProtocol = nullptr;
 
@@ -627,6 +638,12 @@ Ipv4L3Protocol::Receive(Ptr<NetDevice> device,
         return;
     }
 
+    // without a routing protocol, the regular path below reports the error
+    if (m_fastForwarding && m_routingProtocol && FastForward(packet, ipHeader, interface))
+    {
+        return;
+    }
+
     // the packet is valid, we update the ARP cache entry (if present)
     Ptr<ArpCache> arpCache = ipv4Interface->GetArpCache();
     if (arpCache)
@@ -1086,6 +1103,108 @@ Ipv4L3Protocol::IpForward(Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv
         m_dropTrace(header, packet, DROP_TTL_EXPIRED, this, interface);
         return;
     }
+    if (m_fastForwarding)
+    {
+        CacheNextHop(rtentry, ipHeader, interface);
+    }
+    SetForwardingPriority(packet, ipHeader);
+
+    m_unicastForwardTrace(ipHeader, packet, interface);
+    SendRealOut(rtentry, packet, ipHeader);
+}
+
+bool
+Ipv4L3Protocol::FastForward(Ptr<Packet> packet, Ipv4Header& ipHeader, uint32_t iif)
+{
+    NS_LOG_FUNCTION(this << packet << &ipHeader << iif);
+    NS_ASSERT_MSG(m_routingProtocol, "Need a routing protocol object to process packets");
+
+    uint64_t generation = m_routingProtocol->GetRoutesGeneration();
+    if (generation != m_forwardingCacheGeneration)
+    {
+        NS_LOG_LOGIC("Routes changed, flushing the forwarding cache");
+        FlushForwardingCache();
+        m_forwardingCacheGeneration = generation;
+    }
+
+    auto it = m_forwardingCache.find(ipHeader.GetDestination());
+    if (it == m_forwardingCache.end())
+    {
+        return false;
+    }
+    const NextHop& nextHop = it->second;
+
+    // raw sockets, TTL expiration and fragmentation are handled by the regular path
+    if (!m_sockets.empty() || ipHeader.GetTtl() <= 1 || !m_interfaces[iif]->IsForwarding() ||
+        !nextHop.interface->IsUp() ||
+        packet->GetSize() + ipHeader.GetSerializedSize() > nextHop.device->GetMtu())
+    {
+        return false;
+    }
+
+    NS_LOG_LOGIC("Fast forwarding to " << ipHeader.GetDestination() << " via interface "
+                                       << nextHop.interfaceIndex);
+    ipHeader.SetTtl(ipHeader.GetTtl() - 1);
+
+    SetForwardingPriority(packet, ipHeader);
+
+    m_unicastForwardTrace(ipHeader, packet, nextHop.interfaceIndex);
+    CallTxTrace(ipHeader, packet, this, nextHop.interfaceIndex);
+    nextHop.tc->Send(nextHop.device,
+                     Create<Ipv4QueueDiscItem>(packet,
+                                               nextHop.hardwareDestination,
+                                               PROT_NUMBER,
+                                               ipHeader));
+    return true;
+}
+
+void
+Ipv4L3Protocol::CacheNextHop(Ptr<Ipv4Route> rtentry, const Ipv4Header& ipHeader, int32_t interface)
+{
+    NS_LOG_FUNCTION(this << rtentry << &ipHeader << interface);
+
+    NS_ASSERT_MSG(m_routingProtocol, "Need a routing protocol object to process packets");
+
+    Ipv4Address destination = ipHeader.GetDestination();
+    // the routes must be tracked, and the cache up to date with them
+    uint64_t generation = m_routingProtocol->GetRoutesGeneration();
+    if (interface < 0 || generation == 0 || generation != m_forwardingCacheGeneration ||
+        m_forwardingCache.find(destination) != m_forwardingCache.end() || !IsUnicast(destination))
+    {
+        return;
+    }
+
+    Ptr<Ipv4Interface> outInterface = m_interfaces[interface];
+    Ptr<NetDevice> device = outInterface->GetDevice();
+    if (device->NeedsArp() || DynamicCast<LoopbackNetDevice>(device))
+    {
+        return;
+    }
+
+    // packets sent to a local address of the output interface are looped back
+    Ipv4Address target = rtentry->GetGateway().IsAny() ? destination : rtentry->GetGateway();
+    for (uint32_t i = 0; i < outInterface->GetNAddresses(); i++)
+    {
+        if (outInterface->GetAddress(i).GetLocal() == target)
+        {
+            return;
+        }
+    }
+
+    Ptr<TrafficControlLayer> tc = m_node->GetObject<TrafficControlLayer>();
+    if (!tc)
+    {
+        return;
+    }
+
+    NS_LOG_LOGIC("Caching next hop of " << destination << ": interface " << interface);
+    m_forwardingCache[destination] =
+        NextHop{outInterface, static_cast<uint32_t>(interface), device, tc, device->GetBroadcast()};
+}
+
+void
+Ipv4L3Protocol::SetForwardingPriority(Ptr<Packet> packet, const Ipv4Header& ipHeader) const
+{
     // in case the packet still has a priority tag attached, remove it
     SocketPriorityTag priorityTag;
     packet->RemovePacketTag(priorityTag);
@@ -1096,9 +1215,13 @@ Ipv4L3Protocol::IpForward(Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv
         priorityTag.SetPriority(priority);
         packet->AddPacketTag(priorityTag);
     }
+}
 
-    m_unicastForwardTrace(ipHeader, packet, interface);
-    SendRealOut(rtentry, packet, ipHeader);
+void
+Ipv4L3Protocol::FlushForwardingCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_forwardingCache.clear();
 }
 
 void
@@ -1170,6 +1293,7 @@ Ipv4L3Protocol::AddAddress(uint32_t i, Ipv4InterfaceAddress address)
     NS_LOG_FUNCTION(this << i << address);
     Ptr<Ipv4Interface> interface = GetInterface(i);
     bool retVal = interface->AddAddress(address);
+    FlushForwardingCache();
     if (m_routingProtocol)
     {
         m_routingProtocol->NotifyAddAddress(i, address);
@@ -1201,6 +1325,7 @@ Ipv4L3Protocol::RemoveAddress(uint32_t i, uint32_t addressIndex)
     Ipv4InterfaceAddress address = interface->RemoveAddress(addressIndex);
     if (address != Ipv4InterfaceAddress())
     {
+        FlushForwardingCache();
         if (m_routingProtocol)
         {
             m_routingProtocol->NotifyRemoveAddress(i, address);
@@ -1224,6 +1349,7 @@ Ipv4L3Protocol::RemoveAddress(uint32_t i, Ipv4Address address)
     Ipv4InterfaceAddress ifAddr = interface->RemoveAddress(address);
     if (ifAddr != Ipv4InterfaceAddress())
     {
+        FlushForwardingCache();
         if (m_routingProtocol)
         {
             m_routingProtocol->NotifyRemoveAddress(i, ifAddr);
@@ -1367,6 +1493,7 @@ Ipv4L3Protocol::SetUp(uint32_t i)
     if (interface->GetDevice()->GetMtu() >= 68)
     {
         interface->SetUp();
+        FlushForwardingCache();
 
         if (m_routingProtocol)
         {
@@ -1388,6 +1515,7 @@ Ipv4L3Protocol::SetDown(uint32_t ifaceIndex)
     NS_LOG_FUNCTION(this << ifaceIndex);
     Ptr<Ipv4Interface> interface = GetInterface(ifaceIndex);
     interface->SetDown();
+    FlushForwardingCache();
 
     if (m_routingProtocol)
     {
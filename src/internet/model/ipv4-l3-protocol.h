@@ -35,6 +35,7 @@
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 class Ipv4L3ProtocolTestCase;
@@ -54,6 +55,7 @@ class Socket;
 class Ipv4RawSocketImpl;
 class IpL4Protocol;
 class Icmpv4L4Protocol;
+class TrafficControlLayer;
 
 /**
  * \ingroup ipv4
@@ -79,6 +81,23 @@ class Icmpv4L4Protocol;
  * Moreover, the actual implementation does not mimic exactly the Linux
  * kernel. Hence it is not possible, for instance, to test a fragmentation
  * attack.
+ *
+ * Nodes acting as pure routers can enable the "FastForwarding" attribute.
+ * The next hop (output interface, device and L2 address) of every destination
+ * forwarded through the routing protocol is then cached, and the next packets
+ * to that destination bypass the routing protocol callbacks, the raw socket
+ * and ARP refresh steps and the Ipv4Interface send path: their TTL is
+ * decremented in place and they are handed directly to the traffic control
+ * layer.  Only next hops reached through devices that do not need ARP are
+ * cached.  Packets needing fragmentation or an ICMP error, and packets
+ * received while raw sockets are open, take the regular path.  The cache is
+ * flushed when an interface or address of this node changes, and whenever the
+ * generation of the routes of the routing protocol changes
+ * (Ipv4RoutingProtocol::GetRoutesGeneration), e.g., when a static route is
+ * added or the global routing tables are recomputed.  Nothing is cached if
+ * the routing protocol does not track its route changes.  Since the route of
+ * a destination is resolved once, per-packet route randomization (such as
+ * Ipv4GlobalRouting::RandomEcmpRouting) is not applied to cached destinations.
  */
 class Ipv4L3Protocol : public Ipv4
 {
@@ -277,6 +296,15 @@ class Ipv4L3Protocol : public Ipv4
                                        Ptr<Ipv4> ipv4,
                                        uint32_t interface);
 
+    /**
+     * \brief Remove all the next hops cached in fast forwarding mode.
+     *
+     * The cache is flushed automatically when the routes change, so this is
+     * only needed if a routing protocol changes its routes without advancing
+     * their generation.
+     */
+    void FlushForwardingCache();
+
   protected:
     void DoDispose() override;
     /**
@@ -428,6 +456,30 @@ class Ipv4L3Protocol : public Ipv4
      */
     bool ProcessFragment(Ptr<Packet>& packet, Ipv4Header& ipHeader, uint32_t iif);
 
+    /**
+     * \brief Forward a received packet using the cached next hop of its destination.
+     * \param packet the packet, without its IP header
+     * \param ipHeader the IP header, whose TTL is decremented if the packet is forwarded
+     * \param iif Input Interface
+     * \return true if the packet has been forwarded, false if it has to take the regular path
+     */
+    bool FastForward(Ptr<Packet> packet, Ipv4Header& ipHeader, uint32_t iif);
+
+    /**
+     * \brief Cache the next hop of a forwarded packet, if it is eligible to fast forwarding.
+     * \param rtentry the route used to forward the packet
+     * \param ipHeader the IP header of the packet
+     * \param interface the output interface index
+     */
+    void CacheNextHop(Ptr<Ipv4Route> rtentry, const Ipv4Header& ipHeader, int32_t interface);
+
+    /**
+     * \brief Replace the priority tag of a forwarded packet by one derived from its TOS
+     * \param packet the packet
+     * \param ipHeader the IP header of the packet
+     */
+    void SetForwardingPriority(Ptr<Packet> packet, const Ipv4Header& ipHeader) const;
+
     /**
      * \brief Make a copy of the packet, add the header and invoke the TX trace callback
      * \param ipHeader the IP header that will be added to the packet
@@ -639,6 +691,24 @@ class Ipv4L3Protocol : public Ipv4
     Time m_purge;       //!< time between purging expired duplicate entries
     EventId m_cleanDpd; //!< event to cleanup expired duplicate entries
 
+    /**
+     * \brief Next hop of a destination, precomputed for fast forwarding.
+     */
+    struct NextHop
+    {
+        Ptr<Ipv4Interface> interface;  //!< Output interface
+        uint32_t interfaceIndex;       //!< Output interface index
+        Ptr<NetDevice> device;         //!< Output device
+        Ptr<TrafficControlLayer> tc;   //!< Traffic control layer of the output device
+        Address hardwareDestination;   //!< L2 destination address
+    };
+
+    bool m_fastForwarding; //!< Forward packets using cached next hops
+    std::unordered_map<Ipv4Address, NextHop, Ipv4AddressHash>
+        m_forwardingCache; //!< Next hops, by destination address
+    /// Generation of the routes the cached next hops were resolved with
+    uint64_t m_forwardingCacheGeneration{0};
+
     Ipv4RoutingProtocol::UnicastForwardCallback m_ucb;   ///< Unicast forward callback
     Ipv4RoutingProtocol::MulticastForwardCallback m_mcb; ///< Multicast forward callback
     Ipv4RoutingProtocol::LocalDeliverCallback m_lcb;     ///< Local delivery callback
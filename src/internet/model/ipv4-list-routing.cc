@@ -45,6 +45,7 @@ Ipv4ListRouting::Ipv4ListRouting()
     : m_ipv4(nullptr)
 {
     NS_LOG_FUNCTION(this);
+    NotifyRoutesChanged();
 }
 
 Ipv4ListRouting::~Ipv4ListRouting()
@@ -247,12 +248,30 @@ Ipv4ListRouting::SetIpv4(Ptr<Ipv4> ipv4)
     m_ipv4 = ipv4;
 }
 
+uint64_t
+Ipv4ListRouting::GetRoutesGeneration() const
+{
+    // the generations only grow, so their sum changes whenever one of them does
+    uint64_t generation = Ipv4RoutingProtocol::GetRoutesGeneration();
+    for (const auto& rprotoIter : m_routingProtocols)
+    {
+        uint64_t protocolGeneration = rprotoIter.second->GetRoutesGeneration();
+        if (protocolGeneration == 0)
+        {
+            return 0;
+        }
+        generation += protocolGeneration;
+    }
+    return generation;
+}
+
 void
 Ipv4ListRouting::AddRoutingProtocol(Ptr<Ipv4RoutingProtocol> routingProtocol, int16_t priority)
 {
     NS_LOG_FUNCTION(this << routingProtocol->GetInstanceTypeId() << priority);
     m_routingProtocols.emplace_back(priority, routingProtocol);
     m_routingProtocols.sort(Compare);
+    NotifyRoutesChanged();
     if (m_ipv4)
     {
         routingProtocol->SetIpv4(m_ipv4);
@@ -101,6 +101,17 @@ class Ipv4ListRouting : public Ipv4RoutingProtocol
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                            Time::Unit unit = Time::S) const override;
 
+    /**
+     * \brief Get the generation of the routes
+     *
+     * The routes of the list change when a protocol is added to it or when the
+     * routes of one of its protocols change.
+     *
+     * \return the generation of the routes, or 0 if the route changes of a
+     *         protocol in the list are not tracked
+     */
+    uint64_t GetRoutesGeneration() const override;
+
   protected:
     void DoDispose() override;
     void DoInitialize() override;
@@ -17,9 +17,6 @@
 
 #include "ipv4-queue-disc-item.h"
 
-#include "tcp-header.h"
-#include "udp-header.h"
-
 #include "ns3/log.h"
 
 namespace ns3
@@ -115,59 +112,36 @@ Ipv4QueueDiscItem::GetUint8Value(QueueItem::Uint8Values field, uint8_t& value) c
     return ret;
 }
 
-uint32_t
-Ipv4QueueDiscItem::Hash(uint32_t perturbation) const
+uint8_t
+Ipv4QueueDiscItem::GetFlowKey(uint32_t* key) const
 {
-    NS_LOG_FUNCTION(this << perturbation);
+    NS_LOG_FUNCTION(this << key);
 
-    Ipv4Address src = m_header.GetSource();
-    Ipv4Address dest = m_header.GetDestination();
     uint8_t prot = m_header.GetProtocol();
     uint16_t fragOffset = m_header.GetFragmentOffset();
-
-    TcpHeader tcpHdr;
-    UdpHeader udpHdr;
     uint16_t srcPort = 0;
     uint16_t destPort = 0;
 
-    if (prot == 6 && fragOffset == 0) // TCP
+    // The source and destination ports are the first four bytes of both the TCP
+    // and the UDP header, hence there is no need to deserialize the whole header
+    if ((prot == 6 || prot == 17) && fragOffset == 0 && GetPacket()->GetSize() >= 4)
     {
-        GetPacket()->PeekHeader(tcpHdr);
-        srcPort = tcpHdr.GetSourcePort();
-        destPort = tcpHdr.GetDestinationPort();
-    }
-    else if (prot == 17 && fragOffset == 0) // UDP
-    {
-        GetPacket()->PeekHeader(udpHdr);
-        srcPort = udpHdr.GetSourcePort();
-        destPort = udpHdr.GetDestinationPort();
+        uint8_t ports[4];
+        GetPacket()->CopyData(ports, 4);
+        srcPort = (ports[0] << 8) | ports[1];
+        destPort = (ports[2] << 8) | ports[3];
     }
     if (prot != 6 && prot != 17)
     {
         NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
     }
 
-    /* serialize the 5-tuple and the perturbation in buf */
-    uint8_t buf[17];
-    src.Serialize(buf);
-    dest.Serialize(buf + 4);
-    buf[8] = prot;
-    buf[9] = (srcPort >> 8) & 0xff;
-    buf[10] = srcPort & 0xff;
-    buf[11] = (destPort >> 8) & 0xff;
-    buf[12] = destPort & 0xff;
-    buf[13] = (perturbation >> 24) & 0xff;
-    buf[14] = (perturbation >> 16) & 0xff;
-    buf[15] = (perturbation >> 8) & 0xff;
-    buf[16] = perturbation & 0xff;
-
-    // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
-    // already available in ns-3
-    uint32_t hash = Hash32((char*)buf, 17);
-
-    NS_LOG_DEBUG("Hash value " << hash);
-
-    return hash;
+    key[0] = m_header.GetSource().Get();
+    key[1] = m_header.GetDestination().Get();
+    key[2] = (static_cast<uint32_t>(srcPort) << 16) | destPort;
+    key[3] = prot;
+
+    return 4;
 }
 
 } // namespace ns3
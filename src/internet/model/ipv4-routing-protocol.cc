@@ -35,4 +35,16 @@ Ipv4RoutingProtocol::GetTypeId()
     return tid;
 }
 
+uint64_t
+Ipv4RoutingProtocol::GetRoutesGeneration() const
+{
+    return m_routesGeneration;
+}
+
+void
+Ipv4RoutingProtocol::NotifyRoutesChanged()
+{
+    m_routesGeneration++;
+}
+
 } // namespace ns3
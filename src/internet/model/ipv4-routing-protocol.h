@@ -181,6 +181,31 @@ class Ipv4RoutingProtocol : public Object
      */
     virtual void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                                    Time::Unit unit = Time::S) const = 0;
+
+    /**
+     * \brief Get the generation of the routes
+     *
+     * The generation changes whenever the routes of this protocol change, so
+     * that the result of a route lookup can be cached until it does (e.g., by
+     * the FastForwarding mode of Ipv4L3Protocol).  A protocol tracks its route
+     * changes by calling NotifyRoutesChanged when it is constructed and
+     * whenever its routes change; the generation of a protocol which does not
+     * is 0, which disables such caches.
+     *
+     * \return the generation of the routes, or 0 if the route changes are not tracked
+     */
+    virtual uint64_t GetRoutesGeneration() const;
+
+  protected:
+    /**
+     * \brief Notify that the routes of this protocol have changed
+     *
+     * This advances the generation of the routes.
+     */
+    void NotifyRoutesChanged();
+
+  private:
+    uint64_t m_routesGeneration{0}; //!< The generation of the routes
 };
 
 } // namespace ns3
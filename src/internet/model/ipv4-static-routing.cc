@@ -61,6 +61,7 @@ Ipv4StaticRouting::Ipv4StaticRouting()
     : m_ipv4(nullptr)
 {
     NS_LOG_FUNCTION(this);
+    NotifyRoutesChanged();
 }
 
 void
@@ -80,6 +81,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     {
         auto routePtr = new Ipv4RoutingTableEntry(route);
         m_networkRoutes.emplace_back(routePtr, metric);
+        NotifyRoutesChanged();
     }
 }
 
@@ -98,6 +100,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
         auto routePtr = new Ipv4RoutingTableEntry(route);
 
         m_networkRoutes.emplace_back(routePtr, metric);
+        NotifyRoutesChanged();
     }
 }
 
@@ -153,6 +156,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Mask networkMask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
     m_networkRoutes.emplace_back(route, 0);
+    NotifyRoutesChanged();
 }
 
 uint32_t
@@ -459,6 +463,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
         {
             delete j->first;
             m_networkRoutes.erase(j);
+            NotifyRoutesChanged();
             return;
         }
         tmp++;
@@ -633,6 +638,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
         {
             delete it->first;
             it = m_networkRoutes.erase(it);
+            NotifyRoutesChanged();
         }
         else
         {
@@ -678,6 +684,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
         {
             delete it->first;
             it = m_networkRoutes.erase(it);
+            NotifyRoutesChanged();
         }
         else
         {
@@ -152,6 +152,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     auto endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
     m_endPoints.push_back(endPoint);
+    m_tuple4EndPoints.Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -166,6 +167,7 @@ Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
+            m_tuple4EndPoints.Remove(endPoint);
             delete endPoint;
             m_endPoints.erase(i);
             break;
@@ -192,6 +194,13 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval3; /* Matches all but local address */
     EndPoints retval4; /* Exact match on all 4 */
 
+    if (Ipv6EndPoint* endP = LookupEstablished(daddr, dport, saddr, sport, incomingInterface))
+    {
+        EndPoints ret;
+        ret.push_back(endP);
+        return ret;
+    }
+
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
@@ -287,6 +296,13 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     if (!retval4.empty())
     {
         retval = retval4;
+        // The peer of this endpoint has been set after its allocation (e.g., by
+        // Connect), move it to the fast path for the next packets.
+        Ipv6EndPoint* endP = retval.front();
+        if (!m_tuple4EndPoints.Contains(endP))
+        {
+            m_tuple4EndPoints.Insert(endP);
+        }
     }
     else if (!retval3.empty())
     {
@@ -307,6 +323,24 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     return retval; // might be empty if no matches
 }
 
+Ipv6EndPoint*
+Ipv6EndPointDemux::LookupEstablished(Ipv6Address dst,
+                                     uint16_t dport,
+                                     Ipv6Address src,
+                                     uint16_t sport,
+                                     Ptr<Ipv6Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << dst << dport << src << sport << incomingInterface);
+    return m_tuple4EndPoints.Find(dst, dport, src, sport, [&](Ipv6EndPoint* endP) {
+        if (!endP->IsRxEnabled())
+        {
+            return false;
+        }
+        Ptr<NetDevice> dev = endP->GetBoundNetDevice();
+        return !dev || (incomingInterface && dev == incomingInterface->GetDevice());
+    });
+}
+
 Ipv6EndPoint*
 Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
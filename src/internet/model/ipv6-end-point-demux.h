@@ -20,6 +20,7 @@
 #ifndef IPV6_END_POINT_DEMUX_H
 #define IPV6_END_POINT_DEMUX_H
 
+#include "end-point-table.h"
 #include "ipv6-interface.h"
 
 #include "ns3/ipv6-address.h"
@@ -93,6 +94,28 @@ class Ipv6EndPointDemux
                      uint16_t sport,
                      Ptr<Ipv6Interface> incomingInterface);
 
+    /**
+     * \brief Lookup for the endpoint of an established connection.
+     *
+     * This is the fast path of Lookup(): only endpoints whose 4-tuple exactly
+     * matches the parameters are considered, and a single hash table probe
+     * is usually enough to find them.
+     *
+     * EndPoint with disabled Rx are skipped.
+     *
+     * \param dst destination address to test
+     * \param dport destination port to test
+     * \param src source address to test
+     * \param sport source port to test
+     * \param incomingInterface the incoming interface
+     * \return the matching IPv6EndPoint (nullptr if not found)
+     */
+    Ipv6EndPoint* LookupEstablished(Ipv6Address dst,
+                                    uint16_t dport,
+                                    Ipv6Address src,
+                                    uint16_t sport,
+                                    Ptr<Ipv6Interface> incomingInterface);
+
     /**
      * \brief Simple lookup for a four-tuple match.
      * \param dst destination address to test
@@ -186,6 +209,11 @@ class Ipv6EndPointDemux
      * \brief A list of IPv6 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief Endpoints of established connections, by full 4-tuple.
+     */
+    EndPointTable<Ipv6Address, Ipv6AddressHash, Ipv6EndPoint> m_tuple4EndPoints;
 };
 
 } /* namespace ns3 */
@@ -17,11 +17,10 @@
 
 #include "ipv6-queue-disc-item.h"
 
-#include "tcp-header.h"
-#include "udp-header.h"
-
 #include "ns3/log.h"
 
+#include <cstring>
+
 namespace ns3
 {
 
@@ -115,58 +114,38 @@ Ipv6QueueDiscItem::GetUint8Value(QueueItem::Uint8Values field, uint8_t& value) c
     return ret;
 }
 
-uint32_t
-Ipv6QueueDiscItem::Hash(uint32_t perturbation) const
+uint8_t
+Ipv6QueueDiscItem::GetFlowKey(uint32_t* key) const
 {
-    NS_LOG_FUNCTION(this << perturbation);
+    NS_LOG_FUNCTION(this << key);
 
-    Ipv6Address src = m_header.GetSource();
-    Ipv6Address dest = m_header.GetDestination();
     uint8_t prot = m_header.GetNextHeader();
-
-    TcpHeader tcpHdr;
-    UdpHeader udpHdr;
     uint16_t srcPort = 0;
     uint16_t destPort = 0;
 
-    if (prot == 6) // TCP
+    // The source and destination ports are the first four bytes of both the TCP
+    // and the UDP header, hence there is no need to deserialize the whole header
+    if ((prot == 6 || prot == 17) && GetPacket()->GetSize() >= 4)
     {
-        GetPacket()->PeekHeader(tcpHdr);
-        srcPort = tcpHdr.GetSourcePort();
-        destPort = tcpHdr.GetDestinationPort();
-    }
-    else if (prot == 17) // UDP
-    {
-        GetPacket()->PeekHeader(udpHdr);
-        srcPort = udpHdr.GetSourcePort();
-        destPort = udpHdr.GetDestinationPort();
+        uint8_t ports[4];
+        GetPacket()->CopyData(ports, 4);
+        srcPort = (ports[0] << 8) | ports[1];
+        destPort = (ports[2] << 8) | ports[3];
     }
     if (prot != 6 && prot != 17)
     {
         NS_LOG_WARN("Unknown transport protocol, no port number included in hash computation");
     }
 
-    /* serialize the 5-tuple and the perturbation in buf */
-    uint8_t buf[41];
-    src.Serialize(buf);
-    dest.Serialize(buf + 16);
-    buf[32] = prot;
-    buf[33] = (srcPort >> 8) & 0xff;
-    buf[34] = srcPort & 0xff;
-    buf[35] = (destPort >> 8) & 0xff;
-    buf[36] = destPort & 0xff;
-    buf[37] = (perturbation >> 24) & 0xff;
-    buf[38] = (perturbation >> 16) & 0xff;
-    buf[39] = (perturbation >> 8) & 0xff;
-    buf[40] = perturbation & 0xff;
-
-    // Linux calculates jhash2 (jenkins hash), we calculate murmur3 because it is
-    // already available in ns-3
-    uint32_t hash = Hash32((char*)buf, 41);
-
-    NS_LOG_DEBUG("Found Ipv6 packet; hash of the five tuple " << hash);
-
-    return hash;
+    uint8_t addr[16];
+    m_header.GetSource().GetBytes(addr);
+    std::memcpy(key, addr, 16);
+    m_header.GetDestination().GetBytes(addr);
+    std::memcpy(key + 4, addr, 16);
+    key[8] = (static_cast<uint32_t>(srcPort) << 16) | destPort;
+    key[9] = prot;
+
+    return 10;
 }
 
 } // namespace ns3
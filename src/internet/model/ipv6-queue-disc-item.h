@@ -93,17 +93,18 @@ class Ipv6QueueDiscItem : public QueueDiscItem
      */
     bool Mark() override;
 
+  protected:
     /**
-     * \brief Computes the hash of the packet's 5-tuple
+     * \brief Extract the packet's 5-tuple
      *
-     * Computes the hash of the source and destination IP addresses, protocol
-     * number and, if the transport protocol is either UDP or TCP, the source
-     * and destination port
+     * The flow key consists of the source and destination IP addresses, the
+     * protocol number and, if the transport protocol is either UDP or TCP, the
+     * source and destination port
      *
-     * \param perturbation hash perturbation value
-     * \return the hash of the packet's 5-tuple
+     * \param key the array to store the words of the flow key in
+     * \return the number of words of the flow key (10)
      */
-    uint32_t Hash(uint32_t perturbation) const override;
+    uint8_t GetFlowKey(uint32_t* key) const override;
 
   private:
     Ipv6Header m_header; //!< The IPv6 header.
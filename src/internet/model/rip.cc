@@ -52,6 +52,7 @@ Rip::Rip()
       m_initialized(false)
 {
     m_rng = CreateObject<UniformRandomVariable>();
+    NotifyRoutesChanged();
 }
 
 Rip::~Rip()
@@ -712,6 +713,7 @@ Rip::AddNetworkRouteTo(Ipv4Address network,
     route->SetRouteMetric(1);
     route->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
     route->SetRouteChanged(true);
+    NotifyRoutesChanged();
 
     m_routes.emplace_back(route, EventId());
 }
@@ -725,6 +727,7 @@ Rip::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkPrefix, uint32_t int
     route->SetRouteMetric(1);
     route->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
     route->SetRouteChanged(true);
+    NotifyRoutesChanged();
 
     m_routes.emplace_back(route, EventId());
 }
@@ -741,6 +744,7 @@ Rip::InvalidateRoute(RipRoutingTableEntry* route)
             route->SetRouteStatus(RipRoutingTableEntry::RIP_INVALID);
             route->SetRouteMetric(m_linkDown);
             route->SetRouteChanged(true);
+            NotifyRoutesChanged();
             if (it->second.IsRunning())
             {
                 it->second.Cancel();
@@ -764,6 +768,7 @@ Rip::DeleteRoute(RipRoutingTableEntry* route)
         {
             delete route;
             m_routes.erase(it);
+            NotifyRoutesChanged();
             return;
         }
     }
@@ -1090,6 +1095,7 @@ Rip::HandleResponses(RipHeader hdr,
                     it->first->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
                     it->first->SetRouteTag(iter->GetRouteTag());
                     it->first->SetRouteChanged(true);
+                    NotifyRoutesChanged();
                     it->second.Cancel();
                     it->second =
                         Simulator::Schedule(m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
@@ -1117,6 +1123,7 @@ Rip::HandleResponses(RipHeader hdr,
                             route->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
                             route->SetRouteTag(iter->GetRouteTag());
                             route->SetRouteChanged(true);
+                            NotifyRoutesChanged();
                             delete it->first;
                             it->first = route;
                             it->second.Cancel();
@@ -1138,6 +1145,7 @@ Rip::HandleResponses(RipHeader hdr,
                         it->first->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
                         it->first->SetRouteTag(iter->GetRouteTag());
                         it->first->SetRouteChanged(true);
+                        NotifyRoutesChanged();
                         it->second.Cancel();
                         it->second = Simulator::Schedule(m_timeoutDelay,
                                                          &Rip::InvalidateRoute,
@@ -1161,6 +1169,7 @@ Rip::HandleResponses(RipHeader hdr,
             route->SetRouteMetric(rteMetric);
             route->SetRouteStatus(RipRoutingTableEntry::RIP_VALID);
             route->SetRouteChanged(true);
+            NotifyRoutesChanged();
             m_routes.emplace_front(route, EventId());
             EventId invalidateEvent =
                 Simulator::Schedule(m_timeoutDelay, &Rip::InvalidateRoute, this, route);
@@ -470,6 +470,21 @@ TcpL4Protocol::Receive(Ptr<Packet> packet,
         return checksumControl;
     }
 
+    // Fast path: segment of an established connection
+    Ipv4EndPoint* endPoint = m_endPoints->LookupEstablished(incomingIpHeader.GetDestination(),
+                                                            incomingTcpHeader.GetDestinationPort(),
+                                                            incomingIpHeader.GetSource(),
+                                                            incomingTcpHeader.GetSourcePort(),
+                                                            incomingInterface);
+    if (endPoint)
+    {
+        endPoint->ForwardUp(packet,
+                            incomingIpHeader,
+                            incomingTcpHeader.GetSourcePort(),
+                            incomingInterface);
+        return IpL4Protocol::RX_OK;
+    }
+
     Ipv4EndPointDemux::EndPoints endPoints;
     endPoints = m_endPoints->Lookup(incomingIpHeader.GetDestination(),
                                     incomingTcpHeader.GetDestinationPort(),
@@ -546,6 +561,21 @@ TcpL4Protocol::Receive(Ptr<Packet> packet,
         return checksumControl;
     }
 
+    // Fast path: segment of an established connection
+    Ipv6EndPoint* endPoint = m_endPoints6->LookupEstablished(incomingIpHeader.GetDestination(),
+                                                             incomingTcpHeader.GetDestinationPort(),
+                                                             incomingIpHeader.GetSource(),
+                                                             incomingTcpHeader.GetSourcePort(),
+                                                             interface);
+    if (endPoint)
+    {
+        endPoint->ForwardUp(packet,
+                            incomingIpHeader,
+                            incomingTcpHeader.GetSourcePort(),
+                            interface);
+        return IpL4Protocol::RX_OK;
+    }
+
     Ipv6EndPointDemux::EndPoints endPoints =
         m_endPoints6->Lookup(incomingIpHeader.GetDestination(),
                              incomingTcpHeader.GetDestinationPort(),
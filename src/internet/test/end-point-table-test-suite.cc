@@ -0,0 +1,268 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/end-point-table.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/test.h"
+
+#include <memory>
+#include <vector>
+
+using namespace ns3;
+
+/// The table of IPv4 endpoints under test
+using Ipv4EndPointTable = EndPointTable<Ipv4Address, Ipv4AddressHash, Ipv4EndPoint>;
+
+/**
+ * \brief Predicate accepting any endpoint
+ * \return true
+ */
+static bool
+AcceptAll(Ipv4EndPoint*)
+{
+    return true;
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointTable insertion, lookup and removal test
+ *
+ * Enough endpoints are inserted to grow the table several times, half of
+ * them are removed (leaving tombstones in the probe sequences) and the
+ * remaining ones must still be found, before and after a rehash.
+ */
+class EndPointTableInsertRemoveTestCase : public TestCase
+{
+  public:
+    EndPointTableInsertRemoveTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param table the table
+     * \param endPoint an endpoint
+     * \return the endpoint found under the current 4-tuple of the endpoint
+     */
+    Ipv4EndPoint* Find(const Ipv4EndPointTable& table, Ipv4EndPoint* endPoint) const;
+};
+
+EndPointTableInsertRemoveTestCase::EndPointTableInsertRemoveTestCase()
+    : TestCase("Insert, find and remove endpoints, with tombstones and rehashes")
+{
+}
+
+Ipv4EndPoint*
+EndPointTableInsertRemoveTestCase::Find(const Ipv4EndPointTable& table,
+                                        Ipv4EndPoint* endPoint) const
+{
+    return table.Find(endPoint->GetLocalAddress(),
+                      endPoint->GetLocalPort(),
+                      endPoint->GetPeerAddress(),
+                      endPoint->GetPeerPort(),
+                      &AcceptAll);
+}
+
+void
+EndPointTableInsertRemoveTestCase::DoRun()
+{
+    const uint32_t n = 1000;
+    Ipv4EndPointTable table;
+    std::vector<std::unique_ptr<Ipv4EndPoint>> endPoints;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        endPoints.push_back(std::make_unique<Ipv4EndPoint>(Ipv4Address("10.0.0.1"), 1000 + i));
+        endPoints.back()->SetPeer(Ipv4Address(0x0a010000 + i % 7), 80);
+        table.Insert(endPoints.back().get());
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Wrong number of endpoints");
+    for (const auto& endPoint : endPoints)
+    {
+        NS_TEST_ASSERT_MSG_EQ(Find(table, endPoint.get()), endPoint.get(), "Endpoint not found");
+        NS_TEST_ASSERT_MSG_EQ(table.Contains(endPoint.get()), true, "Endpoint not contained");
+    }
+
+    // a 4-tuple with no endpoint
+    NS_TEST_ASSERT_MSG_EQ(table.Find(Ipv4Address("10.0.0.1"),
+                                     999,
+                                     Ipv4Address("10.1.0.0"),
+                                     80,
+                                     &AcceptAll),
+                          nullptr,
+                          "Unexpected endpoint found");
+
+    for (uint32_t i = 0; i < n; i += 2)
+    {
+        NS_TEST_ASSERT_MSG_EQ(table.Remove(endPoints[i].get()), true, "Endpoint not removed");
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n / 2, "Wrong number of endpoints");
+    NS_TEST_ASSERT_MSG_EQ(table.Remove(endPoints[0].get()), false, "Endpoint removed twice");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ipv4EndPoint* expected = (i % 2 == 0) ? nullptr : endPoints[i].get();
+        NS_TEST_ASSERT_MSG_EQ(Find(table, endPoints[i].get()), expected, "Wrong lookup");
+        NS_TEST_ASSERT_MSG_EQ(table.Contains(endPoints[i].get()), (i % 2 == 1), "Wrong contains");
+    }
+
+    // reinsert the removed endpoints: the tombstones are reused or purged
+    for (uint32_t i = 0; i < n; i += 2)
+    {
+        table.Insert(endPoints[i].get());
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Wrong number of endpoints");
+    for (const auto& endPoint : endPoints)
+    {
+        NS_TEST_ASSERT_MSG_EQ(Find(table, endPoint.get()), endPoint.get(), "Endpoint not found");
+    }
+
+    // inserting an endpoint already in the table does not duplicate it
+    table.Insert(endPoints[1].get());
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), n, "Endpoint inserted twice");
+
+    for (const auto& endPoint : endPoints)
+    {
+        NS_TEST_ASSERT_MSG_EQ(table.Remove(endPoint.get()), true, "Endpoint not removed");
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 0, "The table is not empty");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointTable test of endpoints whose 4-tuple changes
+ *
+ * An endpoint whose 4-tuple changed after its insertion must not be found
+ * under its old 4-tuple nor under its new one until it is inserted again,
+ * and must be removable by pointer in both cases.
+ */
+class EndPointTableTupleChangeTestCase : public TestCase
+{
+  public:
+    EndPointTableTupleChangeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EndPointTableTupleChangeTestCase::EndPointTableTupleChangeTestCase()
+    : TestCase("Find, move and remove endpoints whose 4-tuple changed")
+{
+}
+
+void
+EndPointTableTupleChangeTestCase::DoRun()
+{
+    Ipv4EndPointTable table;
+    Ipv4EndPoint a(Ipv4Address("10.0.0.1"), 1000);
+    a.SetPeer(Ipv4Address("10.0.0.2"), 80);
+    Ipv4EndPoint b(Ipv4Address("10.0.0.1"), 1001);
+    b.SetPeer(Ipv4Address("10.0.0.2"), 80);
+    table.Insert(&a);
+    table.Insert(&b);
+
+    a.SetPeer(Ipv4Address("10.0.0.3"), 8080);
+    NS_TEST_ASSERT_MSG_EQ(table.Contains(&a), false, "Endpoint contained under its old 4-tuple");
+    NS_TEST_ASSERT_MSG_EQ(
+        table.Find(Ipv4Address("10.0.0.1"), 1000, Ipv4Address("10.0.0.2"), 80, &AcceptAll),
+        nullptr,
+        "Endpoint found under its old 4-tuple");
+    NS_TEST_ASSERT_MSG_EQ(
+        table.Find(Ipv4Address("10.0.0.1"), 1000, Ipv4Address("10.0.0.3"), 8080, &AcceptAll),
+        nullptr,
+        "Endpoint found under a 4-tuple it was not inserted with");
+
+    // Insert moves the endpoint under its new 4-tuple
+    table.Insert(&a);
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 2, "Endpoint inserted twice");
+    NS_TEST_ASSERT_MSG_EQ(table.Contains(&a), true, "Endpoint not contained");
+    NS_TEST_ASSERT_MSG_EQ(
+        table.Find(Ipv4Address("10.0.0.1"), 1000, Ipv4Address("10.0.0.3"), 8080, &AcceptAll),
+        &a,
+        "Endpoint not found under its new 4-tuple");
+
+    // Remove finds the endpoint by pointer, whatever its current 4-tuple
+    b.SetLocalAddress(Ipv4Address("10.0.1.1"));
+    NS_TEST_ASSERT_MSG_EQ(table.Remove(&b), true, "Endpoint not removed");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 1, "Wrong number of endpoints");
+    NS_TEST_ASSERT_MSG_EQ(table.Remove(&b), false, "Endpoint removed twice");
+    NS_TEST_ASSERT_MSG_EQ(table.Remove(&a), true, "Endpoint not removed");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 0, "The table is not empty");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointTable test of endpoints sharing a 4-tuple
+ */
+class EndPointTableSharedTupleTestCase : public TestCase
+{
+  public:
+    EndPointTableSharedTupleTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EndPointTableSharedTupleTestCase::EndPointTableSharedTupleTestCase()
+    : TestCase("Find the endpoint accepted by the predicate among endpoints sharing a 4-tuple")
+{
+}
+
+void
+EndPointTableSharedTupleTestCase::DoRun()
+{
+    Ipv4EndPointTable table;
+    Ipv4EndPoint a(Ipv4Address("10.0.0.1"), 1000);
+    a.SetPeer(Ipv4Address("10.0.0.2"), 80);
+    Ipv4EndPoint b(Ipv4Address("10.0.0.1"), 1000);
+    b.SetPeer(Ipv4Address("10.0.0.2"), 80);
+    table.Insert(&a);
+    table.Insert(&b);
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 2, "Wrong number of endpoints");
+
+    Ipv4EndPoint* found = table.Find(Ipv4Address("10.0.0.1"),
+                                     1000,
+                                     Ipv4Address("10.0.0.2"),
+                                     80,
+                                     [&b](Ipv4EndPoint* endPoint) { return endPoint == &b; });
+    NS_TEST_ASSERT_MSG_EQ(found, &b, "Wrong endpoint found");
+
+    table.Remove(&a);
+    found = table.Find(Ipv4Address("10.0.0.1"), 1000, Ipv4Address("10.0.0.2"), 80, &AcceptAll);
+    NS_TEST_ASSERT_MSG_EQ(found, &b, "Endpoint not found after the removal of the other one");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointTable test suite
+ */
+class EndPointTableTestSuite : public TestSuite
+{
+  public:
+    EndPointTableTestSuite();
+};
+
+EndPointTableTestSuite::EndPointTableTestSuite()
+    : TestSuite("end-point-table", UNIT)
+{
+    AddTestCase(new EndPointTableInsertRemoveTestCase, TestCase::QUICK);
+    AddTestCase(new EndPointTableTupleChangeTestCase, TestCase::QUICK);
+    AddTestCase(new EndPointTableSharedTupleTestCase, TestCase::QUICK);
+}
+
+static EndPointTableTestSuite g_endPointTableTestSuite; //!< Static variable for test initialization
@@ -562,6 +562,17 @@ Buffer::CreateFullCopy() const
     return *this;
 }
 
+uint32_t
+Buffer::GetZeroAreaOffset() const
+{
+    NS_LOG_FUNCTION(this);
+    if (m_zeroAreaStart == m_zeroAreaEnd)
+    {
+        return GetSize();
+    }
+    return m_zeroAreaStart - m_start;
+}
+
 uint32_t
 Buffer::GetSerializedSize() const
 {
@@ -752,14 +763,8 @@ Buffer::CopyData(uint8_t* buffer, uint32_t size) const
         if (size > 0)
         {
             tmpsize = std::min(m_zeroAreaEnd - m_zeroAreaStart, size);
-            uint32_t left = tmpsize;
-            while (left > 0)
-            {
-                uint32_t toWrite = std::min(left, g_zeroes.size);
-                memcpy(buffer, g_zeroes.buffer, toWrite);
-                left -= toWrite;
-                buffer += toWrite;
-            }
+            memset(buffer, 0, tmpsize);
+            buffer += tmpsize;
             size -= tmpsize;
             if (size > 0)
             {
@@ -595,6 +595,18 @@ class Buffer
      */
     uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
 
+    /**
+     * \brief Return the offset of the zero-filled area of the buffer
+     *
+     * The bytes preceding this offset are stored in memory (e.g., the headers
+     * added to a packet created with a zero-filled payload), while the bytes
+     * of the zero-filled area are virtual.
+     *
+     * \return the offset of the zero-filled area, or the size of the buffer
+     *         if it has no such area.
+     */
+    uint32_t GetZeroAreaOffset() const;
+
     /**
      * Copy the specified amount of data from the buffer to the given output stream.
      *
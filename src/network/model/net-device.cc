@@ -20,6 +20,8 @@
 #include "net-device.h"
 
 #include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-item.h"
 
 namespace ns3
 {
@@ -40,4 +42,21 @@ NetDevice::~NetDevice()
     NS_LOG_FUNCTION(this);
 }
 
+uint32_t
+NetDevice::SendBatch(const std::vector<Ptr<QueueDiscItem>>& items, std::vector<bool>& sent)
+{
+    NS_LOG_FUNCTION(this << items.size());
+    Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface>();
+    sent.clear();
+    for (const auto& item : items)
+    {
+        if (ndqi && ndqi->IsTxQueueStopped(item->GetTxQueueIndex()))
+        {
+            break;
+        }
+        sent.push_back(Send(item->GetPacket(), item->GetAddress(), item->GetProtocol()));
+    }
+    return sent.size();
+}
+
 } // namespace ns3
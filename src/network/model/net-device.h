@@ -30,12 +30,14 @@
 #include "ns3/ptr.h"
 
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -264,6 +266,23 @@ class NetDevice : public Object
                           const Address& source,
                           const Address& dest,
                           uint16_t protocolNumber) = 0;
+    /**
+     * \param items the packets to send, each with its destination address and
+     *        protocol number
+     * \param sent filled with whether the Send operation succeeded for each
+     *        packet consumed
+     *
+     *  Called from higher layer to send a batch of packets into the Network
+     *  Device. The packets are consumed (sent or dropped) in order, until the
+     *  transmission queue of the next packet is stopped, e.g., because the
+     *  device queue is full: the remaining packets are left to the caller.
+     *  The default implementation calls Send on each packet; devices may
+     *  override it to amortize per-packet work across the batch.
+     *
+     * \return the number of packets consumed
+     */
+    virtual uint32_t SendBatch(const std::vector<Ptr<QueueDiscItem>>& items,
+                               std::vector<bool>& sent);
     /**
      * \returns the node base class which contains this network
      *          interface.
@@ -19,6 +19,7 @@
 #include "packet.h"
 
 #include "ns3/assert.h"
+#include "ns3/live-counter.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
@@ -32,6 +33,13 @@ NS_LOG_COMPONENT_DEFINE("Packet");
 
 uint32_t Packet::m_globalUid = 0;
 
+LiveCounter&
+Packet::GetLiveCounter()
+{
+    static LiveCounter counter("ns3_packets_live", "Number of live packets.");
+    return counter;
+}
+
 TypeId
 ByteTagIterator::Item::GetTypeId() const
 {
@@ -398,6 +406,12 @@ Packet::RemoveAllByteTags()
     m_byteTagList.RemoveAll();
 }
 
+uint32_t
+Packet::GetZeroPayloadOffset() const
+{
+    return m_buffer.GetZeroAreaOffset();
+}
+
 uint32_t
 Packet::CopyData(uint8_t* buffer, uint32_t size) const
 {
@@ -30,6 +30,7 @@
 
 #include "ns3/assert.h"
 #include "ns3/callback.h"
+#include "ns3/live-counter.h"
 #include "ns3/mac48-address.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -310,6 +311,17 @@ class Packet : public SimpleRefCount<Packet>
      * \returns the size in bytes of the packet
      */
     inline uint32_t GetSize() const;
+    /**
+     * \brief Returns the number of bytes of the packet preceding its zero-filled
+     * initial payload, i.e., the size of the headers added to a packet created
+     * with a zero-filled payload.
+     *
+     * Copying these bytes only (see CopyData) does not involve the payload.
+     *
+     * \returns the offset of the zero-filled payload, or the size of the packet
+     *          if it has no such payload
+     */
+    uint32_t GetZeroPayloadOffset() const;
     /**
      * \brief Add header to this packet.
      *
@@ -803,6 +815,12 @@ class Packet : public SimpleRefCount<Packet>
      */
     uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
 
+    /**
+     * Get the counter of live packets.
+     * \returns The counter of live packets.
+     */
+    static LiveCounter& GetLiveCounter();
+
     Buffer m_buffer;               //!< the packet buffer (it's actual contents)
     ByteTagList m_byteTagList;     //!< the ByteTag list
     PacketTagList m_packetTagList; //!< the packet's Tag list
@@ -814,6 +832,9 @@ class Packet : public SimpleRefCount<Packet>
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
     static uint32_t m_globalUid; //!< Global counter of packets Uid
+
+    /// Counts the live packets
+    [[no_unique_address]] LiveCount<&Packet::GetLiveCounter> m_liveCount;
 };
 
 /**
@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ring-buffer.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <deque>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ *
+ * \brief RingBuffer test against std::deque
+ *
+ * Random insertions and erasures at both ends and in the middle are applied
+ * to a RingBuffer and to a std::deque, whose contents must remain equal
+ * while the buffer grows and wraps around.
+ */
+class RingBufferDequeTestCase : public TestCase
+{
+  public:
+    RingBufferDequeTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param buffer the ring buffer
+     * \param reference the deque with the expected elements
+     * \return true if the buffer holds the same elements as the deque
+     */
+    static bool Equal(const RingBuffer<int>& buffer, const std::deque<int>& reference);
+};
+
+RingBufferDequeTestCase::RingBufferDequeTestCase()
+    : TestCase("Apply random operations to a RingBuffer and to a std::deque")
+{
+}
+
+bool
+RingBufferDequeTestCase::Equal(const RingBuffer<int>& buffer, const std::deque<int>& reference)
+{
+    return buffer.size() == reference.size() &&
+           std::equal(buffer.begin(), buffer.end(), reference.begin());
+}
+
+void
+RingBufferDequeTestCase::DoRun()
+{
+    auto rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    RingBuffer<int> buffer;
+    std::deque<int> reference;
+    NS_TEST_ASSERT_MSG_EQ(buffer.empty(), true, "A new buffer is not empty");
+
+    for (int value = 0; value < 20000; value++)
+    {
+        // grow to a few hundred elements, then shrink, so that both the
+        // doubling of the capacity and the wrap-around are exercised
+        uint32_t op = rng->GetInteger(0, 9);
+        bool shrink = (value / 5000) % 2 == 1;
+        if (!reference.empty() && (shrink ? op < 6 : op < 3))
+        {
+            switch (op % 3)
+            {
+            case 0:
+                buffer.pop_front();
+                reference.pop_front();
+                break;
+            case 1:
+                buffer.pop_back();
+                reference.pop_back();
+                break;
+            default: {
+                auto i = rng->GetInteger(0, reference.size() - 1);
+                auto it = buffer.erase(buffer.begin() + i);
+                reference.erase(reference.begin() + i);
+                NS_TEST_ASSERT_MSG_EQ((it == buffer.begin() + i), true, "Wrong iterator returned");
+            }
+            }
+        }
+        else
+        {
+            switch (op % 3)
+            {
+            case 0:
+                buffer.push_back(value);
+                reference.push_back(value);
+                break;
+            case 1:
+                buffer.push_front(value);
+                reference.push_front(value);
+                break;
+            default: {
+                auto i = rng->GetInteger(0, reference.size());
+                auto it = buffer.insert(buffer.begin() + i, value);
+                reference.insert(reference.begin() + i, value);
+                NS_TEST_ASSERT_MSG_EQ(*it, value, "Wrong iterator returned");
+            }
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(Equal(buffer, reference), true, "Contents differ at step " << value);
+        if (!reference.empty())
+        {
+            NS_TEST_ASSERT_MSG_EQ(buffer.front(), reference.front(), "Wrong front element");
+            NS_TEST_ASSERT_MSG_EQ(buffer.back(), reference.back(), "Wrong back element");
+        }
+    }
+
+    std::size_t capacity = buffer.capacity();
+    buffer.clear();
+    NS_TEST_ASSERT_MSG_EQ(buffer.empty(), true, "The buffer is not empty after clear");
+    NS_TEST_ASSERT_MSG_EQ(buffer.capacity(), capacity, "The capacity changed on clear");
+}
+
+/**
+ * \ingroup network-test
+ *
+ * \brief RingBuffer test of the capacity and of the release of erased elements
+ */
+class RingBufferCapacityTestCase : public TestCase
+{
+  public:
+    RingBufferCapacityTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RingBufferCapacityTestCase::RingBufferCapacityTestCase()
+    : TestCase("Check the capacity of a RingBuffer and the release of erased elements")
+{
+}
+
+void
+RingBufferCapacityTestCase::DoRun()
+{
+    RingBuffer<Ptr<Object>> buffer;
+    NS_TEST_ASSERT_MSG_EQ(buffer.capacity(), 0, "A new buffer allocated memory");
+
+    // in the FIFO case, the capacity does not grow beyond the peak occupancy
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        buffer.push_back(CreateObject<Object>());
+        if (buffer.size() > 10)
+        {
+            buffer.pop_front();
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(buffer.size(), 10, "Wrong size");
+    NS_TEST_ASSERT_MSG_EQ(buffer.capacity(), 16, "The capacity grew beyond the peak occupancy");
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        buffer.push_back(CreateObject<Object>());
+    }
+    NS_TEST_ASSERT_MSG_EQ(buffer.capacity(), 128, "The capacity is not a power of 2");
+
+    // an erased element is released at once
+    Ptr<Object> object = CreateObject<Object>();
+    buffer.push_front(object);
+    NS_TEST_ASSERT_MSG_EQ(object->GetReferenceCount(), 2, "Wrong reference count");
+    buffer.pop_front();
+    NS_TEST_ASSERT_MSG_EQ(object->GetReferenceCount(), 1, "Popped element not released");
+    buffer.insert(buffer.begin() + 50, object);
+    buffer.erase(buffer.begin() + 50);
+    NS_TEST_ASSERT_MSG_EQ(object->GetReferenceCount(), 1, "Erased element not released");
+    buffer.push_back(object);
+    buffer.clear();
+    NS_TEST_ASSERT_MSG_EQ(object->GetReferenceCount(), 1, "Cleared element not released");
+}
+
+/**
+ * \ingroup network-test
+ *
+ * \brief RingBuffer test suite
+ */
+class RingBufferTestSuite : public TestSuite
+{
+  public:
+    RingBufferTestSuite();
+};
+
+RingBufferTestSuite::RingBufferTestSuite()
+    : TestSuite("ring-buffer", UNIT)
+{
+    AddTestCase(new RingBufferDequeTestCase, TestCase::QUICK);
+    AddTestCase(new RingBufferCapacityTestCase, TestCase::QUICK);
+}
+
+static RingBufferTestSuite g_ringBufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,424 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-file-writer.h"
+
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::AsyncFileWriter and ns3::AsyncStreamBuf implementations.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncFileWriter");
+
+/**
+ * \relates AsyncFileWriter
+ * \anchor GlobalValueAsyncTraceWrite
+ * \brief Whether trace files are written by a background thread.
+ */
+static GlobalValue g_asyncTraceWrite =
+    GlobalValue("AsyncTraceWrite",
+                "Whether pcap and ascii trace files are written by a background thread",
+                BooleanValue(false),
+                MakeBooleanChecker());
+
+/**
+ * \relates AsyncFileWriter
+ * \anchor GlobalValueAsyncTraceBufferSize
+ * \brief The size of the ring buffer of each trace file written asynchronously.
+ */
+static GlobalValue g_asyncTraceBufferSize =
+    GlobalValue("AsyncTraceBufferSize",
+                "The size in bytes of the ring buffer of each trace file written by the "
+                "background thread",
+                UintegerValue(4 * 1024 * 1024),
+                MakeUintegerChecker<uint32_t>(4096));
+
+/**
+ * \relates AsyncFileWriter
+ * \anchor GlobalValueAsyncTraceDropOnOverflow
+ * \brief Whether trace records are dropped when the ring buffer is full.
+ */
+static GlobalValue g_asyncTraceDropOnOverflow =
+    GlobalValue("AsyncTraceDropOnOverflow",
+                "Whether trace records are dropped (rather than the simulation waiting) when "
+                "the ring buffer of a trace file written by the background thread is full",
+                BooleanValue(false),
+                MakeBooleanChecker());
+
+namespace
+{
+
+/**
+ * \ingroup network
+ * \brief The background thread draining the rings of all the AsyncFileWriter objects
+ *
+ * The thread is started when the first writer is registered and stopped at
+ * exit, after writing the pending bytes of the writers that still exist.
+ */
+class AsyncWriterThread
+{
+  public:
+    /**
+     * \return the background thread, started on the first call
+     */
+    static AsyncWriterThread* Get()
+    {
+        // Never deleted: writers may be destroyed during static destruction
+        static AsyncWriterThread* thread = [] {
+            auto t = new AsyncWriterThread();
+            std::atexit([] { Get()->Stop(); });
+            return t;
+        }();
+        return thread;
+    }
+
+    /**
+     * \brief Start draining a writer
+     * \param writer the writer
+     */
+    void Register(AsyncFileWriter* writer)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writers.push_back(writer);
+    }
+
+    /**
+     * \brief Stop draining a writer, the ring of which must be empty
+     * \param writer the writer
+     */
+    void Unregister(AsyncFileWriter* writer)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writers.erase(std::remove(m_writers.begin(), m_writers.end(), writer), m_writers.end());
+    }
+
+    /// \brief Make the thread drain the rings without waiting for the next period
+    void Wake()
+    {
+        m_wake.store(true, std::memory_order_relaxed);
+        m_wakeCv.notify_one();
+    }
+
+    /**
+     * \brief Write the pending bytes of a writer and flush its file
+     *
+     * The caller is the producer of the writer, hence no bytes are pushed
+     * meanwhile and a single drain with the lock held empties the ring.
+     *
+     * \param writer the writer
+     * \param flush the function flushing the file, called with the lock held
+     */
+    template <typename F>
+    void Flush(AsyncFileWriter* writer, F flush)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writer->Drain();
+        flush();
+    }
+
+  private:
+    AsyncWriterThread()
+        : m_wake(false),
+          m_stop(false),
+          m_thread(&AsyncWriterThread::Run, this)
+    {
+    }
+
+    /// \brief Stop the thread and write the pending bytes of all the writers
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeCv.notify_one();
+        m_thread.join();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto writer : m_writers)
+        {
+            writer->Drain();
+        }
+    }
+
+    /// \brief The body of the thread
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop)
+        {
+            bool busy = false;
+            for (auto writer : m_writers)
+            {
+                busy |= writer->Drain();
+            }
+            if (busy)
+            {
+                // Let the producers waiting for the lock in
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+                continue;
+            }
+            m_wakeCv.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return m_wake.load(std::memory_order_relaxed) || m_stop;
+            });
+            m_wake.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    std::mutex m_mutex;                      //!< protects the writers and the files
+    std::condition_variable m_wakeCv;        //!< wakes the thread up
+    std::vector<AsyncFileWriter*> m_writers; //!< the registered writers
+    std::atomic<bool> m_wake;                //!< whether a producer asked for a drain
+    bool m_stop;                             //!< whether the thread must stop
+    std::thread m_thread;                    //!< the thread
+};
+
+} // namespace
+
+bool
+AsyncFileWriter::GetTraceConfig(uint32_t& capacity, OverflowPolicy& policy)
+{
+    BooleanValue enabled;
+    g_asyncTraceWrite.GetValue(enabled);
+    UintegerValue size;
+    g_asyncTraceBufferSize.GetValue(size);
+    BooleanValue drop;
+    g_asyncTraceDropOnOverflow.GetValue(drop);
+    capacity = size.Get();
+    policy = drop.Get() ? DROP : BLOCK;
+    return enabled.Get();
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& filename,
+                                 std::ios::openmode mode,
+                                 uint32_t capacity,
+                                 OverflowPolicy policy)
+    : m_policy(policy),
+      m_head(0),
+      m_tail(0),
+      m_droppedRecords(0),
+      m_droppedBytes(0)
+{
+    NS_LOG_FUNCTION(this << filename << mode << capacity << policy);
+    uint64_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    m_ring.resize(size);
+    m_mask = size - 1;
+
+    // The chunks written are large, the stream does not need a buffer of its own
+    m_file.rdbuf()->pubsetbuf(nullptr, 0);
+    m_file.open(filename, mode | std::ios::out);
+    AsyncWriterThread::Get()->Register(this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    NS_LOG_FUNCTION(this);
+    Flush();
+    AsyncWriterThread::Get()->Unregister(this);
+    m_file.close();
+    if (m_droppedRecords > 0)
+    {
+        NS_LOG_WARN("Dropped " << m_droppedRecords << " records (" << m_droppedBytes
+                               << " bytes)");
+    }
+}
+
+bool
+AsyncFileWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+uint64_t
+AsyncFileWriter::GetFree() const
+{
+    return m_ring.size() - (m_head.load(std::memory_order_relaxed) -
+                            m_tail.load(std::memory_order_acquire));
+}
+
+void
+AsyncFileWriter::Push(const char* data, uint32_t size)
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t offset = head & m_mask;
+    uint64_t first = std::min<uint64_t>(size, m_ring.size() - offset);
+    std::memcpy(&m_ring[offset], data, first);
+    std::memcpy(m_ring.data(), data + first, size - first);
+    m_head.store(head + size, std::memory_order_release);
+}
+
+bool
+AsyncFileWriter::Write(const void* data, uint32_t size)
+{
+    uint64_t quarter = m_ring.size() / 4;
+    bool wasBelow = m_ring.size() - GetFree() < quarter;
+    auto bytes = static_cast<const char*>(data);
+
+    if (m_policy == DROP)
+    {
+        if (GetFree() < size)
+        {
+            m_droppedRecords++;
+            m_droppedBytes += size;
+            AsyncWriterThread::Get()->Wake();
+            return false;
+        }
+        Push(bytes, size);
+    }
+    else
+    {
+        // A record larger than the ring is written in pieces
+        while (size > 0)
+        {
+            uint64_t free = GetFree();
+            if (free == 0)
+            {
+                // Make room by writing the ring from this thread
+                AsyncWriterThread::Get()->Flush(this, [] {});
+                continue;
+            }
+            uint32_t n = std::min<uint64_t>(free, size);
+            Push(bytes, n);
+            bytes += n;
+            size -= n;
+        }
+    }
+
+    // Wake the thread up once per quarter of the ring rather than at each record
+    if (wasBelow && m_ring.size() - GetFree() >= quarter)
+    {
+        AsyncWriterThread::Get()->Wake();
+    }
+    return true;
+}
+
+bool
+AsyncFileWriter::Drain()
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+        return false;
+    }
+    uint64_t offset = tail & m_mask;
+    uint64_t first = std::min<uint64_t>(head - tail, m_ring.size() - offset);
+    m_file.write(&m_ring[offset], first);
+    if (head - tail > first)
+    {
+        m_file.write(m_ring.data(), head - tail - first);
+    }
+    m_tail.store(head, std::memory_order_release);
+    return true;
+}
+
+void
+AsyncFileWriter::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    AsyncWriterThread::Get()->Flush(this, [this] { m_file.flush(); });
+}
+
+uint64_t
+AsyncFileWriter::GetDroppedRecords() const
+{
+    return m_droppedRecords;
+}
+
+uint64_t
+AsyncFileWriter::GetDroppedBytes() const
+{
+    return m_droppedBytes;
+}
+
+AsyncStreamBuf::AsyncStreamBuf(AsyncFileWriter* writer)
+    : m_writer(writer),
+      m_buffer(BUFFER_SIZE)
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+AsyncStreamBuf::~AsyncStreamBuf()
+{
+    PushBuffer(false);
+}
+
+void
+AsyncStreamBuf::PushBuffer(bool wholeLines)
+{
+    std::size_t size = pptr() - pbase();
+    if (wholeLines)
+    {
+        auto end = std::make_reverse_iterator(pbase());
+        auto last = std::find(std::make_reverse_iterator(pptr()), end, '\n');
+        if (last != end)
+        {
+            size = last.base() - pbase();
+        }
+    }
+    if (size > 0)
+    {
+        m_writer->Write(pbase(), size);
+    }
+    // Move the remaining characters (an incomplete line) to the front
+    std::size_t remaining = pptr() - pbase() - size;
+    std::memmove(m_buffer.data(), pbase() + size, remaining);
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    pbump(remaining);
+}
+
+AsyncStreamBuf::int_type
+AsyncStreamBuf::overflow(int_type ch)
+{
+    PushBuffer(true);
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int
+AsyncStreamBuf::sync()
+{
+    PushBuffer(false);
+    return 0;
+}
+
+} // namespace ns3
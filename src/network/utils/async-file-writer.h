@@ -0,0 +1,197 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::AsyncFileWriter and ns3::AsyncStreamBuf declarations.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief A file written by a background thread
+ *
+ * The bytes written are copied into a ring buffer of fixed capacity, from
+ * which a background thread writes them to the file in large chunks. There is
+ * a single producer (the simulation thread) and a single consumer (the
+ * background thread) per ring, hence the ring is lock free: each side only
+ * updates its own position. One background thread, started on demand, serves
+ * all the writers of the process.
+ *
+ * When the ring is full, the producer either writes the ring to the file
+ * itself, as if the file were written synchronously (BLOCK), or discards the
+ * whole record (DROP), hence the memory used does not depend on the rate at
+ * which records are written.
+ *
+ * The trace files of PcapFileWrapper and of the OutputStreamWrapper objects
+ * created with a file name are written this way when the "AsyncTraceWrite"
+ * global value is true.
+ */
+class AsyncFileWriter
+{
+  public:
+    /// What to do with a record that does not fit in the ring
+    enum OverflowPolicy
+    {
+        BLOCK, //!< write the ring to the file from the calling thread
+        DROP   //!< discard the record
+    };
+
+    /**
+     * \brief Get the configuration of the trace files written asynchronously
+     *
+     * The configuration is given by the "AsyncTraceWrite",
+     * "AsyncTraceBufferSize" and "AsyncTraceDropOnOverflow" global values.
+     *
+     * \param capacity the capacity of the ring of each file in bytes
+     * \param policy the overflow policy
+     * \return true if trace files are written asynchronously
+     */
+    static bool GetTraceConfig(uint32_t& capacity, OverflowPolicy& policy);
+
+    /**
+     * \brief Open the file and register the writer with the background thread
+     * \param filename the name of the file
+     * \param mode the open mode of the file (std::ios::out is implied)
+     * \param capacity the capacity of the ring in bytes (rounded up to a power of 2)
+     * \param policy the overflow policy
+     */
+    AsyncFileWriter(const std::string& filename,
+                    std::ios::openmode mode,
+                    uint32_t capacity,
+                    OverflowPolicy policy);
+    /// Write the pending bytes and close the file
+    ~AsyncFileWriter();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * \return true if the file was opened
+     */
+    bool IsOpen() const;
+
+    /**
+     * \brief Write a record
+     *
+     * With the DROP policy, a record is either written entirely or not at all.
+     *
+     * \param data the bytes of the record
+     * \param size the size of the record in bytes
+     * \return false if the record was dropped
+     */
+    bool Write(const void* data, uint32_t size);
+
+    /// \brief Wait until the pending bytes are written and flush the file
+    void Flush();
+
+    /**
+     * \return the number of records dropped so far
+     */
+    uint64_t GetDroppedRecords() const;
+
+    /**
+     * \return the number of bytes dropped so far
+     */
+    uint64_t GetDroppedBytes() const;
+
+    /**
+     * \brief Write the available bytes of the ring to the file
+     *
+     * Called by the background thread, or by the producer when it waits for
+     * room (the calls are serialized by the background thread).
+     *
+     * \return true if some bytes were written
+     */
+    bool Drain();
+
+  private:
+    /**
+     * \brief Copy bytes into the ring, there must be enough room
+     * \param data the bytes
+     * \param size the number of bytes
+     */
+    void Push(const char* data, uint32_t size);
+
+    /**
+     * \return the number of free bytes in the ring
+     */
+    uint64_t GetFree() const;
+
+    std::ofstream m_file;         //!< the file, written by the background thread
+    std::vector<char> m_ring;     //!< the ring buffer
+    uint64_t m_mask;              //!< capacity of the ring minus one
+    OverflowPolicy m_policy;      //!< the overflow policy
+    std::atomic<uint64_t> m_head; //!< total bytes pushed (updated by the producer)
+    std::atomic<uint64_t> m_tail; //!< total bytes written (updated by the consumer)
+    uint64_t m_droppedRecords;    //!< number of records dropped
+    uint64_t m_droppedBytes;      //!< number of bytes dropped
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief A stream buffer writing to an AsyncFileWriter
+ *
+ * The characters are gathered in a small local buffer, which is pushed to the
+ * ring of the writer when it is full or when the stream is flushed. When the
+ * buffer is full, only the complete lines are pushed, so that the DROP policy
+ * discards whole lines. The formatting is still done by the caller, only the
+ * file I/O is moved to the background thread.
+ */
+class AsyncStreamBuf : public std::streambuf
+{
+  public:
+    /**
+     * \param writer the writer (not owned, must outlive the stream buffer)
+     */
+    AsyncStreamBuf(AsyncFileWriter* writer);
+    ~AsyncStreamBuf() override;
+
+  protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+  private:
+    /**
+     * \brief Push the local buffer to the writer
+     * \param wholeLines whether to keep the last incomplete line in the buffer
+     */
+    void PushBuffer(bool wholeLines);
+
+    static constexpr std::size_t BUFFER_SIZE = 8192; //!< size of the local buffer
+
+    AsyncFileWriter* m_writer;  //!< the writer
+    std::vector<char> m_buffer; //!< the local buffer
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_HASH_H
+#define FLOW_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::FlowHash declaration and implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief Hash a flow key made of a fixed number of 32-bit words
+ *
+ * This is MurmurHash3 (x86, 32 bit) applied to the words of the key, hence the
+ * result is the same as Hash32 of the 4 * N bytes of the key on a little-endian
+ * host when the seed is 0. Unlike Hash32, no Hasher object is involved and the
+ * key is not serialized: the number of words is known at compile time, and the
+ * words are scrambled independently of each other before being folded into the
+ * hash, so that the compiler can unroll and vectorize the first step.
+ *
+ * \tparam N \explicit the number of words of the key
+ * \param words the words of the key
+ * \param seed the seed (e.g., a perturbation value)
+ * \return the hash of the key
+ */
+template <std::size_t N>
+inline uint32_t
+FlowHash(const uint32_t* words, uint32_t seed)
+{
+    uint32_t k[N];
+    for (std::size_t i = 0; i < N; i++)
+    {
+        uint32_t w = words[i] * 0xcc9e2d51;
+        w = (w << 15) | (w >> 17);
+        k[i] = w * 0x1b873593;
+    }
+    uint32_t h = seed;
+    for (std::size_t i = 0; i < N; i++)
+    {
+        h ^= k[i];
+        h = (h << 13) | (h >> 19);
+        h = h * 5 + 0xe6546b64;
+    }
+    h ^= static_cast<uint32_t>(N * 4);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace ns3
+
+#endif /* FLOW_HASH_H */
@@ -25,6 +25,8 @@
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
 
+#include <bit>
+
 namespace ns3
 {
 
@@ -43,6 +45,8 @@ NetDeviceQueue::GetTypeId()
 NetDeviceQueue::NetDeviceQueue()
     : m_stoppedByDevice(false),
       m_stoppedByQueueLimits(false),
+      m_ndqi(nullptr),
+      m_index(0),
       NS_LOG_TEMPLATE_DEFINE("NetDeviceQueueInterface")
 {
     NS_LOG_FUNCTION(this);
@@ -55,6 +59,8 @@ NetDeviceQueue::~NetDeviceQueue()
     m_queueLimits = nullptr;
     m_wakeCallback.Nullify();
     m_device = nullptr;
+    m_ndqi = nullptr;
+    m_wouldOverflow = nullptr;
 }
 
 bool
@@ -64,11 +70,20 @@ NetDeviceQueue::IsStopped() const
     return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+bool
+NetDeviceQueue::WouldStop(uint32_t nPackets, uint32_t nBytes) const
+{
+    NS_LOG_FUNCTION(this << nPackets << nBytes);
+    // as in PacketEnqueued, the queue is stopped when it cannot hold another packet
+    return m_wouldOverflow && m_wouldOverflow(nPackets + 1, nBytes + m_device->GetMtu());
+}
+
 void
 NetDeviceQueue::Start()
 {
     NS_LOG_FUNCTION(this);
     m_stoppedByDevice = false;
+    UpdateState();
 }
 
 void
@@ -76,6 +91,7 @@ NetDeviceQueue::Stop()
 {
     NS_LOG_FUNCTION(this);
     m_stoppedByDevice = true;
+    UpdateState();
 }
 
 void
@@ -85,12 +101,35 @@ NetDeviceQueue::Wake()
 
     bool wasStoppedByDevice = m_stoppedByDevice;
     m_stoppedByDevice = false;
+    UpdateState();
 
     // Request the queue disc to dequeue a packet
-    if (wasStoppedByDevice && !m_wakeCallback.IsNull())
+    if (wasStoppedByDevice)
+    {
+        NotifyWake();
+    }
+}
+
+void
+NetDeviceQueue::UpdateState()
+{
+    if (m_ndqi)
+    {
+        m_ndqi->SetTxQueueStopped(m_index, m_stoppedByDevice || m_stoppedByQueueLimits);
+    }
+}
+
+void
+NetDeviceQueue::NotifyWake()
+{
+    if (!m_wakeCallback.IsNull())
     {
         m_wakeCallback();
     }
+    else if (m_ndqi)
+    {
+        m_ndqi->WakeTxQueue(m_index);
+    }
 }
 
 void
@@ -122,6 +161,7 @@ NetDeviceQueue::NotifyQueuedBytes(uint32_t bytes)
         return;
     }
     m_stoppedByQueueLimits = true;
+    UpdateState();
 }
 
 void
@@ -139,10 +179,11 @@ NetDeviceQueue::NotifyTransmittedBytes(uint32_t bytes)
     }
     bool wasStoppedByQueueLimits = m_stoppedByQueueLimits;
     m_stoppedByQueueLimits = false;
+    UpdateState();
     // Request the queue disc to dequeue a packet
-    if (wasStoppedByQueueLimits && !m_wakeCallback.IsNull())
+    if (wasStoppedByQueueLimits)
     {
-        m_wakeCallback();
+        NotifyWake();
     }
 }
 
@@ -198,6 +239,8 @@ NetDeviceQueueInterface::GetTypeId()
 }
 
 NetDeviceQueueInterface::NetDeviceQueueInterface()
+    : m_stoppedTxQueuesValid(true),
+      m_waking(false)
 {
     NS_LOG_FUNCTION(this);
 
@@ -228,7 +271,12 @@ NetDeviceQueueInterface::DoDispose()
 {
     NS_LOG_FUNCTION(this);
 
+    for (auto& tx : m_txQueuesVector)
+    {
+        tx->m_ndqi = nullptr;
+    }
     m_txQueuesVector.clear();
+    m_wakeTxQueueCallback = nullptr;
     Object::DoDispose();
 }
 
@@ -270,7 +318,14 @@ NetDeviceQueueInterface::SetNTxQueues(std::size_t numTxQueues)
     for (std::size_t i = 0; i < numTxQueues; i++)
     {
         m_txQueuesVector.push_back(m_txQueues.Create()->GetObject<NetDeviceQueue>());
+        m_txQueuesVector.back()->m_ndqi = this;
+        m_txQueuesVector.back()->m_index = i;
     }
+    m_stoppedTxQueues.assign((numTxQueues + 63) / 64, 0);
+    // the queues of a subclass may be stopped and started without the bitmap
+    // being updated, or report their state differently
+    m_stoppedTxQueuesValid = (m_txQueues.GetTypeId() == NetDeviceQueue::GetTypeId());
+    m_txQueuesToWake.assign((numTxQueues + 63) / 64, 0);
 }
 
 void
@@ -285,4 +340,69 @@ NetDeviceQueueInterface::GetSelectQueueCallback() const
     return m_selectQueueCallback;
 }
 
+std::size_t
+NetDeviceQueueInterface::SelectTxQueue(Ptr<QueueDiscItem> item) const
+{
+    if (m_selectQueueCallback)
+    {
+        return m_selectQueueCallback(item);
+    }
+    // scale the 32-bit hash to the number of queues (reciprocal_scale in Linux)
+    return (static_cast<uint64_t>(item->Hash()) * m_txQueuesVector.size()) >> 32;
+}
+
+void
+NetDeviceQueueInterface::SetWakeTxQueueCallback(WakeTxQueueCallback cb)
+{
+    m_wakeTxQueueCallback = cb;
+}
+
+void
+NetDeviceQueueInterface::SetTxQueueStopped(std::size_t i, bool stopped)
+{
+    uint64_t bit = uint64_t(1) << (i % 64);
+    if (stopped)
+    {
+        m_stoppedTxQueues[i / 64] |= bit;
+    }
+    else
+    {
+        m_stoppedTxQueues[i / 64] &= ~bit;
+    }
+}
+
+void
+NetDeviceQueueInterface::WakeTxQueue(std::size_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+
+    if (!m_wakeTxQueueCallback)
+    {
+        return;
+    }
+    m_txQueuesToWake[i / 64] |= uint64_t(1) << (i % 64);
+    if (m_waking)
+    {
+        // the queue is woken by the invocation in progress
+        return;
+    }
+
+    m_waking = true;
+    std::size_t w = 0;
+    while (w < m_txQueuesToWake.size())
+    {
+        if (m_txQueuesToWake[w] == 0)
+        {
+            w++;
+            continue;
+        }
+        std::size_t index = w * 64 + std::countr_zero(m_txQueuesToWake[w]);
+        m_txQueuesToWake[w] &= m_txQueuesToWake[w] - 1;
+        m_wakeTxQueueCallback(index);
+        // the callback may have woken queues with a lower index
+        w = 0;
+    }
+    m_waking = false;
+}
+
 } // namespace ns3
@@ -36,6 +36,7 @@ namespace ns3
 class QueueLimits;
 class NetDeviceQueueInterface;
 class QueueItem;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -80,7 +81,8 @@ class NetDeviceQueue : public Object
 
     /**
      * Called by the device to wake the queue disc associated with this
-     * device transmission queue. This is done by invoking the wake callback.
+     * device transmission queue. This is done by invoking the wake callback or,
+     * if not set, the wake callback of the NetDeviceQueueInterface.
      * This is the analogous to the netif_tx_wake_queue function of the Linux kernel.
      */
     virtual void Wake();
@@ -94,6 +96,18 @@ class NetDeviceQueue : public Object
      */
     virtual bool IsStopped() const;
 
+    /**
+     * \brief Check whether enqueuing packets in the device queue would stop this queue.
+     * \param nPackets the number of packets to enqueue
+     * \param nBytes the total size of the packets to enqueue
+     * \return true if, after the packets are enqueued, the device queue connected by
+     *         ConnectQueueTraces could not hold a packet of the MTU size anymore, hence
+     *         this queue would be stopped; false if no device queue is connected.
+     *
+     * Called by queue discs to bound the size of the batches they send to the device.
+     */
+    bool WouldStop(uint32_t nPackets, uint32_t nBytes) const;
+
     /**
      * \brief Notify this NetDeviceQueue that the NetDeviceQueueInterface was
      *        aggregated to an object.
@@ -205,11 +219,28 @@ class NetDeviceQueue : public Object
     void ConnectQueueTraces(Ptr<QueueType> queue);
 
   private:
-    bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
-    bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
-    Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
-    WakeCallback m_wakeCallback;    //!< Wake callback
-    Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+    friend class NetDeviceQueueInterface;
+
+    /**
+     * \brief Report the state of this queue to the NetDeviceQueueInterface, if any
+     */
+    void UpdateState();
+
+    /**
+     * \brief Wake the upper layers through the wake callback of this queue or,
+     *        if not set, the wake callback of the NetDeviceQueueInterface
+     */
+    void NotifyWake();
+
+    bool m_stoppedByDevice;          //!< True if the queue has been stopped by the device
+    bool m_stoppedByQueueLimits;     //!< True if the queue has been stopped by queue limits
+    Ptr<QueueLimits> m_queueLimits;  //!< Queue limits object
+    WakeCallback m_wakeCallback;     //!< Wake callback
+    Ptr<NetDevice> m_device;         //!< the netdevice aggregated to the NetDeviceQueueInterface
+    NetDeviceQueueInterface* m_ndqi; //!< the interface this queue belongs to
+    std::size_t m_index;             //!< the index of this queue in the interface
+    /// The WouldOverflow method of the device queue connected by ConnectQueueTraces
+    std::function<bool(uint32_t, uint32_t)> m_wouldOverflow;
 
     NS_LOG_TEMPLATE_DECLARE; //!< redefinition of the log component
 };
@@ -226,6 +257,16 @@ class NetDeviceQueue : public Object
  * - set the method used (by upper layers) to determine the transmission queue
  *   in which the netdevice would enqueue a given packet
  * NetDevice helpers create this interface and aggregate it to the device.
+ *
+ * The state of all the transmission queues is mirrored in a bitmap stored by
+ * this interface, so that upper layers can check whether a queue is stopped
+ * without accessing the NetDeviceQueue object. The bitmap is only used when the
+ * transmission queues are NetDeviceQueue objects: a subclass may override the
+ * way the state of a queue is changed or reported, hence IsStopped() is called
+ * on queues of any other type. Likewise, upper layers may set
+ * a single wake callback on this interface (instead of one on every queue),
+ * which is invoked with the index of each queue to wake. These make devices
+ * with many (e.g., 64) transmission queues cheap to simulate.
  */
 class NetDeviceQueueInterface : public Object
 {
@@ -299,6 +340,42 @@ class NetDeviceQueueInterface : public Object
      */
     SelectQueueCallback GetSelectQueueCallback() const;
 
+    /**
+     * \brief Select the transmission queue for a given packet
+     * \param item the packet
+     * \return the index of the selected transmission queue
+     *
+     * If the select queue callback is null, the transmission queue is selected
+     * by scaling the flow hash of the packet (which is computed once and cached
+     * in the item) to the number of transmission queues, as the skb_tx_hash
+     * function of Linux does. Otherwise, the select queue callback is invoked.
+     */
+    std::size_t SelectTxQueue(Ptr<QueueDiscItem> item) const;
+
+    /**
+     * \brief Get the status of a device transmission queue
+     * \param i the index of the queue
+     * \return true if the device transmission queue is stopped
+     *
+     * This is equivalent to GetTxQueue(i)->IsStopped(), which is only called if
+     * the transmission queues are of a subclass of NetDeviceQueue.
+     */
+    bool IsTxQueueStopped(std::size_t i) const;
+
+    /// Callback invoked to wake the upper layers for the transmission queue with the given index
+    typedef std::function<void(std::size_t)> WakeTxQueueCallback;
+
+    /**
+     * \brief Set the wake callback of this interface
+     * \param cb the callback to set
+     *
+     * The callback is invoked when a transmission queue that has no wake callback
+     * of its own is woken. Wake-ups are recorded in a bitmap and served in order
+     * of queue index; a queue woken again while the callback is being invoked for
+     * other queues is served once at the end, rather than in a nested invocation.
+     */
+    void SetWakeTxQueueCallback(WakeTxQueueCallback cb);
+
   protected:
     /**
      * \brief Dispose of the object
@@ -310,11 +387,42 @@ class NetDeviceQueueInterface : public Object
     void NotifyNewAggregate() override;
 
   private:
+    friend class NetDeviceQueue;
+
+    /**
+     * \brief Record the state of a device transmission queue
+     * \param i the index of the queue
+     * \param stopped whether the queue is stopped
+     */
+    void SetTxQueueStopped(std::size_t i, bool stopped);
+
+    /**
+     * \brief Wake the upper layers for a device transmission queue
+     * \param i the index of the queue
+     */
+    void WakeTxQueue(std::size_t i);
+
     ObjectFactory m_txQueues;                          //!< Device transmission queues TypeId
     std::vector<Ptr<NetDeviceQueue>> m_txQueuesVector; //!< Device transmission queues
     SelectQueueCallback m_selectQueueCallback;         //!< Select queue callback
+    std::vector<uint64_t> m_stoppedTxQueues;           //!< Bitmap of the stopped tx queues
+    bool m_stoppedTxQueuesValid;                       //!< Whether m_stoppedTxQueues is used
+    std::vector<uint64_t> m_txQueuesToWake;            //!< Bitmap of the tx queues to wake
+    WakeTxQueueCallback m_wakeTxQueueCallback;         //!< Wake callback of this interface
+    bool m_waking;                                     //!< Whether tx queues are being woken
 };
 
+inline bool
+NetDeviceQueueInterface::IsTxQueueStopped(std::size_t i) const
+{
+    NS_ASSERT(i < m_txQueuesVector.size());
+    if (!m_stoppedTxQueuesValid)
+    {
+        return m_txQueuesVector[i]->IsStopped();
+    }
+    return (m_stoppedTxQueues[i / 64] >> (i % 64)) & 1;
+}
+
 /**
  * Implementation of the templates declared above.
  */
@@ -334,6 +442,9 @@ NetDeviceQueue::ConnectQueueTraces(Ptr<QueueType> queue)
     queue->TraceConnectWithoutContext(
         "DropBeforeEnqueue",
         MakeCallback(&NetDeviceQueue::PacketDiscarded<QueueType>, this).Bind(PeekPointer(queue)));
+    m_wouldOverflow = [queue = PeekPointer(queue)](uint32_t nPackets, uint32_t nBytes) {
+        return queue->WouldOverflow(nPackets, nBytes);
+    };
 }
 
 template <typename QueueType>
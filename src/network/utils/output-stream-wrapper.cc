@@ -17,6 +17,8 @@
 
 #include "output-stream-wrapper.h"
 
+#include "async-file-writer.h"
+
 #include "ns3/abort.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/log.h"
@@ -32,11 +34,25 @@ OutputStreamWrapper::OutputStreamWrapper(std::string filename, std::ios::openmod
     : m_destroyable(true)
 {
     NS_LOG_FUNCTION(this << filename << filemode);
-    auto os = new std::ofstream();
-    os->open(filename, filemode);
-    m_ostream = os;
+    uint32_t capacity;
+    AsyncFileWriter::OverflowPolicy policy;
+    bool isOpen;
+    if (AsyncFileWriter::GetTraceConfig(capacity, policy))
+    {
+        m_asyncWriter = std::make_unique<AsyncFileWriter>(filename, filemode, capacity, policy);
+        m_asyncBuf = std::make_unique<AsyncStreamBuf>(m_asyncWriter.get());
+        m_ostream = new std::ostream(m_asyncBuf.get());
+        isOpen = m_asyncWriter->IsOpen();
+    }
+    else
+    {
+        auto os = new std::ofstream();
+        os->open(filename, filemode);
+        m_ostream = os;
+        isOpen = os->is_open();
+    }
     FatalImpl::RegisterStream(m_ostream);
-    NS_ABORT_MSG_UNLESS(os->is_open(),
+    NS_ABORT_MSG_UNLESS(isOpen,
                         "AsciiTraceHelper::CreateFileStream():  "
                             << "Unable to Open " << filename << " for mode " << filemode);
 }
@@ -59,6 +75,9 @@ OutputStreamWrapper::~OutputStreamWrapper()
         delete m_ostream;
     }
     m_ostream = nullptr;
+    // The stream buffer pushes its last characters before the writer is closed
+    m_asyncBuf.reset();
+    m_asyncWriter.reset();
 }
 
 std::ostream*
@@ -23,10 +23,14 @@
 #include "ns3/simple-ref-count.h"
 
 #include <fstream>
+#include <memory>
 
 namespace ns3
 {
 
+class AsyncFileWriter;
+class AsyncStreamBuf;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -73,6 +77,10 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
   public:
     /**
      * Constructor
+     *
+     * If the "AsyncTraceWrite" global value is true, the file is written by a
+     * background thread (see AsyncFileWriter).
+     *
      * \param filename file name
      * \param filemode std::ios::openmode flags
      */
@@ -94,8 +102,10 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
     std::ostream* GetStream();
 
   private:
-    std::ostream* m_ostream; //!< The output stream
-    bool m_destroyable;      //!< Can be destroyed
+    std::ostream* m_ostream;                        //!< The output stream
+    bool m_destroyable;                             //!< Can be destroyed
+    std::unique_ptr<AsyncFileWriter> m_asyncWriter; //!< Background writer of the file, if any
+    std::unique_ptr<AsyncStreamBuf> m_asyncBuf;     //!< Stream buffer of the background writer
 };
 
 } // namespace ns3
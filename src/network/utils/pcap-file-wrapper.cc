@@ -48,6 +48,12 @@ PcapFileWrapper::GetTypeId()
                           "microseconds(default).",
                           BooleanValue(false),
                           MakeBooleanAccessor(&PcapFileWrapper::m_nanosecMode),
+                          MakeBooleanChecker())
+            .AddAttribute("HeadersOnly",
+                          "Whether only the bytes preceding the zero-filled payload of the "
+                          "packets (i.e., their headers) are captured, up to CaptureSize",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PcapFileWrapper::m_headersOnly),
                           MakeBooleanChecker());
     return tid;
 }
@@ -115,6 +121,15 @@ PcapFileWrapper::Init(uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrect
     {
         m_file.Init(dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     }
+
+    m_file.SetHeadersOnly(m_headersOnly);
+
+    uint32_t capacity;
+    AsyncFileWriter::OverflowPolicy policy;
+    if (AsyncFileWriter::GetTraceConfig(capacity, policy))
+    {
+        m_file.EnableAsyncWrite(capacity, policy);
+    }
 }
 
 void
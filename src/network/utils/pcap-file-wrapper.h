@@ -103,6 +103,9 @@ class PcapFileWrapper : public Object
      * time zone from UTC/GMT.  For example, Pacific Standard Time in the US is
      * GMT-8, so one would enter -8 for that correction.  Defaults to 0 (UTC).
      *
+     * If the "AsyncTraceWrite" global value is true, the packets are then
+     * written by a background thread (see AsyncFileWriter).
+     *
      * \warning Calling this method on an existing file will result in the loss
      * any existing data.
      */
@@ -225,6 +228,7 @@ class PcapFileWrapper : public Object
     PcapFile m_file;    //!< Pcap file
     uint32_t m_snapLen; //!< max length of saved packets
     bool m_nanosecMode; //!< Timestamps in nanosecond mode
+    bool m_headersOnly; //!< Capture only the headers of the packets
 };
 
 } // namespace ns3
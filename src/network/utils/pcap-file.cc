@@ -28,6 +28,7 @@
 #include "ns3/log.h"
 #include "ns3/packet.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
@@ -54,7 +55,8 @@ const uint16_t VERSION_MINOR = 4; /**< Minor version of supported pcap file form
 PcapFile::PcapFile()
     : m_file(),
       m_swapMode(false),
-      m_nanosecMode(false)
+      m_nanosecMode(false),
+      m_headersOnly(false)
 {
     NS_LOG_FUNCTION(this);
     FatalImpl::RegisterStream(&m_file);
@@ -92,6 +94,12 @@ void
 PcapFile::Close()
 {
     NS_LOG_FUNCTION(this);
+    if (m_asyncWriter)
+    {
+        // The file stream was already closed when the writer took over
+        m_asyncWriter.reset();
+        return;
+    }
     m_file.close();
 }
 
@@ -409,13 +417,40 @@ PcapFile::Init(uint32_t dataLinkType,
     WriteFileHeader();
 }
 
+void
+PcapFile::EnableAsyncWrite(uint32_t capacity, AsyncFileWriter::OverflowPolicy policy)
+{
+    NS_LOG_FUNCTION(this << capacity << policy);
+    NS_ASSERT(m_file.good() && !m_asyncWriter);
+
+    //
+    // The file header has been written by Init, the records are appended to it.
+    //
+    m_file.close();
+    m_asyncWriter = std::make_unique<AsyncFileWriter>(m_filename,
+                                                      std::ios::binary | std::ios::app,
+                                                      capacity,
+                                                      policy);
+    if (!m_asyncWriter->IsOpen())
+    {
+        m_file.setstate(std::ios::failbit);
+    }
+}
+
+void
+PcapFile::SetHeadersOnly(bool headersOnly)
+{
+    NS_LOG_FUNCTION(this << headersOnly);
+    m_headersOnly = headersOnly;
+}
+
 uint32_t
-PcapFile::WritePacketHeader(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+PcapFile::StartRecord(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t captureLen)
 {
-    NS_LOG_FUNCTION(this << tsSec << tsUsec << totalLen);
-    NS_ASSERT(m_file.good());
+    NS_LOG_FUNCTION(this << tsSec << tsUsec << totalLen << captureLen);
+    NS_ASSERT(m_asyncWriter || m_file.good());
 
-    uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+    uint32_t inclLen = std::min({totalLen, captureLen, m_fileHeader.m_snapLen});
 
     PcapRecordHeader header;
     header.m_tsSec = tsSec;
@@ -429,33 +464,47 @@ PcapFile::WritePacketHeader(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
     //
-    // Watch out for memory alignment differences between machines, so write
-    // them all individually.
+    // Watch out for memory alignment differences between machines, so copy
+    // the fields individually.
     //
-    m_file.write((const char*)&header.m_tsSec, sizeof(header.m_tsSec));
-    m_file.write((const char*)&header.m_tsUsec, sizeof(header.m_tsUsec));
-    m_file.write((const char*)&header.m_inclLen, sizeof(header.m_inclLen));
-    m_file.write((const char*)&header.m_origLen, sizeof(header.m_origLen));
-    NS_BUILD_DEBUG(m_file.flush());
+    m_record.resize(16 + inclLen);
+    std::memcpy(&m_record[0], &header.m_tsSec, sizeof(header.m_tsSec));
+    std::memcpy(&m_record[4], &header.m_tsUsec, sizeof(header.m_tsUsec));
+    std::memcpy(&m_record[8], &header.m_inclLen, sizeof(header.m_inclLen));
+    std::memcpy(&m_record[12], &header.m_origLen, sizeof(header.m_origLen));
     return inclLen;
 }
 
+void
+PcapFile::WriteRecord()
+{
+    if (m_asyncWriter)
+    {
+        m_asyncWriter->Write(m_record.data(), m_record.size());
+        return;
+    }
+    m_file.write((const char*)m_record.data(), m_record.size());
+    NS_BUILD_DEBUG(m_file.flush());
+}
+
 void
 PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const uint8_t* const data, uint32_t totalLen)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << &data << totalLen);
-    uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalLen);
-    m_file.write((const char*)data, inclLen);
-    NS_BUILD_DEBUG(m_file.flush());
+    uint32_t inclLen = StartRecord(tsSec, tsUsec, totalLen, totalLen);
+    std::memcpy(m_record.data() + 16, data, inclLen);
+    WriteRecord();
 }
 
 void
 PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << p);
-    uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, p->GetSize());
-    p->CopyData(&m_file, inclLen);
-    NS_BUILD_DEBUG(m_file.flush());
+    uint32_t size = p->GetSize();
+    uint32_t inclLen =
+        StartRecord(tsSec, tsUsec, size, m_headersOnly ? p->GetZeroPayloadOffset() : size);
+    p->CopyData(m_record.data() + 16, inclLen);
+    WriteRecord();
 }
 
 void
@@ -464,15 +513,17 @@ PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const Header& header, Ptr<const
     NS_LOG_FUNCTION(this << tsSec << tsUsec << &header << p);
     uint32_t headerSize = header.GetSerializedSize();
     uint32_t totalSize = headerSize + p->GetSize();
-    uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalSize);
+    uint32_t captureLen = m_headersOnly ? headerSize + p->GetZeroPayloadOffset() : totalSize;
+    uint32_t inclLen = StartRecord(tsSec, tsUsec, totalSize, captureLen);
 
     Buffer headerBuffer;
     headerBuffer.AddAtStart(headerSize);
     header.Serialize(headerBuffer.Begin());
     uint32_t toCopy = std::min(headerSize, inclLen);
-    headerBuffer.CopyData(&m_file, toCopy);
+    headerBuffer.CopyData(m_record.data() + 16, toCopy);
     inclLen -= toCopy;
-    p->CopyData(&m_file, inclLen);
+    p->CopyData(m_record.data() + 16 + toCopy, inclLen);
+    WriteRecord();
 }
 
 void
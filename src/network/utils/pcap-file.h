@@ -20,11 +20,15 @@
 #ifndef PCAP_FILE_H
 #define PCAP_FILE_H
 
+#include "async-file-writer.h"
+
 #include "ns3/ptr.h"
 
 #include <fstream>
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -121,6 +125,29 @@ class PcapFile
               bool swapMode = false,
               bool nanosecMode = false);
 
+    /**
+     * \brief Capture only the headers of the packets
+     *
+     * When enabled, the bytes of a packet written to the file are those
+     * preceding its zero-filled payload (see Packet::GetZeroPayloadOffset),
+     * up to the snapshot length. The original length of the packet is still
+     * recorded, and the payload is never copied.
+     *
+     * \param headersOnly whether to capture only the headers
+     */
+    void SetHeadersOnly(bool headersOnly);
+
+    /**
+     * \brief Write the next packets from a background thread
+     *
+     * The file, which must have been initialized, is closed and reopened by
+     * an AsyncFileWriter, to which the subsequent records are handed over.
+     *
+     * \param capacity the capacity of the ring buffer in bytes
+     * \param policy the overflow policy
+     */
+    void EnableAsyncWrite(uint32_t capacity, AsyncFileWriter::OverflowPolicy policy);
+
     /**
      * \brief Write next packet to file
      *
@@ -356,28 +383,39 @@ class PcapFile
      */
     void WriteFileHeader();
     /**
-     * \brief Write a Pcap packet header
+     * \brief Start a record in the staging buffer
      *
-     * The pcap header has a fixed length of 24 bytes. The last 4 bytes
-     * represent the link-layer type
+     * The record header is written to the staging buffer, which is resized to
+     * hold the header and the packet data. Building the whole record before
+     * writing it allows a single write per packet.
      *
      * \param tsSec Time stamp (seconds part)
      * \param tsUsec Time stamp (microseconds part)
      * \param totalLen total packet length
+     * \param captureLen maximum number of bytes to capture, in addition to the
+     *        snapshot length
      * \returns the length of the packet to write in the Pcap file
      */
-    uint32_t WritePacketHeader(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+    uint32_t StartRecord(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t captureLen);
+
+    /**
+     * \brief Write the record of the staging buffer to the file
+     */
+    void WriteRecord();
 
     /**
      * \brief Read and verify a Pcap file header
      */
     void ReadAndVerifyFileHeader();
 
-    std::string m_filename;      //!< file name
-    std::fstream m_file;         //!< file stream
-    PcapFileHeader m_fileHeader; //!< file header
-    bool m_swapMode;             //!< swap mode
-    bool m_nanosecMode;          //!< nanosecond timestamp mode
+    std::string m_filename;                         //!< file name
+    std::fstream m_file;                            //!< file stream
+    PcapFileHeader m_fileHeader;                    //!< file header
+    bool m_swapMode;                                //!< swap mode
+    bool m_nanosecMode;                             //!< nanosecond timestamp mode
+    bool m_headersOnly;                             //!< capture only the headers
+    std::vector<uint8_t> m_record;                  //!< staging buffer of the record being written
+    std::unique_ptr<AsyncFileWriter> m_asyncWriter; //!< background writer, if enabled
 };
 
 } // namespace ns3
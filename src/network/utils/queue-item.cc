@@ -19,9 +19,13 @@
 
 #include "queue-item.h"
 
+#include "flow-hash.h"
+
 #include "ns3/log.h"
 #include "ns3/packet.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -74,11 +78,96 @@ operator<<(std::ostream& os, const QueueItem& item)
     return os;
 }
 
+/**
+ * \brief Free lists of the memory blocks released by queue disc items
+ *
+ * There is a free list for each item size, i.e., for each subclass of
+ * QueueDiscItem in use.
+ */
+struct QueueDiscItemFreeLists
+{
+    ~QueueDiscItemFreeLists();
+
+    /// The free lists, with the size of their blocks
+    std::vector<std::pair<std::size_t, std::vector<void*>>> lists;
+};
+
+/// Maximum number of blocks kept in each free list
+static constexpr std::size_t QUEUE_DISC_ITEM_FREE_LIST_MAX = 1000;
+
+/// Whether the free lists have been destroyed (at program exit)
+static bool g_queueDiscItemFreeListsDestroyed = false;
+
+QueueDiscItemFreeLists::~QueueDiscItemFreeLists()
+{
+    for (auto& [size, blocks] : lists)
+    {
+        for (void* block : blocks)
+        {
+            ::operator delete(block);
+        }
+    }
+    g_queueDiscItemFreeListsDestroyed = true;
+}
+
+/**
+ * \param size the size of the blocks
+ * \return the free list of the blocks of the given size
+ */
+static std::vector<void*>&
+GetQueueDiscItemFreeList(std::size_t size)
+{
+    static QueueDiscItemFreeLists freeLists;
+    for (auto& [blockSize, blocks] : freeLists.lists)
+    {
+        if (blockSize == size)
+        {
+            return blocks;
+        }
+    }
+    return freeLists.lists.emplace_back(size, std::vector<void*>()).second;
+}
+
+void*
+QueueDiscItem::operator new(std::size_t size)
+{
+    if (!g_queueDiscItemFreeListsDestroyed)
+    {
+        std::vector<void*>& blocks = GetQueueDiscItemFreeList(size);
+        if (!blocks.empty())
+        {
+            void* block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+    }
+    return ::operator new(size);
+}
+
+void
+QueueDiscItem::operator delete(void* p, std::size_t size)
+{
+    if (!g_queueDiscItemFreeListsDestroyed)
+    {
+        std::vector<void*>& blocks = GetQueueDiscItemFreeList(size);
+        if (blocks.size() < QUEUE_DISC_ITEM_FREE_LIST_MAX)
+        {
+            blocks.push_back(p);
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
 QueueDiscItem::QueueDiscItem(Ptr<Packet> p, const Address& addr, uint16_t protocol)
     : QueueItem(p),
       m_address(addr),
       m_protocol(protocol),
-      m_txq(0)
+      m_txq(0),
+      m_flowKeyWords(FLOW_KEY_UNKNOWN),
+      m_flowHashValid(false),
+      m_flowHashPerturbation(0),
+      m_flowHash(0)
 {
     NS_LOG_FUNCTION(this << p << addr << protocol);
 }
@@ -142,7 +231,43 @@ QueueDiscItem::Print(std::ostream& os) const
 uint32_t
 QueueDiscItem::Hash(uint32_t perturbation) const
 {
-    NS_LOG_WARN("The Hash method should be redefined by subclasses");
+    NS_LOG_FUNCTION(this << perturbation);
+
+    if (m_flowHashValid && m_flowHashPerturbation == perturbation)
+    {
+        return m_flowHash;
+    }
+
+    if (m_flowKeyWords == FLOW_KEY_UNKNOWN)
+    {
+        m_flowKeyWords = GetFlowKey(m_flowKey);
+        NS_ASSERT(m_flowKeyWords <= MAX_FLOW_KEY_WORDS);
+    }
+
+    // one fixed-width kernel for each possible size of the flow key
+    using Kernel = uint32_t (*)(const uint32_t*, uint32_t);
+    static const Kernel kernels[MAX_FLOW_KEY_WORDS + 1] = {nullptr,
+                                                           &FlowHash<1>,
+                                                           &FlowHash<2>,
+                                                           &FlowHash<3>,
+                                                           &FlowHash<4>,
+                                                           &FlowHash<5>,
+                                                           &FlowHash<6>,
+                                                           &FlowHash<7>,
+                                                           &FlowHash<8>,
+                                                           &FlowHash<9>,
+                                                           &FlowHash<10>};
+
+    m_flowHash = (m_flowKeyWords == 0 ? 0 : kernels[m_flowKeyWords](m_flowKey, perturbation));
+    m_flowHashPerturbation = perturbation;
+    m_flowHashValid = true;
+    return m_flowHash;
+}
+
+uint8_t
+QueueDiscItem::GetFlowKey(uint32_t* key) const
+{
+    NS_LOG_WARN("The GetFlowKey method should be redefined by subclasses");
     return 0;
 }
 
@@ -147,6 +147,25 @@ class QueueDiscItem : public QueueItem
     QueueDiscItem(const QueueDiscItem&) = delete;
     QueueDiscItem& operator=(const QueueDiscItem&) = delete;
 
+    /**
+     * \brief Allocate the memory of a queue disc item
+     *
+     * A queue disc item is created for every packet sent through the Traffic
+     * Control layer, hence the memory of destroyed items is kept in free lists
+     * (one for each item size) and reused by subsequently created items.
+     *
+     * \param size the size of the item
+     * \return the allocated memory
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * \brief Release the memory of a queue disc item for reuse
+     * \param p the memory of the item
+     * \param size the size of the item
+     */
+    static void operator delete(void* p, std::size_t size);
+
     /**
      * \brief Get the MAC address included in this item
      * \return the MAC address included in this item.
@@ -209,19 +228,47 @@ class QueueDiscItem : public QueueItem
     /**
      * \brief Computes the hash of various fields of the packet header
      *
-     * This method just returns 0. Subclasses should implement a reasonable hash
-     * for their protocol type, such as hashing on the TCP/IP 5-tuple.
+     * The flow key returned by GetFlowKey is extracted from the packet the first
+     * time this method is called and hashed by means of FlowHash. Both the key
+     * and the last computed hash are cached in the item, so that the classifiers
+     * the packet goes through (e.g., the selection of the transmission queue and
+     * a flow queue disc) pay for the parsing of the headers only once and for
+     * the hash computation only once per perturbation value. If the item has no
+     * flow key, this method returns 0.
      *
      * \param perturbation hash perturbation value
      * \return the hash of various fields of the packet header
      */
     virtual uint32_t Hash(uint32_t perturbation = 0) const;
 
+    static constexpr uint8_t MAX_FLOW_KEY_WORDS = 10; //!< maximum number of words of a flow key
+
+  protected:
+    /**
+     * \brief Extract the flow key of the packet
+     *
+     * The base class has no flow key. Subclasses should store the fields that
+     * identify the flow of the packet for their protocol type, such as the TCP/IP
+     * 5-tuple, in the given array.
+     *
+     * \param key the array to store the words of the flow key in
+     * \return the number of words of the flow key (at most MAX_FLOW_KEY_WORDS)
+     */
+    virtual uint8_t GetFlowKey(uint32_t* key) const;
+
   private:
-    Address m_address;   //!< MAC destination address
-    uint16_t m_protocol; //!< L3 Protocol number
-    uint8_t m_txq;       //!< Transmission queue index
-    Time m_tstamp;       //!< timestamp when the packet was enqueued
+    /// Value of m_flowKeyWords until the flow key has been extracted
+    static constexpr uint8_t FLOW_KEY_UNKNOWN = 0xff;
+
+    Address m_address;                              //!< MAC destination address
+    uint16_t m_protocol;                            //!< L3 Protocol number
+    uint8_t m_txq;                                  //!< Transmission queue index
+    Time m_tstamp;                                  //!< timestamp when the packet was enqueued
+    mutable uint8_t m_flowKeyWords;                 //!< number of words of the flow key
+    mutable bool m_flowHashValid;                   //!< whether m_flowHash is valid
+    mutable uint32_t m_flowHashPerturbation;        //!< perturbation of m_flowHash
+    mutable uint32_t m_flowHash;                    //!< last computed hash of the flow key
+    mutable uint32_t m_flowKey[MAX_FLOW_KEY_WORDS]; //!< the flow key
 };
 
 } // namespace ns3
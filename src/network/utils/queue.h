@@ -246,7 +246,9 @@ class QueueBase : public Object
  * container used internally to store queue items. The container type must provide
  * the methods insert(), erase() and clear() and define the iterator and const_iterator
  * types, following the usual syntax of C++ containers. The default container type
- * is std::list (as defined in queue-fwd.h). In case the container is such that
+ * is RingBuffer (as defined in queue-fwd.h), which does not allocate memory per
+ * item; std::list can be used instead by subclasses needing iterators that stay
+ * valid across insertions and erasures. In case the container is such that
  * an object stored within the queue is obtained from a container element through
  * an operation other than dereferencing an iterator pointing to the container
  * element, the container has to provide a public method named GetItem that
@@ -311,6 +313,12 @@ class Queue : public QueueBase
      */
     void Flush();
 
+    /**
+     * \return true if a sink is connected to the Enqueue or Dequeue trace
+     *         source, and thus may keep a reference to the queued items
+     */
+    bool IsTraced() const;
+
     /// Define ItemType as the type of the stored elements
     typedef Item ItemType;
 
@@ -506,6 +514,13 @@ Queue<Item, Container>::GetContainer() const
     return m_packets;
 }
 
+template <typename Item, typename Container>
+bool
+Queue<Item, Container>::IsTraced() const
+{
+    return !m_traceEnqueue.IsEmpty() || !m_traceDequeue.IsEmpty();
+}
+
 template <typename Item, typename Container>
 bool
 Queue<Item, Container>::DoEnqueue(ConstIterator pos, Ptr<Item> item)
@@ -0,0 +1,453 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup queue
+ * ns3::RingBuffer declaration and implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ *
+ * \brief Growable ring buffer usable as the container of a Queue
+ *
+ * Elements are stored in a single array whose size is a power of two and
+ * which is doubled when full, so that inserting at the back and erasing at
+ * the front (the FIFO case) neither allocates nor moves elements once the
+ * buffer has grown to the peak occupancy of the queue. Inserting or erasing
+ * elsewhere is supported but moves the elements between the position and the
+ * back of the buffer.
+ *
+ * As with std::deque, iterators are invalidated by any insertion or erasure.
+ * The slot of an erased element is reset to a default-constructed value, so
+ * that, e.g., the reference held by a Ptr is released immediately.
+ *
+ * \tparam T \explicit the type of the elements (must be default constructible)
+ */
+template <typename T>
+class RingBuffer
+{
+  public:
+    /**
+     * \brief Iterator over the elements of a RingBuffer
+     * \tparam Const whether the iterator gives const access to the elements
+     */
+    template <bool Const>
+    class IteratorBase
+    {
+      public:
+        /// Container type, const qualified if the iterator is constant
+        using Buffer = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+        using iterator_category = std::random_access_iterator_tag; //!< iterator category
+        using value_type = T;                                      //!< value type
+        using difference_type = std::ptrdiff_t;                    //!< difference type
+        using pointer = std::conditional_t<Const, const T*, T*>;   //!< pointer type
+        using reference = std::conditional_t<Const, const T&, T&>; //!< reference type
+
+        IteratorBase() = default;
+
+        /**
+         * \param buffer the ring buffer
+         * \param index the logical index (0 is the front) of the element
+         */
+        IteratorBase(Buffer* buffer, std::size_t index)
+            : m_buffer(buffer),
+              m_index(index)
+        {
+        }
+
+        /**
+         * \brief Conversion from a non-const iterator
+         * \param it the iterator
+         */
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        IteratorBase(const IteratorBase<false>& it)
+            : m_buffer(it.m_buffer),
+              m_index(it.m_index)
+        {
+        }
+
+        /// \return a reference to the element
+        reference operator*() const
+        {
+            return m_buffer->At(m_index);
+        }
+
+        /// \return a pointer to the element
+        pointer operator->() const
+        {
+            return &m_buffer->At(m_index);
+        }
+
+        /// \return this iterator, moved to the next element
+        IteratorBase& operator++()
+        {
+            m_index++;
+            return *this;
+        }
+
+        /// \return a copy of this iterator, which is moved to the next element
+        IteratorBase operator++(int)
+        {
+            IteratorBase ret = *this;
+            m_index++;
+            return ret;
+        }
+
+        /// \return this iterator, moved to the previous element
+        IteratorBase& operator--()
+        {
+            m_index--;
+            return *this;
+        }
+
+        /// \return a copy of this iterator, which is moved to the previous element
+        IteratorBase operator--(int)
+        {
+            IteratorBase ret = *this;
+            m_index--;
+            return ret;
+        }
+
+        /**
+         * \param n the number of elements to move forward
+         * \return this iterator, moved n elements forward
+         */
+        IteratorBase& operator+=(difference_type n)
+        {
+            m_index += n;
+            return *this;
+        }
+
+        /**
+         * \param n the number of elements to move forward
+         * \return an iterator n elements after this one
+         */
+        IteratorBase operator+(difference_type n) const
+        {
+            return IteratorBase(m_buffer, m_index + n);
+        }
+
+        /**
+         * \param n the number of elements to move backward
+         * \return an iterator n elements before this one
+         */
+        IteratorBase operator-(difference_type n) const
+        {
+            return IteratorBase(m_buffer, m_index - n);
+        }
+
+        /**
+         * \param other another iterator on the same ring buffer
+         * \return the number of elements between the two iterators
+         */
+        difference_type operator-(const IteratorBase& other) const
+        {
+            return static_cast<difference_type>(m_index) -
+                   static_cast<difference_type>(other.m_index);
+        }
+
+        /**
+         * \param other another iterator
+         * \return true if the iterators point to the same element
+         */
+        bool operator==(const IteratorBase& other) const
+        {
+            return m_buffer == other.m_buffer && m_index == other.m_index;
+        }
+
+        /**
+         * \param other another iterator
+         * \return true if the iterators point to different elements
+         */
+        bool operator!=(const IteratorBase& other) const
+        {
+            return !(*this == other);
+        }
+
+        /**
+         * \param other another iterator on the same ring buffer
+         * \return true if this iterator points to an element before the other one
+         */
+        bool operator<(const IteratorBase& other) const
+        {
+            return m_index < other.m_index;
+        }
+
+      private:
+        friend class RingBuffer;
+        friend class IteratorBase<true>;
+
+        Buffer* m_buffer{nullptr}; //!< the ring buffer
+        std::size_t m_index{0};    //!< the logical index of the element
+    };
+
+    using value_type = T;                      //!< value type
+    using size_type = std::size_t;             //!< size type
+    using reference = T&;                      //!< reference type
+    using const_reference = const T&;          //!< const reference type
+    using iterator = IteratorBase<false>;      //!< iterator type
+    using const_iterator = IteratorBase<true>; //!< const iterator type
+
+    RingBuffer() = default;
+
+    /// \return true if the buffer holds no element
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /// \return the number of elements in the buffer
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    /// \return the number of elements the buffer can hold before growing
+    size_type capacity() const
+    {
+        return m_slots.size();
+    }
+
+    /// \return an iterator to the first element
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    /// \return an iterator past the last element
+    iterator end()
+    {
+        return iterator(this, m_size);
+    }
+
+    /// \return a const iterator to the first element
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// \return a const iterator past the last element
+    const_iterator end() const
+    {
+        return const_iterator(this, m_size);
+    }
+
+    /// \return a const iterator to the first element
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    /// \return a const iterator past the last element
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    /// \return a reference to the first element
+    reference front()
+    {
+        NS_ASSERT(m_size > 0);
+        return At(0);
+    }
+
+    /// \return a const reference to the first element
+    const_reference front() const
+    {
+        NS_ASSERT(m_size > 0);
+        return At(0);
+    }
+
+    /// \return a reference to the last element
+    reference back()
+    {
+        NS_ASSERT(m_size > 0);
+        return At(m_size - 1);
+    }
+
+    /// \return a const reference to the last element
+    const_reference back() const
+    {
+        NS_ASSERT(m_size > 0);
+        return At(m_size - 1);
+    }
+
+    /**
+     * \brief Append an element
+     * \param value the element
+     */
+    void push_back(T value)
+    {
+        Reserve(m_size + 1);
+        At(m_size) = std::move(value);
+        m_size++;
+    }
+
+    /**
+     * \brief Prepend an element
+     * \param value the element
+     */
+    void push_front(T value)
+    {
+        Reserve(m_size + 1);
+        m_head = (m_head - 1) & (m_slots.size() - 1);
+        m_slots[m_head] = std::move(value);
+        m_size++;
+    }
+
+    /// \brief Remove the first element
+    void pop_front()
+    {
+        NS_ASSERT(m_size > 0);
+        m_slots[m_head] = T();
+        m_head = (m_head + 1) & (m_slots.size() - 1);
+        m_size--;
+    }
+
+    /// \brief Remove the last element
+    void pop_back()
+    {
+        NS_ASSERT(m_size > 0);
+        At(m_size - 1) = T();
+        m_size--;
+    }
+
+    /**
+     * \brief Insert an element before the given position
+     * \param pos the position
+     * \param value the element
+     * \return an iterator to the inserted element
+     */
+    iterator insert(const_iterator pos, T value)
+    {
+        NS_ASSERT(pos.m_buffer == this && pos.m_index <= m_size);
+        std::size_t index = pos.m_index;
+        if (index == 0)
+        {
+            push_front(std::move(value));
+            return begin();
+        }
+        Reserve(m_size + 1);
+        for (std::size_t i = m_size; i > index; i--)
+        {
+            At(i) = std::move(At(i - 1));
+        }
+        At(index) = std::move(value);
+        m_size++;
+        return iterator(this, index);
+    }
+
+    /**
+     * \brief Erase the element at the given position
+     * \param pos the position
+     * \return an iterator to the element following the erased one
+     */
+    iterator erase(const_iterator pos)
+    {
+        NS_ASSERT(pos.m_buffer == this && pos.m_index < m_size);
+        std::size_t index = pos.m_index;
+        if (index == 0)
+        {
+            pop_front();
+            return begin();
+        }
+        for (std::size_t i = index; i + 1 < m_size; i++)
+        {
+            At(i) = std::move(At(i + 1));
+        }
+        pop_back();
+        return iterator(this, index);
+    }
+
+    /// \brief Remove all the elements, keeping the allocated capacity
+    void clear()
+    {
+        while (m_size > 0)
+        {
+            pop_back();
+        }
+        m_head = 0;
+    }
+
+  private:
+    static constexpr std::size_t MIN_CAPACITY = 16; //!< capacity allocated by the first insert
+
+    /**
+     * \param index the logical index (0 is the front) of an element
+     * \return a reference to the element
+     */
+    T& At(std::size_t index)
+    {
+        return m_slots[(m_head + index) & (m_slots.size() - 1)];
+    }
+
+    /**
+     * \param index the logical index (0 is the front) of an element
+     * \return a const reference to the element
+     */
+    const T& At(std::size_t index) const
+    {
+        return m_slots[(m_head + index) & (m_slots.size() - 1)];
+    }
+
+    /**
+     * \brief Make room for the given number of elements, doubling the capacity if needed
+     * \param n the number of elements
+     */
+    void Reserve(std::size_t n)
+    {
+        if (n <= m_slots.size())
+        {
+            return;
+        }
+        std::size_t capacity = m_slots.empty() ? MIN_CAPACITY : m_slots.size();
+        while (capacity < n)
+        {
+            capacity *= 2;
+        }
+        std::vector<T> slots(capacity);
+        for (std::size_t i = 0; i < m_size; i++)
+        {
+            slots[i] = std::move(At(i));
+        }
+        m_slots.swap(slots);
+        m_head = 0;
+    }
+
+    std::vector<T> m_slots; //!< the slots (their number is a power of 2)
+    std::size_t m_head{0};  //!< the slot of the first element
+    std::size_t m_size{0};  //!< the number of elements
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
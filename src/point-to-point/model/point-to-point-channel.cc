@@ -96,17 +96,46 @@ PointToPointChannel::TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevic
 
     uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-    Simulator::ScheduleWithContext(m_link[wire].m_dst->GetNode()->GetId(),
-                                   txTime + m_delay,
-                                   &PointToPointNetDevice::Receive,
-                                   m_link[wire].m_dst,
-                                   p->Copy());
+    ScheduleReceive(wire, p->Copy(), txTime);
 
     // Call the tx anim callback on the net device
     m_txrxPointToPoint(p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
     return true;
 }
 
+bool
+PointToPointChannel::TransmitStartWithoutCopy(Ptr<Packet> p,
+                                              Ptr<PointToPointNetDevice> src,
+                                              Time txTime)
+{
+    NS_LOG_FUNCTION(this << p << src);
+
+    if (!m_txrxPointToPoint.IsEmpty())
+    {
+        return TransmitStart(p, src, txTime);
+    }
+
+    NS_LOG_LOGIC("UID is " << p->GetUid() << ")");
+
+    NS_ASSERT(m_link[0].m_state != INITIALIZING);
+    NS_ASSERT(m_link[1].m_state != INITIALIZING);
+
+    uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+    ScheduleReceive(wire, p, txTime);
+    return true;
+}
+
+void
+PointToPointChannel::ScheduleReceive(uint32_t wire, Ptr<Packet> p, Time txTime)
+{
+    Simulator::ScheduleWithContext(m_link[wire].m_dst->GetNode()->GetId(),
+                                   txTime + m_delay,
+                                   &PointToPointNetDevice::Receive,
+                                   m_link[wire].m_dst,
+                                   std::move(p));
+}
+
 std::size_t
 PointToPointChannel::GetNDevices() const
 {
@@ -81,6 +81,26 @@ class PointToPointChannel : public Channel
      */
     virtual bool TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+    /**
+     * \brief Transmit a packet over this channel, handing it over to the receiver
+     *
+     * Unlike TransmitStart, the packet is not copied: the very same Packet
+     * object is delivered to the destination device, which strips its headers
+     * in place.  The caller gives up the packet and must not access it
+     * afterwards, and must make sure that no sink of its own trace sources
+     * may have kept a reference to it (see PointToPointNetDevice::IsTxTraced).
+     * If the TxRxPointToPoint trace source is connected, its sinks may keep a
+     * reference to the transmitted packet, so a copy is delivered instead.
+     *
+     * \param p Packet to transmit
+     * \param src Source PointToPointNetDevice
+     * \param txTime Transmit time to apply
+     * \returns true if successful (currently always true)
+     */
+    virtual bool TransmitStartWithoutCopy(Ptr<Packet> p,
+                                          Ptr<PointToPointNetDevice> src,
+                                          Time txTime);
+
     /**
      * \brief Get number of devices on this channel
      * \returns number of devices on this channel
@@ -151,6 +171,15 @@ class PointToPointChannel : public Channel
     /** Each point to point link has exactly two net devices. */
     static const std::size_t N_DEVICES = 2;
 
+    /**
+     * \brief Schedule the reception of a packet at the other end of a wire
+     *
+     * \param wire the wire the packet is transmitted on
+     * \param p the packet to be received, which must not be shared with the sender
+     * \param txTime Transmit time to apply
+     */
+    void ScheduleReceive(uint32_t wire, Ptr<Packet> p, Time txTime);
+
     Time m_delay;           //!< Propagation delay
     std::size_t m_nDevices; //!< Devices of this channel
 
@@ -20,11 +20,14 @@
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
 
+#include "ns3/boolean.h"
 #include "ns3/error-model.h"
 #include "ns3/llc-snap-header.h"
 #include "ns3/log.h"
 #include "ns3/mac48-address.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-item.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
@@ -71,6 +74,17 @@ PointToPointNetDevice::GetTypeId()
                           TimeValue(Seconds(0.0)),
                           MakeTimeAccessor(&PointToPointNetDevice::m_tInterframeGap),
                           MakeTimeChecker())
+            .AddAttribute("HandOverPackets",
+                          "If true, a transmitted packet is handed over to the receiver, which "
+                          "strips its headers in place, instead of being copied, unless a sink "
+                          "is connected to a trace source of this device or of its transmit "
+                          "queue. The sinks of the trace sources of other objects (e.g., the "
+                          "Enqueue/Dequeue trace sources of a QueueDisc or the Tx/UnicastForward "
+                          "trace sources of Ipv4L3Protocol) must then not keep a reference to "
+                          "the packet: set this attribute to false if they do.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&PointToPointNetDevice::m_handOverPackets),
+                          MakeBooleanChecker())
 
             //
             // Transmit queueing discipline for the device which includes its own set
@@ -176,6 +190,7 @@ PointToPointNetDevice::GetTypeId()
 
 PointToPointNetDevice::PointToPointNetDevice()
     : m_txMachineState(READY),
+      m_handOverPackets(true),
       m_channel(nullptr),
       m_linkUp(false),
       m_currentPkt(nullptr)
@@ -255,7 +270,13 @@ PointToPointNetDevice::TransmitStart(Ptr<Packet> p)
     NS_LOG_LOGIC("Schedule TransmitCompleteEvent in " << txCompleteTime.As(Time::S));
     Simulator::Schedule(txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
 
-    bool result = m_channel->TransmitStart(p, this, txTime);
+    //
+    // The receiver strips the headers of the packet it gets.  Unless a sink on
+    // this side may have kept a reference to the packet, it is handed over to
+    // the receiver instead of being copied by the channel.
+    //
+    bool result = IsTxTraced() ? m_channel->TransmitStart(p, this, txTime)
+                               : m_channel->TransmitStartWithoutCopy(p, this, txTime);
     if (!result)
     {
         m_phyTxDropTrace(p);
@@ -263,6 +284,14 @@ PointToPointNetDevice::TransmitStart(Ptr<Packet> p)
     return result;
 }
 
+bool
+PointToPointNetDevice::IsTxTraced() const
+{
+    return !m_handOverPackets || !m_macTxTrace.IsEmpty() || !m_snifferTrace.IsEmpty() ||
+           !m_promiscSnifferTrace.IsEmpty() || !m_phyTxBeginTrace.IsEmpty() ||
+           !m_phyTxEndTrace.IsEmpty() || (m_queue && m_queue->IsTraced());
+}
+
 void
 PointToPointNetDevice::TransmitComplete()
 {
@@ -356,9 +385,13 @@ PointToPointNetDevice::Receive(Ptr<Packet> packet)
 
         //
         // Trace sinks will expect complete packets, not packets without some of the
-        // headers.
+        // headers.  The copy is only needed if there is any such sink.
         //
-        Ptr<Packet> originalPacket = packet->Copy();
+        Ptr<Packet> originalPacket;
+        if (!m_macRxTrace.IsEmpty() || !m_macPromiscRxTrace.IsEmpty())
+        {
+            originalPacket = packet->Copy();
+        }
 
         //
         // Strip off the point-to-point protocol header and forward this packet
@@ -526,6 +559,45 @@ PointToPointNetDevice::Send(Ptr<Packet> packet, const Address& dest, uint16_t pr
         return false;
     }
 
+    return DoSend(packet, protocolNumber);
+}
+
+uint32_t
+PointToPointNetDevice::SendBatch(const std::vector<Ptr<QueueDiscItem>>& items,
+                                 std::vector<bool>& sent)
+{
+    NS_LOG_FUNCTION(this << items.size());
+
+    sent.clear();
+    if (!IsLinkUp())
+    {
+        for (const auto& item : items)
+        {
+            m_macTxDropTrace(item->GetPacket());
+        }
+        sent.resize(items.size(), false);
+        return items.size();
+    }
+
+    // stop when the device queue cannot take a full-sized packet anymore, as the
+    // traffic control layer would not send a packet to a stopped transmission queue
+    Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface>();
+    Ptr<NetDeviceQueue> txq = ndqi ? ndqi->GetTxQueue(0) : nullptr;
+    for (const auto& item : items)
+    {
+        if (txq && txq->IsStopped())
+        {
+            break;
+        }
+        NS_LOG_LOGIC("UID is " << item->GetPacket()->GetUid());
+        sent.push_back(DoSend(item->GetPacket(), item->GetProtocol()));
+    }
+    return sent.size();
+}
+
+bool
+PointToPointNetDevice::DoSend(Ptr<Packet> packet, uint16_t protocolNumber)
+{
     //
     // Stick a point to point protocol header on the packet in preparation for
     // shoving it out the door.
@@ -185,6 +185,8 @@ class PointToPointNetDevice : public NetDevice
                   const Address& source,
                   const Address& dest,
                   uint16_t protocolNumber) override;
+    uint32_t SendBatch(const std::vector<Ptr<QueueDiscItem>>& items,
+                       std::vector<bool>& sent) override;
 
     Ptr<Node> GetNode() const override;
     void SetNode(Ptr<Node> node) override;
@@ -218,6 +220,15 @@ class PointToPointNetDevice : public NetDevice
      */
     Address GetRemote() const;
 
+    /**
+     * \brief Add the PPP header to a packet sent while the link is up, enqueue
+     *        it and start the transmission if the device is idle
+     * \param packet the packet
+     * \param protocolNumber the protocol number of the payload
+     * \return whether the packet was enqueued (and, if so, transmitted)
+     */
+    bool DoSend(Ptr<Packet> packet, uint16_t protocolNumber);
+
     /**
      * Adds the necessary headers and trailers to a packet of data in order to
      * respect the protocol implemented by the agent.
@@ -253,6 +264,22 @@ class PointToPointNetDevice : public NetDevice
      */
     bool TransmitStart(Ptr<Packet> p);
 
+    /**
+     * Check whether a sender-side trace sink may keep a reference to the
+     * transmitted packets, i.e., whether a sink is connected to the MacTx,
+     * Sniffer, PromiscSniffer, PhyTxBegin or PhyTxEnd trace sources or to
+     * the Enqueue or Dequeue trace sources of the transmit queue, or whether
+     * the HandOverPackets attribute is false.
+     *
+     * The trace sources of the upper layers (e.g., the Enqueue and Dequeue
+     * trace sources of a QueueDisc, or the Tx and UnicastForward trace
+     * sources of Ipv4L3Protocol) are not checked: their sinks must not keep
+     * a reference to the packet, or HandOverPackets must be set to false.
+     *
+     * \returns true if the transmitted packets may be referenced by a sink
+     */
+    bool IsTxTraced() const;
+
     /**
      * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
      *
@@ -294,6 +321,12 @@ class PointToPointNetDevice : public NetDevice
      */
     Time m_tInterframeGap;
 
+    /**
+     * Whether transmitted packets are handed over to the receiver, rather
+     * than copied, when no sink of this device may keep a reference to them
+     */
+    bool m_handOverPackets;
+
     /**
      * The PointToPointChannel to which this PointToPointNetDevice has been
      * attached.
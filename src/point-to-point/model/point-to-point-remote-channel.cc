@@ -73,4 +73,13 @@ PointToPointRemoteChannel::TransmitStart(Ptr<const Packet> p,
     return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitStartWithoutCopy(Ptr<Packet> p,
+                                                    Ptr<PointToPointNetDevice> src,
+                                                    Time txTime)
+{
+    NS_LOG_FUNCTION(this << p << src);
+    return TransmitStart(p, src, txTime);
+}
+
 } // namespace ns3
@@ -67,6 +67,21 @@ class PointToPointRemoteChannel : public PointToPointChannel
      * \returns true if successful (currently always true)
      */
     bool TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime) override;
+
+    /**
+     * \brief Transmit the packet
+     *
+     * The packet is serialized towards the remote rank anyway, so this is
+     * the same as TransmitStart.
+     *
+     * \param p Packet to transmit
+     * \param src Source PointToPointNetDevice
+     * \param txTime Transmit time to apply
+     * \returns true if successful (currently always true)
+     */
+    bool TransmitStartWithoutCopy(Ptr<Packet> p,
+                                  Ptr<PointToPointNetDevice> src,
+                                  Time txTime) override;
 };
 
 } // namespace ns3
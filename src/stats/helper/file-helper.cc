@@ -82,11 +82,35 @@ FileHelper::ConfigureFile(const std::string& outputFileNameWithoutExtension,
     m_fileType = fileType;
     m_outputFileNameWithoutExtension = outputFileNameWithoutExtension;
     m_hasHeadingBeenSet = false;
+    m_columnarAggregator = nullptr;
 
     // Note that this does not construct an aggregator. It will be
     // constructed later when needed.
 }
 
+void
+FileHelper::ConfigureColumnarFile(const std::string& outputFileNameWithoutExtension)
+{
+    NS_LOG_FUNCTION(this << outputFileNameWithoutExtension);
+
+    // See if an aggregator has already been constructed.
+    if (m_columnarAggregator)
+    {
+        NS_LOG_WARN("An existing aggregator object "
+                    << m_columnarAggregator << " may be destroyed if no references remain.");
+    }
+
+    // The series are named after this.
+    m_outputFileNameWithoutExtension = outputFileNameWithoutExtension;
+
+    // Create the aggregator.
+    std::string outputFileName = m_outputFileNameWithoutExtension + ".col";
+    m_columnarAggregator = CreateObject<ColumnarAggregator>(outputFileName);
+
+    // Enable logging of data for the aggregator.
+    m_columnarAggregator->Enable();
+}
+
 void
 FileHelper::WriteProbe(const std::string& typeId,
                        const std::string& path,
@@ -355,6 +379,12 @@ FileHelper::GetAggregatorMultiple(const std::string& aggregatorName,
     return m_aggregatorMap[aggregatorName];
 }
 
+Ptr<ColumnarAggregator>
+FileHelper::GetColumnarAggregator() const
+{
+    return m_columnarAggregator;
+}
+
 void
 FileHelper::SetHeading(const std::string& heading)
 {
@@ -552,13 +582,24 @@ FileHelper::ConnectProbeToAggregator(const std::string& typeId,
                                              << "; need to add support in the helper for this");
     }
 
+    std::string adaptorTraceSource = "Output";
+    if (m_columnarAggregator)
+    {
+        // Connect the adaptor to the columnar aggregator, the series
+        // being identified by the callback rather than by a context.
+        uint32_t seriesId = m_columnarAggregator->GetSeriesId(outputFileNameWithoutExtension);
+        m_timeSeriesAdaptorMap[probeContext]->TraceConnectWithoutContext(
+            adaptorTraceSource,
+            MakeCallback(&ColumnarAggregator::WriteSeries2d, m_columnarAggregator).Bind(seriesId));
+        return;
+    }
+
     // Add the aggregator to the map of aggregators, which will keep the
     // aggregator in memory after this function ends.
     std::string outputFileName = outputFileNameWithoutExtension + ".txt";
     AddAggregator(probeContext, outputFileName, onlyOneAggregator);
 
     // Connect the adaptor to the aggregator.
-    std::string adaptorTraceSource = "Output";
     m_timeSeriesAdaptorMap[probeContext]->TraceConnect(
         adaptorTraceSource,
         probeContext,
@@ -20,6 +20,7 @@
 #ifndef FILE_HELPER_H
 #define FILE_HELPER_H
 
+#include "ns3/columnar-aggregator.h"
 #include "ns3/file-aggregator.h"
 #include "ns3/object-factory.h"
 #include "ns3/probe.h"
@@ -74,6 +75,21 @@ class FileHelper
     void ConfigureFile(const std::string& outputFileNameWithoutExtension,
                        FileAggregator::FileType fileType = FileAggregator::SPACE_SEPARATED);
 
+    /**
+     * \param outputFileNameWithoutExtension name of output file to
+     * write with no extension
+     *
+     * Configures this file helper so that the values of all the probes
+     * are written by a ColumnarAggregator to a single binary file named
+     * outputFileNameWithoutExtension plus ".col", rather than to one
+     * text file per wildcard match.  Each match is a series of the
+     * file, named as the text file it replaces without its extension
+     * (e.g. "packet-byte-count-12-9").  The format strings and the
+     * heading are not used.  Call ConfigureFile to write text files
+     * again.
+     */
+    void ConfigureColumnarFile(const std::string& outputFileNameWithoutExtension);
+
     /**
      * \param typeId the type ID for the probe used when it is created.
      * \param path Config path for underlying trace source to be probed
@@ -155,6 +171,13 @@ class FileHelper
     Ptr<FileAggregator> GetAggregatorMultiple(const std::string& aggregatorName,
                                               const std::string& outputFileName);
 
+    /**
+     * \return Ptr to the ColumnarAggregator object, or nullptr if
+     * ConfigureColumnarFile has not been called
+     * \brief Gets the aggregator writing the binary columnar file.
+     */
+    Ptr<ColumnarAggregator> GetColumnarAggregator() const;
+
     /**
      * \param heading the heading string.
      *
@@ -288,6 +311,10 @@ class FileHelper
     /// are needed.
     std::map<std::string, Ptr<FileAggregator>> m_aggregatorMap;
 
+    /// The aggregator writing all the values to a binary columnar file,
+    /// if any.
+    Ptr<ColumnarAggregator> m_columnarAggregator;
+
     /// Maps probe names to probes.
     std::map<std::string, std::pair<Ptr<Probe>, std::string>> m_probeMap;
 
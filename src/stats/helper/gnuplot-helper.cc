@@ -97,11 +97,32 @@ GnuplotHelper::ConfigurePlot(const std::string& outputFileNameWithoutExtension,
     m_xLegend = xLegend;
     m_yLegend = yLegend;
     m_terminalType = terminalType;
+    m_columnarAggregator = nullptr;
 
     // Construct the aggregator.
     ConstructAggregator();
 }
 
+void
+GnuplotHelper::ConfigureColumnarFile(const std::string& outputFileNameWithoutExtension)
+{
+    NS_LOG_FUNCTION(this << outputFileNameWithoutExtension);
+
+    // See if an aggregator has already been constructed.
+    if (m_columnarAggregator)
+    {
+        NS_LOG_WARN("An existing aggregator object "
+                    << m_columnarAggregator << " may be destroyed if no references remain.");
+    }
+
+    // Create the aggregator.
+    std::string outputFileName = outputFileNameWithoutExtension + ".col";
+    m_columnarAggregator = CreateObject<ColumnarAggregator>(outputFileName);
+
+    // Enable logging of data for the aggregator.
+    m_columnarAggregator->Enable();
+}
+
 void
 GnuplotHelper::PlotProbe(const std::string& typeId,
                          const std::string& path,
@@ -111,17 +132,21 @@ GnuplotHelper::PlotProbe(const std::string& typeId,
 {
     NS_LOG_FUNCTION(this << typeId << path << probeTraceSource << title << keyLocation);
 
-    // Get a pointer to the aggregator.
-    Ptr<GnuplotAggregator> aggregator = GetAggregator();
+    // The plot is not made if the datasets are written to a columnar file.
+    if (!m_columnarAggregator)
+    {
+        // Get a pointer to the aggregator.
+        Ptr<GnuplotAggregator> aggregator = GetAggregator();
 
-    // Add a subtitle to the title to show the trace source's path.
-    aggregator->SetTitle(m_title + " \\n\\nTrace Source Path: " + path);
+        // Add a subtitle to the title to show the trace source's path.
+        aggregator->SetTitle(m_title + " \\n\\nTrace Source Path: " + path);
 
-    // Set the default dataset plotting style for the values.
-    aggregator->Set2dDatasetDefaultStyle(Gnuplot2dDataset::LINES_POINTS);
+        // Set the default dataset plotting style for the values.
+        aggregator->Set2dDatasetDefaultStyle(Gnuplot2dDataset::LINES_POINTS);
 
-    // Set the location of the key in the plot.
-    aggregator->SetKeyLocation(keyLocation);
+        // Set the location of the key in the plot.
+        aggregator->SetKeyLocation(keyLocation);
+    }
 
     std::string pathWithoutLastToken;
     std::string lastToken;
@@ -284,6 +309,12 @@ GnuplotHelper::GetAggregator()
     return m_aggregator;
 }
 
+Ptr<ColumnarAggregator>
+GnuplotHelper::GetColumnarAggregator() const
+{
+    return m_columnarAggregator;
+}
+
 void
 GnuplotHelper::ConstructAggregator()
 {
@@ -310,8 +341,6 @@ GnuplotHelper::ConnectProbeToAggregator(const std::string& typeId,
 {
     NS_LOG_FUNCTION(this << typeId << matchIdentifier << path << probeTraceSource << title);
 
-    Ptr<GnuplotAggregator> aggregator = GetAggregator();
-
     // Increment the total number of plot probes that have been created.
     m_plotProbeCount++;
 
@@ -409,8 +438,20 @@ GnuplotHelper::ConnectProbeToAggregator(const std::string& typeId,
                                              << "; need to add support in the helper for this");
     }
 
-    // Connect the adaptor to the aggregator.
     std::string adaptorTraceSource = "Output";
+    if (m_columnarAggregator)
+    {
+        // Connect the adaptor to the columnar aggregator, the series
+        // being identified by the callback rather than by a context.
+        uint32_t seriesId = m_columnarAggregator->GetSeriesId(title);
+        m_timeSeriesAdaptorMap[probeContext]->TraceConnectWithoutContext(
+            adaptorTraceSource,
+            MakeCallback(&ColumnarAggregator::WriteSeries2d, m_columnarAggregator).Bind(seriesId));
+        return;
+    }
+
+    // Connect the adaptor to the aggregator.
+    Ptr<GnuplotAggregator> aggregator = GetAggregator();
     m_timeSeriesAdaptorMap[probeContext]->TraceConnect(
         adaptorTraceSource,
         probeContext,
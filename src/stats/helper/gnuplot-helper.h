@@ -20,6 +20,7 @@
 #ifndef GNUPLOT_HELPER_H
 #define GNUPLOT_HELPER_H
 
+#include "ns3/columnar-aggregator.h"
 #include "ns3/gnuplot-aggregator.h"
 #include "ns3/object-factory.h"
 #include "ns3/probe.h"
@@ -94,6 +95,22 @@ class GnuplotHelper
                        const std::string& yLegend,
                        const std::string& terminalType = "png");
 
+    /**
+     * \param outputFileNameWithoutExtension name of the data file to
+     * write with no extension
+     *
+     * Configures this gnuplot helper so that the datasets of the probes
+     * plotted afterwards are written by a ColumnarAggregator to a
+     * binary file named outputFileNameWithoutExtension plus ".col",
+     * rather than kept in memory and written to the gnuplot data file.
+     * Each dataset is a series of the file, named after the title of
+     * the dataset (datasets with the same title share a series).  The
+     * plot files of a gnuplot aggregator constructed beforehand (e.g.
+     * by the constructor with plot parameters) do not hold these
+     * datasets.  Call ConfigurePlot to plot the datasets again.
+     */
+    void ConfigureColumnarFile(const std::string& outputFileNameWithoutExtension);
+
     /**
      * \param typeId the type ID for the probe used when it is created.
      * \param path Config path for underlying trace source to be probed
@@ -149,6 +166,13 @@ class GnuplotHelper
      */
     Ptr<GnuplotAggregator> GetAggregator();
 
+    /**
+     * \return Ptr to the ColumnarAggregator object, or nullptr if
+     * ConfigureColumnarFile has not been called
+     * \brief Gets the aggregator writing the binary columnar file.
+     */
+    Ptr<ColumnarAggregator> GetColumnarAggregator() const;
+
   private:
     /**
      * \param typeId the type ID for the probe used when it is created.
@@ -186,6 +210,9 @@ class GnuplotHelper
     /// The aggregator used to make the plots.
     Ptr<GnuplotAggregator> m_aggregator;
 
+    /// The aggregator writing the datasets to a binary columnar file, if any.
+    Ptr<ColumnarAggregator> m_columnarAggregator;
+
     /// Maps probe names to probes.
     std::map<std::string, std::pair<Ptr<Probe>, std::string>> m_probeMap;
 
@@ -0,0 +1,590 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "columnar-aggregator.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ColumnarAggregator");
+
+NS_OBJECT_ENSURE_REGISTERED(ColumnarAggregator);
+
+namespace
+{
+
+const char MAGIC[8] = {'N', 'S', '3', 'C', 'O', 'L', 'T', 'S'}; //!< magic string of the files
+const uint32_t VERSION = 1;                                      //!< version of the format
+const uint8_t DICTIONARY_CHUNK = 1;                              //!< type of dictionary chunks
+const uint8_t BLOCK_CHUNK = 2;                                   //!< type of block chunks
+
+/**
+ * \brief Append an integer in little endian order
+ * \param buf the buffer
+ * \param value the integer
+ * \param size the number of bytes of the integer
+ */
+void
+PutUint(std::vector<char>& buf, uint64_t value, std::size_t size)
+{
+    for (std::size_t b = 0; b < size; b++)
+    {
+        buf.push_back(static_cast<char>((value >> (8 * b)) & 0xff));
+    }
+}
+
+/**
+ * \brief Append a variable length integer (7 bits per byte)
+ * \param buf the buffer
+ * \param value the integer
+ */
+void
+PutVarint(std::vector<char>& buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<char>(value));
+}
+
+/**
+ * \brief Read an integer stored in little endian order
+ * \param p the position in the buffer, advanced past the integer
+ * \param end the end of the buffer
+ * \param size the number of bytes of the integer
+ * \param value the integer
+ * \return false if the buffer ended
+ */
+bool
+GetUint(const unsigned char*& p, const unsigned char* end, std::size_t size, uint64_t& value)
+{
+    if (static_cast<std::size_t>(end - p) < size)
+    {
+        return false;
+    }
+    value = 0;
+    for (std::size_t b = 0; b < size; b++)
+    {
+        value |= static_cast<uint64_t>(*p++) << (8 * b);
+    }
+    return true;
+}
+
+/**
+ * \brief Read a variable length integer
+ * \param p the position in the buffer, advanced past the integer
+ * \param end the end of the buffer
+ * \param value the integer
+ * \return false if the buffer ended or the integer is too long
+ */
+bool
+GetVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (p == end)
+        {
+            return false;
+        }
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Read an integer stored in little endian order from a stream
+ * \param is the input stream
+ * \param size the number of bytes of the integer
+ * \param value the integer
+ * \return false if the stream ended
+ */
+bool
+ReadUint(std::istream& is, std::size_t size, uint64_t& value)
+{
+    unsigned char buf[8];
+    if (!is.read(reinterpret_cast<char*>(buf), size))
+    {
+        return false;
+    }
+    const unsigned char* p = buf;
+    return GetUint(p, buf + size, size, value);
+}
+
+} // namespace
+
+TypeId
+ColumnarAggregator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ColumnarAggregator")
+            .SetParent<DataCollectionObject>()
+            .SetGroupName("Stats")
+            .AddAttribute("BlockSize",
+                          "The maximum number of samples buffered before they are written",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&ColumnarAggregator::m_blockSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Compress",
+                          "Whether the columns of the blocks are packed rather than written "
+                          "with a fixed width",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&ColumnarAggregator::m_compress),
+                          MakeBooleanChecker());
+
+    return tid;
+}
+
+ColumnarAggregator::ColumnarAggregator(const std::string& outputFileName)
+    : m_outputFileName(outputFileName),
+      m_file(outputFileName, std::ios::out | std::ios::binary | std::ios::trunc),
+      m_blockSize(65536),
+      m_compress(true),
+      m_nWrittenSeries(0),
+      m_lastSeriesId(0),
+      m_hasLastContext(false),
+      m_nSamples(0)
+{
+    NS_LOG_FUNCTION(this << outputFileName);
+    NS_ABORT_MSG_UNLESS(m_file.is_open(), "Cannot open file " << outputFileName);
+
+    std::vector<char> header(MAGIC, MAGIC + sizeof(MAGIC));
+    PutUint(header, VERSION, 4);
+    m_file.write(header.data(), header.size());
+}
+
+ColumnarAggregator::~ColumnarAggregator()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+uint32_t
+ColumnarAggregator::GetSeriesId(const std::string& name)
+{
+    NS_LOG_FUNCTION(this << name);
+
+    auto [it, inserted] = m_seriesIds.emplace(name, m_seriesNames.size());
+    if (inserted)
+    {
+        m_seriesNames.push_back(name);
+    }
+    return it->second;
+}
+
+void
+ColumnarAggregator::Write(uint32_t seriesId, Time time, double value)
+{
+    NS_LOG_FUNCTION(this << seriesId << time << value);
+    NS_ASSERT_MSG(seriesId < m_seriesNames.size(), "Unknown series id " << seriesId);
+
+    if (!m_enabled || !m_file.is_open())
+    {
+        return;
+    }
+    m_times.push_back(time.GetNanoSeconds());
+    m_seriesCol.push_back(seriesId);
+    m_values.push_back(value);
+    if (m_times.size() >= m_blockSize)
+    {
+        WriteDictionary();
+        WriteBlock();
+    }
+}
+
+void
+ColumnarAggregator::WriteSeries1d(uint32_t seriesId, double v1)
+{
+    Write(seriesId, Simulator::Now(), v1);
+}
+
+void
+ColumnarAggregator::WriteSeries2d(uint32_t seriesId, double v1, double v2)
+{
+    // The times of a TimeSeriesAdaptor are seconds of an integral number of
+    // nanoseconds, rounding them gets the original times back.
+    Write(seriesId, NanoSeconds(std::llround(v1 * 1e9)), v2);
+}
+
+void
+ColumnarAggregator::Write1d(std::string context, double v1)
+{
+    NS_LOG_FUNCTION(this << context << v1);
+
+    // Successive samples usually belong to the same series.
+    if (!m_hasLastContext || context != m_lastContext)
+    {
+        m_lastSeriesId = GetSeriesId(context);
+        m_lastContext = context;
+        m_hasLastContext = true;
+    }
+    WriteSeries1d(m_lastSeriesId, v1);
+}
+
+void
+ColumnarAggregator::Write2d(std::string context, double v1, double v2)
+{
+    NS_LOG_FUNCTION(this << context << v1 << v2);
+
+    if (!m_hasLastContext || context != m_lastContext)
+    {
+        m_lastSeriesId = GetSeriesId(context);
+        m_lastContext = context;
+        m_hasLastContext = true;
+    }
+    WriteSeries2d(m_lastSeriesId, v1, v2);
+}
+
+void
+ColumnarAggregator::WriteDictionary()
+{
+    if (m_nWrittenSeries == m_seriesNames.size())
+    {
+        return;
+    }
+    std::vector<char> chunk;
+    PutUint(chunk, DICTIONARY_CHUNK, 1);
+    PutUint(chunk, m_seriesNames.size() - m_nWrittenSeries, 4);
+    for (uint32_t i = m_nWrittenSeries; i < m_seriesNames.size(); i++)
+    {
+        PutUint(chunk, m_seriesNames[i].size(), 4);
+        chunk.insert(chunk.end(), m_seriesNames[i].begin(), m_seriesNames[i].end());
+    }
+    m_file.write(chunk.data(), chunk.size());
+    m_nWrittenSeries = m_seriesNames.size();
+}
+
+void
+ColumnarAggregator::WriteBlock()
+{
+    if (m_times.empty())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << m_times.size());
+
+    std::size_t n = m_times.size();
+    m_payload.clear();
+    if (m_compress)
+    {
+        int64_t previousTime = 0;
+        for (auto time : m_times)
+        {
+            // Zigzag encoding, so that small negative deltas are short too
+            auto delta = static_cast<uint64_t>(time) - static_cast<uint64_t>(previousTime);
+            PutVarint(m_payload, (delta << 1) ^ (0 - (delta >> 63)));
+            previousTime = time;
+        }
+        for (auto seriesId : m_seriesCol)
+        {
+            PutVarint(m_payload, seriesId);
+        }
+        // Each value is XORed with the previous value of its series; a control
+        // byte holds the number of leading and trailing zero bytes of the
+        // result, which are not stored.
+        m_previous.assign(m_seriesNames.size(), 0);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            auto bits = std::bit_cast<uint64_t>(m_values[i]);
+            uint64_t x = bits ^ m_previous[m_seriesCol[i]];
+            m_previous[m_seriesCol[i]] = bits;
+            if (x == 0)
+            {
+                PutUint(m_payload, 0x80, 1);
+                continue;
+            }
+            unsigned leading = std::countl_zero(x) / 8;
+            unsigned trailing = std::countr_zero(x) / 8;
+            PutUint(m_payload, (leading << 4) | trailing, 1);
+            PutUint(m_payload, x >> (8 * trailing), 8 - leading - trailing);
+        }
+    }
+    else
+    {
+        m_payload.reserve(n * (sizeof(int64_t) + sizeof(uint32_t) + sizeof(double)));
+        for (auto time : m_times)
+        {
+            PutUint(m_payload, time, sizeof(int64_t));
+        }
+        for (auto seriesId : m_seriesCol)
+        {
+            PutUint(m_payload, seriesId, sizeof(uint32_t));
+        }
+        for (auto value : m_values)
+        {
+            PutUint(m_payload, std::bit_cast<uint64_t>(value), sizeof(double));
+        }
+    }
+
+    std::vector<char> header;
+    PutUint(header, BLOCK_CHUNK, 1);
+    PutUint(header, m_compress ? PACKED : RAW, 1);
+    PutUint(header, n, 4);
+    PutUint(header, m_payload.size(), 4);
+    m_file.write(header.data(), header.size());
+    m_file.write(m_payload.data(), m_payload.size());
+
+    m_nSamples += n;
+    m_times.clear();
+    m_seriesCol.clear();
+    m_values.clear();
+}
+
+void
+ColumnarAggregator::Flush()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    WriteDictionary();
+    WriteBlock();
+    m_file.flush();
+}
+
+void
+ColumnarAggregator::Close()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    Flush();
+    m_file.close();
+}
+
+uint64_t
+ColumnarAggregator::GetNSamples() const
+{
+    return m_nSamples + m_times.size();
+}
+
+ColumnarReader::ColumnarReader(const std::string& fileName)
+    : m_is(fileName, std::ios::in | std::ios::binary),
+      m_open(false),
+      m_next(0)
+{
+    NS_LOG_FUNCTION(this << fileName);
+
+    char magic[sizeof(MAGIC)];
+    uint64_t version;
+    if (m_is.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), MAGIC) &&
+        ReadUint(m_is, 4, version) && version == VERSION)
+    {
+        m_open = true;
+    }
+}
+
+bool
+ColumnarReader::IsOpen() const
+{
+    return m_open;
+}
+
+bool
+ColumnarReader::Read(Time& time, uint32_t& seriesId, double& value)
+{
+    if (m_next == m_times.size() && !ReadBlock())
+    {
+        return false;
+    }
+    time = NanoSeconds(m_times[m_next]);
+    seriesId = m_seriesCol[m_next];
+    value = m_values[m_next];
+    m_next++;
+    return true;
+}
+
+uint32_t
+ColumnarReader::GetNSeries() const
+{
+    return m_seriesNames.size();
+}
+
+std::string
+ColumnarReader::GetSeriesName(uint32_t seriesId) const
+{
+    NS_ASSERT_MSG(seriesId < m_seriesNames.size(), "Unknown series id " << seriesId);
+    return m_seriesNames[seriesId];
+}
+
+bool
+ColumnarReader::LookupSeries(const std::string& name, uint32_t& seriesId) const
+{
+    auto it = std::find(m_seriesNames.begin(), m_seriesNames.end(), name);
+    if (it == m_seriesNames.end())
+    {
+        return false;
+    }
+    seriesId = it - m_seriesNames.begin();
+    return true;
+}
+
+bool
+ColumnarReader::ReadBlock()
+{
+    m_times.clear();
+    m_seriesCol.clear();
+    m_values.clear();
+    m_next = 0;
+
+    uint64_t type;
+    while (m_open && ReadUint(m_is, 1, type))
+    {
+        if (type == DICTIONARY_CHUNK)
+        {
+            uint64_t count;
+            if (!ReadUint(m_is, 4, count))
+            {
+                break;
+            }
+            uint64_t i = 0;
+            for (; i < count; i++)
+            {
+                uint64_t length;
+                std::string name;
+                if (!ReadUint(m_is, 4, length) ||
+                    !m_is.read(name.assign(length, '\0').data(), length))
+                {
+                    break;
+                }
+                m_seriesNames.push_back(std::move(name));
+            }
+            if (i < count)
+            {
+                break;
+            }
+            continue;
+        }
+
+        uint64_t encoding;
+        uint64_t n;
+        uint64_t size;
+        if (type != BLOCK_CHUNK || !ReadUint(m_is, 1, encoding) || !ReadUint(m_is, 4, n) ||
+            !ReadUint(m_is, 4, size))
+        {
+            break;
+        }
+        std::vector<unsigned char> payload(size);
+        if (!m_is.read(reinterpret_cast<char*>(payload.data()), size))
+        {
+            break;
+        }
+        const unsigned char* p = payload.data();
+        const unsigned char* end = p + size;
+        m_times.resize(n);
+        m_seriesCol.resize(n);
+        m_values.resize(n);
+        bool ok = true;
+        if (encoding == ColumnarAggregator::PACKED)
+        {
+            uint64_t time = 0;
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t delta = 0;
+                ok = GetVarint(p, end, delta);
+                time += (delta >> 1) ^ (0 - (delta & 1));
+                m_times[i] = static_cast<int64_t>(time);
+            }
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t seriesId = 0;
+                ok = GetVarint(p, end, seriesId) && seriesId < m_seriesNames.size();
+                m_seriesCol[i] = seriesId;
+            }
+            std::vector<uint64_t> previous(m_seriesNames.size(), 0);
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t control = 0;
+                ok = GetUint(p, end, 1, control);
+                unsigned leading = control >> 4;
+                unsigned trailing = control & 0xf;
+                uint64_t x = 0;
+                if (ok && leading < 8)
+                {
+                    ok = leading + trailing < 8 &&
+                         GetUint(p, end, 8 - leading - trailing, x);
+                    x <<= 8 * trailing;
+                }
+                previous[m_seriesCol[i]] ^= x;
+                m_values[i] = std::bit_cast<double>(previous[m_seriesCol[i]]);
+            }
+        }
+        else if (encoding == ColumnarAggregator::RAW)
+        {
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t time = 0;
+                ok = GetUint(p, end, sizeof(int64_t), time);
+                m_times[i] = static_cast<int64_t>(time);
+            }
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t seriesId = 0;
+                ok = GetUint(p, end, sizeof(uint32_t), seriesId) &&
+                     seriesId < m_seriesNames.size();
+                m_seriesCol[i] = seriesId;
+            }
+            for (std::size_t i = 0; ok && i < n; i++)
+            {
+                uint64_t bits = 0;
+                ok = GetUint(p, end, sizeof(double), bits);
+                m_values[i] = std::bit_cast<double>(bits);
+            }
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            NS_LOG_WARN("Corrupted block");
+            break;
+        }
+        if (n > 0)
+        {
+            return true;
+        }
+    }
+    // End of file or corrupted chunk: there are no more samples to read
+    m_open = false;
+    m_times.clear();
+    m_seriesCol.clear();
+    m_values.clear();
+    return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,265 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_AGGREGATOR_H
+#define COLUMNAR_AGGREGATOR_H
+
+#include "data-collection-object.h"
+
+#include "ns3/nstime.h"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup aggregator
+ *
+ * \brief This aggregator writes time series to a binary columnar file.
+ *
+ * Each sample is a (time, series id, value) tuple: the time in
+ * nanoseconds as a 64-bit integer, the series id as a 32-bit integer
+ * and the value as a double. The series are named by strings (e.g.,
+ * the context of Write2d), which are mapped to ids by a dictionary
+ * written along with the samples, so that the name of a series is
+ * stored once rather than with each sample.
+ *
+ * The samples are buffered in memory and written in blocks of at most
+ * "BlockSize" samples, each column of a block being stored
+ * contiguously. If "Compress" is true, the columns of a block are
+ * packed: the times are delta encoded, the ids are variable length
+ * integers, and each value is XORed with the previous value of its
+ * series, only the non-zero bytes of the result being stored. Slowly
+ * varying series (e.g., queue lengths or congestion windows) then
+ * take a few bytes per sample.
+ *
+ * The file is made of an 8-byte magic string, a 32-bit version and a
+ * sequence of chunks, all integers being little endian:
+ * - a dictionary chunk: the type (1, 8 bits), the number of new series
+ *   (32 bits) and for each series, by increasing id, the length of its
+ *   name (32 bits) followed by the name;
+ * - a block chunk: the type (2, 8 bits), the encoding (0 for raw, 1 for
+ *   packed, 8 bits), the number of samples (32 bits), the size of the
+ *   payload (32 bits) and the payload (the time, id and value columns).
+ *
+ * A dictionary chunk always precedes the first block using its series.
+ * Use ColumnarReader to read the samples back.
+ */
+class ColumnarAggregator : public DataCollectionObject
+{
+  public:
+    /// Encoding of a block.
+    enum Encoding : uint8_t
+    {
+        RAW = 0,   //!< fixed-width columns
+        PACKED = 1 //!< delta, variable length and XOR encoded columns
+    };
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \param outputFileName name of the file to write.
+     *
+     * Constructs a columnar aggregator that will create a file named
+     * outputFileName (the file is truncated).
+     */
+    ColumnarAggregator(const std::string& outputFileName);
+
+    ~ColumnarAggregator() override;
+
+    /**
+     * \param name the name of a series.
+     * \return the id of the series, which is added to the dictionary
+     * if it is new.
+     */
+    uint32_t GetSeriesId(const std::string& name);
+
+    /**
+     * \param seriesId the id of the series.
+     * \param time the time of the sample.
+     * \param value the value of the sample.
+     *
+     * \brief Writes a sample.
+     */
+    void Write(uint32_t seriesId, Time time, double value);
+
+    /**
+     * \param seriesId the id of the series.
+     * \param v1 the value of the sample.
+     *
+     * \brief Writes a sample taken at the current simulation time.
+     *
+     * This is a trace sink for one-dimensional values, to be bound to
+     * a series id, e.g. with Callback::Bind().
+     */
+    void WriteSeries1d(uint32_t seriesId, double v1);
+
+    /**
+     * \param seriesId the id of the series.
+     * \param v1 the time of the sample in seconds.
+     * \param v2 the value of the sample.
+     *
+     * \brief Writes a sample.
+     *
+     * This is a trace sink for the output of a TimeSeriesAdaptor, to be
+     * bound to a series id, e.g. with Callback::Bind().
+     */
+    void WriteSeries2d(uint32_t seriesId, double v1, double v2);
+
+    /**
+     * \param context the name of the series.
+     * \param v1 the value of the sample.
+     *
+     * \brief Writes a sample taken at the current simulation time.
+     */
+    void Write1d(std::string context, double v1);
+
+    /**
+     * \param context the name of the series.
+     * \param v1 the time of the sample in seconds.
+     * \param v2 the value of the sample.
+     *
+     * \brief Writes a sample.
+     */
+    void Write2d(std::string context, double v1, double v2);
+
+    /**
+     * \brief Writes the buffered samples and the new series to the file.
+     */
+    void Flush();
+
+    /**
+     * \brief Writes the buffered samples and closes the file.
+     *
+     * The samples written afterwards are discarded.
+     */
+    void Close();
+
+    /**
+     * \return the number of samples written so far.
+     */
+    uint64_t GetNSamples() const;
+
+  private:
+    /**
+     * \brief Writes the series added since the last dictionary chunk.
+     */
+    void WriteDictionary();
+
+    /**
+     * \brief Writes the buffered samples as a block chunk.
+     */
+    void WriteBlock();
+
+    std::string m_outputFileName; //!< The output file name.
+    std::ofstream m_file;         //!< Used to write values to the file.
+    uint32_t m_blockSize;         //!< Maximum number of samples of a block.
+    bool m_compress;              //!< Whether the blocks are packed.
+
+    /// Maps series names to series ids.
+    std::unordered_map<std::string, uint32_t> m_seriesIds;
+    /// Series names, by id.
+    std::vector<std::string> m_seriesNames;
+    /// Number of series written to the dictionary.
+    uint32_t m_nWrittenSeries;
+
+    std::string m_lastContext; //!< Context of the last call to Write1d or Write2d.
+    uint32_t m_lastSeriesId;   //!< Series id of m_lastContext.
+    bool m_hasLastContext;     //!< Whether m_lastContext is valid.
+
+    std::vector<int64_t> m_times;      //!< Time column of the current block (ns).
+    std::vector<uint32_t> m_seriesCol; //!< Series id column of the current block.
+    std::vector<double> m_values;      //!< Value column of the current block.
+    std::vector<char> m_payload;       //!< Encoded payload of the current block.
+    std::vector<uint64_t> m_previous;  //!< Previous value of each series (PACKED).
+    uint64_t m_nSamples;               //!< Number of samples written.
+};
+
+/**
+ * \ingroup aggregator
+ *
+ * \brief Reads the samples written by a ColumnarAggregator.
+ *
+ * The samples are read one block at a time, in the order in which they
+ * were written.
+ */
+class ColumnarReader
+{
+  public:
+    /**
+     * \param fileName the name of the file to read.
+     */
+    ColumnarReader(const std::string& fileName);
+
+    /**
+     * \return true if the file was opened and its format recognized.
+     */
+    bool IsOpen() const;
+
+    /**
+     * \param time the time of the sample.
+     * \param seriesId the id of the series.
+     * \param value the value of the sample.
+     * \return false if there are no more samples (or the file is corrupted).
+     *
+     * \brief Reads the next sample.
+     */
+    bool Read(Time& time, uint32_t& seriesId, double& value);
+
+    /**
+     * \return the number of series read so far.
+     */
+    uint32_t GetNSeries() const;
+
+    /**
+     * \param seriesId the id of a series read so far.
+     * \return the name of the series.
+     */
+    std::string GetSeriesName(uint32_t seriesId) const;
+
+    /**
+     * \param name the name of a series.
+     * \param seriesId the id of the series.
+     * \return false if the series has not been read so far.
+     */
+    bool LookupSeries(const std::string& name, uint32_t& seriesId) const;
+
+  private:
+    /**
+     * \brief Reads chunks until a block is loaded.
+     * \return false if there are no more blocks.
+     */
+    bool ReadBlock();
+
+    std::ifstream m_is;                     //!< The input file.
+    bool m_open;                            //!< Whether the file is open and recognized.
+    std::vector<std::string> m_seriesNames; //!< Series names, by id.
+    std::vector<int64_t> m_times;           //!< Time column of the current block (ns).
+    std::vector<uint32_t> m_seriesCol;      //!< Series id column of the current block.
+    std::vector<double> m_values;           //!< Value column of the current block.
+    std::size_t m_next;                     //!< Index of the next sample of the block.
+};
+
+} // namespace ns3
+
+#endif // COLUMNAR_AGGREGATOR_H
@@ -0,0 +1,286 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "quantile-sketch.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define DEFAULT_RELATIVE_ACCURACY 0.01
+#define DEFAULT_MAX_BINS 2048
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QuantileSketch");
+
+QuantileSketch::QuantileSketch(double relativeAccuracy, uint32_t maxBins)
+    : m_maxBins(maxBins)
+{
+    NS_ASSERT(maxBins > 0);
+    Clear();
+    SetRelativeAccuracy(relativeAccuracy);
+}
+
+QuantileSketch::QuantileSketch()
+    : QuantileSketch(DEFAULT_RELATIVE_ACCURACY, DEFAULT_MAX_BINS)
+{
+}
+
+void
+QuantileSketch::SetRelativeAccuracy(double relativeAccuracy)
+{
+    NS_ASSERT(m_count == 0); // we can only change the accuracy if no values were added
+    NS_ASSERT(relativeAccuracy > 0 && relativeAccuracy < 1);
+    m_relativeAccuracy = relativeAccuracy;
+    m_gamma = (1 + relativeAccuracy) / (1 - relativeAccuracy);
+    m_logGamma = std::log(m_gamma);
+    m_minIndexable = std::numeric_limits<double>::min() * m_gamma;
+}
+
+double
+QuantileSketch::GetRelativeAccuracy() const
+{
+    return m_relativeAccuracy;
+}
+
+int32_t
+QuantileSketch::GetIndex(double value) const
+{
+    return static_cast<int32_t>(std::ceil(std::log(value) / m_logGamma));
+}
+
+double
+QuantileSketch::GetValue(int32_t index) const
+{
+    return 2 * std::exp(index * m_logGamma) / (m_gamma + 1);
+}
+
+void
+QuantileSketch::AddToBin(int32_t index, uint64_t count)
+{
+    if (m_bins.empty())
+    {
+        m_offset = index;
+        m_bins.assign(1, count);
+        return;
+    }
+
+    int32_t high = m_offset + static_cast<int32_t>(m_bins.size()) - 1;
+    if (index >= m_offset && index <= high)
+    {
+        m_bins[index - m_offset] += count;
+        return;
+    }
+
+    int32_t newHigh = std::max(index, high);
+    int32_t newLow = std::min(index, m_offset);
+    if (newHigh - newLow + 1 > static_cast<int32_t>(m_maxBins))
+    {
+        // collapse the lowest bins
+        newLow = newHigh - static_cast<int32_t>(m_maxBins) + 1;
+    }
+
+    if (newLow == m_offset)
+    {
+        // the array only grows at its upper end
+        m_bins.resize(newHigh - newLow + 1, 0);
+    }
+    else
+    {
+        NS_LOG_DEBUG("Moving the first bin from " << m_offset << " to " << newLow);
+        std::vector<uint64_t> bins(newHigh - newLow + 1, 0);
+        for (std::size_t j = 0; j < m_bins.size(); j++)
+        {
+            int32_t i = std::max(m_offset + static_cast<int32_t>(j), newLow);
+            if (i <= newHigh)
+            {
+                bins[i - newLow] += m_bins[j];
+            }
+        }
+        m_bins.swap(bins);
+        m_offset = newLow;
+    }
+    m_bins[std::max(index, newLow) - newLow] += count;
+}
+
+void
+QuantileSketch::AddValue(double value)
+{
+    value = std::max(value, 0.0);
+    if (m_count == 0)
+    {
+        m_min = value;
+        m_max = value;
+    }
+    else
+    {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+    m_count++;
+    m_sum += value;
+
+    if (value <= m_minIndexable)
+    {
+        m_zeroCount++;
+    }
+    else
+    {
+        AddToBin(GetIndex(value), 1);
+    }
+}
+
+void
+QuantileSketch::Merge(const QuantileSketch& other)
+{
+    NS_ASSERT_MSG(other.m_relativeAccuracy == m_relativeAccuracy,
+                  "Cannot merge sketches with different relative accuracies");
+    if (other.m_count == 0)
+    {
+        return;
+    }
+    if (m_count == 0)
+    {
+        m_min = other.m_min;
+        m_max = other.m_max;
+    }
+    else
+    {
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_zeroCount += other.m_zeroCount;
+
+    // add the highest bins first, so that the lowest ones are collapsed if needed
+    for (std::size_t j = other.m_bins.size(); j > 0; j--)
+    {
+        if (other.m_bins[j - 1] > 0)
+        {
+            AddToBin(other.m_offset + static_cast<int32_t>(j - 1), other.m_bins[j - 1]);
+        }
+    }
+}
+
+double
+QuantileSketch::GetQuantile(double q) const
+{
+    NS_ASSERT(q >= 0 && q <= 1);
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    double rank = q * (m_count - 1);
+    uint64_t cumulative = m_zeroCount;
+    if (rank < cumulative)
+    {
+        return m_min;
+    }
+    for (std::size_t j = 0; j < m_bins.size(); j++)
+    {
+        cumulative += m_bins[j];
+        if (rank < cumulative)
+        {
+            // the representative value of the bin, within the observed range
+            return std::clamp(GetValue(m_offset + static_cast<int32_t>(j)), m_min, m_max);
+        }
+    }
+    return m_max;
+}
+
+uint64_t
+QuantileSketch::GetCount() const
+{
+    return m_count;
+}
+
+double
+QuantileSketch::GetSum() const
+{
+    return m_sum;
+}
+
+double
+QuantileSketch::GetMin() const
+{
+    return m_min;
+}
+
+double
+QuantileSketch::GetMax() const
+{
+    return m_max;
+}
+
+uint32_t
+QuantileSketch::GetNBins() const
+{
+    return m_bins.size();
+}
+
+void
+QuantileSketch::Clear()
+{
+    m_bins.clear();
+    m_offset = 0;
+    m_zeroCount = 0;
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+void
+QuantileSketch::SerializeToXmlStream(std::ostream& os,
+                                     uint16_t indent,
+                                     std::string elementName) const
+{
+    os << std::string(indent, ' ') << "<" << elementName << " relativeAccuracy=\""
+       << m_relativeAccuracy << "\""
+       << " count=\"" << m_count << "\""
+       << " sum=\"" << m_sum << "\""
+       << " min=\"" << m_min << "\""
+       << " max=\"" << m_max << "\""
+       << " p50=\"" << GetQuantile(0.5) << "\""
+       << " p90=\"" << GetQuantile(0.9) << "\""
+       << " p99=\"" << GetQuantile(0.99) << "\""
+       << " zeroCount=\"" << m_zeroCount << "\""
+       << " >\n";
+    indent += 2;
+    for (std::size_t j = 0; j < m_bins.size(); j++)
+    {
+        if (m_bins[j])
+        {
+            int32_t index = m_offset + static_cast<int32_t>(j);
+            os << std::string(indent, ' ');
+            os << "<bin"
+               << " index=\"" << index << "\""
+               << " value=\"" << GetValue(index) << "\""
+               << " count=\"" << m_bins[j] << "\""
+               << " />\n";
+        }
+    }
+    indent -= 2;
+    os << std::string(indent, ' ') << "</" << elementName << ">\n";
+}
+
+} // namespace ns3
@@ -0,0 +1,164 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef NS3_QUANTILE_SKETCH_H
+#define NS3_QUANTILE_SKETCH_H
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Mergeable sketch of the distribution of non-negative values.
+ *
+ * This is a DDSketch (C. Masson, J. E. Rim and H. K. Lee, "DDSketch: a fast
+ * and fully-mergeable quantile sketch with relative-error guarantees", VLDB
+ * 2019). Value \a x is counted in bin ceil(log(x) / log(gamma)), where
+ * gamma = (1 + alpha) / (1 - alpha), hence every quantile is estimated with
+ * a relative error of at most \a alpha, whatever the range of the values.
+ * Values not larger than the minimum indexable value (e.g., zero delays) are
+ * counted apart.
+ *
+ * The bins are kept in a contiguous array covering the range of the values
+ * seen so far. The number of bins is bounded: when the array would exceed
+ * the maximum number of bins, the lowest bins are collapsed into one, so
+ * that the high quantiles (usually the interesting ones) keep their accuracy.
+ *
+ * Two sketches with the same relative accuracy can be merged, e.g., to
+ * aggregate the statistics of several flows or simulation runs.
+ */
+class QuantileSketch
+{
+  public:
+    /**
+     * \brief Constructor
+     * \param relativeAccuracy the relative accuracy (alpha) of the quantiles
+     * \param maxBins the maximum number of bins
+     */
+    QuantileSketch(double relativeAccuracy, uint32_t maxBins = 2048);
+    QuantileSketch();
+
+    /**
+     * \brief Set the relative accuracy.
+     *
+     * Note that the relative accuracy can be changed only if the sketch is empty.
+     *
+     * \param relativeAccuracy the relative accuracy (alpha) of the quantiles
+     */
+    void SetRelativeAccuracy(double relativeAccuracy);
+
+    /**
+     * \return the relative accuracy (alpha) of the quantiles
+     */
+    double GetRelativeAccuracy() const;
+
+    /**
+     * \brief Add a value to the sketch
+     * \param value the value to add (negative values are counted as zero)
+     */
+    void AddValue(double value);
+
+    /**
+     * \brief Add the values of another sketch to this one
+     * \param other the other sketch, which must have the same relative accuracy
+     */
+    void Merge(const QuantileSketch& other);
+
+    /**
+     * \brief Estimate a quantile of the values
+     * \param q the quantile, between 0 and 1 (e.g., 0.99 for the 99th percentile)
+     * \return the estimate of the quantile (0 if the sketch is empty)
+     */
+    double GetQuantile(double q) const;
+
+    /**
+     * \return the number of values added to the sketch
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * \return the sum of the values added to the sketch
+     */
+    double GetSum() const;
+
+    /**
+     * \return the smallest value added to the sketch
+     */
+    double GetMin() const;
+
+    /**
+     * \return the largest value added to the sketch
+     */
+    double GetMax() const;
+
+    /**
+     * \return the number of bins currently allocated
+     */
+    uint32_t GetNBins() const;
+
+    /**
+     * Clear the sketch content.
+     */
+    void Clear();
+
+    /**
+     * \brief Serializes the sketch to an std::ostream in XML format.
+     * \param os the output stream
+     * \param indent number of spaces to use as base indentation level
+     * \param elementName name of the element to serialize.
+     */
+    void SerializeToXmlStream(std::ostream& os, uint16_t indent, std::string elementName) const;
+
+  private:
+    /**
+     * \param value a value larger than the minimum indexable value
+     * \return the index of the bin of the value
+     */
+    int32_t GetIndex(double value) const;
+
+    /**
+     * \param index the index of a bin
+     * \return the representative value of the bin
+     */
+    double GetValue(int32_t index) const;
+
+    /**
+     * \brief Add a count to a bin, growing or collapsing the array if needed
+     * \param index the index of the bin
+     * \param count the count to add
+     */
+    void AddToBin(int32_t index, uint64_t count);
+
+    double m_relativeAccuracy;    //!< relative accuracy (alpha)
+    double m_gamma;               //!< base of the logarithmic bins
+    double m_logGamma;            //!< log of gamma
+    double m_minIndexable;        //!< values not larger than this are counted in m_zeroCount
+    uint32_t m_maxBins;           //!< maximum number of bins
+    std::vector<uint64_t> m_bins; //!< the bins
+    int32_t m_offset;             //!< index of the first bin
+    uint64_t m_zeroCount;         //!< count of the values not larger than m_minIndexable
+    uint64_t m_count;             //!< count of all the values
+    double m_sum;                 //!< sum of the values
+    double m_min;                 //!< smallest value
+    double m_max;                 //!< largest value
+};
+
+} // namespace ns3
+
+#endif /* NS3_QUANTILE_SKETCH_H */
@@ -23,8 +23,11 @@
 #include "data-collector.h"
 #include "sqlite-output.h"
 
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/nstime.h"
+#include "ns3/uinteger.h"
 
 #include <sstream>
 
@@ -33,8 +36,20 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("SqliteDataOutput");
 
+namespace
+{
+
+/// Command inserting a singleton, the first parameter being the run label
+const std::string INSERT_SINGLETON = "INSERT INTO Singletons "
+                                     "(run, name, variable, value)"
+                                     "values (?, ?, ?, ?)";
+
+} // namespace
+
 SqliteDataOutput::SqliteDataOutput()
-    : DataOutputInterface()
+    : DataOutputInterface(),
+      m_batchSize(0),
+      m_backgroundWrite(false)
 {
     NS_LOG_FUNCTION(this);
 
@@ -50,10 +65,23 @@ SqliteDataOutput::~SqliteDataOutput()
 TypeId
 SqliteDataOutput::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::SqliteDataOutput")
-                            .SetParent<DataOutputInterface>()
-                            .SetGroupName("Stats")
-                            .AddConstructor<SqliteDataOutput>();
+    static TypeId tid =
+        TypeId("ns3::SqliteDataOutput")
+            .SetParent<DataOutputInterface>()
+            .SetGroupName("Stats")
+            .AddConstructor<SqliteDataOutput>()
+            .AddAttribute("BatchSize",
+                          "The maximum number of rows of a transaction, 0 for a transaction "
+                          "per metadata row and a single one for the calculator values",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SqliteDataOutput::m_batchSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("BackgroundWrite",
+                          "Whether the rows are written by a background thread (BatchSize "
+                          "must not be 0)",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SqliteDataOutput::m_backgroundWrite),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -62,79 +90,68 @@ void
 SqliteDataOutput::Output(DataCollector& dc)
 {
     NS_LOG_FUNCTION(this << &dc);
+    NS_ABORT_MSG_IF(m_backgroundWrite && m_batchSize == 0,
+                    "BackgroundWrite requires a non-zero BatchSize");
 
     std::string m_dbFile = m_filePrefix + ".db";
     std::string run = dc.GetRunLabel();
     bool res;
 
+    // Release the previous database first, which waits for its pending rows
+    m_sqliteOut = nullptr;
     m_sqliteOut = new SQLiteOutput(m_dbFile);
 
+    // The tables are created before the rows are queued
     res = m_sqliteOut->SpinExec("CREATE TABLE IF NOT EXISTS Experiments (run, experiment, "
                                 "strategy, input, description text)");
     NS_ASSERT(res);
-
-    sqlite3_stmt* stmt;
-    res = m_sqliteOut->WaitPrepare(&stmt,
-                                   "INSERT INTO Experiments "
-                                   "(run, experiment, strategy, input, description)"
-                                   "values (?, ?, ?, ?, ?)");
-    NS_ASSERT(res);
-
-    // Create temporary strings to hold their value
-    // throughout the lifetime of the Bind and Step
-    // procedures
-    //
-    // DataCollector could return const std::string&,
-    // but that could break the python bindings
-    res = m_sqliteOut->Bind(stmt, 1, run);
-    NS_ASSERT(res);
-    std::string experimentLabel = dc.GetExperimentLabel();
-    res = m_sqliteOut->Bind(stmt, 2, experimentLabel);
-    NS_ASSERT(res);
-    std::string strategyLabel = dc.GetStrategyLabel();
-    res = m_sqliteOut->Bind(stmt, 3, strategyLabel);
-    NS_ASSERT(res);
-    std::string inputLabel = dc.GetInputLabel();
-    res = m_sqliteOut->Bind(stmt, 4, inputLabel);
-    NS_ASSERT(res);
-    std::string description = dc.GetDescription();
-    res = m_sqliteOut->Bind(stmt, 5, description);
-    NS_ASSERT(res);
-
-    res = m_sqliteOut->SpinStep(stmt);
-    NS_ASSERT(res);
-    res = m_sqliteOut->SpinFinalize(stmt);
-    NS_ASSERT(res == 0);
-
     res = m_sqliteOut->WaitExec("CREATE TABLE IF NOT EXISTS "
                                 "Metadata ( run text, key text, value)");
     NS_ASSERT(res);
+    res = m_sqliteOut->WaitExec("CREATE TABLE IF NOT EXISTS Singletons "
+                                "( run text, name text, variable text, value )");
+    NS_ASSERT(res);
 
-    res = m_sqliteOut->WaitPrepare(&stmt,
-                                   "INSERT INTO Metadata "
-                                   "(run, key, value)"
-                                   "values (?, ?, ?)");
+    if (m_batchSize > 0)
+    {
+        m_sqliteOut->EnableBatching(m_batchSize, m_backgroundWrite);
+    }
+
+    res = m_sqliteOut->Insert("INSERT INTO Experiments "
+                              "(run, experiment, strategy, input, description)"
+                              "values (?, ?, ?, ?, ?)",
+                              {run,
+                               dc.GetExperimentLabel(),
+                               dc.GetStrategyLabel(),
+                               dc.GetInputLabel(),
+                               dc.GetDescription()});
     NS_ASSERT(res);
 
     for (auto i = dc.MetadataBegin(); i != dc.MetadataEnd(); i++)
     {
-        std::pair<std::string, std::string> blob = (*i);
-        m_sqliteOut->SpinReset(stmt);
-        m_sqliteOut->Bind(stmt, 1, run);
-        m_sqliteOut->Bind(stmt, 2, blob.first);
-        m_sqliteOut->Bind(stmt, 3, blob.second);
-        m_sqliteOut->SpinStep(stmt);
+        m_sqliteOut->Insert("INSERT INTO Metadata "
+                            "(run, key, value)"
+                            "values (?, ?, ?)",
+                            {run, i->first, i->second});
     }
 
-    m_sqliteOut->SpinFinalize(stmt);
-
-    m_sqliteOut->SpinExec("BEGIN");
+    if (m_batchSize == 0)
+    {
+        m_sqliteOut->SpinExec("BEGIN");
+    }
     SqliteOutputCallback callback(m_sqliteOut, run);
     for (auto i = dc.DataCalculatorBegin(); i != dc.DataCalculatorEnd(); i++)
     {
         (*i)->Output(callback);
     }
-    m_sqliteOut->SpinExec("COMMIT");
+    if (m_batchSize == 0)
+    {
+        m_sqliteOut->SpinExec("COMMIT");
+    }
+    else if (!m_backgroundWrite)
+    {
+        m_sqliteOut->Flush();
+    }
     // end SqliteDataOutput::Output
     m_sqliteOut->Unref();
 }
@@ -145,20 +162,10 @@ SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback(const Ptr<SQLiteOut
       m_runLabel(run)
 {
     NS_LOG_FUNCTION(this << db << run);
-
-    m_db->WaitExec("CREATE TABLE IF NOT EXISTS Singletons "
-                   "( run text, name text, variable text, value )");
-
-    m_db->WaitPrepare(&m_insertSingletonStatement,
-                      "INSERT INTO Singletons "
-                      "(run, name, variable, value)"
-                      "values (?, ?, ?, ?)");
-    m_db->Bind(m_insertSingletonStatement, 1, m_runLabel);
 }
 
 SqliteDataOutput::SqliteOutputCallback::~SqliteOutputCallback()
 {
-    m_db->SpinFinalize(m_insertSingletonStatement);
 }
 
 void
@@ -198,11 +205,7 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton(std::string key,
 {
     NS_LOG_FUNCTION(this << key << variable << val);
 
-    m_db->SpinReset(m_insertSingletonStatement);
-    m_db->Bind(m_insertSingletonStatement, 2, key);
-    m_db->Bind(m_insertSingletonStatement, 3, variable);
-    m_db->Bind(m_insertSingletonStatement, 4, val);
-    m_db->SpinStep(m_insertSingletonStatement);
+    m_db->Insert(INSERT_SINGLETON, {m_runLabel, key, variable, static_cast<int64_t>(val)});
 }
 
 void
@@ -212,11 +215,7 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton(std::string key,
 {
     NS_LOG_FUNCTION(this << key << variable << val);
 
-    m_db->SpinReset(m_insertSingletonStatement);
-    m_db->Bind(m_insertSingletonStatement, 2, key);
-    m_db->Bind(m_insertSingletonStatement, 3, variable);
-    m_db->Bind(m_insertSingletonStatement, 4, val);
-    m_db->SpinStep(m_insertSingletonStatement);
+    m_db->Insert(INSERT_SINGLETON, {m_runLabel, key, variable, static_cast<int64_t>(val)});
 }
 
 void
@@ -226,11 +225,7 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton(std::string key,
 {
     NS_LOG_FUNCTION(this << key << variable << val);
 
-    m_db->SpinReset(m_insertSingletonStatement);
-    m_db->Bind(m_insertSingletonStatement, 2, key);
-    m_db->Bind(m_insertSingletonStatement, 3, variable);
-    m_db->Bind(m_insertSingletonStatement, 4, val);
-    m_db->SpinStep(m_insertSingletonStatement);
+    m_db->Insert(INSERT_SINGLETON, {m_runLabel, key, variable, val});
 }
 
 void
@@ -240,11 +235,7 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton(std::string key,
 {
     NS_LOG_FUNCTION(this << key << variable << val);
 
-    m_db->SpinReset(m_insertSingletonStatement);
-    m_db->Bind(m_insertSingletonStatement, 2, key);
-    m_db->Bind(m_insertSingletonStatement, 3, variable);
-    m_db->Bind(m_insertSingletonStatement, 4, val);
-    m_db->SpinStep(m_insertSingletonStatement);
+    m_db->Insert(INSERT_SINGLETON, {m_runLabel, key, variable, std::move(val)});
 }
 
 void
@@ -254,11 +245,7 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton(std::string key,
 {
     NS_LOG_FUNCTION(this << key << variable << val);
 
-    m_db->SpinReset(m_insertSingletonStatement);
-    m_db->Bind(m_insertSingletonStatement, 2, key);
-    m_db->Bind(m_insertSingletonStatement, 3, variable);
-    m_db->Bind(m_insertSingletonStatement, 4, val.GetTimeStep());
-    m_db->SpinStep(m_insertSingletonStatement);
+    m_db->Insert(INSERT_SINGLETON, {m_runLabel, key, variable, val.GetTimeStep()});
 }
 
 } // namespace ns3
@@ -24,8 +24,6 @@
 
 #include "ns3/nstime.h"
 
-struct sqlite3_stmt;
-
 namespace ns3
 {
 
@@ -37,6 +35,14 @@ class SQLiteOutput;
  * \ingroup dataoutput
  * \class SqliteDataOutput
  * \brief Outputs data in a format compatible with SQLite
+ *
+ * By default, the metadata rows are written in autocommit mode (one
+ * transaction each) and the calculator values in a single transaction.
+ * With a non-zero "BatchSize", all the rows are grouped into transactions
+ * of up to BatchSize rows. With "BackgroundWrite", the rows are written by
+ * a background thread: Output returns once the rows are queued, and the
+ * database is complete when the next Output starts or this object is
+ * destroyed.
  */
 class SqliteDataOutput : public DataOutputInterface
 {
@@ -126,12 +132,11 @@ class SqliteDataOutput : public DataOutputInterface
       private:
         Ptr<SQLiteOutput> m_db; //!< Db
         std::string m_runLabel; //!< Run label
-
-        /// Pointer to a Sqlite3 singleton statement
-        sqlite3_stmt* m_insertSingletonStatement;
     };
 
     Ptr<SQLiteOutput> m_sqliteOut; //!< Database
+    uint32_t m_batchSize;          //!< Rows per transaction, 0 for the default grouping
+    bool m_backgroundWrite;        //!< Whether the rows are written by a background thread
 };
 
 // end namespace ns3
@@ -37,6 +37,24 @@ SQLiteOutput::SQLiteOutput(const std::string& name)
 
 SQLiteOutput::~SQLiteOutput()
 {
+    Flush();
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard lock{m_queueMutex};
+            m_stop = true;
+        }
+        m_queueCv.notify_one();
+        m_thread.join();
+    }
+    for (auto stmt : m_statements)
+    {
+        if (stmt != nullptr)
+        {
+            SpinFinalize(stmt);
+        }
+    }
+
     int rc = SQLITE_FAIL;
 
     rc = sqlite3_close_v2(m_db);
@@ -50,6 +68,178 @@ SQLiteOutput::SetJournalInMemory()
     SpinExec("PRAGMA journal_mode = MEMORY");
 }
 
+void
+SQLiteOutput::EnableBatching(uint32_t rowsPerTransaction, bool background)
+{
+    NS_LOG_FUNCTION(this << rowsPerTransaction << background);
+    NS_ABORT_MSG_IF(rowsPerTransaction == 0, "A transaction must hold at least one row");
+    NS_ABORT_MSG_IF(m_thread.joinable(), "The rows are already written by a background thread");
+
+    {
+        std::lock_guard lock{m_mutex};
+        m_rowsPerTransaction = rowsPerTransaction;
+    }
+    if (background)
+    {
+        m_thread = std::thread(&SQLiteOutput::Run, this);
+    }
+}
+
+bool
+SQLiteOutput::Insert(const std::string& cmd, std::vector<Value> values)
+{
+    Row row;
+    auto [it, inserted] = m_commands.emplace(cmd, m_commands.size());
+    row.command = it->second;
+    if (inserted)
+    {
+        // The writer prepares the statement when it gets the first row
+        row.cmd = cmd;
+    }
+    row.values = std::move(values);
+
+    if (m_thread.joinable())
+    {
+        bool wake;
+        {
+            std::lock_guard lock{m_queueMutex};
+            wake = m_queue.empty();
+            m_queue.push_back(std::move(row));
+        }
+        if (wake)
+        {
+            m_queueCv.notify_one();
+        }
+        return true;
+    }
+
+    std::unique_lock lock{m_mutex};
+    return WriteRow(row);
+}
+
+bool
+SQLiteOutput::Flush()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_thread.joinable())
+    {
+        std::unique_lock queueLock{m_queueMutex};
+        m_idleCv.wait(queueLock, [this] { return m_queue.empty() && !m_busy; });
+    }
+
+    std::unique_lock lock{m_mutex};
+    Commit();
+    return m_failedRows == 0;
+}
+
+bool
+SQLiteOutput::WriteRow(const Row& row)
+{
+    // The rows are written in order, hence a command is new on its first row
+    NS_ASSERT(row.command <= m_statements.size());
+    if (row.command == m_statements.size())
+    {
+        sqlite3_stmt* stmt = nullptr;
+        int rc = SpinPrepare(m_db, &stmt, row.cmd);
+        if (CheckError(m_db, rc, row.cmd, false))
+        {
+            stmt = nullptr;
+        }
+        m_statements.push_back(stmt);
+    }
+    sqlite3_stmt* stmt = m_statements[row.command];
+    if (stmt == nullptr)
+    {
+        m_failedRows++;
+        return false;
+    }
+
+    if (m_rowsPerTransaction > 0 && !m_inTransaction)
+    {
+        CheckError(m_db, SpinExec(m_db, "BEGIN"), "BEGIN", false);
+        m_inTransaction = true;
+    }
+
+    for (std::size_t i = 0; i < row.values.size(); i++)
+    {
+        int pos = static_cast<int>(i) + 1;
+        if (auto value = std::get_if<int64_t>(&row.values[i]))
+        {
+            sqlite3_bind_int64(stmt, pos, *value);
+        }
+        else if (auto value = std::get_if<double>(&row.values[i]))
+        {
+            sqlite3_bind_double(stmt, pos, *value);
+        }
+        else
+        {
+            // The string outlives the step
+            const auto& text = std::get<std::string>(row.values[i]);
+            sqlite3_bind_text(stmt, pos, text.c_str(), -1, SQLITE_STATIC);
+        }
+    }
+    int rc = SpinStep(stmt);
+    bool ok = !CheckError(m_db, rc, sqlite3_sql(stmt), false);
+    SpinReset(stmt);
+    if (!ok)
+    {
+        m_failedRows++;
+    }
+
+    if (m_inTransaction && ++m_transactionRows >= m_rowsPerTransaction)
+    {
+        Commit();
+    }
+    return ok;
+}
+
+void
+SQLiteOutput::Commit()
+{
+    if (!m_inTransaction)
+    {
+        return;
+    }
+    CheckError(m_db, SpinExec(m_db, "COMMIT"), "COMMIT", false);
+    m_inTransaction = false;
+    m_transactionRows = 0;
+}
+
+void
+SQLiteOutput::Run()
+{
+    std::unique_lock queueLock{m_queueMutex};
+    while (true)
+    {
+        m_queueCv.wait(queueLock, [this] { return !m_queue.empty() || m_stop; });
+        if (m_queue.empty())
+        {
+            break;
+        }
+
+        // Take all the pending rows, so that the caller is not blocked
+        // while they are written
+        std::vector<Row> rows;
+        rows.swap(m_queue);
+        m_busy = true;
+        queueLock.unlock();
+        {
+            std::lock_guard lock{m_mutex};
+            for (const auto& row : rows)
+            {
+                WriteRow(row);
+            }
+        }
+        queueLock.lock();
+        m_busy = false;
+        if (m_queue.empty())
+        {
+            m_idleCv.notify_all();
+        }
+    }
+}
+
 bool
 SQLiteOutput::SpinExec(const std::string& cmd) const
 {
@@ -20,9 +20,15 @@
 
 #include "ns3/simple-ref-count.h"
 
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <sqlite3.h>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +48,14 @@ namespace ns3
  * the database is unique, using "Spin" methods will speed up database access.
  *
  * The database is opened in the constructor, and closed in the deconstructor.
+ *
+ * Rows can also be added with Insert, which prepares each distinct command
+ * once and reuses the statement. By default, each row is a transaction of its
+ * own (the autocommit mode of SQLITE, with a journal sync per row). After
+ * EnableBatching, the rows are grouped into explicit transactions of up to a
+ * given number of rows and, optionally, written by a background thread, the
+ * caller only queuing the values. Flush waits for the pending rows and
+ * commits them; the other methods should not be used while rows are pending.
  */
 class SQLiteOutput : public SimpleRefCount<SQLiteOutput>
 {
@@ -63,6 +77,34 @@ class SQLiteOutput : public SimpleRefCount<SQLiteOutput>
      */
     void SetJournalInMemory();
 
+    /// A value of a row added with Insert
+    using Value = std::variant<int64_t, double, std::string>;
+
+    /**
+     * \brief Group the rows added with Insert into explicit transactions
+     * \param rowsPerTransaction Maximum number of rows of a transaction
+     * \param background Whether the rows are written by a background thread
+     */
+    void EnableBatching(uint32_t rowsPerTransaction, bool background);
+
+    /**
+     * \brief Add a row, binding values to the parameters of a command
+     *
+     * The statement of the command is prepared on first use and reused
+     * afterwards. Without batching, the row is written immediately.
+     *
+     * \param cmd Command, usually an INSERT with one parameter per value
+     * \param values The values of the parameters, in order
+     * \return false if the row was written immediately and that failed
+     */
+    bool Insert(const std::string& cmd, std::vector<Value> values);
+
+    /**
+     * \brief Write the pending rows and commit the open transaction, if any
+     * \return false if any row added with Insert failed so far
+     */
+    bool Flush();
+
     /**
      * \brief Execute a command until the return value is OK or an ERROR
      *
@@ -227,9 +269,54 @@ class SQLiteOutput : public SimpleRefCount<SQLiteOutput>
     static bool CheckError(sqlite3* db, int rc, const std::string& cmd, bool hardExit);
 
   private:
+    /// A row added with Insert
+    struct Row
+    {
+        uint32_t command;          //!< Index of the command
+        std::string cmd;           //!< Text of the command, on the first use only
+        std::vector<Value> values; //!< Values of the parameters
+    };
+
+    /**
+     * \brief Write a row, in the open transaction when batching
+     *
+     * Called with m_mutex held, by the background thread if any.
+     *
+     * \param row The row
+     * \return true in case of success
+     */
+    bool WriteRow(const Row& row);
+
+    /**
+     * \brief Commit the open transaction, if any, with m_mutex held
+     */
+    void Commit();
+
+    /// \brief The body of the background thread
+    void Run();
+
     std::string m_dBname;       //!< Database name
     mutable std::mutex m_mutex; //!< Mutex
     sqlite3* m_db{nullptr};     //!< Database pointer
+
+    // Insert (caller side)
+    std::unordered_map<std::string, uint32_t> m_commands; //!< Index of each command
+    uint32_t m_rowsPerTransaction{0};                     //!< Rows per transaction (0: no batch)
+
+    // Insert (writer side, with m_mutex held)
+    std::vector<sqlite3_stmt*> m_statements; //!< Prepared statement of each command
+    uint32_t m_transactionRows{0};           //!< Rows of the open transaction
+    bool m_inTransaction{false};             //!< Whether a transaction is open
+    uint64_t m_failedRows{0};                //!< Rows that could not be written
+
+    // Background thread
+    std::mutex m_queueMutex;           //!< Protects the queue and the state of the thread
+    std::condition_variable m_queueCv; //!< Signals new rows or the end of the thread
+    std::condition_variable m_idleCv;  //!< Signals that the queue was written
+    std::vector<Row> m_queue;          //!< Rows waiting for the background thread
+    bool m_busy{false};                //!< Whether the thread is writing rows
+    bool m_stop{false};                //!< Whether the thread must stop
+    std::thread m_thread;              //!< The background thread, if any
 };
 
 } // namespace ns3
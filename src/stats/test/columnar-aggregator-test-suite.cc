@@ -0,0 +1,217 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/columnar-aggregator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <bit>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief ColumnarAggregator and ColumnarReader round trip test
+ *
+ * Samples of several series, some of them added after the first blocks
+ * were written, are written with a given block size and encoding and read
+ * back: the times, series and values (bit for bit) must be those written.
+ */
+class ColumnarAggregatorRoundTripTestCase : public TestCase
+{
+  public:
+    /**
+     * \param blockSize the maximum number of samples of a block
+     * \param compress whether the blocks are packed
+     */
+    ColumnarAggregatorRoundTripTestCase(uint32_t blockSize, bool compress);
+
+  private:
+    void DoRun() override;
+
+    /// A sample written to the file
+    struct Sample
+    {
+        Time time;        //!< the time of the sample
+        std::string name; //!< the name of the series
+        double value;     //!< the value of the sample
+    };
+
+    uint32_t m_blockSize; //!< the maximum number of samples of a block
+    bool m_compress;      //!< whether the blocks are packed
+};
+
+ColumnarAggregatorRoundTripTestCase::ColumnarAggregatorRoundTripTestCase(uint32_t blockSize,
+                                                                         bool compress)
+    : TestCase("Write and read back samples in blocks of " + std::to_string(blockSize) +
+               (compress ? " packed" : " raw") + " samples"),
+      m_blockSize(blockSize),
+      m_compress(compress)
+{
+}
+
+void
+ColumnarAggregatorRoundTripTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("columnar");
+
+    std::vector<Sample> samples;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        // a slowly varying series, a series whose values change a lot, and
+        // series added as the samples are written
+        samples.push_back({MicroSeconds(10 * i), "queue", static_cast<double>(i / 7)});
+        samples.push_back({MicroSeconds(10 * i + 3), "cwnd", 1448.0 * i * i - 0.1 * i});
+        if (i % 10 == 0)
+        {
+            samples.push_back({MicroSeconds(10 * i + 5), "flow " + std::to_string(i), -1.0 / 3});
+        }
+    }
+    // times not in order, and special values
+    samples.push_back({Seconds(5), "queue", -0.0});
+    samples.push_back({Seconds(1), "queue", std::numeric_limits<double>::infinity()});
+    samples.push_back({Seconds(2), "cwnd", std::numeric_limits<double>::quiet_NaN()});
+    samples.push_back({Seconds(-1), "cwnd", std::numeric_limits<double>::denorm_min()});
+    samples.push_back({Seconds(3), "queue", std::numeric_limits<double>::max()});
+
+    auto aggregator = CreateObject<ColumnarAggregator>(fileName);
+    aggregator->SetAttribute("BlockSize", UintegerValue(m_blockSize));
+    aggregator->SetAttribute("Compress", BooleanValue(m_compress));
+    for (const auto& sample : samples)
+    {
+        aggregator->Write(aggregator->GetSeriesId(sample.name), sample.time, sample.value);
+    }
+    aggregator->Close();
+    NS_TEST_ASSERT_MSG_EQ(aggregator->GetNSamples(), samples.size(), "Wrong number of samples");
+
+    ColumnarReader reader(fileName);
+    NS_TEST_ASSERT_MSG_EQ(reader.IsOpen(), true, "File not recognized");
+    Time time;
+    uint32_t seriesId;
+    double value;
+    for (std::size_t i = 0; i < samples.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(reader.Read(time, seriesId, value), true, "Sample not read");
+        NS_TEST_EXPECT_MSG_EQ(time, samples[i].time, "Wrong time of sample " << i);
+        NS_TEST_EXPECT_MSG_EQ(reader.GetSeriesName(seriesId),
+                              samples[i].name,
+                              "Wrong series of sample " << i);
+        NS_TEST_EXPECT_MSG_EQ(std::bit_cast<uint64_t>(value),
+                              std::bit_cast<uint64_t>(samples[i].value),
+                              "Wrong value of sample " << i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(reader.Read(time, seriesId, value), false, "Unexpected sample read");
+
+    NS_TEST_ASSERT_MSG_EQ(reader.GetNSeries(), 12, "Wrong number of series");
+    NS_TEST_ASSERT_MSG_EQ(reader.LookupSeries("cwnd", seriesId), true, "Series not found");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetSeriesName(seriesId), "cwnd", "Wrong series name");
+    NS_TEST_ASSERT_MSG_EQ(reader.LookupSeries("flow 90", seriesId), true, "Series not found");
+    NS_TEST_ASSERT_MSG_EQ(reader.LookupSeries("flow 5", seriesId), false, "Unknown series found");
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief ColumnarAggregator test of the samples written by the trace sinks
+ */
+class ColumnarAggregatorSinkTestCase : public TestCase
+{
+  public:
+    ColumnarAggregatorSinkTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ColumnarAggregatorSinkTestCase::ColumnarAggregatorSinkTestCase()
+    : TestCase("Write samples through the trace sinks of a ColumnarAggregator")
+{
+}
+
+void
+ColumnarAggregatorSinkTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("columnar-sinks");
+
+    auto aggregator = CreateObject<ColumnarAggregator>(fileName);
+    aggregator->SetAttribute("BlockSize", UintegerValue(2));
+    aggregator->Write2d("a", 1.5, 10);
+    aggregator->Write2d("b", 2.5, 20);
+    aggregator->Write2d("a", 3.5, 30);
+    aggregator->WriteSeries2d(aggregator->GetSeriesId("b"), 4.5, 40);
+    aggregator->Write1d("c", 50);
+    // the samples written while disabled or after the file is closed are discarded
+    aggregator->Disable();
+    aggregator->Write2d("a", 5.5, 60);
+    aggregator->Enable();
+    aggregator->Flush();
+    aggregator->Write2d("a", 6.5, 70);
+    aggregator->Close();
+    aggregator->Write2d("a", 7.5, 80);
+    NS_TEST_ASSERT_MSG_EQ(aggregator->GetNSamples(), 6, "Wrong number of samples");
+
+    const std::vector<std::pair<std::string, double>> expected{{"a", 10},
+                                                               {"b", 20},
+                                                               {"a", 30},
+                                                               {"b", 40},
+                                                               {"c", 50},
+                                                               {"a", 70}};
+    ColumnarReader reader(fileName);
+    Time time;
+    uint32_t seriesId;
+    double value;
+    for (const auto& [name, v] : expected)
+    {
+        NS_TEST_ASSERT_MSG_EQ(reader.Read(time, seriesId, value), true, "Sample not read");
+        NS_TEST_EXPECT_MSG_EQ(reader.GetSeriesName(seriesId), name, "Wrong series");
+        NS_TEST_EXPECT_MSG_EQ(value, v, "Wrong value");
+    }
+    NS_TEST_ASSERT_MSG_EQ(reader.Read(time, seriesId, value), false, "Unexpected sample read");
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief ColumnarAggregator test suite
+ */
+class ColumnarAggregatorTestSuite : public TestSuite
+{
+  public:
+    ColumnarAggregatorTestSuite();
+};
+
+ColumnarAggregatorTestSuite::ColumnarAggregatorTestSuite()
+    : TestSuite("columnar-aggregator", UNIT)
+{
+    AddTestCase(new ColumnarAggregatorRoundTripTestCase(3, true), TestCase::QUICK);
+    AddTestCase(new ColumnarAggregatorRoundTripTestCase(3, false), TestCase::QUICK);
+    AddTestCase(new ColumnarAggregatorRoundTripTestCase(65536, true), TestCase::QUICK);
+    AddTestCase(new ColumnarAggregatorRoundTripTestCase(65536, false), TestCase::QUICK);
+    AddTestCase(new ColumnarAggregatorSinkTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static ColumnarAggregatorTestSuite g_columnarAggregatorTestSuite;
@@ -0,0 +1,227 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/quantile-sketch.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief QuantileSketch relative error test
+ *
+ * Values spanning several orders of magnitude are added to a sketch, whose
+ * quantile estimates must be within its relative accuracy of the exact
+ * quantiles.
+ */
+class QuantileSketchAccuracyTestCase : public TestCase
+{
+  public:
+    QuantileSketchAccuracyTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+QuantileSketchAccuracyTestCase::QuantileSketchAccuracyTestCase()
+    : TestCase("Check the relative error of the quantiles of a QuantileSketch")
+{
+}
+
+void
+QuantileSketchAccuracyTestCase::DoRun()
+{
+    auto rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    for (double alpha : {0.01, 0.05})
+    {
+        QuantileSketch sketch(alpha);
+        std::vector<double> values;
+        for (uint32_t i = 0; i < 10000; i++)
+        {
+            // delays between 1 us and 10 s
+            values.push_back(std::pow(10, rng->GetValue(-6, 1)));
+            sketch.AddValue(values.back());
+        }
+        // a few zero delays
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            values.push_back(0);
+            sketch.AddValue(0);
+        }
+        std::sort(values.begin(), values.end());
+
+        NS_TEST_ASSERT_MSG_EQ(sketch.GetCount(), values.size(), "Wrong count");
+        NS_TEST_ASSERT_MSG_EQ(sketch.GetMin(), 0, "Wrong minimum");
+        NS_TEST_ASSERT_MSG_EQ(sketch.GetMax(), values.back(), "Wrong maximum");
+        for (double q : {0.0, 0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0})
+        {
+            double exact = values[static_cast<std::size_t>(q * (values.size() - 1))];
+            NS_TEST_ASSERT_MSG_EQ_TOL(sketch.GetQuantile(q),
+                                      exact,
+                                      alpha * exact + 1e-12,
+                                      "Relative error too large for q=" << q);
+        }
+    }
+
+    QuantileSketch empty(0.01);
+    NS_TEST_ASSERT_MSG_EQ(empty.GetQuantile(0.5), 0, "Wrong quantile of an empty sketch");
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief QuantileSketch test of the collapse of the lowest bins
+ *
+ * When the number of bins is bounded, the lowest bins are collapsed: the
+ * high quantiles must keep their relative accuracy.
+ */
+class QuantileSketchCollapseTestCase : public TestCase
+{
+  public:
+    QuantileSketchCollapseTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+QuantileSketchCollapseTestCase::QuantileSketchCollapseTestCase()
+    : TestCase("Check the high quantiles of a QuantileSketch with collapsed bins")
+{
+}
+
+void
+QuantileSketchCollapseTestCase::DoRun()
+{
+    auto rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(2);
+
+    const double alpha = 0.01;
+    QuantileSketch sketch(alpha, 64);
+    std::vector<double> values;
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        values.push_back(std::pow(10, rng->GetValue(-6, 1)));
+        sketch.AddValue(values.back());
+    }
+    std::sort(values.begin(), values.end());
+
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(sketch.GetNBins(), 64, "Too many bins");
+    for (double q : {0.99, 0.999, 1.0})
+    {
+        double exact = values[static_cast<std::size_t>(q * (values.size() - 1))];
+        NS_TEST_ASSERT_MSG_EQ_TOL(sketch.GetQuantile(q),
+                                  exact,
+                                  alpha * exact,
+                                  "Relative error too large for q=" << q);
+    }
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief QuantileSketch merge test
+ *
+ * Merging the sketches of two sets of values must give the same statistics
+ * as a single sketch of both sets.
+ */
+class QuantileSketchMergeTestCase : public TestCase
+{
+  public:
+    QuantileSketchMergeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+QuantileSketchMergeTestCase::QuantileSketchMergeTestCase()
+    : TestCase("Merge two QuantileSketch objects")
+{
+}
+
+void
+QuantileSketchMergeTestCase::DoRun()
+{
+    auto rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(3);
+
+    QuantileSketch a(0.01);
+    QuantileSketch b(0.01);
+    QuantileSketch all(0.01);
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        // the two sets of values have different ranges, so that the bins
+        // of the merged sketch extend those of both sketches
+        double low = std::pow(10, rng->GetValue(-6, -2));
+        double high = std::pow(10, rng->GetValue(-3, 1));
+        a.AddValue(low);
+        b.AddValue(high);
+        all.AddValue(low);
+        all.AddValue(high);
+    }
+    a.AddValue(0);
+    all.AddValue(0);
+
+    a.Merge(b);
+    NS_TEST_ASSERT_MSG_EQ(a.GetCount(), all.GetCount(), "Wrong count");
+    NS_TEST_ASSERT_MSG_EQ_TOL(a.GetSum(), all.GetSum(), 1e-9 * all.GetSum(), "Wrong sum");
+    NS_TEST_ASSERT_MSG_EQ(a.GetMin(), all.GetMin(), "Wrong minimum");
+    NS_TEST_ASSERT_MSG_EQ(a.GetMax(), all.GetMax(), "Wrong maximum");
+    for (double q : {0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0})
+    {
+        NS_TEST_ASSERT_MSG_EQ(a.GetQuantile(q), all.GetQuantile(q), "Wrong quantile " << q);
+    }
+
+    // merging an empty sketch changes nothing
+    QuantileSketch empty(0.01);
+    a.Merge(empty);
+    NS_TEST_ASSERT_MSG_EQ(a.GetCount(), all.GetCount(), "Wrong count");
+    NS_TEST_ASSERT_MSG_EQ(a.GetQuantile(0.5), all.GetQuantile(0.5), "Wrong median");
+
+    // merging into an empty sketch copies the other sketch
+    empty.Merge(all);
+    NS_TEST_ASSERT_MSG_EQ(empty.GetCount(), all.GetCount(), "Wrong count");
+    NS_TEST_ASSERT_MSG_EQ(empty.GetMin(), all.GetMin(), "Wrong minimum");
+    NS_TEST_ASSERT_MSG_EQ(empty.GetQuantile(0.9), all.GetQuantile(0.9), "Wrong quantile");
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief QuantileSketch test suite
+ */
+class QuantileSketchTestSuite : public TestSuite
+{
+  public:
+    QuantileSketchTestSuite();
+};
+
+QuantileSketchTestSuite::QuantileSketchTestSuite()
+    : TestSuite("quantile-sketch", UNIT)
+{
+    AddTestCase(new QuantileSketchAccuracyTestCase, TestCase::QUICK);
+    AddTestCase(new QuantileSketchCollapseTestCase, TestCase::QUICK);
+    AddTestCase(new QuantileSketchMergeTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static QuantileSketchTestSuite g_quantileSketchTestSuite;
@@ -199,6 +199,12 @@ TrafficControlHelper::DoAddChildQueueDiscs(uint16_t handle,
     return list;
 }
 
+void
+TrafficControlHelper::SetSharedBufferPool(Ptr<SharedBufferPool> pool)
+{
+    m_sharedBufferPool = pool;
+}
+
 QueueDiscContainer
 TrafficControlHelper::Install(Ptr<NetDevice> d)
 {
@@ -222,6 +228,10 @@ TrafficControlHelper::Install(Ptr<NetDevice> d)
     // Set the root queue disc (if any has been created) on the device
     if (!m_queueDiscs.empty() && m_queueDiscs[0])
     {
+        if (m_sharedBufferPool)
+        {
+            m_queueDiscs[0]->SetSharedBufferPool(m_sharedBufferPool);
+        }
         tc->SetRootQueueDiscOnDevice(d, m_queueDiscs[0]);
         container.Add(m_queueDiscs[0]);
     }
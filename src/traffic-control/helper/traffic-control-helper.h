@@ -24,6 +24,7 @@
 #include "ns3/net-device-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/queue.h"
+#include "ns3/shared-buffer-pool.h"
 
 #include <map>
 #include <string>
@@ -250,6 +251,15 @@ class TrafficControlHelper
     template <typename... Args>
     void SetQueueLimits(std::string type, Args&&... args);
 
+    /**
+     * Helper function used to make the root queue discs installed by this helper
+     * draw from a shared packet buffer, as the ports of a shared-buffer switch.
+     * Each root queue disc is attached to the pool as a new port.
+     *
+     * \param pool the shared buffer pool (null to stop attaching root queue discs)
+     */
+    void SetSharedBufferPool(Ptr<SharedBufferPool> pool);
+
     /**
      * \param c set of devices
      * \returns a QueueDisc container with the root queue discs installed on the devices
@@ -370,6 +380,8 @@ class TrafficControlHelper
     std::vector<Ptr<QueueDisc>> m_queueDiscs;
     /// Factory to create a queue limits object
     ObjectFactory m_queueLimitsFactory;
+    /// Shared buffer pool the root queue discs are attached to
+    Ptr<SharedBufferPool> m_sharedBufferPool;
 };
 
 } // namespace ns3
@@ -108,6 +108,11 @@ class CobaltQueueDisc : public QueueDisc
         "forcedMark"; //!< forced marks by Codel on ECN-enabled
     static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
         "CE threshold exceeded mark"; //!< Sojourn time above CE threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t TARGET_EXCEEDED_DROP_ID;       //!< ID of TARGET_EXCEEDED_DROP
+    static const uint32_t OVERLIMIT_DROP_ID;             //!< ID of OVERLIMIT_DROP
+    static const uint32_t FORCED_MARK_ID;                //!< ID of FORCED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
 
     /**
      * \brief Get the drop probability of Blue
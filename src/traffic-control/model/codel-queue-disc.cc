@@ -70,6 +70,14 @@ CoDelGetTime()
 
 NS_OBJECT_ENSURE_REGISTERED(CoDelQueueDisc);
 
+const uint32_t CoDelQueueDisc::TARGET_EXCEEDED_DROP_ID =
+    QueueDisc::RegisterReason(TARGET_EXCEEDED_DROP);
+const uint32_t CoDelQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::RegisterReason(OVERLIMIT_DROP);
+const uint32_t CoDelQueueDisc::TARGET_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(TARGET_EXCEEDED_MARK);
+const uint32_t CoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId
 CoDelQueueDisc::GetTypeId()
 {
@@ -179,7 +187,7 @@ CoDelQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     if (GetCurrentSize() + item > GetMaxSize())
     {
         NS_LOG_LOGIC("Queue full -- dropping pkt");
-        DropBeforeEnqueue(item, OVERLIMIT_DROP);
+        DropBeforeEnqueue(item, OVERLIMIT_DROP_ID);
         return false;
     }
 
@@ -268,7 +276,7 @@ CoDelQueueDisc::DoDequeue()
             }
 
             if (CoDelTimeAfter(ldelay, Time2CoDel(m_ceThreshold)) &&
-                Mark(item, CE_THRESHOLD_EXCEEDED_MARK))
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
             {
                 NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
             }
@@ -308,7 +316,7 @@ CoDelQueueDisc::DoDequeue()
                 // A large amount of packets in queue might result in drop
                 // rates so high that the next drop should happen now,
                 // hence the while loop.
-                if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK))
+                if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK_ID))
                 {
                     isMarked = true;
                     NS_LOG_LOGIC("Sojourn time is still above target and it's time for next drop "
@@ -323,7 +331,7 @@ CoDelQueueDisc::DoDequeue()
                 NS_LOG_LOGIC(
                     "Sojourn time is still above target and it's time for next drop; dropping "
                     << item);
-                DropAfterDequeue(item, TARGET_EXCEEDED_DROP);
+                DropAfterDequeue(item, TARGET_EXCEEDED_DROP_ID);
 
                 item = GetInternalQueue(0)->Dequeue();
 
@@ -359,7 +367,7 @@ CoDelQueueDisc::DoDequeue()
                      "first packet");
         if (okToDrop)
         {
-            if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK))
+            if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK_ID))
             {
                 isMarked = true;
                 NS_LOG_LOGIC("Sojourn time goes above target, marking the first packet "
@@ -370,7 +378,7 @@ CoDelQueueDisc::DoDequeue()
                 // Drop the first packet and enter dropping state unless the queue is empty
                 NS_LOG_LOGIC("Sojourn time goes above target, dropping the first packet "
                              << item << " and entering the dropping state");
-                DropAfterDequeue(item, TARGET_EXCEEDED_DROP);
+                DropAfterDequeue(item, TARGET_EXCEEDED_DROP_ID);
                 item = GetInternalQueue(0)->Dequeue();
                 if (item)
                 {
@@ -411,7 +419,8 @@ end:
     // it would result in two counts of mark in the queue statistics. Therefore, we
     // use the isMarked flag to suppress a second attempt at marking.
     if (!isMarked && item && !m_useL4s && m_useEcn &&
-        CoDelTimeAfter(ldelay, Time2CoDel(m_ceThreshold)) && Mark(item, CE_THRESHOLD_EXCEEDED_MARK))
+        CoDelTimeAfter(ldelay, Time2CoDel(m_ceThreshold)) &&
+        Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
     {
         NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
     }
@@ -109,10 +109,16 @@ class CoDelQueueDisc : public QueueDisc
         "Target exceeded mark"; //!< Sojourn time above target
     static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
         "CE threshold exceeded mark"; //!< Sojourn time above CE threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t TARGET_EXCEEDED_DROP_ID;       //!< ID of TARGET_EXCEEDED_DROP
+    static const uint32_t OVERLIMIT_DROP_ID;             //!< ID of OVERLIMIT_DROP
+    static const uint32_t TARGET_EXCEEDED_MARK_ID;       //!< ID of TARGET_EXCEEDED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
 
   private:
     friend class ::CoDelQueueDiscNewtonStepTest; // Test code
     friend class ::CoDelQueueDiscControlLawTest; // Test code
+    friend class FqCoDelQueueDisc;               // Shares the CoDel control law
     /**
      * \brief Add a packet to the queue
      *
@@ -174,28 +180,28 @@ class CoDelQueueDisc : public QueueDisc
      * @param b right operand
      * @return true if a is greater than b
      */
-    bool CoDelTimeAfter(uint32_t a, uint32_t b);
+    static bool CoDelTimeAfter(uint32_t a, uint32_t b);
     /**
      * Check if CoDel time a is successive or equal to b
      * @param a left operand
      * @param b right operand
      * @return true if a is greater than or equal to b
      */
-    bool CoDelTimeAfterEq(uint32_t a, uint32_t b);
+    static bool CoDelTimeAfterEq(uint32_t a, uint32_t b);
     /**
      * Check if CoDel time a is preceding b
      * @param a left operand
      * @param b right operand
      * @return true if a is less than to b
      */
-    bool CoDelTimeBefore(uint32_t a, uint32_t b);
+    static bool CoDelTimeBefore(uint32_t a, uint32_t b);
     /**
      * Check if CoDel time a is preceding or equal to b
      * @param a left operand
      * @param b right operand
      * @return true if a is less than or equal to b
      */
-    bool CoDelTimeBeforeEq(uint32_t a, uint32_t b);
+    static bool CoDelTimeBeforeEq(uint32_t a, uint32_t b);
 
     /**
      * Return the unsigned 32-bit integer representation of the input Time
@@ -203,7 +209,7 @@ class CoDelQueueDisc : public QueueDisc
      * @param t the input Time Object
      * @return the unsigned 32-bit integer representation
      */
-    uint32_t Time2CoDel(Time t);
+    static uint32_t Time2CoDel(Time t);
 
     void InitializeParams() override;
 
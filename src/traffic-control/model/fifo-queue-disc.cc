@@ -30,6 +30,9 @@ NS_LOG_COMPONENT_DEFINE("FifoQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(FifoQueueDisc);
 
+const uint32_t FifoQueueDisc::LIMIT_EXCEEDED_DROP_ID =
+    QueueDisc::RegisterReason(LIMIT_EXCEEDED_DROP);
+
 TypeId
 FifoQueueDisc::GetTypeId()
 {
@@ -65,7 +68,7 @@ FifoQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     if (GetCurrentSize() + item > GetMaxSize())
     {
         NS_LOG_LOGIC("Queue full -- dropping pkt");
-        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP_ID);
         return false;
     }
 
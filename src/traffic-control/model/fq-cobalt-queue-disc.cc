@@ -26,11 +26,9 @@
 
 #include "fq-cobalt-queue-disc.h"
 
-#include "cobalt-queue-disc.h"
-
 #include "ns3/log.h"
 #include "ns3/net-device-queue-interface.h"
-#include "ns3/queue.h"
+#include "ns3/simulator.h"
 #include "ns3/string.h"
 
 namespace ns3
@@ -38,81 +36,32 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("FqCobaltQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED(FqCobaltFlow);
-
-TypeId
-FqCobaltFlow::GetTypeId()
-{
-    static TypeId tid = TypeId("ns3::FqCobaltFlow")
-                            .SetParent<QueueDiscClass>()
-                            .SetGroupName("TrafficControl")
-                            .AddConstructor<FqCobaltFlow>();
-    return tid;
-}
-
-FqCobaltFlow::FqCobaltFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
-{
-    NS_LOG_FUNCTION(this);
-}
-
-FqCobaltFlow::~FqCobaltFlow()
-{
-    NS_LOG_FUNCTION(this);
-}
-
-void
-FqCobaltFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-FqCobaltFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-FqCobaltFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-FqCobaltFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-FqCobaltFlow::FlowStatus
-FqCobaltFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-FqCobaltFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-FqCobaltFlow::GetIndex() const
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+static inline uint32_t
+ReciprocalDivide(uint32_t A, uint32_t R)
 {
-    return m_index;
+    return (uint32_t)(((uint64_t)A * R) >> 32);
 }
 
 NS_OBJECT_ENSURE_REGISTERED(FqCobaltQueueDisc);
 
+const uint32_t FqCobaltQueueDisc::UNCLASSIFIED_DROP_ID =
+    QueueDisc::RegisterReason(UNCLASSIFIED_DROP);
+const uint32_t FqCobaltQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::RegisterReason(OVERLIMIT_DROP);
+const uint32_t FqCobaltQueueDisc::FLOW_OVERLIMIT_DROP_ID =
+    QueueDisc::RegisterReason(FLOW_OVERLIMIT_DROP);
+const uint32_t FqCobaltQueueDisc::TARGET_EXCEEDED_DROP_ID =
+    QueueDisc::RegisterReason(TARGET_EXCEEDED_DROP);
+const uint32_t FqCobaltQueueDisc::FORCED_MARK_ID = QueueDisc::RegisterReason(FORCED_MARK);
+const uint32_t FqCobaltQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId
 FqCobaltQueueDisc::GetTypeId()
 {
@@ -205,6 +154,25 @@ FqCobaltQueueDisc::FqCobaltQueueDisc()
       m_quantum(0)
 {
     NS_LOG_FUNCTION(this);
+    m_uv = CreateObject<UniformRandomVariable>();
+
+    // the first values of the reciprocal inverse square root are the same for
+    // all the flow queues, compute them once
+    FlowState state;
+    m_recInvSqrtCache[0] = state.recInvSqrt;
+    for (state.count = 1; state.count < REC_INV_SQRT_CACHE; state.count++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            uint32_t invsqrt = state.recInvSqrt;
+            uint32_t invsqrt2 = ((uint64_t)invsqrt * invsqrt) >> 32;
+            uint64_t val = (3LL << 32) - ((uint64_t)state.count * invsqrt2);
+            val >>= 2; /* avoid overflow */
+            val = (val * invsqrt) >> (32 - 2 + 1);
+            state.recInvSqrt = val;
+        }
+        m_recInvSqrtCache[state.count] = state.recInvSqrt;
+    }
 }
 
 FqCobaltQueueDisc::~FqCobaltQueueDisc()
@@ -212,6 +180,15 @@ FqCobaltQueueDisc::~FqCobaltQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqCobaltQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_uv = nullptr;
+    m_flowTable.Clear();
+    QueueDisc::DoDispose();
+}
+
 void
 FqCobaltQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -225,6 +202,20 @@ FqCobaltQueueDisc::GetQuantum() const
     return m_quantum;
 }
 
+uint32_t
+FqCobaltQueueDisc::GetNFlowQueues() const
+{
+    return m_flowTable.GetNFlows();
+}
+
+int64_t
+FqCobaltQueueDisc::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_uv->SetStream(stream);
+    return 1;
+}
+
 uint32_t
 FqCobaltQueueDisc::SetAssociativeHash(uint32_t flowHash)
 {
@@ -236,22 +227,27 @@ FqCobaltQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t flow = m_flowTable.Find(i);
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqCobaltFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqCobaltFlow::INACTIVE)
+        if (flow == m_flowTable.NO_FLOW)
         {
-            // this queue has not been created yet or is associated with this flow
-            // or is inactive, hence we can use it
-            m_tags[i] = flowHash;
+            // this queue has not been created yet, hence we can use it
+            flow = m_flowTable.Add(i, FlowState());
+            m_flowTable.GetState(flow).pDrop = m_Pdrop;
+            m_flowTable.SetTag(flow, flowHash);
+            return i;
+        }
+        if (m_flowTable.GetTag(flow) == flowHash ||
+            m_flowTable.GetStatus(flow) == m_flowTable.INACTIVE)
+        {
+            // this queue is associated with this flow or is inactive, hence we can use it
+            m_flowTable.SetTag(flow, flowHash);
             return i;
         }
     }
 
     // all the queues of the set are used. Use the first queue of the set
-    m_tags[outerHash] = flowHash;
+    m_flowTable.SetTag(m_flowTable.Find(outerHash), flowHash);
     return outerHash;
 }
 
@@ -278,7 +274,7 @@ FqCobaltQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         else
         {
             NS_LOG_ERROR("No filter has been able to classify this packet, drop it.");
-            DropBeforeEnqueue(item, UNCLASSIFIED_DROP);
+            DropBeforeEnqueue(item, UNCLASSIFIED_DROP_ID);
             return false;
         }
     }
@@ -292,43 +288,32 @@ FqCobaltQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqCobaltFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t flow = m_flowTable.Find(h);
+    if (flow == m_flowTable.NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqCobaltFlow>();
-        Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
-        // If Cobalt, Set values of CobaltQueueDisc to match this QueueDisc
-        Ptr<CobaltQueueDisc> cobalt = qd->GetObject<CobaltQueueDisc>();
-        if (cobalt)
-        {
-            cobalt->SetAttribute("UseEcn", BooleanValue(m_useEcn));
-            cobalt->SetAttribute("CeThreshold", TimeValue(m_ceThreshold));
-            cobalt->SetAttribute("UseL4s", BooleanValue(m_useL4s));
-            cobalt->SetAttribute("BlueThreshold", TimeValue(m_blueThreshold));
-        }
-        qd->Initialize();
-        flow->SetQueueDisc(qd);
-        flow->SetIndex(h);
-        AddQueueDiscClass(flow);
-
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
+        flow = m_flowTable.Add(h, FlowState());
+        m_flowTable.GetState(flow).pDrop = m_Pdrop;
     }
-    else
+
+    if (m_flowTable.GetSize(flow, GetMaxSize().GetUnit()) + item > GetMaxSize())
     {
-        flow = StaticCast<FqCobaltFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        NS_LOG_LOGIC("Flow queue full -- dropping pkt");
+        // Call this to update Blue's drop probability
+        CobaltQueueFull(m_flowTable.GetState(flow), Simulator::Now().GetNanoSeconds());
+        DropBeforeEnqueue(item, FLOW_OVERLIMIT_DROP_ID);
+        return false;
     }
 
-    if (flow->GetStatus() == FqCobaltFlow::INACTIVE)
+    if (m_flowTable.Activate(flow, m_quantum))
     {
-        flow->SetStatus(FqCobaltFlow::NEW_FLOW);
-        flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        NS_LOG_DEBUG("Flow queue " << h << " is now a new flow");
     }
 
-    flow->GetQueueDisc()->Enqueue(item);
+    m_flowTable.Enqueue(flow, item);
+    PacketEnqueued(item);
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << flow);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -344,88 +329,255 @@ FqCobaltQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<FqCobaltFlow> flow;
+    uint32_t flow;
     Ptr<QueueDiscItem> item;
 
     do
     {
-        bool found = false;
+        flow = m_flowTable.Select(m_quantum);
 
-        while (!found && !m_newFlows.empty())
+        if (flow == m_flowTable.NO_FLOW)
         {
-            flow = m_newFlows.front();
-
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                flow->SetStatus(FqCobaltFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found a new flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
+            NS_LOG_DEBUG("No flow found to dequeue a packet");
+            return nullptr;
         }
 
-        while (!found && !m_oldFlows.empty())
-        {
-            flow = m_oldFlows.front();
+        NS_LOG_DEBUG("Found flow " << m_flowTable.GetBucket(flow) << " with positive deficit");
+        item = CobaltDequeue(flow);
 
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.push_back(flow);
-                m_oldFlows.pop_front();
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found an old flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
+        if (!item)
+        {
+            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
+            m_flowTable.Retire();
         }
+        else
+        {
+            NS_LOG_DEBUG("Dequeued packet " << item->GetPacket());
+        }
+    } while (!item);
+
+    m_flowTable.Charge(flow, item->GetSize());
 
-        if (!found)
+    return item;
+}
+
+Ptr<QueueDiscItem>
+FqCobaltQueueDisc::FlowDequeue(uint32_t flow)
+{
+    Ptr<QueueDiscItem> item = m_flowTable.Dequeue(flow);
+    if (item)
+    {
+        PacketDequeued(item);
+    }
+    return item;
+}
+
+Ptr<QueueDiscItem>
+FqCobaltQueueDisc::CobaltDequeue(uint32_t flow)
+{
+    NS_LOG_FUNCTION(this << flow);
+    FlowState& state = m_flowTable.GetState(flow);
+
+    while (true)
+    {
+        Ptr<QueueDiscItem> item = FlowDequeue(flow);
+        int64_t now = Simulator::Now().GetNanoSeconds();
+
+        if (!item)
         {
-            NS_LOG_DEBUG("No flow found to dequeue a packet");
+            // Leave dropping state when queue is empty (derived from Codel)
+            state.dropping = false;
+            // Call this to update Blue's drop probability
+            CobaltQueueEmpty(state, now);
             return nullptr;
         }
 
-        item = flow->GetQueueDisc()->Dequeue();
+        // Determine if item should be dropped
+        // ECN marking happens inside this function, so it need not be done here
+        if (!CobaltShouldDrop(state, item, now))
+        {
+            return item;
+        }
+        DropAfterDequeue(item, TARGET_EXCEEDED_DROP_ID);
+    }
+}
 
-        if (!item)
+void
+FqCobaltQueueDisc::InvSqrt(FlowState& state) const
+{
+    if (state.count < REC_INV_SQRT_CACHE)
+    {
+        state.recInvSqrt = m_recInvSqrtCache[state.count];
+    }
+    else
+    {
+        // Newton step
+        uint32_t invsqrt = state.recInvSqrt;
+        uint32_t invsqrt2 = ((uint64_t)invsqrt * invsqrt) >> 32;
+        uint64_t val = (3LL << 32) - ((uint64_t)state.count * invsqrt2);
+
+        val >>= 2; /* avoid overflow */
+        val = (val * invsqrt) >> (32 - 2 + 1);
+        state.recInvSqrt = val;
+    }
+}
+
+int64_t
+FqCobaltQueueDisc::ControlLaw(const FlowState& state, int64_t t) const
+{
+    return t + ReciprocalDivide(m_cobaltInterval, state.recInvSqrt);
+}
+
+void
+FqCobaltQueueDisc::CobaltQueueFull(FlowState& state, int64_t now)
+{
+    NS_LOG_FUNCTION(this);
+    if (now - state.lastUpdateTimeBlue > m_cobaltTarget)
+    {
+        state.pDrop = std::min(state.pDrop + m_increment, 1.0);
+        state.lastUpdateTimeBlue = now;
+    }
+    state.dropping = true;
+    state.dropNext = now;
+    if (!state.count)
+    {
+        state.count = 1;
+    }
+}
+
+void
+FqCobaltQueueDisc::CobaltQueueEmpty(FlowState& state, int64_t now)
+{
+    NS_LOG_FUNCTION(this);
+    if (state.pDrop && now - state.lastUpdateTimeBlue > m_cobaltTarget)
+    {
+        state.pDrop = std::max(state.pDrop - m_decrement, 0.0);
+        state.lastUpdateTimeBlue = now;
+    }
+    state.dropping = false;
+
+    if (state.count && now - state.dropNext >= 0)
+    {
+        state.count--;
+        InvSqrt(state);
+        state.dropNext = ControlLaw(state, state.dropNext);
+    }
+}
+
+bool
+FqCobaltQueueDisc::CobaltShouldDrop(FlowState& state, Ptr<QueueDiscItem> item, int64_t now)
+{
+    NS_LOG_FUNCTION(this << item << now);
+    bool drop = false;
+
+    /* Simplified Codel implementation */
+    int64_t sojournTime = (Simulator::Now() - item->GetTimeStamp()).GetNanoSeconds();
+    int64_t schedule = now - state.dropNext;
+    bool over_target = sojournTime > m_cobaltTarget;
+    bool next_due = state.count && schedule >= 0;
+    bool isMarked = false;
+
+    // If L4S mode is enabled then check if the packet is ECT1 or CE and
+    // if sojourn time is greater than CE threshold then the packet is marked.
+    // If packet is marked successfully then the CoDel steps can be skipped.
+    if (m_useL4s)
+    {
+        uint8_t tosByte = 0;
+        if (item->GetUint8Value(QueueItem::IP_DSFIELD, tosByte) &&
+            (((tosByte & 0x3) == 1) || (tosByte & 0x3) == 3))
         {
-            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
-            {
-                flow->SetStatus(FqCobaltFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
+            if (sojournTime > m_ceThreshold.GetNanoSeconds() &&
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
             {
-                flow->SetStatus(FqCobaltFlow::INACTIVE);
-                m_oldFlows.pop_front();
+                NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
             }
+            return false;
         }
-        else
+    }
+
+    if (over_target)
+    {
+        if (!state.dropping)
         {
-            NS_LOG_DEBUG("Dequeued packet " << item->GetPacket());
+            state.dropping = true;
+            state.dropNext = ControlLaw(state, now);
         }
-    } while (!item);
+        if (!state.count)
+        {
+            state.count = 1;
+        }
+    }
+    else if (state.dropping)
+    {
+        state.dropping = false;
+    }
 
-    flow->IncreaseDeficit(item->GetSize() * -1);
+    if (next_due && state.dropping)
+    {
+        /* Check for marking possibility only if BLUE decides NOT to drop. */
+        isMarked = (m_useEcn && Mark(item, FORCED_MARK_ID));
+        drop = !isMarked;
 
-    return item;
+        state.count = std::max(state.count, state.count + 1);
+
+        InvSqrt(state);
+        state.dropNext = ControlLaw(state, state.dropNext);
+        schedule = now - state.dropNext;
+    }
+    else
+    {
+        while (next_due)
+        {
+            state.count--;
+            InvSqrt(state);
+            state.dropNext = ControlLaw(state, state.dropNext);
+            schedule = now - state.dropNext;
+            next_due = state.count && schedule >= 0;
+        }
+    }
+
+    // If the packet has already been marked, a second attempt at marking is suppressed.
+    // If L4S is enabled, ECT0 packets are not marked.
+    if (!isMarked && !m_useL4s && m_useEcn && sojournTime > m_ceThreshold.GetNanoSeconds() &&
+        Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
+    {
+        NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
+    }
+
+    // Enable Blue Enhancement if sojourn time is greater than blueThreshold and its been
+    // target time until the last time blue was updated
+    if (sojournTime > m_blueThreshold.GetNanoSeconds() &&
+        now - state.lastUpdateTimeBlue > m_cobaltTarget)
+    {
+        state.pDrop = std::min(state.pDrop + m_increment, 1.0);
+        state.lastUpdateTimeBlue = now;
+    }
+
+    /* Simple BLUE implementation. Lack of ECN is deliberate. */
+    if (state.pDrop)
+    {
+        double u = m_uv->GetValue();
+        drop = drop || (u < state.pDrop);
+    }
+
+    /* Overload the drop_next field as an activity timeout */
+    if (!state.count)
+    {
+        state.dropNext = now + m_cobaltInterval;
+    }
+    else if (schedule > 0 && !drop)
+    {
+        state.dropNext = now;
+    }
+
+    return drop;
 }
 
 bool
 FqCobaltQueueDisc::CheckConfig()
 {
     NS_LOG_FUNCTION(this);
+    // the flow queues are not classes, see the FqFlowTable
     if (GetNQueueDiscClasses() > 0)
     {
         NS_LOG_ERROR("FqCobaltQueueDisc cannot have classes");
@@ -482,15 +634,8 @@ FqCobaltQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
 
-    m_flowFactory.SetTypeId("ns3::FqCobaltFlow");
-
-    m_queueDiscFactory.SetTypeId("ns3::CobaltQueueDisc");
-    m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
-    m_queueDiscFactory.Set("Interval", StringValue(m_interval));
-    m_queueDiscFactory.Set("Target", StringValue(m_target));
-    m_queueDiscFactory.Set("Pdrop", DoubleValue(m_Pdrop));
-    m_queueDiscFactory.Set("Increment", DoubleValue(m_increment));
-    m_queueDiscFactory.Set("Decrement", DoubleValue(m_decrement));
+    m_cobaltInterval = Time(m_interval).GetNanoSeconds();
+    m_cobaltTarget = Time(m_target).GetNanoSeconds();
 }
 
 uint32_t
@@ -498,35 +643,21 @@ FqCobaltQueueDisc::FqCobaltDrop()
 {
     NS_LOG_FUNCTION(this);
 
-    uint32_t maxBacklog = 0;
-    uint32_t index = 0;
-    Ptr<QueueDisc> qd;
-
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
-    {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
-        if (bytes > maxBacklog)
-        {
-            maxBacklog = bytes;
-            index = i;
-        }
-    }
+    uint32_t index = m_flowTable.GetFattestFlow();
 
     /* Our goal is to drop half of this fat flow backlog */
     uint32_t len = 0;
     uint32_t count = 0;
-    uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    uint32_t threshold = m_flowTable.GetNBytes(index) >> 1;
     Ptr<QueueDiscItem> item;
 
     do
     {
         NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
                                                        << " threshold: " << threshold);
-        item = qd->GetInternalQueue(0)->Dequeue();
-        DropAfterDequeue(item, OVERLIMIT_DROP);
+        item = FlowDequeue(index);
+        DropAfterDequeue(item, OVERLIMIT_DROP_ID);
         len += item->GetSize();
     } while (++count < m_dropBatchSize && len < threshold);
 
@@ -27,94 +27,32 @@
 #ifndef FQ_COBALT_QUEUE_DISC
 #define FQ_COBALT_QUEUE_DISC
 
+#include "cobalt-queue-disc.h"
+#include "fq-flow-table.h"
 #include "queue-disc.h"
 
-#include "ns3/object-factory.h"
-
-#include <list>
-#include <map>
+#include "ns3/random-variable-stream.h"
 
 namespace ns3
 {
 
-/**
- * \ingroup traffic-control
- *
- * \brief A flow queue used by the FqCobalt queue disc
- */
-
-class FqCobaltFlow : public QueueDiscClass
-{
-  public:
-    /**
-     * \brief Get the type ID.
-     * \return the object TypeId
-     */
-    static TypeId GetTypeId();
-    /**
-     * \brief FqCobaltFlow constructor
-     */
-    FqCobaltFlow();
-
-    ~FqCobaltFlow() override;
-
-    /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
-     */
-    enum FlowStatus
-    {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
-
-    /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
-     */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-};
-
 /**
  * \ingroup traffic-control
  *
  * \brief A FqCobalt packet queue disc
+ *
+ * As in FqCoDelQueueDisc, the flow queues and their COBALT state are stored
+ * in a flat FqFlowTable rather than in classes with a child COBALT queue disc
+ * each. Packets dropped or marked by the COBALT algorithm are reported with
+ * the same reasons as they would have been by a child COBALT queue disc.
+ *
+ * Hence, this queue disc has no classes (GetNQueueDiscClasses() returns 0)
+ * and cannot be given any. The FqCobaltFlow class and the attributes and
+ * trace sources of the child COBALT queue discs (e.g., the "Count",
+ * "DropState" and "DropNext" traces) do not exist anymore: the COBALT
+ * parameters are the attributes of this queue disc, and the drops and marks of
+ * all the flow queues are reported by the trace sources and statistics of
+ * this queue disc.
  */
 
 class FqCobaltQueueDisc : public QueueDisc
@@ -148,12 +86,62 @@ class FqCobaltQueueDisc : public QueueDisc
      */
     uint32_t GetQuantum() const;
 
+    /**
+     * \brief Get the number of flow queues created so far.
+     *
+     * \returns the number of flow queues that have been assigned at least a packet
+     */
+    uint32_t GetNFlowQueues() const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
     // Reasons for dropping packets
     static constexpr const char* UNCLASSIFIED_DROP =
         "Unclassified drop"; //!< No packet filter able to classify packet
     static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    static constexpr const char* FLOW_OVERLIMIT_DROP =
+        "(Dropped by child queue disc) Overlimit drop"; //!< Flow queue holding MaxSize
+    static constexpr const char* TARGET_EXCEEDED_DROP =
+        "(Dropped by child queue disc) Target exceeded drop"; //!< Sojourn time above target
+    // Reasons for marking packets
+    static constexpr const char* FORCED_MARK =
+        "(Marked by child queue disc) forcedMark"; //!< forced marks by Codel on ECN-enabled
+    static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
+        "(Marked by child queue disc) CE threshold exceeded mark"; //!< Sojourn time above CE
+                                                                   //!< threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t UNCLASSIFIED_DROP_ID;          //!< ID of UNCLASSIFIED_DROP
+    static const uint32_t OVERLIMIT_DROP_ID;             //!< ID of OVERLIMIT_DROP
+    static const uint32_t FLOW_OVERLIMIT_DROP_ID;        //!< ID of FLOW_OVERLIMIT_DROP
+    static const uint32_t TARGET_EXCEEDED_DROP_ID;       //!< ID of TARGET_EXCEEDED_DROP
+    static const uint32_t FORCED_MARK_ID;                //!< ID of FORCED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
+
+  protected:
+    void DoDispose() override;
 
   private:
+    /**
+     * \brief COBALT state of a flow queue
+     */
+    struct FlowState
+    {
+        uint32_t count{0};             //!< Number of packets dropped since entering drop state
+        int64_t dropNext{0};           //!< Time to drop next packet
+        bool dropping{false};          //!< True if in dropping state
+        uint32_t recInvSqrt{~0U};      //!< Reciprocal inverse square root
+        double pDrop{0};               //!< Blue drop probability
+        int64_t lastUpdateTimeBlue{0}; //!< Blue's last update time for drop probability
+    };
+
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
     bool CheckConfig() override;
@@ -174,6 +162,57 @@ class FqCobaltQueueDisc : public QueueDisc
      */
     uint32_t SetAssociativeHash(uint32_t flowHash);
 
+    /**
+     * \brief Remove the packet at the head of a flow queue
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> FlowDequeue(uint32_t flow);
+
+    /**
+     * \brief Dequeue a packet from a flow queue according to the COBALT algorithm
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> CobaltDequeue(uint32_t flow);
+
+    /**
+     * \brief Update the reciprocal inverse square root of the drop count of a flow queue
+     * \param state the COBALT state of the flow queue
+     */
+    void InvSqrt(FlowState& state) const;
+
+    /**
+     * \brief Determine the time for next drop
+     * \param state the COBALT state of the flow queue
+     * \param t the current next drop time, in nanoseconds
+     * \return the new next drop time, in nanoseconds
+     */
+    int64_t ControlLaw(const FlowState& state, int64_t t) const;
+
+    /**
+     * \brief Update the COBALT state of a flow queue that overflowed
+     * \param state the COBALT state of the flow queue
+     * \param now the current time, in nanoseconds
+     */
+    void CobaltQueueFull(FlowState& state, int64_t now);
+
+    /**
+     * \brief Update the COBALT state of a flow queue that was found empty
+     * \param state the COBALT state of the flow queue
+     * \param now the current time, in nanoseconds
+     */
+    void CobaltQueueEmpty(FlowState& state, int64_t now);
+
+    /**
+     * \brief Determine whether a packet dequeued from a flow queue has to be dropped
+     * \param state the COBALT state of the flow queue
+     * \param item the packet
+     * \param now the current time, in nanoseconds
+     * \return true if the packet has to be dropped
+     */
+    bool CobaltShouldDrop(FlowState& state, Ptr<QueueDiscItem> item, int64_t now);
+
     std::string m_interval;   //!< CoDel interval attribute
     std::string m_target;     //!< CoDel target attribute
     uint32_t m_quantum;       //!< Deficit assigned to flows at each round
@@ -190,14 +229,13 @@ class FqCobaltQueueDisc : public QueueDisc
     double m_Pdrop;       //!< Drop Probability
     Time m_blueThreshold; //!< Threshold to enable blue enhancement
 
-    std::list<Ptr<FqCobaltFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<FqCobaltFlow>> m_oldFlows; //!< The list of old flows
-
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
+    int64_t m_cobaltInterval; //!< CoDel interval, in nanoseconds
+    int64_t m_cobaltTarget;   //!< CoDel target, in nanoseconds
+    uint32_t m_recInvSqrtCache[REC_INV_SQRT_CACHE]; //!< Initial values of the reciprocal inverse
+                                                    //!< square root
 
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+    Ptr<UniformRandomVariable> m_uv;    //!< Rng stream
+    FqFlowTable<FlowState> m_flowTable; //!< The flow queues
 };
 
 } // namespace ns3
@@ -24,7 +24,7 @@
 
 #include "ns3/log.h"
 #include "ns3/net-device-queue-interface.h"
-#include "ns3/queue.h"
+#include "ns3/simulator.h"
 #include "ns3/string.h"
 
 namespace ns3
@@ -32,81 +32,20 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("FqCoDelQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED(FqCoDelFlow);
-
-TypeId
-FqCoDelFlow::GetTypeId()
-{
-    static TypeId tid = TypeId("ns3::FqCoDelFlow")
-                            .SetParent<QueueDiscClass>()
-                            .SetGroupName("TrafficControl")
-                            .AddConstructor<FqCoDelFlow>();
-    return tid;
-}
-
-FqCoDelFlow::FqCoDelFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
-{
-    NS_LOG_FUNCTION(this);
-}
-
-FqCoDelFlow::~FqCoDelFlow()
-{
-    NS_LOG_FUNCTION(this);
-}
-
-void
-FqCoDelFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-FqCoDelFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-FqCoDelFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-FqCoDelFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-FqCoDelFlow::FlowStatus
-FqCoDelFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-FqCoDelFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-FqCoDelFlow::GetIndex() const
-{
-    return m_index;
-}
-
 NS_OBJECT_ENSURE_REGISTERED(FqCoDelQueueDisc);
 
+const uint32_t FqCoDelQueueDisc::UNCLASSIFIED_DROP_ID =
+    QueueDisc::RegisterReason(UNCLASSIFIED_DROP);
+const uint32_t FqCoDelQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::RegisterReason(OVERLIMIT_DROP);
+const uint32_t FqCoDelQueueDisc::FLOW_OVERLIMIT_DROP_ID =
+    QueueDisc::RegisterReason(FLOW_OVERLIMIT_DROP);
+const uint32_t FqCoDelQueueDisc::TARGET_EXCEEDED_DROP_ID =
+    QueueDisc::RegisterReason(TARGET_EXCEEDED_DROP);
+const uint32_t FqCoDelQueueDisc::TARGET_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(TARGET_EXCEEDED_MARK);
+const uint32_t FqCoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId
 FqCoDelQueueDisc::GetTypeId()
 {
@@ -174,6 +113,12 @@ FqCoDelQueueDisc::GetTypeId()
     return tid;
 }
 
+/**
+ * Minimum number of bytes in a flow queue to allow a packet drop (the default
+ * MinBytes of CoDelQueueDisc)
+ */
+static const uint32_t FQ_CODEL_MIN_BYTES = 1500;
+
 FqCoDelQueueDisc::FqCoDelQueueDisc()
     : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
       m_quantum(0)
@@ -186,6 +131,14 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_flowTable.Clear();
+    QueueDisc::DoDispose();
+}
+
 void
 FqCoDelQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -199,6 +152,12 @@ FqCoDelQueueDisc::GetQuantum() const
     return m_quantum;
 }
 
+uint32_t
+FqCoDelQueueDisc::GetNFlowQueues() const
+{
+    return m_flowTable.GetNFlows();
+}
+
 uint32_t
 FqCoDelQueueDisc::SetAssociativeHash(uint32_t flowHash)
 {
@@ -210,22 +169,26 @@ FqCoDelQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t flow = m_flowTable.Find(i);
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqCoDelFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqCoDelFlow::INACTIVE)
+        if (flow == m_flowTable.NO_FLOW)
+        {
+            // this queue has not been created yet, hence we can use it
+            m_flowTable.Add(i, FlowState());
+            m_flowTable.SetTag(m_flowTable.Find(i), flowHash);
+            return i;
+        }
+        if (m_flowTable.GetTag(flow) == flowHash ||
+            m_flowTable.GetStatus(flow) == m_flowTable.INACTIVE)
         {
-            // this queue has not been created yet or is associated with this flow
-            // or is inactive, hence we can use it
-            m_tags[i] = flowHash;
+            // this queue is associated with this flow or is inactive, hence we can use it
+            m_flowTable.SetTag(flow, flowHash);
             return i;
         }
     }
 
     // all the queues of the set are used. Use the first queue of the set
-    m_tags[outerHash] = flowHash;
+    m_flowTable.SetTag(m_flowTable.Find(outerHash), flowHash);
     return outerHash;
 }
 
@@ -252,7 +215,7 @@ FqCoDelQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         else
         {
             NS_LOG_ERROR("No filter has been able to classify this packet, drop it.");
-            DropBeforeEnqueue(item, UNCLASSIFIED_DROP);
+            DropBeforeEnqueue(item, UNCLASSIFIED_DROP_ID);
             return false;
         }
     }
@@ -266,42 +229,29 @@ FqCoDelQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqCoDelFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t flow = m_flowTable.Find(h);
+    if (flow == m_flowTable.NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqCoDelFlow>();
-        Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
-        // If CoDel, Set values of CoDelQueueDisc to match this QueueDisc
-        Ptr<CoDelQueueDisc> codel = qd->GetObject<CoDelQueueDisc>();
-        if (codel)
-        {
-            codel->SetAttribute("UseEcn", BooleanValue(m_useEcn));
-            codel->SetAttribute("CeThreshold", TimeValue(m_ceThreshold));
-            codel->SetAttribute("UseL4s", BooleanValue(m_useL4s));
-        }
-        qd->Initialize();
-        flow->SetQueueDisc(qd);
-        flow->SetIndex(h);
-        AddQueueDiscClass(flow);
-
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
+        flow = m_flowTable.Add(h, FlowState());
     }
-    else
+
+    if (m_flowTable.GetSize(flow, GetMaxSize().GetUnit()) + item > GetMaxSize())
     {
-        flow = StaticCast<FqCoDelFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        NS_LOG_LOGIC("Flow queue full -- dropping pkt");
+        DropBeforeEnqueue(item, FLOW_OVERLIMIT_DROP_ID);
+        return false;
     }
 
-    if (flow->GetStatus() == FqCoDelFlow::INACTIVE)
+    if (m_flowTable.Activate(flow, m_quantum))
     {
-        flow->SetStatus(FqCoDelFlow::NEW_FLOW);
-        flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        NS_LOG_DEBUG("Flow queue " << h << " is now a new flow");
     }
 
-    flow->GetQueueDisc()->Enqueue(item);
+    m_flowTable.Enqueue(flow, item);
+    PacketEnqueued(item);
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << flow);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -317,79 +267,207 @@ FqCoDelQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<FqCoDelFlow> flow;
+    uint32_t flow;
     Ptr<QueueDiscItem> item;
 
     do
     {
-        bool found = false;
+        flow = m_flowTable.Select(m_quantum);
 
-        while (!found && !m_newFlows.empty())
+        if (flow == m_flowTable.NO_FLOW)
         {
-            flow = m_newFlows.front();
-
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                flow->SetStatus(FqCoDelFlow::OLD_FLOW);
-                m_oldFlows.splice(m_oldFlows.end(), m_newFlows, m_newFlows.begin());
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found a new flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
+            NS_LOG_DEBUG("No flow found to dequeue a packet");
+            return nullptr;
         }
 
-        while (!found && !m_oldFlows.empty())
-        {
-            flow = m_oldFlows.front();
+        NS_LOG_DEBUG("Found flow " << m_flowTable.GetBucket(flow) << " with positive deficit");
+        item = CoDelDequeue(flow);
 
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.splice(m_oldFlows.end(), m_oldFlows, m_oldFlows.begin());
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found an old flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
+        if (!item)
+        {
+            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
+            m_flowTable.Retire();
         }
-
-        if (!found)
+        else
         {
-            NS_LOG_DEBUG("No flow found to dequeue a packet");
-            return nullptr;
+            NS_LOG_DEBUG("Dequeued packet " << item->GetPacket());
         }
+    } while (!item);
 
-        item = flow->GetQueueDisc()->Dequeue();
+    m_flowTable.Charge(flow, item->GetSize());
 
-        if (!item)
+    return item;
+}
+
+Ptr<QueueDiscItem>
+FqCoDelQueueDisc::FlowDequeue(uint32_t flow)
+{
+    Ptr<QueueDiscItem> item = m_flowTable.Dequeue(flow);
+    if (item)
+    {
+        PacketDequeued(item);
+    }
+    return item;
+}
+
+bool
+FqCoDelQueueDisc::OkToDrop(uint32_t flow, Ptr<QueueDiscItem> item, uint32_t now)
+{
+    NS_LOG_FUNCTION(this << flow << item << now);
+    FlowState& state = m_flowTable.GetState(flow);
+
+    if (!item)
+    {
+        state.firstAboveTime = 0;
+        return false;
+    }
+
+    uint32_t sojournTime = CoDelQueueDisc::Time2CoDel(Simulator::Now() - item->GetTimeStamp());
+
+    if (CoDelQueueDisc::CoDelTimeBefore(sojournTime, m_codelTarget) ||
+        m_flowTable.GetNBytes(flow) < FQ_CODEL_MIN_BYTES)
+    {
+        // went below so we'll stay below for at least interval
+        state.firstAboveTime = 0;
+        return false;
+    }
+    if (state.firstAboveTime == 0)
+    {
+        // just went above from below. If we stay above
+        // for at least interval we'll say it's ok to drop
+        state.firstAboveTime = now + m_codelInterval;
+        return false;
+    }
+    return CoDelQueueDisc::CoDelTimeAfter(now, state.firstAboveTime);
+}
+
+Ptr<QueueDiscItem>
+FqCoDelQueueDisc::CoDelDequeue(uint32_t flow)
+{
+    NS_LOG_FUNCTION(this << flow);
+    FlowState& state = m_flowTable.GetState(flow);
+
+    Ptr<QueueDiscItem> item = FlowDequeue(flow);
+    if (!item)
+    {
+        // Leave dropping state when queue is empty
+        state.dropping = false;
+        return nullptr;
+    }
+    uint32_t ldelay = CoDelQueueDisc::Time2CoDel(Simulator::Now() - item->GetTimeStamp());
+    if (m_useL4s)
+    {
+        uint8_t tosByte = 0;
+        if (item->GetUint8Value(QueueItem::IP_DSFIELD, tosByte) &&
+            (((tosByte & 0x3) == 1) || (tosByte & 0x3) == 3))
         {
-            NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
+            if (CoDelQueueDisc::CoDelTimeAfter(ldelay, m_codelCeThreshold) &&
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
             {
-                flow->SetStatus(FqCoDelFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
             }
-            else
+            return item;
+        }
+    }
+
+    uint32_t now = CoDelQueueDisc::Time2CoDel(Simulator::Now());
+
+    // Determine if item should be dropped
+    bool okToDrop = OkToDrop(flow, item, now);
+    bool isMarked = false;
+
+    if (state.dropping)
+    {
+        // In the dropping state (sojourn time has gone above target and hasn't come down yet)
+        // Check if we can leave the dropping state or next drop should occur
+        if (!okToDrop)
+        {
+            // sojourn time fell below target - leave dropping state
+            state.dropping = false;
+        }
+        else if (CoDelQueueDisc::CoDelTimeAfterEq(now, state.dropNext))
+        {
+            while (state.dropping && CoDelQueueDisc::CoDelTimeAfterEq(now, state.dropNext))
             {
-                flow->SetStatus(FqCoDelFlow::INACTIVE);
-                m_oldFlows.pop_front();
+                ++state.count;
+                state.recInvSqrt = CoDelQueueDisc::NewtonStep(state.recInvSqrt, state.count);
+                // It's time for the next drop. Drop the current packet and
+                // dequeue the next. The dequeue might take us out of dropping
+                // state. If not, schedule the next drop.
+                if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK_ID))
+                {
+                    isMarked = true;
+                    state.dropNext =
+                        CoDelQueueDisc::ControlLaw(now, m_codelInterval, state.recInvSqrt);
+                    break;
+                }
+                NS_LOG_LOGIC("Sojourn time is still above target and it's time for next drop; "
+                             "dropping "
+                             << item);
+                DropAfterDequeue(item, TARGET_EXCEEDED_DROP_ID);
+
+                item = FlowDequeue(flow);
+
+                if (!OkToDrop(flow, item, now))
+                {
+                    // leave dropping state
+                    state.dropping = false;
+                }
+                else
+                {
+                    // schedule the next drop
+                    state.dropNext =
+                        CoDelQueueDisc::ControlLaw(state.dropNext, m_codelInterval, state.recInvSqrt);
+                }
             }
         }
+    }
+    else if (okToDrop)
+    {
+        // Not in the dropping state: enter it and drop (or mark) the first packet
+        if (m_useEcn && Mark(item, TARGET_EXCEEDED_MARK_ID))
+        {
+            isMarked = true;
+        }
         else
         {
-            NS_LOG_DEBUG("Dequeued packet " << item->GetPacket());
+            NS_LOG_LOGIC("Sojourn time goes above target, dropping the first packet "
+                         << item << " and entering the dropping state");
+            DropAfterDequeue(item, TARGET_EXCEEDED_DROP_ID);
+            item = FlowDequeue(flow);
+            OkToDrop(flow, item, now);
         }
-    } while (!item);
-
-    flow->IncreaseDeficit(item->GetSize() * -1);
+        state.dropping = true;
+        // if min went above target close to when we last went below it
+        // assume that the drop rate that controlled the queue on the
+        // last cycle is a good starting point to control it now.
+        int delta = state.count - state.lastCount;
+        if (delta > 1 &&
+            CoDelQueueDisc::CoDelTimeBefore(now - state.dropNext, 16 * m_codelInterval))
+        {
+            state.count = delta;
+            state.recInvSqrt = CoDelQueueDisc::NewtonStep(state.recInvSqrt, state.count);
+        }
+        else
+        {
+            state.count = 1;
+            state.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+        state.lastCount = state.count;
+        state.dropNext = CoDelQueueDisc::ControlLaw(now, m_codelInterval, state.recInvSqrt);
+    }
 
+    // In Linux, the CE threshold is checked even if the packet has been marked
+    // according to the target delay above. Use the isMarked flag to suppress a
+    // second attempt at marking, which would be counted twice in the statistics.
+    if (!isMarked && item && !m_useL4s && m_useEcn &&
+        CoDelQueueDisc::CoDelTimeAfter(
+            CoDelQueueDisc::Time2CoDel(Simulator::Now() - item->GetTimeStamp()),
+            m_codelCeThreshold) &&
+        Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
+    {
+        NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
+    }
     return item;
 }
 
@@ -397,6 +475,7 @@ bool
 FqCoDelQueueDisc::CheckConfig()
 {
     NS_LOG_FUNCTION(this);
+    // the flow queues are not classes, see the FqFlowTable
     if (GetNQueueDiscClasses() > 0)
     {
         NS_LOG_ERROR("FqCoDelQueueDisc cannot have classes");
@@ -453,12 +532,9 @@ FqCoDelQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
 
-    m_flowFactory.SetTypeId("ns3::FqCoDelFlow");
-
-    m_queueDiscFactory.SetTypeId("ns3::CoDelQueueDisc");
-    m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
-    m_queueDiscFactory.Set("Interval", StringValue(m_interval));
-    m_queueDiscFactory.Set("Target", StringValue(m_target));
+    m_codelInterval = CoDelQueueDisc::Time2CoDel(Time(m_interval));
+    m_codelTarget = CoDelQueueDisc::Time2CoDel(Time(m_target));
+    m_codelCeThreshold = CoDelQueueDisc::Time2CoDel(m_ceThreshold);
 }
 
 uint32_t
@@ -466,35 +542,21 @@ FqCoDelQueueDisc::FqCoDelDrop()
 {
     NS_LOG_FUNCTION(this);
 
-    uint32_t maxBacklog = 0;
-    uint32_t index = 0;
-    Ptr<QueueDisc> qd;
-
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
-    {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
-        if (bytes > maxBacklog)
-        {
-            maxBacklog = bytes;
-            index = i;
-        }
-    }
+    uint32_t index = m_flowTable.GetFattestFlow();
 
     /* Our goal is to drop half of this fat flow backlog */
     uint32_t len = 0;
     uint32_t count = 0;
-    uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    uint32_t threshold = m_flowTable.GetNBytes(index) >> 1;
     Ptr<QueueDiscItem> item;
 
     do
     {
         NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
                                                        << " threshold: " << threshold);
-        item = qd->GetInternalQueue(0)->Dequeue();
-        DropAfterDequeue(item, OVERLIMIT_DROP);
+        item = FlowDequeue(index);
+        DropAfterDequeue(item, OVERLIMIT_DROP_ID);
         len += item->GetSize();
     } while (++count < m_dropBatchSize && len < threshold);
 
@@ -21,94 +21,32 @@
 #ifndef FQ_CODEL_QUEUE_DISC
 #define FQ_CODEL_QUEUE_DISC
 
+#include "fq-flow-table.h"
 #include "queue-disc.h"
 
-#include "ns3/object-factory.h"
-
-#include <list>
-#include <map>
-
 namespace ns3
 {
 
-/**
- * \ingroup traffic-control
- *
- * \brief A flow queue used by the FqCoDel queue disc
- */
-
-class FqCoDelFlow : public QueueDiscClass
-{
-  public:
-    /**
-     * \brief Get the type ID.
-     * \return the object TypeId
-     */
-    static TypeId GetTypeId();
-    /**
-     * \brief FqCoDelFlow constructor
-     */
-    FqCoDelFlow();
-
-    ~FqCoDelFlow() override;
-
-    /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
-     */
-    enum FlowStatus
-    {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
-
-    /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
-     */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-};
-
 /**
  * \ingroup traffic-control
  *
  * \brief A FqCoDel packet queue disc
+ *
+ * The flow queues are not implemented as classes with a child CoDel queue
+ * disc each: the packets, the DRR scheduler state and the CoDel state of all
+ * the flow queues are stored in a flat FqFlowTable, and the CoDel algorithm
+ * is run on each flow queue by this queue disc. Packets dropped or marked by
+ * the CoDel algorithm are reported with the same reasons as they would have
+ * been by a child CoDel queue disc.
+ *
+ * Hence, this queue disc has no classes (GetNQueueDiscClasses() returns 0)
+ * and, like the other classless queue discs, cannot be given any. The
+ * FqCoDelFlow class and the attributes and trace sources of the child CoDel
+ * queue discs (e.g., the "Count", "LastCount", "DropState" and "DropNext"
+ * traces) do not exist anymore. The CoDel parameters are the attributes of
+ * this queue disc, which apply to all the flow queues; the drops and marks of
+ * all the flow queues are reported by the trace sources and statistics of
+ * this queue disc, and GetNFlowQueues() returns the number of flow queues.
  */
 
 class FqCoDelQueueDisc : public QueueDisc
@@ -142,12 +80,52 @@ class FqCoDelQueueDisc : public QueueDisc
      */
     uint32_t GetQuantum() const;
 
+    /**
+     * \brief Get the number of flow queues created so far.
+     *
+     * \returns the number of flow queues that have been assigned at least a packet
+     */
+    uint32_t GetNFlowQueues() const;
+
     // Reasons for dropping packets
     static constexpr const char* UNCLASSIFIED_DROP =
         "Unclassified drop"; //!< No packet filter able to classify packet
     static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    static constexpr const char* FLOW_OVERLIMIT_DROP =
+        "(Dropped by child queue disc) Overlimit drop"; //!< Flow queue holding MaxSize
+    static constexpr const char* TARGET_EXCEEDED_DROP =
+        "(Dropped by child queue disc) Target exceeded drop"; //!< Sojourn time above target
+    // Reasons for marking packets
+    static constexpr const char* TARGET_EXCEEDED_MARK =
+        "(Marked by child queue disc) Target exceeded mark"; //!< Sojourn time above target
+    static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
+        "(Marked by child queue disc) CE threshold exceeded mark"; //!< Sojourn time above CE
+                                                                   //!< threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t UNCLASSIFIED_DROP_ID;          //!< ID of UNCLASSIFIED_DROP
+    static const uint32_t OVERLIMIT_DROP_ID;             //!< ID of OVERLIMIT_DROP
+    static const uint32_t FLOW_OVERLIMIT_DROP_ID;        //!< ID of FLOW_OVERLIMIT_DROP
+    static const uint32_t TARGET_EXCEEDED_DROP_ID;       //!< ID of TARGET_EXCEEDED_DROP
+    static const uint32_t TARGET_EXCEEDED_MARK_ID;       //!< ID of TARGET_EXCEEDED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
+
+  protected:
+    void DoDispose() override;
 
   private:
+    /**
+     * \brief CoDel state of a flow queue
+     */
+    struct FlowState
+    {
+        uint32_t count{0};          //!< Number of packets dropped since entering drop state
+        uint32_t lastCount{0};      //!< Last number of packets dropped since entering drop state
+        bool dropping{false};       //!< True if in dropping state
+        uint16_t recInvSqrt{0};     //!< Reciprocal inverse square root
+        uint32_t firstAboveTime{0}; //!< Time to declare sojourn time above target
+        uint32_t dropNext{0};       //!< Time to drop next packet
+    };
+
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
     bool CheckConfig() override;
@@ -159,6 +137,29 @@ class FqCoDelQueueDisc : public QueueDisc
      */
     uint32_t FqCoDelDrop();
 
+    /**
+     * \brief Remove the packet at the head of a flow queue
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> FlowDequeue(uint32_t flow);
+
+    /**
+     * \brief Dequeue a packet from a flow queue according to the CoDel algorithm
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> CoDelDequeue(uint32_t flow);
+
+    /**
+     * \brief Determine whether a packet dequeued from a flow queue is OK to be dropped
+     * \param flow the index of the flow queue
+     * \param item the packet
+     * \param now the current time in CoDel time units
+     * \returns true if the sojourn time has been above target for at least interval
+     */
+    bool OkToDrop(uint32_t flow, Ptr<QueueDiscItem> item, uint32_t now);
+
     bool m_useEcn; //!< True if ECN is used (packets are marked instead of being dropped)
     /**
      * Compute the index of the queue for the flow having the given flowHash,
@@ -180,14 +181,11 @@ class FqCoDelQueueDisc : public QueueDisc
     bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
     bool m_useL4s; //!< True if L4S is used (ECT1 packets are marked at CE threshold)
 
-    std::list<Ptr<FqCoDelFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<FqCoDelFlow>> m_oldFlows; //!< The list of old flows
-
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
+    uint32_t m_codelInterval;    //!< CoDel interval, in CoDel time units
+    uint32_t m_codelTarget;      //!< CoDel target, in CoDel time units
+    uint32_t m_codelCeThreshold; //!< CE threshold, in CoDel time units
 
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+    FqFlowTable<FlowState> m_flowTable; //!< The flow queues
 };
 
 } // namespace ns3
@@ -0,0 +1,485 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_FLOW_TABLE_H
+#define FQ_FLOW_TABLE_H
+
+#include "ns3/queue-item.h"
+#include "ns3/queue-size.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Flat storage of the flow queues of the FQ-AQM queue discs
+ *
+ * This table stores the flow queues of FqCoDelQueueDisc, FqPieQueueDisc and
+ * FqCobaltQueueDisc as in the Linux fq_codel implementation: a flow is an
+ * entry of a contiguous array holding its deficit, its status, the links of
+ * the (intrusive) lists of new and old flows and the per-flow state of the AQM
+ * algorithm. The packets of all the flows are stored in a shared pool of
+ * slots, linked in a FIFO list per flow.
+ *
+ * Flows are identified by the index (bucket) computed by the queue disc from
+ * the flow hash. A flow is created the first time a packet is classified into
+ * its bucket and is never destroyed, hence memory is only used for the buckets
+ * that actually carried traffic.
+ *
+ * \tparam State the per-flow state of the AQM algorithm, default constructible
+ */
+template <class State>
+class FqFlowTable
+{
+  public:
+    /**
+     * \brief Used to determine the status of a flow queue
+     */
+    enum FlowStatus
+    {
+        INACTIVE,
+        NEW_FLOW,
+        OLD_FLOW
+    };
+
+    static constexpr uint32_t NO_FLOW =
+        std::numeric_limits<uint32_t>::max(); //!< invalid flow index
+
+    FqFlowTable()
+        : m_buckets(MIN_BUCKETS, NO_FLOW),
+          m_freeItem(NO_FLOW),
+          m_newFlows{NO_FLOW, NO_FLOW},
+          m_oldFlows{NO_FLOW, NO_FLOW}
+    {
+    }
+
+    /**
+     * \param bucket the bucket of the flow
+     * \return the index of the flow, or NO_FLOW if the flow has not been created
+     */
+    uint32_t Find(uint32_t bucket) const
+    {
+        std::size_t mask = m_buckets.size() - 1;
+        for (std::size_t i = Hash(bucket) & mask; m_buckets[i] != NO_FLOW; i = (i + 1) & mask)
+        {
+            if (m_flows[m_buckets[i]].bucket == bucket)
+            {
+                return m_buckets[i];
+            }
+        }
+        return NO_FLOW;
+    }
+
+    /**
+     * \brief Create a flow. The flow must not exist.
+     * \param bucket the bucket of the flow
+     * \param state the initial AQM state of the flow
+     * \return the index of the flow
+     */
+    uint32_t Add(uint32_t bucket, const State& state)
+    {
+        if ((m_flows.size() + 1) * 2 > m_buckets.size())
+        {
+            std::vector<uint32_t> buckets(m_buckets.size() * 2, NO_FLOW);
+            m_buckets.swap(buckets);
+            for (uint32_t flow = 0; flow < m_flows.size(); flow++)
+            {
+                InsertBucket(m_flows[flow].bucket, flow);
+            }
+        }
+        auto flow = static_cast<uint32_t>(m_flows.size());
+        m_flows.push_back(Flow{state, bucket});
+        InsertBucket(bucket, flow);
+        return flow;
+    }
+
+    /**
+     * \return the number of flows created so far
+     */
+    uint32_t GetNFlows() const
+    {
+        return m_flows.size();
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the bucket of the flow
+     */
+    uint32_t GetBucket(uint32_t flow) const
+    {
+        return m_flows[flow].bucket;
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the AQM state of the flow
+     */
+    State& GetState(uint32_t flow)
+    {
+        return m_flows[flow].state;
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the status of the flow
+     */
+    FlowStatus GetStatus(uint32_t flow) const
+    {
+        return m_flows[flow].status;
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the tag of the flow (used by set associative hash)
+     */
+    uint32_t GetTag(uint32_t flow) const
+    {
+        return m_flows[flow].tag;
+    }
+
+    /**
+     * \param flow the flow index
+     * \param tag the tag of the flow (used by set associative hash)
+     */
+    void SetTag(uint32_t flow, uint32_t tag)
+    {
+        m_flows[flow].tag = tag;
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the number of packets queued in the flow
+     */
+    uint32_t GetNPackets(uint32_t flow) const
+    {
+        return m_flows[flow].nPackets;
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the number of bytes queued in the flow
+     */
+    uint32_t GetNBytes(uint32_t flow) const
+    {
+        return m_flows[flow].nBytes;
+    }
+
+    /**
+     * \param flow the flow index
+     * \param unit the unit of the size
+     * \return the amount of packets or bytes queued in the flow
+     */
+    QueueSize GetSize(uint32_t flow, QueueSizeUnit unit) const
+    {
+        return QueueSize(unit,
+                         unit == QueueSizeUnit::PACKETS ? m_flows[flow].nPackets
+                                                        : m_flows[flow].nBytes);
+    }
+
+    /**
+     * \param flow the flow index
+     * \return the deficit of the flow
+     */
+    int32_t GetDeficit(uint32_t flow) const
+    {
+        return m_flows[flow].deficit;
+    }
+
+    /**
+     * \brief Append a packet to the queue of a flow
+     * \param flow the flow index
+     * \param item the packet
+     */
+    void Enqueue(uint32_t flow, Ptr<QueueDiscItem> item)
+    {
+        uint32_t slot = m_freeItem;
+        if (slot == NO_FLOW)
+        {
+            slot = static_cast<uint32_t>(m_items.size());
+            m_items.emplace_back();
+        }
+        else
+        {
+            m_freeItem = m_items[slot].next;
+        }
+        m_items[slot].item = item;
+        m_items[slot].next = NO_FLOW;
+
+        Flow& f = m_flows[flow];
+        if (f.head == NO_FLOW)
+        {
+            f.head = slot;
+        }
+        else
+        {
+            m_items[f.tail].next = slot;
+        }
+        f.tail = slot;
+        f.nPackets++;
+        f.nBytes += item->GetSize();
+    }
+
+    /**
+     * \brief Remove the packet at the head of the queue of a flow
+     * \param flow the flow index
+     * \return the packet, or nullptr if the queue is empty
+     */
+    Ptr<QueueDiscItem> Dequeue(uint32_t flow)
+    {
+        Flow& f = m_flows[flow];
+        if (f.head == NO_FLOW)
+        {
+            return nullptr;
+        }
+        uint32_t slot = f.head;
+        Ptr<QueueDiscItem> item = m_items[slot].item;
+        m_items[slot].item = nullptr;
+        f.head = m_items[slot].next;
+        if (f.head == NO_FLOW)
+        {
+            f.tail = NO_FLOW;
+        }
+        m_items[slot].next = m_freeItem;
+        m_freeItem = slot;
+        f.nPackets--;
+        f.nBytes -= item->GetSize();
+        return item;
+    }
+
+    /**
+     * \brief Append an inactive flow to the list of new flows, with the given deficit
+     * \param flow the flow index
+     * \param quantum the initial deficit
+     * \return true if the flow was inactive
+     */
+    bool Activate(uint32_t flow, uint32_t quantum)
+    {
+        Flow& f = m_flows[flow];
+        if (f.status != INACTIVE)
+        {
+            return false;
+        }
+        f.status = NEW_FLOW;
+        f.deficit = quantum;
+        PushBack(m_newFlows, flow);
+        return true;
+    }
+
+    /**
+     * \brief Select the flow to serve according to the DRR scheduler
+     *
+     * New flows are served before old flows. Flows at the head of the lists
+     * with a non-positive deficit get a quantum and are moved to the tail of the
+     * list of old flows. The selected flow is left at the head of its list.
+     *
+     * \param quantum the quantum
+     * \return the index of the selected flow, or NO_FLOW if no flow is active
+     */
+    uint32_t Select(uint32_t quantum)
+    {
+        while (m_newFlows.head != NO_FLOW)
+        {
+            Flow& f = m_flows[m_newFlows.head];
+            if (f.deficit > 0)
+            {
+                return m_newFlows.head;
+            }
+            f.deficit += quantum;
+            f.status = OLD_FLOW;
+            PushBack(m_oldFlows, PopFront(m_newFlows));
+        }
+        while (m_oldFlows.head != NO_FLOW)
+        {
+            Flow& f = m_flows[m_oldFlows.head];
+            if (f.deficit > 0)
+            {
+                return m_oldFlows.head;
+            }
+            f.deficit += quantum;
+            PushBack(m_oldFlows, PopFront(m_oldFlows));
+        }
+        return NO_FLOW;
+    }
+
+    /**
+     * \brief Remove the flow last returned by Select, which turned out to be empty
+     *
+     * A new flow is moved to the list of old flows, so that it is deactivated
+     * the next time it turns out to be empty; an old flow becomes inactive.
+     */
+    void Retire()
+    {
+        if (m_newFlows.head != NO_FLOW)
+        {
+            uint32_t flow = PopFront(m_newFlows);
+            m_flows[flow].status = OLD_FLOW;
+            PushBack(m_oldFlows, flow);
+        }
+        else
+        {
+            m_flows[PopFront(m_oldFlows)].status = INACTIVE;
+        }
+    }
+
+    /**
+     * \brief Charge the flow for the bytes it has been served
+     * \param flow the flow index
+     * \param bytes the number of bytes
+     */
+    void Charge(uint32_t flow, uint32_t bytes)
+    {
+        m_flows[flow].deficit -= static_cast<int32_t>(bytes);
+    }
+
+    /**
+     * \return the index of the flow with the largest byte count (the first
+     *         flow if all the flows are empty)
+     */
+    uint32_t GetFattestFlow() const
+    {
+        uint32_t maxBacklog = 0;
+        uint32_t index = 0;
+        for (uint32_t flow = 0; flow < m_flows.size(); flow++)
+        {
+            if (m_flows[flow].nBytes > maxBacklog)
+            {
+                maxBacklog = m_flows[flow].nBytes;
+                index = flow;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * \brief Remove all the flows and the packets they store
+     */
+    void Clear()
+    {
+        m_flows.clear();
+        m_items.clear();
+        m_buckets.assign(MIN_BUCKETS, NO_FLOW);
+        m_freeItem = NO_FLOW;
+        m_newFlows = {NO_FLOW, NO_FLOW};
+        m_oldFlows = {NO_FLOW, NO_FLOW};
+    }
+
+  private:
+    /// A flow queue
+    struct Flow
+    {
+        State state;                 //!< the AQM state
+        uint32_t bucket;             //!< the bucket of the flow
+        uint32_t tag{0};             //!< the tag used by set associative hash
+        FlowStatus status{INACTIVE}; //!< the status of the flow
+        int32_t deficit{0};          //!< the deficit of the flow
+        uint32_t next{NO_FLOW};      //!< the next flow in the list of new or old flows
+        uint32_t head{NO_FLOW};      //!< the slot of the first packet
+        uint32_t tail{NO_FLOW};      //!< the slot of the last packet
+        uint32_t nPackets{0};        //!< the number of packets queued
+        uint32_t nBytes{0};          //!< the number of bytes queued
+    };
+
+    /// A packet slot
+    struct Item
+    {
+        Ptr<QueueDiscItem> item; //!< the packet
+        uint32_t next{NO_FLOW};  //!< the next slot of the flow queue (or of the free list)
+    };
+
+    /// A list of flows
+    struct FlowList
+    {
+        uint32_t head; //!< the first flow
+        uint32_t tail; //!< the last flow
+    };
+
+    static constexpr std::size_t MIN_BUCKETS = 16; //!< initial size of the bucket index
+
+    /**
+     * \param bucket the bucket
+     * \return the hash of the bucket in the bucket index
+     */
+    static std::size_t Hash(uint32_t bucket)
+    {
+        return (static_cast<uint64_t>(bucket) * 0x9e3779b97f4a7c15ULL) >> 32;
+    }
+
+    /**
+     * \brief Add a flow to the bucket index
+     * \param bucket the bucket
+     * \param flow the flow index
+     */
+    void InsertBucket(uint32_t bucket, uint32_t flow)
+    {
+        std::size_t mask = m_buckets.size() - 1;
+        std::size_t i = Hash(bucket) & mask;
+        while (m_buckets[i] != NO_FLOW)
+        {
+            i = (i + 1) & mask;
+        }
+        m_buckets[i] = flow;
+    }
+
+    /**
+     * \brief Append a flow to a list
+     * \param list the list
+     * \param flow the flow index
+     */
+    void PushBack(FlowList& list, uint32_t flow)
+    {
+        m_flows[flow].next = NO_FLOW;
+        if (list.head == NO_FLOW)
+        {
+            list.head = flow;
+        }
+        else
+        {
+            m_flows[list.tail].next = flow;
+        }
+        list.tail = flow;
+    }
+
+    /**
+     * \brief Remove the first flow of a non-empty list
+     * \param list the list
+     * \return the flow index
+     */
+    uint32_t PopFront(FlowList& list)
+    {
+        uint32_t flow = list.head;
+        list.head = m_flows[flow].next;
+        if (list.head == NO_FLOW)
+        {
+            list.tail = NO_FLOW;
+        }
+        return flow;
+    }
+
+    std::vector<Flow> m_flows;       //!< the flows, in order of creation
+    std::vector<uint32_t> m_buckets; //!< open-addressing index of the flows by bucket
+    std::vector<Item> m_items;       //!< the packet slots
+    uint32_t m_freeItem;             //!< the first free packet slot
+    FlowList m_newFlows;             //!< the list of new flows
+    FlowList m_oldFlows;             //!< the list of old flows
+};
+
+} // namespace ns3
+
+#endif /* FQ_FLOW_TABLE_H */
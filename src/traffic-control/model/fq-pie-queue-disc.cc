@@ -25,93 +25,28 @@
 
 #include "fq-pie-queue-disc.h"
 
-#include "pie-queue-disc.h"
-
 #include "ns3/log.h"
 #include "ns3/net-device-queue-interface.h"
-#include "ns3/queue.h"
+#include "ns3/simulator.h"
 #include "ns3/string.h"
 
+#include <cmath>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("FqPieQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED(FqPieFlow);
-
-TypeId
-FqPieFlow::GetTypeId()
-{
-    static TypeId tid = TypeId("ns3::FqPieFlow")
-                            .SetParent<QueueDiscClass>()
-                            .SetGroupName("TrafficControl")
-                            .AddConstructor<FqPieFlow>();
-    return tid;
-}
-
-FqPieFlow::FqPieFlow()
-    : m_deficit(0),
-      m_status(INACTIVE),
-      m_index(0)
-{
-    NS_LOG_FUNCTION(this);
-}
-
-FqPieFlow::~FqPieFlow()
-{
-    NS_LOG_FUNCTION(this);
-}
-
-void
-FqPieFlow::SetDeficit(uint32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit = deficit;
-}
-
-int32_t
-FqPieFlow::GetDeficit() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_deficit;
-}
-
-void
-FqPieFlow::IncreaseDeficit(int32_t deficit)
-{
-    NS_LOG_FUNCTION(this << deficit);
-    m_deficit += deficit;
-}
-
-void
-FqPieFlow::SetStatus(FlowStatus status)
-{
-    NS_LOG_FUNCTION(this);
-    m_status = status;
-}
-
-FqPieFlow::FlowStatus
-FqPieFlow::GetStatus() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_status;
-}
-
-void
-FqPieFlow::SetIndex(uint32_t index)
-{
-    NS_LOG_FUNCTION(this);
-    m_index = index;
-}
-
-uint32_t
-FqPieFlow::GetIndex() const
-{
-    return m_index;
-}
-
 NS_OBJECT_ENSURE_REGISTERED(FqPieQueueDisc);
 
+const uint32_t FqPieQueueDisc::UNCLASSIFIED_DROP_ID = QueueDisc::RegisterReason(UNCLASSIFIED_DROP);
+const uint32_t FqPieQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::RegisterReason(OVERLIMIT_DROP);
+const uint32_t FqPieQueueDisc::FORCED_DROP_ID = QueueDisc::RegisterReason(FORCED_DROP);
+const uint32_t FqPieQueueDisc::UNFORCED_DROP_ID = QueueDisc::RegisterReason(UNFORCED_DROP);
+const uint32_t FqPieQueueDisc::UNFORCED_MARK_ID = QueueDisc::RegisterReason(UNFORCED_MARK);
+const uint32_t FqPieQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId
 FqPieQueueDisc::GetTypeId()
 {
@@ -200,6 +135,11 @@ FqPieQueueDisc::GetTypeId()
                           BooleanValue(false),
                           MakeBooleanAccessor(&FqPieQueueDisc::m_useDerandomization),
                           MakeBooleanChecker())
+            .AddAttribute("UseFixedPoint",
+                          "True to update the drop probabilities in the integer domain",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&FqPieQueueDisc::m_useFixedPoint),
+                          MakeBooleanChecker())
             .AddAttribute("Flows",
                           "The number of queues into which the incoming packets are classified",
                           UintegerValue(1024),
@@ -234,6 +174,7 @@ FqPieQueueDisc::FqPieQueueDisc()
       m_quantum(0)
 {
     NS_LOG_FUNCTION(this);
+    m_uv = CreateObject<UniformRandomVariable>();
 }
 
 FqPieQueueDisc::~FqPieQueueDisc()
@@ -241,6 +182,16 @@ FqPieQueueDisc::~FqPieQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqPieQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_uv = nullptr;
+    m_rtrsEvent.Cancel();
+    m_flowTable.Clear();
+    QueueDisc::DoDispose();
+}
+
 void
 FqPieQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -254,6 +205,20 @@ FqPieQueueDisc::GetQuantum() const
     return m_quantum;
 }
 
+uint32_t
+FqPieQueueDisc::GetNFlowQueues() const
+{
+    return m_flowTable.GetNFlows();
+}
+
+int64_t
+FqPieQueueDisc::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_uv->SetStream(stream);
+    return 1;
+}
+
 uint32_t
 FqPieQueueDisc::SetAssociativeHash(uint32_t flowHash)
 {
@@ -265,22 +230,26 @@ FqPieQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t flow = m_flowTable.Find(i);
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqPieFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqPieFlow::INACTIVE)
+        if (flow == m_flowTable.NO_FLOW)
+        {
+            // this queue has not been created yet, hence we can use it
+            m_flowTable.Add(i, FlowState());
+            m_flowTable.SetTag(m_flowTable.Find(i), flowHash);
+            return i;
+        }
+        if (m_flowTable.GetTag(flow) == flowHash ||
+            m_flowTable.GetStatus(flow) == m_flowTable.INACTIVE)
         {
-            // this queue has not been created yet or is associated with this flow
-            // or is inactive, hence we can use it
-            m_tags[i] = flowHash;
+            // this queue is associated with this flow or is inactive, hence we can use it
+            m_flowTable.SetTag(flow, flowHash);
             return i;
         }
     }
 
     // all the queues of the set are used. Use the first queue of the set
-    m_tags[outerHash] = flowHash;
+    m_flowTable.SetTag(m_flowTable.Find(outerHash), flowHash);
     return outerHash;
 }
 
@@ -307,7 +276,7 @@ FqPieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         else
         {
             NS_LOG_ERROR("No filter has been able to classify this packet, drop it.");
-            DropBeforeEnqueue(item, UNCLASSIFIED_DROP);
+            DropBeforeEnqueue(item, UNCLASSIFIED_DROP_ID);
             return false;
         }
     }
@@ -321,123 +290,317 @@ FqPieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqPieFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t flow = m_flowTable.Find(h);
+    if (flow == m_flowTable.NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqPieFlow>();
-        Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
-        // If Pie, Set values of PieQueueDisc to match this QueueDisc
-        Ptr<PieQueueDisc> pie = qd->GetObject<PieQueueDisc>();
-        if (pie)
+        flow = m_flowTable.Add(h, FlowState());
+    }
+
+    if (!PieEnqueue(flow, item))
+    {
+        return false;
+    }
+
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << flow);
+
+    if (GetCurrentSize() > GetMaxSize())
+    {
+        NS_LOG_DEBUG("Overload; enter FqPieDrop ()");
+        FqPieDrop();
+    }
+
+    return true;
+}
+
+bool
+FqPieQueueDisc::PieEnqueue(uint32_t flow, Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << flow << item);
+    FlowState& state = m_flowTable.GetState(flow);
+
+    QueueSize nQueued = m_flowTable.GetSize(flow, GetMaxSize().GetUnit());
+    // If L4S is enabled, then check if the packet is ECT1, and if it is then set isEct true
+    bool isEct1 = false;
+    if (m_useL4s)
+    {
+        uint8_t tosByte = 0;
+        if (item->GetUint8Value(QueueItem::IP_DSFIELD, tosByte) &&
+            (((tosByte & 0x3) == 1) || (tosByte & 0x3) == 3))
         {
-            pie->SetAttribute("UseEcn", BooleanValue(m_useEcn));
-            pie->SetAttribute("CeThreshold", TimeValue(m_ceThreshold));
-            pie->SetAttribute("UseL4s", BooleanValue(m_useL4s));
+            isEct1 = true;
         }
-        qd->Initialize();
-        flow->SetQueueDisc(qd);
-        flow->SetIndex(h);
-        AddQueueDiscClass(flow);
+    }
 
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
+    if (nQueued + item > GetMaxSize())
+    {
+        // Drops due to queue limit: reactive
+        DropBeforeEnqueue(item, FORCED_DROP_ID);
+        state.accuProb = 0;
+        return false;
     }
-    else
+    // If L4S is enabled and packet is ECT1 then directly enqueue the packet.
+    else if (!isEct1 && DropEarly(state, item, nQueued.GetValue()))
+    {
+        if (!m_useEcn || state.dropProb >= m_markEcnTh || !Mark(item, UNFORCED_MARK_ID))
+        {
+            // Early probability drop: proactive
+            DropBeforeEnqueue(item, UNFORCED_DROP_ID);
+            state.accuProb = 0;
+            return false;
+        }
+    }
+
+    // No drop
+    if (m_flowTable.Activate(flow, m_quantum))
+    {
+        NS_LOG_DEBUG("Flow queue " << m_flowTable.GetBucket(flow) << " is now a new flow");
+    }
+    m_flowTable.Enqueue(flow, item);
+    PacketEnqueued(item);
+    return true;
+}
+
+bool
+FqPieQueueDisc::DropEarly(FlowState& state, Ptr<QueueDiscItem> item, uint32_t qSize)
+{
+    NS_LOG_FUNCTION(this << item << qSize);
+    if (state.burstAllowance.GetSeconds() > 0)
     {
-        flow = StaticCast<FqPieFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        // If there is still burst_allowance left, skip random early drop.
+        return false;
     }
 
-    if (flow->GetStatus() == FqPieFlow::INACTIVE)
+    if (state.burstState == PieQueueDisc::NO_BURST)
     {
-        flow->SetStatus(FqPieFlow::NEW_FLOW);
-        flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        state.burstState = PieQueueDisc::IN_BURST_PROTECTING;
+        state.burstAllowance = m_maxBurst;
     }
 
-    flow->GetQueueDisc()->Enqueue(item);
+    double p = state.dropProb;
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    uint32_t packetSize = item->GetSize();
 
-    if (GetCurrentSize() > GetMaxSize())
+    if (GetMaxSize().GetUnit() == QueueSizeUnit::BYTES)
     {
-        NS_LOG_DEBUG("Overload; enter FqPieDrop ()");
-        FqPieDrop();
+        p = p * packetSize / m_meanPktSize;
     }
 
-    return true;
+    // Safeguard PIE to be work conserving (Section 4.1 of RFC 8033)
+    if ((state.qDelayOld.GetSeconds() < (0.5 * m_qDelayRef.GetSeconds())) &&
+        (state.dropProb < 0.2))
+    {
+        return false;
+    }
+    else if (GetMaxSize().GetUnit() == QueueSizeUnit::BYTES && qSize <= 2 * m_meanPktSize)
+    {
+        return false;
+    }
+    else if (GetMaxSize().GetUnit() == QueueSizeUnit::PACKETS && qSize <= 2)
+    {
+        return false;
+    }
+
+    if (m_useDerandomization)
+    {
+        if (state.dropProb == 0)
+        {
+            state.accuProb = 0;
+        }
+        state.accuProb += state.dropProb;
+        if (state.accuProb < 0.85)
+        {
+            return false;
+        }
+        else if (state.accuProb >= 8.5)
+        {
+            return true;
+        }
+    }
+
+    double u = m_uv->GetValue();
+    return u <= p;
 }
 
-Ptr<QueueDiscItem>
-FqPieQueueDisc::DoDequeue()
+void
+FqPieQueueDisc::CalculateP()
 {
     NS_LOG_FUNCTION(this);
+    for (uint32_t flow = 0; flow < m_flowTable.GetNFlows(); flow++)
+    {
+        CalculateFlowP(flow);
+    }
+    m_rtrsEvent = Simulator::Schedule(m_tUpdate, &FqPieQueueDisc::CalculateP, this);
+}
 
-    Ptr<FqPieFlow> flow;
-    Ptr<QueueDiscItem> item;
+void
+FqPieQueueDisc::CalculateFlowP(uint32_t flow)
+{
+    FlowState& state = m_flowTable.GetState(flow);
+    Time qDelay;
+    double p = 0.0;
+    bool missingInitFlag = false;
 
-    do
+    if (m_useDqRateEstimator)
+    {
+        if (state.avgDqRate > 0)
+        {
+            qDelay = Seconds(m_flowTable.GetNBytes(flow) / state.avgDqRate);
+        }
+        else
+        {
+            qDelay = Seconds(0);
+            missingInitFlag = true;
+        }
+        state.qDelay = qDelay;
+    }
+    else
     {
-        bool found = false;
+        qDelay = state.qDelay;
+    }
 
-        while (!found && !m_newFlows.empty())
+    if (m_useFixedPoint)
+    {
+        // the drop probability is a multiple of 1 / FIXED_POINT_ONE, hence the
+        // conversions to and from the integer domain are exact
+        int64_t dropProb = 0;
+        if (!state.burstAllowance.IsStrictlyPositive())
+        {
+            dropProb = PieQueueDisc::FixedPointDropProb(
+                static_cast<int64_t>(std::ldexp(state.dropProb, 52)),
+                qDelay.GetNanoSeconds(),
+                state.qDelayOld.GetNanoSeconds(),
+                m_qDelayRef.GetNanoSeconds(),
+                m_aFixed,
+                m_bFixed,
+                m_isCapDropAdjustment);
+        }
+        p = std::ldexp(static_cast<double>(dropProb), -52);
+    }
+    else if (state.burstAllowance.GetSeconds() > 0)
+    {
+        state.dropProb = 0;
+    }
+    else
+    {
+        p = m_a * (qDelay.GetSeconds() - m_qDelayRef.GetSeconds()) +
+            m_b * (qDelay.GetSeconds() - state.qDelayOld.GetSeconds());
+        if (state.dropProb < 0.000001)
+        {
+            p /= 2048;
+        }
+        else if (state.dropProb < 0.00001)
+        {
+            p /= 512;
+        }
+        else if (state.dropProb < 0.0001)
+        {
+            p /= 128;
+        }
+        else if (state.dropProb < 0.001)
         {
-            flow = m_newFlows.front();
+            p /= 32;
+        }
+        else if (state.dropProb < 0.01)
+        {
+            p /= 8;
+        }
+        else if (state.dropProb < 0.1)
+        {
+            p /= 2;
+        }
 
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                flow->SetStatus(FqPieFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
-            {
-                NS_LOG_DEBUG("Found a new flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
-            }
+        // Cap Drop Adjustment (Section 5.5 of RFC 8033)
+        if (m_isCapDropAdjustment && (state.dropProb >= 0.1) && (p > 0.02))
+        {
+            p = 0.02;
         }
+    }
+
+    if (!m_useFixedPoint)
+    {
+        p += state.dropProb;
 
-        while (!found && !m_oldFlows.empty())
+        // For non-linear drop in prob
+        // Decay the drop probability exponentially (Section 4.2 of RFC 8033)
+        if (qDelay.GetSeconds() == 0 && state.qDelayOld.GetSeconds() == 0)
         {
-            flow = m_oldFlows.front();
+            p *= 0.98;
+        }
+    }
 
-            if (flow->GetDeficit() <= 0)
-            {
-                NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
-                flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.push_back(flow);
-                m_oldFlows.pop_front();
-            }
-            else
+    // bound the drop probability (Section 4.2 of RFC 8033)
+    state.dropProb = std::clamp(p, 0.0, 1.0);
+
+    // Section 4.4 #2
+    if (state.burstAllowance < m_tUpdate)
+    {
+        state.burstAllowance = Seconds(0);
+    }
+    else
+    {
+        state.burstAllowance -= m_tUpdate;
+    }
+
+    auto burstResetLimit = static_cast<uint32_t>(BURST_RESET_TIMEOUT / m_tUpdate.GetSeconds());
+    bool belowHalfRef = (qDelay.GetSeconds() < 0.5 * m_qDelayRef.GetSeconds()) &&
+                        (state.qDelayOld.GetSeconds() < (0.5 * m_qDelayRef.GetSeconds())) &&
+                        (state.dropProb == 0);
+    if (belowHalfRef && !missingInitFlag)
+    {
+        state.dqCount = DQCOUNT_INVALID;
+        state.avgDqRate = 0.0;
+    }
+    if (belowHalfRef && (state.burstAllowance.GetSeconds() == 0))
+    {
+        if (state.burstState == PieQueueDisc::IN_BURST_PROTECTING)
+        {
+            state.burstState = PieQueueDisc::IN_BURST;
+            state.burstReset = 0;
+        }
+        else if (state.burstState == PieQueueDisc::IN_BURST)
+        {
+            state.burstReset++;
+            if (state.burstReset > burstResetLimit)
             {
-                NS_LOG_DEBUG("Found an old flow " << flow->GetIndex() << " with positive deficit");
-                found = true;
+                state.burstReset = 0;
+                state.burstState = PieQueueDisc::NO_BURST;
             }
         }
+    }
+    else if (state.burstState == PieQueueDisc::IN_BURST)
+    {
+        state.burstReset = 0;
+    }
+
+    state.qDelayOld = qDelay;
+}
+
+Ptr<QueueDiscItem>
+FqPieQueueDisc::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
 
-        if (!found)
+    uint32_t flow;
+    Ptr<QueueDiscItem> item;
+
+    do
+    {
+        flow = m_flowTable.Select(m_quantum);
+
+        if (flow == m_flowTable.NO_FLOW)
         {
             NS_LOG_DEBUG("No flow found to dequeue a packet");
             return nullptr;
         }
 
-        item = flow->GetQueueDisc()->Dequeue();
+        NS_LOG_DEBUG("Found flow " << m_flowTable.GetBucket(flow) << " with positive deficit");
+        item = PieDequeue(flow);
 
         if (!item)
         {
             NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
-            {
-                flow->SetStatus(FqPieFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
-            }
-            else
-            {
-                flow->SetStatus(FqPieFlow::INACTIVE);
-                m_oldFlows.pop_front();
-            }
+            m_flowTable.Retire();
         }
         else
         {
@@ -445,8 +608,99 @@ FqPieQueueDisc::DoDequeue()
         }
     } while (!item);
 
-    flow->IncreaseDeficit(item->GetSize() * -1);
+    m_flowTable.Charge(flow, item->GetSize());
+
+    return item;
+}
 
+Ptr<QueueDiscItem>
+FqPieQueueDisc::FlowDequeue(uint32_t flow)
+{
+    Ptr<QueueDiscItem> item = m_flowTable.Dequeue(flow);
+    if (item)
+    {
+        PacketDequeued(item);
+    }
+    return item;
+}
+
+Ptr<QueueDiscItem>
+FqPieQueueDisc::PieDequeue(uint32_t flow)
+{
+    NS_LOG_FUNCTION(this << flow);
+    FlowState& state = m_flowTable.GetState(flow);
+
+    Ptr<QueueDiscItem> item = FlowDequeue(flow);
+    if (!item)
+    {
+        return nullptr;
+    }
+
+    // If L4S is enabled and packet is ECT1, then check if delay is greater
+    // than CE threshold and if it is then mark the packet,
+    // skip PIE steps, and return the item.
+    if (m_useL4s)
+    {
+        uint8_t tosByte = 0;
+        if (item->GetUint8Value(QueueItem::IP_DSFIELD, tosByte) &&
+            (((tosByte & 0x3) == 1) || (tosByte & 0x3) == 3))
+        {
+            if ((Now() - item->GetTimeStamp() > m_ceThreshold) &&
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
+            {
+                NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
+            }
+            return item;
+        }
+    }
+
+    uint32_t bytes = m_flowTable.GetNBytes(flow);
+
+    if (!m_useDqRateEstimator)
+    {
+        state.qDelay = (bytes == 0 ? Seconds(0) : Now() - item->GetTimeStamp());
+        return item;
+    }
+
+    // if not in a measurement cycle and the queue has built up to dq_threshold,
+    // start the measurement cycle
+    if ((bytes >= m_dqThreshold) && (!state.inMeasurement))
+    {
+        state.dqStart = Now();
+        state.dqCount = 0;
+        state.inMeasurement = true;
+    }
+
+    if (state.inMeasurement)
+    {
+        state.dqCount += item->GetSize();
+
+        // done with a measurement cycle
+        if (state.dqCount >= m_dqThreshold)
+        {
+            Time dqTime = Now() - state.dqStart;
+            if (dqTime > Seconds(0))
+            {
+                if (state.avgDqRate == 0)
+                {
+                    state.avgDqRate = state.dqCount / dqTime.GetSeconds();
+                }
+                else
+                {
+                    state.avgDqRate =
+                        (0.5 * state.avgDqRate) + (0.5 * (state.dqCount / dqTime.GetSeconds()));
+                }
+            }
+
+            // restart a measurement cycle if there is enough data
+            state.dqCount = 0;
+            state.inMeasurement = (bytes > m_dqThreshold);
+            if (state.inMeasurement)
+            {
+                state.dqStart = Now();
+            }
+        }
+    }
     return item;
 }
 
@@ -454,6 +708,7 @@ bool
 FqPieQueueDisc::CheckConfig()
 {
     NS_LOG_FUNCTION(this);
+    // the flow queues are not classes, see the FqFlowTable
     if (GetNQueueDiscClasses() > 0)
     {
         NS_LOG_ERROR("FqPieQueueDisc cannot have classes");
@@ -510,21 +765,9 @@ FqPieQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
 
-    m_flowFactory.SetTypeId("ns3::FqPieFlow");
-
-    m_queueDiscFactory.SetTypeId("ns3::PieQueueDisc");
-    m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
-    m_queueDiscFactory.Set("MeanPktSize", UintegerValue(m_meanPktSize));
-    m_queueDiscFactory.Set("A", DoubleValue(m_a));
-    m_queueDiscFactory.Set("B", DoubleValue(m_b));
-    m_queueDiscFactory.Set("Tupdate", TimeValue(m_tUpdate));
-    m_queueDiscFactory.Set("Supdate", TimeValue(m_sUpdate));
-    m_queueDiscFactory.Set("DequeueThreshold", UintegerValue(m_dqThreshold));
-    m_queueDiscFactory.Set("QueueDelayReference", TimeValue(m_qDelayRef));
-    m_queueDiscFactory.Set("MaxBurstAllowance", TimeValue(m_maxBurst));
-    m_queueDiscFactory.Set("UseDequeueRateEstimator", BooleanValue(m_useDqRateEstimator));
-    m_queueDiscFactory.Set("UseCapDropAdjustment", BooleanValue(m_isCapDropAdjustment));
-    m_queueDiscFactory.Set("UseDerandomization", BooleanValue(m_useDerandomization));
+    m_aFixed = PieQueueDisc::FixedPointGain(m_a);
+    m_bFixed = PieQueueDisc::FixedPointGain(m_b);
+    m_rtrsEvent = Simulator::Schedule(m_sUpdate, &FqPieQueueDisc::CalculateP, this);
 }
 
 uint32_t
@@ -532,35 +775,21 @@ FqPieQueueDisc::FqPieDrop()
 {
     NS_LOG_FUNCTION(this);
 
-    uint32_t maxBacklog = 0;
-    uint32_t index = 0;
-    Ptr<QueueDisc> qd;
-
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
-    {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
-        if (bytes > maxBacklog)
-        {
-            maxBacklog = bytes;
-            index = i;
-        }
-    }
+    uint32_t index = m_flowTable.GetFattestFlow();
 
     /* Our goal is to drop half of this fat flow backlog */
     uint32_t len = 0;
     uint32_t count = 0;
-    uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    uint32_t threshold = m_flowTable.GetNBytes(index) >> 1;
     Ptr<QueueDiscItem> item;
 
     do
     {
         NS_LOG_DEBUG("Drop packet (overflow); count: " << count << " len: " << len
                                                        << " threshold: " << threshold);
-        item = qd->GetInternalQueue(0)->Dequeue();
-        DropAfterDequeue(item, OVERLIMIT_DROP);
+        item = FlowDequeue(index);
+        DropAfterDequeue(item, OVERLIMIT_DROP_ID);
         len += item->GetSize();
     } while (++count < m_dropBatchSize && len < threshold);
 
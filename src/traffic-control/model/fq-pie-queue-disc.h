@@ -26,94 +26,36 @@
 #ifndef FQ_PIE_QUEUE_DISC
 #define FQ_PIE_QUEUE_DISC
 
+#include "fq-flow-table.h"
+#include "pie-queue-disc.h"
 #include "queue-disc.h"
 
-#include "ns3/object-factory.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
-#include <list>
-#include <map>
+#include <limits>
 
 namespace ns3
 {
 
-/**
- * \ingroup traffic-control
- *
- * \brief A flow queue used by the FqPie queue disc
- */
-
-class FqPieFlow : public QueueDiscClass
-{
-  public:
-    /**
-     * \brief Get the type ID.
-     * \return the object TypeId
-     */
-    static TypeId GetTypeId();
-    /**
-     * \brief FqPieFlow constructor
-     */
-    FqPieFlow();
-
-    ~FqPieFlow() override;
-
-    /**
-     * \enum FlowStatus
-     * \brief Used to determine the status of this flow queue
-     */
-    enum FlowStatus
-    {
-        INACTIVE,
-        NEW_FLOW,
-        OLD_FLOW
-    };
-
-    /**
-     * \brief Set the deficit for this flow
-     * \param deficit the deficit for this flow
-     */
-    void SetDeficit(uint32_t deficit);
-    /**
-     * \brief Get the deficit for this flow
-     * \return the deficit for this flow
-     */
-    int32_t GetDeficit() const;
-    /**
-     * \brief Increase the deficit for this flow
-     * \param deficit the amount by which the deficit is to be increased
-     */
-    void IncreaseDeficit(int32_t deficit);
-    /**
-     * \brief Set the status for this flow
-     * \param status the status for this flow
-     */
-    void SetStatus(FlowStatus status);
-    /**
-     * \brief Get the status of this flow
-     * \return the status of this flow
-     */
-    FlowStatus GetStatus() const;
-    /**
-     * \brief Set the index for this flow
-     * \param index the index for this flow
-     */
-    void SetIndex(uint32_t index);
-    /**
-     * \brief Get the index of this flow
-     * \return the index of this flow
-     */
-    uint32_t GetIndex() const;
-
-  private:
-    int32_t m_deficit;   //!< the deficit for this flow
-    FlowStatus m_status; //!< the status of this flow
-    uint32_t m_index;    //!< the index for this flow
-};
-
 /**
  * \ingroup traffic-control
  *
  * \brief A FqPie packet queue disc
+ *
+ * As in FqCoDelQueueDisc, the flow queues and their PIE state are stored in a
+ * flat FqFlowTable rather than in classes with a child PIE queue disc each.
+ * A single timer updates the drop probability of all the flow queues every
+ * Tupdate, as in the Linux fq_pie implementation. Packets dropped or marked by
+ * the PIE algorithm are reported with the same reasons as they would have been
+ * by a child PIE queue disc.
+ *
+ * Hence, this queue disc has no classes (GetNQueueDiscClasses() returns 0)
+ * and cannot be given any. The FqPieFlow class and the attributes and trace
+ * sources of the child PIE queue discs do not exist anymore: the PIE
+ * parameters are the attributes of this queue disc, and the drops and marks of
+ * all the flow queues are reported by the trace sources and statistics of
+ * this queue disc.
  */
 
 class FqPieQueueDisc : public QueueDisc
@@ -147,12 +89,70 @@ class FqPieQueueDisc : public QueueDisc
      */
     uint32_t GetQuantum() const;
 
+    /**
+     * \brief Get the number of flow queues created so far.
+     *
+     * \returns the number of flow queues that have been assigned at least a packet
+     */
+    uint32_t GetNFlowQueues() const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
     // Reasons for dropping packets
     static constexpr const char* UNCLASSIFIED_DROP =
         "Unclassified drop"; //!< No packet filter able to classify packet
     static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
+    static constexpr const char* FORCED_DROP =
+        "(Dropped by child queue disc) Forced drop"; //!< Flow queue holding MaxSize
+    static constexpr const char* UNFORCED_DROP =
+        "(Dropped by child queue disc) Unforced drop"; //!< Early probability drops
+    // Reasons for marking packets
+    static constexpr const char* UNFORCED_MARK =
+        "(Marked by child queue disc) Unforced mark"; //!< Early probability marks
+    static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
+        "(Marked by child queue disc) CE threshold exceeded mark"; //!< Sojourn time above CE
+                                                                   //!< threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t UNCLASSIFIED_DROP_ID;          //!< ID of UNCLASSIFIED_DROP
+    static const uint32_t OVERLIMIT_DROP_ID;             //!< ID of OVERLIMIT_DROP
+    static const uint32_t FORCED_DROP_ID;                //!< ID of FORCED_DROP
+    static const uint32_t UNFORCED_DROP_ID;              //!< ID of UNFORCED_DROP
+    static const uint32_t UNFORCED_MARK_ID;              //!< ID of UNFORCED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
+
+  protected:
+    void DoDispose() override;
 
   private:
+    /**
+     * \brief PIE state of a flow queue
+     */
+    struct FlowState
+    {
+        double dropProb{0};                //!< Variable used in calculation of drop probability
+        Time qDelayOld;                    //!< Old value of queue delay
+        Time qDelay;                       //!< Current value of queue delay
+        Time burstAllowance;               //!< Current max burst value allowed before random drops
+        uint32_t burstReset{0};            //!< Used to reset value of burst allowance
+        PieQueueDisc::BurstStateT burstState{PieQueueDisc::NO_BURST}; //!< Current burst state
+        bool inMeasurement{false};         //!< Indicates whether we are in a measurement cycle
+        double avgDqRate{0};               //!< Time averaged dequeue rate
+        Time dqStart;                      //!< Start timestamp of current measurement cycle
+        uint64_t dqCount{DQCOUNT_INVALID}; //!< Bytes departed since current measurement cycle
+        double accuProb{0};                //!< Accumulated drop probability
+    };
+
+    static constexpr uint64_t DQCOUNT_INVALID =
+        std::numeric_limits<uint64_t>::max(); //!< Invalid dqCount value
+
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
     bool CheckConfig() override;
@@ -173,6 +173,48 @@ class FqPieQueueDisc : public QueueDisc
      */
     uint32_t SetAssociativeHash(uint32_t flowHash);
 
+    /**
+     * \brief Remove the packet at the head of a flow queue
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> FlowDequeue(uint32_t flow);
+
+    /**
+     * \brief Enqueue a packet in a flow queue according to the PIE algorithm
+     * \param flow the index of the flow queue
+     * \param item the packet
+     * \return false if the packet has been dropped
+     */
+    bool PieEnqueue(uint32_t flow, Ptr<QueueDiscItem> item);
+
+    /**
+     * \brief Dequeue a packet from a flow queue and update its PIE state
+     * \param flow the index of the flow queue
+     * \return the packet, or nullptr if the flow queue is empty
+     */
+    Ptr<QueueDiscItem> PieDequeue(uint32_t flow);
+
+    /**
+     * \brief Check if a packet needs to be dropped due to probability drop
+     * \param state the PIE state of the flow queue
+     * \param item the packet
+     * \param qSize the size of the flow queue
+     * \returns false for no drop, true for drop
+     */
+    bool DropEarly(FlowState& state, Ptr<QueueDiscItem> item, uint32_t qSize);
+
+    /**
+     * \brief Periodically update the drop probability of all the flow queues
+     */
+    void CalculateP();
+
+    /**
+     * \brief Update the drop probability of a flow queue
+     * \param flow the index of the flow queue
+     */
+    void CalculateFlowP(uint32_t flow);
+
     // PIE queue disc parameter
     bool m_useEcn;          //!< True if ECN is used (packets are marked instead of being dropped)
     double m_markEcnTh;     //!< ECN marking threshold (default 10% as suggested in RFC 8033)
@@ -191,6 +233,9 @@ class FqPieQueueDisc : public QueueDisc
     bool
         m_isCapDropAdjustment; //!< Enable/Disable Cap Drop Adjustment feature mentioned in RFC 8033
     bool m_useDerandomization; //!< Enable Derandomization feature mentioned in RFC 8033
+    bool m_useFixedPoint;      //!< True to update the drop probabilities in the integer domain
+    int64_t m_aFixed;          //!< Alpha in the integer domain
+    int64_t m_bFixed;          //!< Beta in the integer domain
 
     // Fq parameters
     uint32_t m_quantum;              //!< Deficit assigned to flows at each round
@@ -200,14 +245,9 @@ class FqPieQueueDisc : public QueueDisc
     uint32_t m_perturbation;         //!< hash perturbation value
     bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
 
-    std::list<Ptr<FqPieFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<FqPieFlow>> m_oldFlows; //!< The list of old flows
-
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
-
-    ObjectFactory m_flowFactory;      //!< Factory to create a new flow
-    ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+    Ptr<UniformRandomVariable> m_uv;    //!< Rng stream
+    EventId m_rtrsEvent;                //!< Event used to update the drop probabilities
+    FqFlowTable<FlowState> m_flowTable; //!< The flow queues
 };
 
 } // namespace ns3
@@ -22,7 +22,8 @@
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/tcp-socket-base.h"
 #include "queue-disc.h"
-#include <array>
+#include <algorithm>
+#include <functional>
 
 namespace ns3
 {
@@ -31,6 +32,11 @@ NS_LOG_COMPONENT_DEFINE("FqQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(FqQueueDisc);
 
+const uint32_t FqQueueDisc::LIMIT_EXCEEDED_DROP_ID = QueueDisc::RegisterReason(LIMIT_EXCEEDED_DROP);
+const uint32_t FqQueueDisc::HORIZON_DROP_ID = QueueDisc::RegisterReason(HORIZON_DROP);
+const uint32_t FqQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 class FqFlow
 {
 public:
@@ -89,6 +95,11 @@ void FqFlow::EraseHead(Ptr<QueueDiscItem> item) {
 
 constexpr uint64_t RATE_BPS_MAX = (1ULL << 63) - 1;
 
+/// Initial number of slots of the flow table (a power of 2)
+constexpr uint32_t FQ_FLOW_TABLE_MIN = 1024;
+/// Number of flows above which idle flows are garbage collected
+constexpr int FQ_GC_THRESHOLD = 2 * FQ_FLOW_TABLE_MIN;
+
 TypeId
 FqQueueDisc::GetTypeId()
 {
@@ -152,7 +163,8 @@ FqQueueDisc::GetTypeId()
 }
 
 FqQueueDisc::FqQueueDisc()
-    : QueueDisc(QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+    : QueueDisc(QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE),
+      m_flowTable(FQ_FLOW_TABLE_MIN)
 {
 }
 
@@ -161,12 +173,10 @@ FqQueueDisc::~FqQueueDisc()
     m_newFlows.clear();
     m_oldFlows.clear();
     m_delayedFlows.clear();
-    for (auto& root : m_fqRoot) {
-        for (auto [key, flow] : root) {
-            delete flow;
-        }
-        root.clear();
+    for (auto& slot : m_flowTable) {
+        delete slot.flow;
     }
+    m_flowTable.clear();
 }
 
 
@@ -178,6 +188,52 @@ static uint32_t HashPtr(uintptr_t val, uint32_t bits) {
     }
 }
 
+uint32_t
+FqQueueDisc::FindSlot(uintptr_t sk) const
+{
+    uint32_t mask = m_flowTable.size() - 1;
+    uint32_t i = HashPtr(sk, 32) & mask;
+    while (m_flowTable[i].flow != nullptr && m_flowTable[i].sk != sk) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void
+FqQueueDisc::EraseSlot(uint32_t i)
+{
+    uint32_t mask = m_flowTable.size() - 1;
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (m_flowTable[j].flow == nullptr) {
+            break;
+        }
+        // the entry in slot j can fill the hole in slot i unless its home slot
+        // lies cyclically in (i, j]
+        uint32_t home = HashPtr(m_flowTable[j].sk, 32) & mask;
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+            continue;
+        }
+        m_flowTable[i] = m_flowTable[j];
+        i = j;
+    }
+    m_flowTable[i] = FlowSlot{};
+}
+
+void
+FqQueueDisc::Rehash(uint32_t capacity)
+{
+    std::vector<FlowSlot> old(capacity);
+    old.swap(m_flowTable);
+    for (const auto& slot : old) {
+        if (slot.flow != nullptr) {
+            m_flowTable[FindSlot(slot.sk)] = slot;
+        }
+    }
+    m_gcCursor = 0;
+}
+
 FqFlow*
 FqQueueDisc::Classify(Ptr<QueueDiscItem> item)
 {
@@ -188,13 +244,12 @@ FqQueueDisc::Classify(Ptr<QueueDiscItem> item)
         sk = ((uintptr_t)item->Hash() << 1) | 1;
     }
 
-    auto& root = m_fqRoot[HashPtr(sk, 10)];
-    if (m_flows >= 2 * (int)m_fqRoot.size() && m_inactiveFlows > m_flows/2) {
-        GarbageCollection(root, sk);
+    if (m_flows >= FQ_GC_THRESHOLD && m_inactiveFlows > m_flows/2) {
+        GarbageCollection(sk);
     }
-    auto it = root.find(sk);
-    if (it != root.end()) {
-        return it->second;
+    uint32_t i = FindSlot(sk);
+    if (m_flowTable[i].flow != nullptr) {
+        return m_flowTable[i].flow;
     }
 
     auto flow = new FqFlow{};
@@ -206,7 +261,12 @@ FqQueueDisc::Classify(Ptr<QueueDiscItem> item)
     }
 
     flow->m_credit = m_initialQuantum;
-    root[sk] = flow;
+    // keep the load factor of the flow table below 1/2
+    if ((m_flows + 1) * 2 > (int)m_flowTable.size()) {
+        Rehash(m_flowTable.size() * 2);
+        i = FindSlot(sk);
+    }
+    m_flowTable[i] = FlowSlot{sk, flow};
     m_flows++;
     m_inactiveFlows++;
     return flow;
@@ -217,7 +277,7 @@ FqQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
     if (GetCurrentSize() + item > GetMaxSize())
     {
-        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP_ID);
         std::cout << "Fq enqueue unexpected drop: limit\n";
         return false;
     }
@@ -230,7 +290,7 @@ FqQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     } else {
         if (txTime > now + m_horizon) {
             if (m_horizonDrop) {
-                DropBeforeEnqueue(item, "Packet beyond horizon");
+                DropBeforeEnqueue(item, HORIZON_DROP_ID);
                 std::cout << "Fq enqueue unexpected drop: horizon\n";
                 return false;
             }
@@ -240,7 +300,7 @@ FqQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 
     FqFlow* flow = Classify(item);
     if (flow->m_qlen >= (int)m_flowPktLimit) {
-        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP_ID);
         return false;
     }
 
@@ -271,17 +331,27 @@ FqQueueDisc::CheckThrottled()
     m_unthrottleLatency += (sample - m_unthrottleLatency) / 8;
     m_timeNextDelayedFlow = Time::Max();
     while (!m_delayedFlows.empty()) {
-        FqFlow* flow = m_delayedFlows.begin()->second;
+        FqFlow* flow = m_delayedFlows.front().flow;
         if (flow->timeNextPacket > now) {
             m_timeNextDelayedFlow = flow->timeNextPacket;
             break;
         }
-        m_delayedFlows.erase(m_delayedFlows.begin());
+        std::pop_heap(m_delayedFlows.begin(), m_delayedFlows.end(), std::greater<>());
+        m_delayedFlows.pop_back();
         m_throttledFlows--;
         m_oldFlows.push_back(flow);
     }
 }
 
+void
+FqQueueDisc::Throttle(FqFlow* flow)
+{
+    m_delayedFlows.push_back({flow->timeNextPacket, m_throttleSeq++, flow});
+    std::push_heap(m_delayedFlows.begin(), m_delayedFlows.end(), std::greater<>());
+    m_throttledFlows++;
+    m_timeNextDelayedFlow = std::min(m_timeNextDelayedFlow, flow->timeNextPacket);
+}
+
 Ptr<QueueDiscItem>
 FqQueueDisc::DoDequeue()
 {
@@ -326,14 +396,12 @@ FqQueueDisc::DoDequeue()
             if (now < timeNextPacket) {
                 flowList->pop_front();
                 flow->timeNextPacket = timeNextPacket;
-                m_delayedFlows.insert({timeNextPacket, flow});
-                m_throttledFlows++;
-                m_timeNextDelayedFlow = std::min(m_timeNextDelayedFlow, timeNextPacket);
+                Throttle(flow);
                 continue;
             }
             if (now - timeNextPacket > m_ceThreshold) {
                 std::cout << "Fq Mark\n";
-                Mark(item, "Queuing time beyond threshold mark");
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID);
             }
             flow->EraseHead(item);
             flow->m_qlen--;
@@ -382,32 +450,30 @@ FqQueueDisc::DoDequeue()
 }
 
 void
-FqQueueDisc::GarbageCollection(FlowTree_t &root, uintptr_t sk)
+FqQueueDisc::GarbageCollection(uintptr_t sk)
 {
     constexpr int FQ_GC_MAX = 8;
+    constexpr uint32_t FQ_GC_SCAN = 64;
     const Time FQ_GC_AGE = MilliSeconds(12);
 
-    std::vector<FlowTree_t::iterator> toFree;
-    for (auto it = root.begin(); it != root.end(); it++) {
-        FqFlow *flow = it->second;
-        if (flow->sk == sk) {
-            break;
-        }
-
-        if (flow->m_detached && Simulator::Now() > flow->m_age + FQ_GC_AGE) {
-            toFree.push_back(it);
-            if (toFree.size() >= FQ_GC_MAX) {
-                break;
-            }
+    // Visit a bounded window of the flow table, resuming where the previous
+    // collection stopped, and free up to FQ_GC_MAX idle flows
+    Time now = Simulator::Now();
+    uint32_t mask = m_flowTable.size() - 1;
+    int cnt = 0;
+    for (uint32_t n = 0; n < FQ_GC_SCAN && cnt < FQ_GC_MAX; n++) {
+        FqFlow* flow = m_flowTable[m_gcCursor].flow;
+        if (flow != nullptr && flow->sk != sk && flow->m_detached &&
+            now > flow->m_age + FQ_GC_AGE) {
+            delete flow;
+            // EraseSlot may shift another flow into this slot, visit it again
+            EraseSlot(m_gcCursor);
+            cnt++;
+            continue;
         }
+        m_gcCursor = (m_gcCursor + 1) & mask;
     }
 
-    for (const auto &it : toFree) {
-        delete it->second;
-        root.erase(it);
-    }
-
-    int cnt = toFree.size();
     m_flows -= cnt;
     m_inactiveFlows -= cnt;
 }
@@ -23,6 +23,7 @@
 #include "ns3/queue-disc.h"
 #include "ns3/data-rate.h"
 #include <deque>
+#include <vector>
 
 namespace ns3
 {
@@ -56,9 +57,41 @@ class FqQueueDisc : public QueueDisc
     // Reasons for dropping packets
     static constexpr const char* LIMIT_EXCEEDED_DROP =
         "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+    static constexpr const char* HORIZON_DROP =
+        "Packet beyond horizon"; //!< Packet timestamp beyond the horizon
+    // Reasons for marking packets
+    static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
+        "Queuing time beyond threshold mark"; //!< Packet late by more than the CE threshold
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t LIMIT_EXCEEDED_DROP_ID;        //!< ID of LIMIT_EXCEEDED_DROP
+    static const uint32_t HORIZON_DROP_ID;               //!< ID of HORIZON_DROP
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
 
   private:
-    using FlowTree_t = std::map<uintptr_t, FqFlow*>;
+    /// A slot of the flow table; an empty slot has a null flow
+    struct FlowSlot
+    {
+        uintptr_t sk{0};       //!< the flow key (socket address or tagged packet hash)
+        FqFlow* flow{nullptr}; //!< the flow
+    };
+
+    /// A throttled flow, ordered by the time its next packet can be sent
+    struct ThrottledFlow
+    {
+        Time timeNextPacket; //!< the time the flow can send again
+        uint64_t seq;        //!< insertion order, to break ties deterministically
+        FqFlow* flow;        //!< the flow
+
+        /**
+         * \param other the other throttled flow
+         * \return true if this flow is to be released after the other one
+         */
+        bool operator>(const ThrottledFlow& other) const
+        {
+            return timeNextPacket > other.timeNextPacket ||
+                   (timeNextPacket == other.timeNextPacket && seq > other.seq);
+        }
+    };
 
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
@@ -67,7 +100,25 @@ class FqQueueDisc : public QueueDisc
 
     FqFlow* Classify(Ptr<QueueDiscItem> item);
     void CheckThrottled();
-    void GarbageCollection(FlowTree_t &root, uintptr_t sock);
+    void Throttle(FqFlow* flow);
+    void GarbageCollection(uintptr_t sk);
+
+    /**
+     * \brief Look a flow up in the flow table
+     * \param sk the flow key
+     * \return the index of the slot holding the flow or of the empty slot ending the probe
+     */
+    uint32_t FindSlot(uintptr_t sk) const;
+    /**
+     * \brief Remove the flow stored in a slot, shifting back the following entries
+     * \param i the slot index
+     */
+    void EraseSlot(uint32_t i);
+    /**
+     * \brief Rebuild the flow table with the given number of slots (a power of 2)
+     * \param capacity the new number of slots
+     */
+    void Rehash(uint32_t capacity);
 
     /* arguments */
     uint32_t m_quantum;
@@ -82,13 +133,15 @@ class FqQueueDisc : public QueueDisc
 
     std::deque<FqFlow*> m_newFlows;
     std::deque<FqFlow*> m_oldFlows;
-    std::multimap<Time, FqFlow*> m_delayedFlows;
+    std::vector<ThrottledFlow> m_delayedFlows; //!< min-heap of the throttled flows
+    uint64_t m_throttleSeq{0};                 //!< sequence number of the next throttled flow
     Time m_timeNextDelayedFlow{Time::Max()};
     Time m_unthrottleLatency{0};
     int m_flows{0};
     int m_inactiveFlows{0};
     int m_throttledFlows{0};
-    std::array<FlowTree_t, 1024> m_fqRoot;
+    std::vector<FlowSlot> m_flowTable; //!< open-addressing flow table, keyed by socket
+    uint32_t m_gcCursor{0};            //!< next slot visited by the garbage collector
 
     EventId m_sheduleEvent;
 };
@@ -33,6 +33,9 @@ NS_LOG_COMPONENT_DEFINE("PfifoFastQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(PfifoFastQueueDisc);
 
+const uint32_t PfifoFastQueueDisc::LIMIT_EXCEEDED_DROP_ID =
+    QueueDisc::RegisterReason(LIMIT_EXCEEDED_DROP);
+
 TypeId
 PfifoFastQueueDisc::GetTypeId()
 {
@@ -70,7 +73,7 @@ PfifoFastQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     if (GetCurrentSize() >= GetMaxSize())
     {
         NS_LOG_LOGIC("Queue disc limit exceeded -- dropping packet");
-        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP_ID);
         return false;
     }
 
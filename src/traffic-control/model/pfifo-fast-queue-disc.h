@@ -66,6 +66,8 @@ class PfifoFastQueueDisc : public QueueDisc
     // Reasons for dropping packets
     static constexpr const char* LIMIT_EXCEEDED_DROP =
         "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t LIMIT_EXCEEDED_DROP_ID; //!< ID of LIMIT_EXCEEDED_DROP
 
   private:
     /**
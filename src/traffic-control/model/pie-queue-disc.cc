@@ -34,6 +34,9 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace ns3
 {
 
@@ -41,6 +44,12 @@ NS_LOG_COMPONENT_DEFINE("PieQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(PieQueueDisc);
 
+const uint32_t PieQueueDisc::UNFORCED_DROP_ID = QueueDisc::RegisterReason(UNFORCED_DROP);
+const uint32_t PieQueueDisc::FORCED_DROP_ID = QueueDisc::RegisterReason(FORCED_DROP);
+const uint32_t PieQueueDisc::UNFORCED_MARK_ID = QueueDisc::RegisterReason(UNFORCED_MARK);
+const uint32_t PieQueueDisc::CE_THRESHOLD_EXCEEDED_MARK_ID =
+    QueueDisc::RegisterReason(CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId
 PieQueueDisc::GetTypeId()
 {
@@ -133,6 +142,11 @@ PieQueueDisc::GetTypeId()
                           "True to use L4S (only ECT1 packets are marked at CE threshold)",
                           BooleanValue(false),
                           MakeBooleanAccessor(&PieQueueDisc::m_useL4s),
+                          MakeBooleanChecker())
+            .AddAttribute("UseFixedPoint",
+                          "True to update the drop probability in the integer domain",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PieQueueDisc::m_useFixedPoint),
                           MakeBooleanChecker());
 
     return tid;
@@ -203,7 +217,7 @@ PieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     if (nQueued + item > GetMaxSize())
     {
         // Drops due to queue limit: reactive
-        DropBeforeEnqueue(item, FORCED_DROP);
+        DropBeforeEnqueue(item, FORCED_DROP_ID);
         m_accuProb = 0;
         return false;
     }
@@ -212,10 +226,10 @@ PieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     else if ((m_activeThreshold == Time::Max() || m_active) && !isEct1 &&
              DropEarly(item, nQueued.GetValue()))
     {
-        if (!m_useEcn || m_dropProb >= m_markEcnTh || !Mark(item, UNFORCED_MARK))
+        if (!m_useEcn || m_dropProb >= m_markEcnTh || !Mark(item, UNFORCED_MARK_ID))
         {
             // Early probability drop: proactive
-            DropBeforeEnqueue(item, UNFORCED_DROP);
+            DropBeforeEnqueue(item, UNFORCED_DROP_ID);
             m_accuProb = 0;
             return false;
         }
@@ -269,6 +283,71 @@ PieQueueDisc::InitializeParams()
     m_qDelayOld = Seconds(0);
     m_accuProb = 0.0;
     m_active = false;
+    m_aFixed = FixedPointGain(m_a);
+    m_bFixed = FixedPointGain(m_b);
+}
+
+int64_t
+PieQueueDisc::FixedPointGain(double gain)
+{
+    return std::llround(std::ldexp(gain, 52) / 1e9);
+}
+
+int64_t
+PieQueueDisc::FixedPointDropProb(int64_t dropProb,
+                                 int64_t qDelay,
+                                 int64_t qDelayOld,
+                                 int64_t qDelayRef,
+                                 int64_t a,
+                                 int64_t b,
+                                 bool capDropAdjustment)
+{
+    // bound the delay differences (to 100 s) so that the products cannot overflow
+    const int64_t maxDiff = 100000000000;
+    int64_t p = a * std::clamp(qDelay - qDelayRef, -maxDiff, maxDiff) +
+                b * std::clamp(qDelay - qDelayOld, -maxDiff, maxDiff);
+
+    if (dropProb < FIXED_POINT_ONE / 1000000)
+    {
+        p /= 2048;
+    }
+    else if (dropProb < FIXED_POINT_ONE / 100000)
+    {
+        p /= 512;
+    }
+    else if (dropProb < FIXED_POINT_ONE / 10000)
+    {
+        p /= 128;
+    }
+    else if (dropProb < FIXED_POINT_ONE / 1000)
+    {
+        p /= 32;
+    }
+    else if (dropProb < FIXED_POINT_ONE / 100)
+    {
+        p /= 8;
+    }
+    else if (dropProb < FIXED_POINT_ONE / 10)
+    {
+        p /= 2;
+    }
+
+    // Cap Drop Adjustment (Section 5.5 of RFC 8033)
+    if (capDropAdjustment && dropProb >= FIXED_POINT_ONE / 10 && p > FIXED_POINT_ONE / 50)
+    {
+        p = FIXED_POINT_ONE / 50;
+    }
+
+    p += dropProb;
+
+    // Decay the drop probability exponentially (p *= 0.98, Section 4.2 of RFC 8033)
+    if (qDelay == 0 && qDelayOld == 0)
+    {
+        p -= p / 50;
+    }
+
+    // bound the drop probability (Section 4.2 of RFC 8033)
+    return std::clamp<int64_t>(p, 0, FIXED_POINT_ONE);
 }
 
 bool
@@ -358,7 +437,25 @@ PieQueueDisc::CalculateP()
     }
     NS_LOG_DEBUG("Queue delay while calculating probability: " << qDelay.GetMilliSeconds() << "ms");
 
-    if (m_burstAllowance.GetSeconds() > 0)
+    if (m_useFixedPoint)
+    {
+        // the drop probability is a multiple of 1 / FIXED_POINT_ONE, hence the
+        // conversions to and from the integer domain are exact
+        int64_t dropProb = 0;
+        if (!m_burstAllowance.IsStrictlyPositive())
+        {
+            dropProb = FixedPointDropProb(
+                static_cast<int64_t>(std::ldexp(m_dropProb, 52)),
+                qDelay.GetNanoSeconds(),
+                m_qDelayOld.GetNanoSeconds(),
+                m_qDelayRef.GetNanoSeconds(),
+                m_aFixed,
+                m_bFixed,
+                m_isCapDropAdjustment);
+        }
+        p = std::ldexp(static_cast<double>(dropProb), -52);
+    }
+    else if (m_burstAllowance.GetSeconds() > 0)
     {
         m_dropProb = 0;
     }
@@ -404,13 +501,16 @@ PieQueueDisc::CalculateP()
         }
     }
 
-    p += m_dropProb;
-
-    // For non-linear drop in prob
-    // Decay the drop probability exponentially (Section 4.2 of RFC 8033)
-    if (qDelay.GetSeconds() == 0 && m_qDelayOld.GetSeconds() == 0)
+    if (!m_useFixedPoint)
     {
-        p *= 0.98;
+        p += m_dropProb;
+
+        // For non-linear drop in prob
+        // Decay the drop probability exponentially (Section 4.2 of RFC 8033)
+        if (qDelay.GetSeconds() == 0 && m_qDelayOld.GetSeconds() == 0)
+        {
+            p *= 0.98;
+        }
     }
 
     // bound the drop probability (Section 4.2 of RFC 8033)
@@ -505,7 +605,7 @@ PieQueueDisc::DoDequeue()
                 NS_LOG_DEBUG("CE packet " << static_cast<uint16_t>(tosByte & 0x3));
             }
             if ((Now() - item->GetTimeStamp() > m_ceThreshold) &&
-                Mark(item, CE_THRESHOLD_EXCEEDED_MARK))
+                Mark(item, CE_THRESHOLD_EXCEEDED_MARK_ID))
             {
                 NS_LOG_LOGIC("Marking due to CeThreshold " << m_ceThreshold.GetSeconds());
             }
@@ -96,6 +96,43 @@ class PieQueueDisc : public QueueDisc
      */
     int64_t AssignStreams(int64_t stream);
 
+    /// Drop probability equal to 1 in the integer domain
+    static constexpr int64_t FIXED_POINT_ONE = int64_t(1) << 52;
+
+    /**
+     * \brief Convert a gain of the PIE controller to the integer domain
+     * \param gain the gain (alpha or beta), in Hz
+     * \return the drop probability increment (in units of 1 / FIXED_POINT_ONE) per ns of delay
+     */
+    static int64_t FixedPointGain(double gain);
+
+    /**
+     * \brief Update the drop probability in the integer domain
+     *
+     * Fixed-point counterpart of the update of the drop probability performed
+     * by the PIE controller (Section 4.2 of RFC 8033) when no burst allowance
+     * is left, including the non-linear scaling, the cap drop adjustment, the
+     * exponential decay and the bounding of the result. Delays are integers (ns)
+     * and probabilities are multiples of 1 / FIXED_POINT_ONE, hence the update
+     * does not depend on the floating-point unit of the host.
+     *
+     * \param dropProb the current drop probability (units of 1 / FIXED_POINT_ONE)
+     * \param qDelay the current queue delay (ns)
+     * \param qDelayOld the previous queue delay (ns)
+     * \param qDelayRef the desired queue delay (ns)
+     * \param a the alpha gain returned by FixedPointGain
+     * \param b the beta gain returned by FixedPointGain
+     * \param capDropAdjustment whether to apply the cap drop adjustment
+     * \return the new drop probability (units of 1 / FIXED_POINT_ONE)
+     */
+    static int64_t FixedPointDropProb(int64_t dropProb,
+                                      int64_t qDelay,
+                                      int64_t qDelayOld,
+                                      int64_t qDelayRef,
+                                      int64_t a,
+                                      int64_t b,
+                                      bool capDropAdjustment);
+
     // Reasons for dropping packets
     static constexpr const char* UNFORCED_DROP =
         "Unforced drop"; //!< Early probability drops: proactive
@@ -105,6 +142,11 @@ class PieQueueDisc : public QueueDisc
         "Unforced mark"; //!< Early probability marks: proactive
     static constexpr const char* CE_THRESHOLD_EXCEEDED_MARK =
         "CE threshold exceeded mark"; //!< Early probability marks: proactive
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t UNFORCED_DROP_ID;              //!< ID of UNFORCED_DROP
+    static const uint32_t FORCED_DROP_ID;                //!< ID of FORCED_DROP
+    static const uint32_t UNFORCED_MARK_ID;              //!< ID of UNFORCED_MARK
+    static const uint32_t CE_THRESHOLD_EXCEEDED_MARK_ID; //!< ID of CE_THRESHOLD_EXCEEDED_MARK
 
   protected:
     /**
@@ -160,8 +202,11 @@ class PieQueueDisc : public QueueDisc
     Time m_activeThreshold;    //!< Threshold for activating PIE (disabled by default)
     Time m_ceThreshold;        //!< Threshold above which to CE mark
     bool m_useL4s;             //!< True if L4S is used (ECT1 packets are marked at CE threshold)
+    bool m_useFixedPoint;      //!< True to update the drop probability in the integer domain
 
     // ** Variables maintained by PIE
+    int64_t m_aFixed;         //!< Alpha in the integer domain
+    int64_t m_bFixed;         //!< Beta in the integer domain
     double m_dropProb;        //!< Variable used in calculation of drop probability
     Time m_qDelayOld;         //!< Old value of queue delay
     Time m_qDelay;            //!< Current value of queue delay
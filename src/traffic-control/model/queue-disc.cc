@@ -18,12 +18,15 @@
 
 #include "queue-disc.h"
 
+#include "shared-buffer-pool.h"
+
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-limits.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
 #include "ns3/socket.h"
@@ -31,6 +34,9 @@
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/tcp-socket-base.h"
 
+#include <deque>
+#include <unordered_map>
+
 namespace ns3
 {
 
@@ -247,6 +253,83 @@ operator<<(std::ostream& os, const QueueDisc::Stats& stats)
 
 NS_OBJECT_ENSURE_REGISTERED(QueueDisc);
 
+/// The reasons to drop or mark packets registered by queue discs
+struct QueueDiscReasonRegistry
+{
+    std::deque<std::string> names;                 //!< The reasons, indexed by ID
+    std::unordered_map<std::string, uint32_t> ids; //!< The IDs, indexed by reason
+};
+
+/**
+ * \return the registry of the reasons to drop or mark packets
+ */
+static QueueDiscReasonRegistry&
+GetReasonRegistry()
+{
+    static QueueDiscReasonRegistry registry;
+    return registry;
+}
+
+uint32_t
+QueueDisc::RegisterReason(const std::string& reason)
+{
+    QueueDiscReasonRegistry& registry = GetReasonRegistry();
+    auto [it, inserted] = registry.ids.emplace(reason, registry.names.size());
+    if (inserted)
+    {
+        registry.names.push_back(reason);
+    }
+    return it->second;
+}
+
+const std::string&
+QueueDisc::GetReasonName(uint32_t id)
+{
+    QueueDiscReasonRegistry& registry = GetReasonRegistry();
+    NS_ASSERT_MSG(id < registry.names.size(), "Unknown reason ID " << id);
+    return registry.names[id];
+}
+
+const uint32_t QueueDisc::INTERNAL_QUEUE_DROP_ID = QueueDisc::RegisterReason(INTERNAL_QUEUE_DROP);
+const uint32_t QueueDisc::SHARED_BUFFER_DROP_ID = QueueDisc::RegisterReason(SHARED_BUFFER_DROP);
+
+uint32_t
+QueueDisc::GetReasonId(ReasonIdCache& cache, const char* prefix, const char* reason)
+{
+    auto it = cache.find(std::string_view(reason));
+    if (it == cache.end())
+    {
+        it = cache.emplace(reason, RegisterReason(std::string(prefix).append(reason))).first;
+    }
+    return it->second;
+}
+
+void
+QueueDisc::CountReason(std::vector<ReasonCounters>& counters, uint32_t id, uint32_t size)
+{
+    if (id >= counters.size())
+    {
+        counters.resize(id + 1);
+    }
+    counters[id].packets++;
+    counters[id].bytes += size;
+}
+
+void
+QueueDisc::FillReasonMaps(const std::vector<ReasonCounters>& counters,
+                          std::map<std::string, uint32_t, std::less<>>& packets,
+                          std::map<std::string, uint64_t, std::less<>>& bytes)
+{
+    for (uint32_t id = 0; id < counters.size(); id++)
+    {
+        if (counters[id].packets > 0)
+        {
+            packets[GetReasonName(id)] = counters[id].packets;
+            bytes[GetReasonName(id)] = counters[id].bytes;
+        }
+    }
+}
+
 TypeId
 QueueDisc::GetTypeId()
 {
@@ -321,6 +404,7 @@ QueueDisc::QueueDisc(QueueDiscSizePolicy policy)
     : m_nPackets(0),
       m_nBytes(0),
       m_maxSize(QueueSize("1p")), // to avoid that setting the mode at construction time is ignored
+      m_bufferPort(0),
       m_running(false),
       m_peeked(false),
       m_sizePolicy(policy),
@@ -334,10 +418,10 @@ QueueDisc::QueueDisc(QueueDiscSizePolicy policy)
     // internal queues, the INTERNAL_QUEUE_DROP constant is passed as the reason
     // why the packet is dropped.
     m_internalQueueDbeFunctor = [this](Ptr<const QueueDiscItem> item) {
-        return DropBeforeEnqueue(item, INTERNAL_QUEUE_DROP);
+        return DropBeforeEnqueue(item, INTERNAL_QUEUE_DROP_ID);
     };
     m_internalQueueDadFunctor = [this](Ptr<const QueueDiscItem> item) {
-        return DropAfterDequeue(item, INTERNAL_QUEUE_DROP);
+        return DropAfterDequeue(item, INTERNAL_QUEUE_DROP_ID);
     };
 
     // These lambdas call the DropBeforeEnqueue or DropAfterDequeue methods of this
@@ -347,18 +431,18 @@ QueueDisc::QueueDisc(QueueDiscSizePolicy policy)
     // and the second argument provided by such traces is passed as the reason why
     // the packet is dropped.
     m_childQueueDiscDbeFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
-        return DropBeforeEnqueue(
-            item,
-            m_childQueueDiscDropMsg.assign(CHILD_QUEUE_DISC_DROP).append(r).data());
+        uint32_t id = GetReasonId(m_childDropReasonIds, CHILD_QUEUE_DISC_DROP, r);
+        return DoDropBeforeEnqueue(item, id, GetReasonName(id).c_str());
     };
     m_childQueueDiscDadFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
-        return DropAfterDequeue(
-            item,
-            m_childQueueDiscDropMsg.assign(CHILD_QUEUE_DISC_DROP).append(r).data());
+        uint32_t id = GetReasonId(m_childDropReasonIds, CHILD_QUEUE_DISC_DROP, r);
+        return DoDropAfterDequeue(item, id, GetReasonName(id).c_str());
     };
     m_childQueueDiscMarkFunctor = [this](Ptr<const QueueDiscItem> item, const char* r) {
-        return Mark(const_cast<QueueDiscItem*>(PeekPointer(item)),
-                    m_childQueueDiscMarkMsg.assign(CHILD_QUEUE_DISC_MARK).append(r).data());
+        uint32_t id = GetReasonId(m_childMarkReasonIds, CHILD_QUEUE_DISC_MARK, r);
+        return DoMark(const_cast<QueueDiscItem*>(PeekPointer(item)),
+                      id,
+                      GetReasonName(id).c_str());
     };
 }
 
@@ -383,7 +467,12 @@ QueueDisc::DoDispose()
     m_classes.clear();
     m_devQueueIface = nullptr;
     m_send = nullptr;
-    m_requeued = nullptr;
+    m_sendBatch = nullptr;
+    m_batch.clear();
+    m_batchSent.clear();
+    m_batchSockets.clear();
+    m_bufferPool = nullptr;
+    m_requeued.clear();
     m_internalQueueDbeFunctor = nullptr;
     m_internalQueueDadFunctor = nullptr;
     m_childQueueDiscDbeFunctor = nullptr;
@@ -421,11 +510,25 @@ QueueDisc::GetStats()
     // the total number of sent packets is only updated here to avoid to increase it
     // after a dequeue and then having to decrease it if the packet is dropped after
     // dequeue or requeued
-    m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0) -
+    uint64_t requeuedBytes = 0;
+    for (const auto& item : m_requeued)
+    {
+        requeuedBytes += item->GetSize();
+    }
+    m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - m_requeued.size() -
                                 m_stats.nTotalDroppedPacketsAfterDequeue;
-    m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes -
-                              (m_requeued ? m_requeued->GetSize() : 0) -
-                              m_stats.nTotalDroppedBytesAfterDequeue;
+    m_stats.nTotalSentBytes =
+        m_stats.nTotalDequeuedBytes - requeuedBytes - m_stats.nTotalDroppedBytesAfterDequeue;
+
+    // the per-reason statistics are kept in flat arrays indexed by reason ID and
+    // only converted to maps keyed by the reason string here
+    FillReasonMaps(m_droppedBeforeEnqueue,
+                   m_stats.nDroppedPacketsBeforeEnqueue,
+                   m_stats.nDroppedBytesBeforeEnqueue);
+    FillReasonMaps(m_droppedAfterDequeue,
+                   m_stats.nDroppedPacketsAfterDequeue,
+                   m_stats.nDroppedBytesAfterDequeue);
+    FillReasonMaps(m_marked, m_stats.nMarkedPackets, m_stats.nMarkedBytes);
 
     return m_stats;
 }
@@ -557,6 +660,28 @@ QueueDisc::GetSendCallback() const
     return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback(SendBatchCallback func)
+{
+    NS_LOG_FUNCTION(this);
+    m_sendBatch = func;
+}
+
+void
+QueueDisc::SetSharedBufferPool(Ptr<SharedBufferPool> pool)
+{
+    NS_LOG_FUNCTION(this << pool);
+    NS_ABORT_MSG_IF(m_bufferPool, "The queue disc is already attached to a shared buffer pool");
+    m_bufferPool = pool;
+    m_bufferPort = pool->AddPort();
+}
+
+Ptr<SharedBufferPool>
+QueueDisc::GetSharedBufferPool() const
+{
+    return m_bufferPool;
+}
+
 void
 QueueDisc::SetQuota(const uint32_t quota)
 {
@@ -684,11 +809,45 @@ QueueDisc::GetWakeMode() const
     return WAKE_ROOT;
 }
 
+/**
+ * \param item the item
+ * \return the priority of the item in a shared buffer pool
+ */
+static uint8_t
+GetBufferPriority(Ptr<const QueueDiscItem> item)
+{
+    SocketPriorityTag priorityTag;
+    if (item->GetPacket()->PeekPacketTag(priorityTag))
+    {
+        return priorityTag.GetPriority() % SharedBufferPool::N_PRIORITIES;
+    }
+    return 0;
+}
+
 void
 QueueDisc::PacketEnqueued(Ptr<const QueueDiscItem> item)
 {
+    // Stamp the packet as soon as it is stored, so that it is accounted for
+    // before the queue disc may drop it (e.g., to make room for it). Parent
+    // queue discs are notified after their children, hence only the innermost
+    // queue disc accounts for the packet in the socket that sent it.
+    bool isFresh = item->GetTimeStamp().IsZero();
+    const_cast<QueueDiscItem*>(PeekPointer(item))->SetTimeStamp(Simulator::Now());
+    if (isFresh)
+    {
+        auto tcpSock = dynamic_cast<TcpSocketBase*>(item->GetPacket()->GetSocket());
+        if (tcpSock != nullptr)
+        {
+            tcpSock->TxEnqueued(item->GetSize());
+        }
+    }
+
     m_nPackets++;
     m_nBytes += item->GetSize();
+    if (m_bufferPool)
+    {
+        m_bufferPool->Allocate(m_bufferPort, GetBufferPriority(item), item->GetSize());
+    }
     m_stats.nTotalEnqueuedPackets++;
     m_stats.nTotalEnqueuedBytes += item->GetSize();
 
@@ -708,6 +867,10 @@ QueueDisc::PacketDequeued(Ptr<const QueueDiscItem> item)
     {
         m_nPackets--;
         m_nBytes -= item->GetSize();
+        if (m_bufferPool)
+        {
+            m_bufferPool->Release(m_bufferPort, GetBufferPriority(item), item->GetSize());
+        }
         m_stats.nTotalDequeuedPackets++;
         m_stats.nTotalDequeuedBytes += item->GetSize();
 
@@ -721,33 +884,27 @@ QueueDisc::PacketDequeued(Ptr<const QueueDiscItem> item)
 void
 QueueDisc::DropBeforeEnqueue(Ptr<const QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    DoDropBeforeEnqueue(item, GetReasonId(m_reasonIds, "", reason), reason);
+}
+
+void
+QueueDisc::DropBeforeEnqueue(Ptr<const QueueDiscItem> item, uint32_t reasonId)
+{
+    DoDropBeforeEnqueue(item, reasonId, GetReasonName(reasonId).c_str());
+}
+
+void
+QueueDisc::DoDropBeforeEnqueue(Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+    NS_LOG_FUNCTION(this << item << id << reason);
 
     m_stats.nTotalDroppedPackets++;
     m_stats.nTotalDroppedBytes += item->GetSize();
     m_stats.nTotalDroppedPacketsBeforeEnqueue++;
     m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize();
 
-    // update the number of packets dropped for the given reason
-    auto itp = m_stats.nDroppedPacketsBeforeEnqueue.find(reason);
-    if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-    // update the amount of bytes dropped for the given reason
-    auto itb = m_stats.nDroppedBytesBeforeEnqueue.find(reason);
-    if (itb != m_stats.nDroppedBytesBeforeEnqueue.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes dropped for the given reason
+    CountReason(m_droppedBeforeEnqueue, id, item->GetSize());
 
     if (auto tcpSock = dynamic_cast<TcpSocketBase*>(item->GetPacket()->GetSocket()); tcpSock != nullptr) {
         tcpSock->TxDropped();
@@ -764,33 +921,27 @@ QueueDisc::DropBeforeEnqueue(Ptr<const QueueDiscItem> item, const char* reason)
 void
 QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    DoDropAfterDequeue(item, GetReasonId(m_reasonIds, "", reason), reason);
+}
+
+void
+QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, uint32_t reasonId)
+{
+    DoDropAfterDequeue(item, reasonId, GetReasonName(reasonId).c_str());
+}
+
+void
+QueueDisc::DoDropAfterDequeue(Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+    NS_LOG_FUNCTION(this << item << id << reason);
 
     m_stats.nTotalDroppedPackets++;
     m_stats.nTotalDroppedBytes += item->GetSize();
     m_stats.nTotalDroppedPacketsAfterDequeue++;
     m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize();
 
-    // update the number of packets dropped for the given reason
-    auto itp = m_stats.nDroppedPacketsAfterDequeue.find(reason);
-    if (itp != m_stats.nDroppedPacketsAfterDequeue.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-    // update the amount of bytes dropped for the given reason
-    auto itb = m_stats.nDroppedBytesAfterDequeue.find(reason);
-    if (itb != m_stats.nDroppedBytesAfterDequeue.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes dropped for the given reason
+    CountReason(m_droppedAfterDequeue, id, item->GetSize());
 
     // if in the context of a peek request a dequeued packet is dropped, we need
     // to update the statistics and fire the dequeue trace before firing the drop
@@ -818,7 +969,19 @@ QueueDisc::DropAfterDequeue(Ptr<const QueueDiscItem> item, const char* reason)
 bool
 QueueDisc::Mark(Ptr<QueueDiscItem> item, const char* reason)
 {
-    NS_LOG_FUNCTION(this << item << reason);
+    return DoMark(item, GetReasonId(m_reasonIds, "", reason), reason);
+}
+
+bool
+QueueDisc::Mark(Ptr<QueueDiscItem> item, uint32_t reasonId)
+{
+    return DoMark(item, reasonId, GetReasonName(reasonId).c_str());
+}
+
+bool
+QueueDisc::DoMark(Ptr<QueueDiscItem> item, uint32_t id, const char* reason)
+{
+    NS_LOG_FUNCTION(this << item << id << reason);
 
     bool retval = item->Mark();
 
@@ -830,26 +993,8 @@ QueueDisc::Mark(Ptr<QueueDiscItem> item, const char* reason)
     m_stats.nTotalMarkedPackets++;
     m_stats.nTotalMarkedBytes += item->GetSize();
 
-    // update the number of packets marked for the given reason
-    auto itp = m_stats.nMarkedPackets.find(reason);
-    if (itp != m_stats.nMarkedPackets.end())
-    {
-        itp->second++;
-    }
-    else
-    {
-        m_stats.nMarkedPackets[reason] = 1;
-    }
-    // update the amount of bytes marked for the given reason
-    auto itb = m_stats.nMarkedBytes.find(reason);
-    if (itb != m_stats.nMarkedBytes.end())
-    {
-        itb->second += item->GetSize();
-    }
-    else
-    {
-        m_stats.nMarkedBytes[reason] = item->GetSize();
-    }
+    // update the number of packets and bytes marked for the given reason
+    CountReason(m_marked, id, item->GetSize());
 
     NS_LOG_DEBUG("Total packets/bytes marked: " << m_stats.nTotalMarkedPackets << " / "
                                                 << m_stats.nTotalMarkedBytes);
@@ -865,20 +1010,17 @@ QueueDisc::Enqueue(Ptr<QueueDiscItem> item)
     m_stats.nTotalReceivedPackets++;
     m_stats.nTotalReceivedBytes += item->GetSize();
 
-    bool retval = DoEnqueue(item);
-
-    if (retval)
+    // the admission check of the shared buffer pool takes constant time,
+    // regardless of the number of ports drawing from the pool
+    if (m_bufferPool &&
+        !m_bufferPool->CheckAdmission(m_bufferPort, GetBufferPriority(item), item->GetSize()))
     {
-        bool isFresh = item->GetTimeStamp().IsZero();
-        item->SetTimeStamp(Simulator::Now());
-        if (isFresh) {
-            auto tcpSock = dynamic_cast<TcpSocketBase*>(item->GetPacket()->GetSocket());
-            if (tcpSock != nullptr) {
-                tcpSock->TxEnqueued(item->GetSize());
-            }
-        }
+        DropBeforeEnqueue(item, SHARED_BUFFER_DROP_ID);
+        return false;
     }
 
+    bool retval = DoEnqueue(item);
+
     // DoEnqueue may return false because:
     // 1) the internal queue is full
     //    -> the DropBeforeEnqueue method of this queue disc is automatically called
@@ -907,16 +1049,17 @@ QueueDisc::Dequeue()
     // The QueueDisc::DoPeek method dequeues a packet and keeps it as a requeued
     // packet. Thus, first check whether a peeked packet exists. Otherwise, call
     // the private DoDequeue method.
-    Ptr<QueueDiscItem> item = m_requeued;
+    Ptr<QueueDiscItem> item;
 
-    if (item)
+    if (!m_requeued.empty())
     {
-        m_requeued = nullptr;
+        item = m_requeued.front();
+        m_requeued.pop_front();
         if (m_peeked)
         {
             // If the packet was requeued because a peek operation was requested
             // (which is the case here because DequeuePacket calls Dequeue only
-            // when m_requeued is null), we need to explicitly call PacketDequeued
+            // when m_requeued is empty), we need to explicitly call PacketDequeued
             // to update statistics about dequeued packets and fire the dequeue trace.
             m_peeked = false;
             PacketDequeued(item);
@@ -945,17 +1088,19 @@ QueueDisc::DoPeek()
 {
     NS_LOG_FUNCTION(this);
 
-    if (!m_requeued)
+    if (m_requeued.empty())
     {
         m_peeked = true;
-        m_requeued = Dequeue();
+        Ptr<QueueDiscItem> item = Dequeue();
         // if no packet is returned, reset the m_peeked flag
-        if (!m_requeued)
+        if (!item)
         {
             m_peeked = false;
+            return nullptr;
         }
+        m_requeued.push_back(item);
     }
-    return m_requeued;
+    return m_requeued.front();
 }
 
 void
@@ -966,19 +1111,35 @@ QueueDisc::Run()
     if (RunBegin())
     {
         uint32_t quota = m_quota;
-        while (Restart())
+        if (CanSendBatch())
+        {
+            while (quota > 0 && RestartBatch(quota))
+            {
+            }
+        }
+        else
         {
-            quota -= 1;
-            if (quota <= 0)
+            while (Restart())
             {
-                /// \todo netif_schedule (q);
-                break;
+                quota -= 1;
+                if (quota <= 0)
+                {
+                    /// \todo netif_schedule (q);
+                    break;
+                }
             }
         }
         RunEnd();
     }
 }
 
+bool
+QueueDisc::CanSendBatch() const
+{
+    return m_sendBatch && m_devQueueIface && m_devQueueIface->GetNTxQueues() == 1 &&
+           m_devQueueIface->GetTxQueue(0)->GetQueueLimits();
+}
+
 bool
 QueueDisc::RunBegin()
 {
@@ -1013,6 +1174,109 @@ QueueDisc::Restart()
     return Transmit(item);
 }
 
+bool
+QueueDisc::RestartBatch(uint32_t& quota)
+{
+    NS_LOG_FUNCTION(this << quota);
+
+    Ptr<QueueDiscItem> item = DequeuePacket();
+    if (!item)
+    {
+        NS_LOG_LOGIC("No packet to send");
+        return false;
+    }
+
+    // the first packet is sent as long as the device queue is not stopped, which
+    // implies that the queue limits have room for at least one byte and the device
+    // queue has room for at least one packet. Further packets are added to the batch
+    // as long as neither the queue limits nor the device queue would have stopped
+    // the transmission queue before their transmission if they were sent one at a time
+    Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue(0);
+    int64_t available = txq->GetQueueLimits()->Available();
+    m_batch.clear();
+    m_batch.push_back(item);
+    // the packets requeued by a previous batch come first and have their header already
+    std::size_t requeued = m_requeued.size();
+    uint64_t bytes = item->GetSize();
+    while (m_batch.size() < quota && static_cast<int64_t>(bytes) <= available &&
+           !txq->WouldStop(m_batch.size(), bytes))
+    {
+        Ptr<QueueDiscItem> next = Dequeue();
+        if (!next)
+        {
+            break;
+        }
+        if (m_batch.size() > requeued)
+        {
+            next->AddHeader();
+        }
+        bytes += next->GetSize();
+        m_batch.push_back(next);
+    }
+    NS_LOG_LOGIC("Sending a batch of " << m_batch.size() << " packets");
+
+    // a single queue device makes no use of the priority tag
+    for (auto& batchItem : m_batch)
+    {
+        SocketPriorityTag priorityTag;
+        batchItem->GetPacket()->RemovePacketTag(priorityTag);
+        m_batchSockets.emplace_back(
+            dynamic_cast<TcpSocketBase*>(batchItem->GetPacket()->TakeSocketInfo()),
+            batchItem->GetSize());
+    }
+
+    uint32_t consumed = m_sendBatch(m_batch, m_batchSent);
+    NS_ASSERT(consumed <= m_batch.size() && m_batchSent.size() == consumed);
+    quota -= std::min(quota, consumed);
+
+    // the packets the device did not consume, because its transmission queue has been
+    // stopped, are requeued, as Linux does with the rest of a bulk dequeue
+    bool allConsumed = (consumed == m_batch.size());
+    for (uint32_t i = m_batch.size(); i-- > consumed;)
+    {
+        m_batch[i]->GetPacket()->SetSocket(m_batchSockets[i].first);
+        Requeue(m_batch[i]);
+    }
+    m_batch.clear();
+
+    // the packets dropped by the device leave the queue disc as well, but are lost
+    for (uint32_t i = 0; i < consumed; i++)
+    {
+        if (auto [tcpSock, pktSize] = m_batchSockets[i]; tcpSock != nullptr)
+        {
+            tcpSock->TxComplete(pktSize);
+            if (!m_batchSent[i])
+            {
+                tcpSock->TxDropped();
+            }
+        }
+    }
+    m_batchSockets.clear();
+
+    return allConsumed && !(GetNPackets() == 0 || txq->IsStopped());
+}
+
+uint32_t
+QueueDisc::DequeueBatch(uint32_t n, std::vector<Ptr<QueueDiscItem>>& batch, uint32_t bytes)
+{
+    NS_LOG_FUNCTION(this << n << bytes);
+
+    uint32_t count = 0;
+    uint64_t dequeuedBytes = 0;
+    while (count < n && dequeuedBytes <= bytes)
+    {
+        Ptr<QueueDiscItem> item = Dequeue();
+        if (!item)
+        {
+            break;
+        }
+        dequeuedBytes += item->GetSize();
+        batch.push_back(item);
+        count++;
+    }
+    return count;
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket()
 {
@@ -1021,16 +1285,16 @@ QueueDisc::DequeuePacket()
     Ptr<QueueDiscItem> item;
 
     // First check if there is a requeued packet
-    if (m_requeued)
+    if (!m_requeued.empty())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
         if (!m_devQueueIface ||
-            !m_devQueueIface->GetTxQueue(m_requeued->GetTxQueueIndex())->IsStopped())
+            !m_devQueueIface->IsTxQueueStopped(m_requeued.front()->GetTxQueueIndex()))
         {
-            item = m_requeued;
-            m_requeued = nullptr;
+            item = m_requeued.front();
+            m_requeued.pop_front();
             if (m_peeked)
             {
                 // If the packet was requeued because a peek operation was requested
@@ -1049,7 +1313,7 @@ QueueDisc::DequeuePacket()
         // Otherwise, ask the queue disc to dequeue a packet only if the (unique) queue
         // is not stopped.
         if (!m_devQueueIface || m_devQueueIface->GetNTxQueues() > 1 ||
-            !m_devQueueIface->GetTxQueue(0)->IsStopped())
+            !m_devQueueIface->IsTxQueueStopped(0))
         {
             item = Dequeue();
             // If the item is not null, add the header to the packet.
@@ -1067,7 +1331,8 @@ void
 QueueDisc::Requeue(Ptr<QueueDiscItem> item)
 {
     NS_LOG_FUNCTION(this << item);
-    m_requeued = item;
+    // the packets requeued together are requeued in reverse transmission order
+    m_requeued.push_front(item);
     /// \todo netif_schedule (q);
 
     m_stats.nTotalRequeuedPackets++;
@@ -1085,7 +1350,7 @@ QueueDisc::Transmit(Ptr<QueueDiscItem> item)
     // if the device queue is stopped, requeue the packet and return false.
     // Note that if the underlying device is tc-unaware, packets are never
     // requeued because the queues of tc-unaware devices are never stopped
-    if (m_devQueueIface && m_devQueueIface->GetTxQueue(item->GetTxQueueIndex())->IsStopped())
+    if (m_devQueueIface && m_devQueueIface->IsTxQueueStopped(item->GetTxQueueIndex()))
     {
         Requeue(item);
         return false;
@@ -1129,7 +1394,7 @@ QueueDisc::Transmit(Ptr<QueueDiscItem> item)
     // that the Run method does not attempt to dequeue other packets and exits
     return !(
         GetNPackets() == 0 ||
-        (m_devQueueIface && m_devQueueIface->GetTxQueue(item->GetTxQueueIndex())->IsStopped()));
+        (m_devQueueIface && m_devQueueIface->IsTxQueueStopped(item->GetTxQueueIndex())));
 }
 
 } // namespace ns3
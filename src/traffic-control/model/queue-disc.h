@@ -28,9 +28,13 @@
 #include "ns3/traced-callback.h"
 #include "ns3/traced-value.h"
 
+#include <deque>
 #include <functional>
+#include <limits>
 #include <map>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -38,6 +42,8 @@ namespace ns3
 
 class QueueDisc;
 class NetDeviceQueueInterface;
+class SharedBufferPool;
+class TcpSocketBase;
 
 /**
  * \ingroup traffic-control
@@ -168,7 +174,10 @@ enum QueueDiscSizePolicy
  * When a packet is dropped by an internal queue, e.g., because the queue is full,
  * the reason is "Dropped by internal queue". When a packet is dropped by a child
  * queue disc, the reason is "(Dropped by child queue disc) " followed by the
- * reason why the child queue disc dropped the packet.
+ * reason why the child queue disc dropped the packet. Reasons are registered
+ * once as small integer IDs (see RegisterReason), so that the per-reason
+ * counters can be updated without any string operation; they are converted to
+ * maps keyed by the reason string when GetStats is called.
  *
  * The QueueDisc base class provides the SojournTime trace source, which provides
  * the sojourn time of every packet dequeued from a queue disc, including packets
@@ -206,21 +215,25 @@ class QueueDisc : public Object
         uint32_t nTotalDroppedPackets;
         /// Total packets dropped before enqueue
         uint32_t nTotalDroppedPacketsBeforeEnqueue;
-        /// Packets dropped before enqueue, for each reason
+        /// Packets dropped before enqueue, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint32_t, std::less<>> nDroppedPacketsBeforeEnqueue;
         /// Total packets dropped after dequeue
         uint32_t nTotalDroppedPacketsAfterDequeue;
-        /// Packets dropped after dequeue, for each reason
+        /// Packets dropped after dequeue, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint32_t, std::less<>> nDroppedPacketsAfterDequeue;
         /// Total dropped bytes
         uint64_t nTotalDroppedBytes;
         /// Total bytes dropped before enqueue
         uint64_t nTotalDroppedBytesBeforeEnqueue;
-        /// Bytes dropped before enqueue, for each reason
+        /// Bytes dropped before enqueue, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint64_t, std::less<>> nDroppedBytesBeforeEnqueue;
         /// Total bytes dropped after dequeue
         uint64_t nTotalDroppedBytesAfterDequeue;
-        /// Bytes dropped after dequeue, for each reason
+        /// Bytes dropped after dequeue, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint64_t, std::less<>> nDroppedBytesAfterDequeue;
         /// Total requeued packets
         uint32_t nTotalRequeuedPackets;
@@ -228,11 +241,13 @@ class QueueDisc : public Object
         uint64_t nTotalRequeuedBytes;
         /// Total marked packets
         uint32_t nTotalMarkedPackets;
-        /// Marked packets, for each reason
+        /// Marked packets, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint32_t, std::less<>> nMarkedPackets;
         /// Total marked bytes
         uint32_t nTotalMarkedBytes;
-        /// Marked bytes, for each reason
+        /// Marked bytes, for each reason -- this value is not kept up to
+        /// date, call GetStats first
         std::map<std::string, uint64_t, std::less<>> nMarkedBytes;
 
         /// constructor
@@ -343,6 +358,27 @@ class QueueDisc : public Object
      */
     const Stats& GetStats();
 
+    /**
+     * \brief Register a reason to drop or mark packets
+     *
+     * Reasons are registered once for all the queue discs and then identified
+     * by a small integer ID, which per-reason statistics are indexed by. Queue
+     * discs register their reasons along with their TypeId, in static
+     * constants, and pass the IDs to DropBeforeEnqueue, DropAfterDequeue and
+     * Mark. The reasons passed as strings are registered the first time they
+     * are used.
+     *
+     * \param reason the reason
+     * \return the ID of the reason (the existing one, if already registered)
+     */
+    static uint32_t RegisterReason(const std::string& reason);
+
+    /**
+     * \param id the ID of a registered reason
+     * \return the reason
+     */
+    static const std::string& GetReasonName(uint32_t id);
+
     /**
      * \param ndqi the NetDeviceQueueInterface aggregated to the receiving object.
      *
@@ -378,6 +414,42 @@ class QueueDisc : public Object
      */
     SendCallback GetSendCallback() const;
 
+    /**
+     * Callback invoked to send a batch of packets to the receiving object when Run is
+     * called. It returns the number of packets consumed, as NetDevice::SendBatch, and
+     * fills its second argument with whether each of them was sent.
+     */
+    typedef std::function<uint32_t(const std::vector<Ptr<QueueDiscItem>>&, std::vector<bool>&)>
+        SendBatchCallback;
+
+    /**
+     * \param func the callback to send a batch of packets to the receiving object.
+     *
+     * Set the callback used by the Run method to send a batch of packets to the
+     * receiving object. Packets are sent in batches only if this callback is set,
+     * the receiving object has a single transmission queue and such queue has a
+     * queue limits object (e.g., DynamicQueueLimits), which bounds the number of
+     * bytes in a batch. Otherwise, packets are sent one at a time through the
+     * send callback. The packets of a batch not consumed by the receiving object,
+     * because its transmission queue has been stopped, are requeued.
+     */
+    void SetSendBatchCallback(SendBatchCallback func);
+
+    /**
+     * \param pool the shared buffer pool
+     *
+     * Attach this queue disc, which must be a root queue disc, to the given
+     * shared buffer pool as a new port. The packets stored in this queue disc
+     * are then accounted for by the pool, and a packet is dropped before being
+     * enqueued if the pool does not admit it.
+     */
+    void SetSharedBufferPool(Ptr<SharedBufferPool> pool);
+
+    /**
+     * \return the shared buffer pool this queue disc is attached to, if any
+     */
+    Ptr<SharedBufferPool> GetSharedBufferPool() const;
+
     /**
      * \brief Set the maximum number of dequeue operations following a packet enqueue
      * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -408,6 +480,20 @@ class QueueDisc : public Object
      */
     Ptr<QueueDiscItem> Dequeue();
 
+    /**
+     * Dequeue up to the given number of packets by calling Dequeue repeatedly,
+     * stopping as soon as the queue disc is empty or the total size of the
+     * dequeued packets exceeds the given number of bytes.
+     *
+     * \param n the maximum number of packets to dequeue
+     * \param batch the vector the dequeued items are appended to
+     * \param bytes the number of bytes after which no further packet is dequeued
+     * \return the number of dequeued packets
+     */
+    uint32_t DequeueBatch(uint32_t n,
+                          std::vector<Ptr<QueueDiscItem>>& batch,
+                          uint32_t bytes = std::numeric_limits<uint32_t>::max());
+
     /**
      * Get a copy of the next packet the queue discipline will extract. This
      * function only calls the (private) DoPeek function. This base class provides
@@ -525,6 +611,11 @@ class QueueDisc : public Object
         "(Dropped by child queue disc) "; //!< Packet dropped by a child queue disc
     static constexpr const char* CHILD_QUEUE_DISC_MARK =
         "(Marked by child queue disc) "; //!< Packet marked by a child queue disc
+    static constexpr const char* SHARED_BUFFER_DROP =
+        "Shared buffer full"; //!< Packet not admitted by the shared buffer pool
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t INTERNAL_QUEUE_DROP_ID; //!< ID of INTERNAL_QUEUE_DROP
+    static const uint32_t SHARED_BUFFER_DROP_ID;  //!< ID of SHARED_BUFFER_DROP
 
   protected:
     /**
@@ -547,31 +638,59 @@ class QueueDisc : public Object
      * \brief Perform the actions required when the queue disc is notified of
      *        a packet dropped before enqueue
      * \param item item that was dropped
-     * \param reason the reason why the item was dropped
+     * \param reason the reason why the item was dropped (a string constant)
      * This method must be called by subclasses to record that a packet was
      * dropped before enqueue for the specified reason
      */
     void DropBeforeEnqueue(Ptr<const QueueDiscItem> item, const char* reason);
 
+    /**
+     * \brief Perform the actions required when the queue disc is notified of
+     *        a packet dropped before enqueue
+     * \param item item that was dropped
+     * \param reasonId the ID of the reason why the item was dropped, as
+     *        returned by RegisterReason
+     */
+    void DropBeforeEnqueue(Ptr<const QueueDiscItem> item, uint32_t reasonId);
+
     /**
      * \brief Perform the actions required when the queue disc is notified of
      *        a packet dropped after dequeue
      * \param item item that was dropped
-     * \param reason the reason why the item was dropped
+     * \param reason the reason why the item was dropped (a string constant)
      * This method must be called by subclasses to record that a packet was
      * dropped after dequeue for the specified reason
      */
     void DropAfterDequeue(Ptr<const QueueDiscItem> item, const char* reason);
 
+    /**
+     * \brief Perform the actions required when the queue disc is notified of
+     *        a packet dropped after dequeue
+     * \param item item that was dropped
+     * \param reasonId the ID of the reason why the item was dropped, as
+     *        returned by RegisterReason
+     */
+    void DropAfterDequeue(Ptr<const QueueDiscItem> item, uint32_t reasonId);
+
     /**
      * \brief Marks the given packet and, if successful, updates the counters
      *        associated with the given reason
      * \param item item that has to be marked
-     * \param reason the reason why the item has to be marked
+     * \param reason the reason why the item has to be marked (a string constant)
      * \return true if the item was successfully marked, false otherwise
      */
     bool Mark(Ptr<QueueDiscItem> item, const char* reason);
 
+    /**
+     * \brief Marks the given packet and, if successful, updates the counters
+     *        associated with the given reason
+     * \param item item that has to be marked
+     * \param reasonId the ID of the reason why the item has to be marked, as
+     *        returned by RegisterReason
+     * \return true if the item was successfully marked, false otherwise
+     */
+    bool Mark(Ptr<QueueDiscItem> item, uint32_t reasonId);
+
   private:
     /**
      * This function actually enqueues a packet into the queue disc.
@@ -648,6 +767,25 @@ class QueueDisc : public Object
      */
     bool Restart();
 
+    /**
+     * Modelled after the Linux functions qdisc_restart and try_bulk_dequeue_skb
+     * (net/sched/sch_generic.c). Dequeue a batch of packets whose size is bounded
+     * by the bytes available in the queue limits of the device transmission queue
+     * and by the room in the device queue, and send it to the device in a single
+     * call. The packets the device does not consume, because its transmission queue
+     * has been stopped nonetheless (e.g., by the link layer headers), are requeued.
+     * \param quota the maximum number of packets to dequeue, decreased by the number
+     *              of packets sent
+     * \return true if packets are successfully sent to the device and more packets
+     *         can be sent.
+     */
+    bool RestartBatch(uint32_t& quota);
+
+    /**
+     * \return true if packets are to be sent to the device in batches
+     */
+    bool CanSendBatch() const;
+
     /**
      * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
      * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
@@ -702,13 +840,108 @@ private:
     uint32_t m_quota; //!< Maximum number of packets dequeued in a qdisc run
     Ptr<NetDeviceQueueInterface> m_devQueueIface; //!< NetDevice queue interface
     SendCallback m_send;           //!< Callback used to send a packet to the receiving object
-    bool m_running;                //!< The queue disc is performing multiple dequeue operations
-    Ptr<QueueDiscItem> m_requeued; //!< The last packet that failed to be transmitted
-    bool m_peeked;                 //!< A packet was dequeued because Peek was called
-    std::string m_childQueueDiscDropMsg; //!< Reason why a packet was dropped by a child queue disc
-    std::string m_childQueueDiscMarkMsg; //!< Reason why a packet was marked by a child queue disc
-    QueueDiscSizePolicy m_sizePolicy;    //!< The queue disc size policy
-    bool m_prohibitChangeMode;           //!< True if changing mode is prohibited
+    SendBatchCallback m_sendBatch; //!< Callback used to send a batch of packets
+    std::vector<Ptr<QueueDiscItem>> m_batch; //!< The batch of packets being sent
+    std::vector<bool> m_batchSent;           //!< Whether each packet consumed was sent
+    /// The TCP sockets of the packets in the batch being sent, with the packet sizes
+    std::vector<std::pair<TcpSocketBase*, uint32_t>> m_batchSockets;
+    Ptr<SharedBufferPool> m_bufferPool; //!< The shared buffer pool, if any
+    uint32_t m_bufferPort;              //!< The port index in the shared buffer pool
+    bool m_running; //!< The queue disc is performing multiple dequeue operations
+    /// The packets that failed to be transmitted, in transmission order
+    std::deque<Ptr<QueueDiscItem>> m_requeued;
+    bool m_peeked; //!< A packet was dequeued because Peek was called
+    QueueDiscSizePolicy m_sizePolicy; //!< The queue disc size policy
+    bool m_prohibitChangeMode;        //!< True if changing mode is prohibited
+
+    /// Packet and byte counters of a reason to drop or mark packets
+    struct ReasonCounters
+    {
+        uint32_t packets{0}; //!< number of packets
+        uint64_t bytes{0};   //!< number of bytes
+    };
+
+    /// Hash of the reasons, which can be looked up without building a string
+    struct ReasonHash
+    {
+        using is_transparent = void; //!< Enable the lookup by std::string_view
+
+        /**
+         * \param reason the reason
+         * \return the hash of the reason
+         */
+        std::size_t operator()(std::string_view reason) const
+        {
+            return std::hash<std::string_view>{}(reason);
+        }
+    };
+
+    /// Reason IDs, looked up by reason
+    typedef std::unordered_map<std::string, uint32_t, ReasonHash, std::equal_to<>> ReasonIdCache;
+
+    /**
+     * \brief Get the ID of a reason, registering it the first time it is used
+     *
+     * The reasons are compared by content, so they need not be string constants.
+     * This is only needed for the reasons passed as strings, e.g., those
+     * reported by the child queue discs.
+     *
+     * \param cache the cache to look the reason up in
+     * \param prefix the prefix added to the reason when it is registered
+     * \param reason the reason
+     * \return the ID of the reason
+     */
+    static uint32_t GetReasonId(ReasonIdCache& cache, const char* prefix, const char* reason);
+
+    /**
+     * \brief Add a packet to the counters of a reason
+     * \param counters the counters, indexed by reason ID
+     * \param id the ID of the reason
+     * \param size the size of the packet
+     */
+    static void CountReason(std::vector<ReasonCounters>& counters, uint32_t id, uint32_t size);
+
+    /**
+     * \brief Fill the per-reason maps of the statistics from the counters
+     * \param counters the counters, indexed by reason ID
+     * \param packets the map of the number of packets for each reason
+     * \param bytes the map of the amount of bytes for each reason
+     */
+    static void FillReasonMaps(const std::vector<ReasonCounters>& counters,
+                               std::map<std::string, uint32_t, std::less<>>& packets,
+                               std::map<std::string, uint64_t, std::less<>>& bytes);
+
+    /**
+     * \brief Drop a packet before enqueue for a reason with the given ID
+     * \param item item that was dropped
+     * \param id the ID of the reason
+     * \param reason the reason, as passed to the trace sources
+     */
+    void DoDropBeforeEnqueue(Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
+    /**
+     * \brief Drop a packet after dequeue for a reason with the given ID
+     * \param item item that was dropped
+     * \param id the ID of the reason
+     * \param reason the reason, as passed to the trace sources
+     */
+    void DoDropAfterDequeue(Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
+    /**
+     * \brief Mark a packet for a reason with the given ID
+     * \param item item that has to be marked
+     * \param id the ID of the reason
+     * \param reason the reason, as passed to the trace sources
+     * \return true if the item was successfully marked
+     */
+    bool DoMark(Ptr<QueueDiscItem> item, uint32_t id, const char* reason);
+
+    ReasonIdCache m_reasonIds;          //!< IDs of the reasons passed as strings
+    ReasonIdCache m_childDropReasonIds; //!< IDs of the reasons used by child queue discs to drop
+    ReasonIdCache m_childMarkReasonIds; //!< IDs of the reasons used by child queue discs to mark
+    std::vector<ReasonCounters> m_droppedBeforeEnqueue; //!< Dropped before enqueue, by reason ID
+    std::vector<ReasonCounters> m_droppedAfterDequeue;  //!< Dropped after dequeue, by reason ID
+    std::vector<ReasonCounters> m_marked;               //!< Marked, by reason ID
 
     /// Traced callback: fired when a packet is enqueued
     TracedCallback<Ptr<const QueueDiscItem>> m_traceEnqueue;
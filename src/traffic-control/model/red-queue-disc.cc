@@ -72,6 +72,11 @@ NS_LOG_COMPONENT_DEFINE("RedQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED(RedQueueDisc);
 
+const uint32_t RedQueueDisc::UNFORCED_DROP_ID = QueueDisc::RegisterReason(UNFORCED_DROP);
+const uint32_t RedQueueDisc::FORCED_DROP_ID = QueueDisc::RegisterReason(FORCED_DROP);
+const uint32_t RedQueueDisc::UNFORCED_MARK_ID = QueueDisc::RegisterReason(UNFORCED_MARK);
+const uint32_t RedQueueDisc::FORCED_MARK_ID = QueueDisc::RegisterReason(FORCED_MARK);
+
 TypeId
 RedQueueDisc::GetTypeId()
 {
@@ -201,6 +206,15 @@ RedQueueDisc::GetTypeId()
                           BooleanValue(false),
                           MakeBooleanAccessor(&RedQueueDisc::m_isNs1Compat),
                           MakeBooleanChecker())
+            .AddAttribute("UseFixedPoint",
+                          "True to compute the average queue size in the integer domain "
+                          "(the queue weight is rounded to a power of 2). The drop "
+                          "probability is still computed in floating point, so this makes "
+                          "the average queue size independent of the floating-point behavior "
+                          "of the platform, not the simulation faster",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RedQueueDisc::m_useFixedPoint),
+                          MakeBooleanChecker())
             .AddAttribute("LinkBandwidth",
                           "The RED link bandwidth",
                           DataRateValue(DataRate("1.5Mbps")),
@@ -353,7 +367,13 @@ RedQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         NS_LOG_DEBUG("RED Queue Disc is idle.");
         Time now = Simulator::Now();
 
-        if (m_cautious == 3)
+        if (m_useFixedPoint)
+        {
+            int64_t pktTime = (m_cautious == 3 ? m_idlePktTime : m_pktTime);
+            m = static_cast<uint32_t>(
+                std::min<int64_t>((now - m_idleTime).GetNanoSeconds() / pktTime, UINT32_MAX - 1));
+        }
+        else if (m_cautious == 3)
         {
             double ptc = m_ptc * m_meanPktSize / m_idlePktSize;
             m = uint32_t(ptc * (now - m_idleTime).GetSeconds());
@@ -410,20 +430,20 @@ RedQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 
     if (dropType == DTYPE_UNFORCED)
     {
-        if (!m_useEcn || !Mark(item, UNFORCED_MARK))
+        if (!m_useEcn || !Mark(item, UNFORCED_MARK_ID))
         {
             NS_LOG_DEBUG("\t Dropping due to Prob Mark " << m_qAvg);
-            DropBeforeEnqueue(item, UNFORCED_DROP);
+            DropBeforeEnqueue(item, UNFORCED_DROP_ID);
             return false;
         }
         NS_LOG_DEBUG("\t Marking due to Prob Mark " << m_qAvg);
     }
     else if (dropType == DTYPE_FORCED)
     {
-        if (m_useHardDrop || !m_useEcn || !Mark(item, FORCED_MARK))
+        if (m_useHardDrop || !m_useEcn || !Mark(item, FORCED_MARK_ID))
         {
             NS_LOG_DEBUG("\t Dropping due to Hard Mark " << m_qAvg);
-            DropBeforeEnqueue(item, FORCED_DROP);
+            DropBeforeEnqueue(item, FORCED_DROP_ID);
             if (m_isNs1Compat)
             {
                 m_count = 0;
@@ -555,6 +575,21 @@ RedQueueDisc::InitializeParams()
         m_qW = 1.0 - std::exp(-10.0 / m_ptc);
     }
 
+    if (m_useFixedPoint)
+    {
+        // round the queue weight to the nearest power of 2. An automatic weight
+        // rounded to 0 (for a huge packet time constant) gets the smallest one
+        double wLog = (m_qW > 0.0 ? std::round(-std::log2(m_qW)) : 31.0);
+        m_wLog = static_cast<uint32_t>(std::clamp(wLog, 1.0, 31.0));
+        m_qW = std::ldexp(1.0, -static_cast<int>(m_wLog));
+        m_qAvgFixed = 0;
+        // transmission times of a mean and of an idle packet, for the idle period
+        uint64_t bitRate = std::max<uint64_t>(m_linkBandwidth.GetBitRate(), 1);
+        m_pktTime = std::max<int64_t>(8000000000ULL * m_meanPktSize / bitRate, 1);
+        m_idlePktTime = std::max<int64_t>(8000000000ULL * m_idlePktSize / bitRate, 1);
+        NS_LOG_DEBUG("\tUsing fixed point: m_wLog " << m_wLog << "; m_pktTime " << m_pktTime);
+    }
+
     if (m_bottom == 0)
     {
         m_bottom = 0.01;
@@ -634,8 +669,16 @@ RedQueueDisc::Estimator(uint32_t nQueued, uint32_t m, double qAvg, double qW)
 {
     NS_LOG_FUNCTION(this << nQueued << m << qAvg << qW);
 
-    double newAve = qAvg * std::pow(1.0 - qW, m);
-    newAve += qW * nQueued;
+    double newAve;
+    if (m_useFixedPoint)
+    {
+        newAve = FixedPointEstimator(nQueued, m);
+    }
+    else
+    {
+        newAve = qAvg * std::pow(1.0 - qW, m);
+        newAve += qW * nQueued;
+    }
 
     Time now = Simulator::Now();
     if (m_isAdaptMaxP && now > m_lastSet + m_interval)
@@ -650,6 +693,34 @@ RedQueueDisc::Estimator(uint32_t nQueued, uint32_t m, double qAvg, double qW)
     return newAve;
 }
 
+double
+RedQueueDisc::FixedPointEstimator(uint32_t nQueued, uint32_t m)
+{
+    NS_LOG_FUNCTION(this << nQueued << m);
+
+    // decay the average as if m - 1 empty samples were taken (idle period),
+    // i.e., multiply it by (1 - 2^-m_wLog)^(m - 1), computed by squaring in Q32
+    if (m > 1)
+    {
+        uint64_t base = (uint64_t(1) << 32) - (uint64_t(1) << (32 - m_wLog));
+        uint64_t factor = uint64_t(1) << 32;
+        for (uint32_t e = m - 1; e > 0 && factor > 0; e >>= 1)
+        {
+            if (e & 1)
+            {
+                factor = (factor * base) >> 32;
+            }
+            base = (base * base) >> 32;
+        }
+        m_qAvgFixed = (m_qAvgFixed >> 32) * factor + (((m_qAvgFixed & 0xffffffff) * factor) >> 32);
+    }
+
+    // qAvg = (1 - 2^-m_wLog) * qAvg + 2^-m_wLog * nQueued
+    m_qAvgFixed += ((uint64_t(nQueued) << FIXED_POINT_SHIFT) >> m_wLog) - (m_qAvgFixed >> m_wLog);
+
+    return std::ldexp(static_cast<double>(m_qAvgFixed), -static_cast<int>(FIXED_POINT_SHIFT));
+}
+
 // Check if packet p needs to be dropped due to probability mark
 bool
 RedQueueDisc::DropEarly(Ptr<QueueDiscItem> item, uint32_t qSize)
@@ -890,6 +961,13 @@ RedQueueDisc::CheckConfig()
         NS_LOG_ERROR("m_isAdaptMaxP and m_isFengAdaptive cannot be simultaneously true");
     }
 
+    if (m_useFixedPoint && (m_qW > 1.0 || (m_qW < 0.0 && m_qW != -1.0 && m_qW != -2.0)))
+    {
+        NS_LOG_ERROR("With UseFixedPoint, QW must be in (0, 1], or one of 0, -1 and -2 for "
+                     "an automatic setting");
+        return false;
+    }
+
     return true;
 }
 
@@ -199,6 +199,11 @@ class RedQueueDisc : public QueueDisc
     // Reasons for marking packets
     static constexpr const char* UNFORCED_MARK = "Unforced mark"; //!< Early probability marks
     static constexpr const char* FORCED_MARK = "Forced mark"; //!< Forced marks, m_qAvg > m_maxTh
+    // IDs of the reasons, registered with the TypeId
+    static const uint32_t UNFORCED_DROP_ID; //!< ID of UNFORCED_DROP
+    static const uint32_t FORCED_DROP_ID;   //!< ID of FORCED_DROP
+    static const uint32_t UNFORCED_MARK_ID; //!< ID of UNFORCED_MARK
+    static const uint32_t FORCED_MARK_ID;   //!< ID of FORCED_MARK
 
   protected:
     /**
@@ -230,6 +235,18 @@ class RedQueueDisc : public QueueDisc
      * \returns new average queue size
      */
     double Estimator(uint32_t nQueued, uint32_t m, double qAvg, double qW);
+    /**
+     * \brief Compute the average queue size in the integer domain
+     *
+     * Fixed-point counterpart of the computation performed by Estimator: the
+     * queue weight is 2^-m_wLog and the average is a fixed-point number with
+     * FIXED_POINT_SHIFT fractional bits, so that it is updated with shifts only
+     * (as the Linux kernel does) and does not depend on the floating-point unit.
+     * \param nQueued number of queued packets
+     * \param m simulated number of packet arrivals during idle period
+     * \returns new average queue size
+     */
+    double FixedPointEstimator(uint32_t nQueued, uint32_t m);
     /**
      * \brief Update m_curMaxP
      * \param newAve new average queue length
@@ -283,11 +300,14 @@ class RedQueueDisc : public QueueDisc
     double m_b;               //!< Increment parameter for m_curMaxP in Feng's Adaptive RED
     double m_a;               //!< Decrement parameter for m_curMaxP in Feng's Adaptive RED
     bool m_isNs1Compat;       //!< Ns-1 compatibility
+    bool m_useFixedPoint;     //!< True to compute the average queue size in the integer domain
     DataRate m_linkBandwidth; //!< Link bandwidth
     Time m_linkDelay;         //!< Link delay
     bool m_useEcn;            //!< True if ECN is used (packets are marked instead of being dropped)
     bool m_useHardDrop;       //!< True if packets are always dropped above max threshold
 
+    static constexpr uint32_t FIXED_POINT_SHIFT = 24; //!< Fractional bits of m_qAvgFixed
+
     // ** Variables maintained by RED
     double m_vA;             //!< 1.0 / (m_maxTh - m_minTh)
     double m_vB;             //!< -m_minTh / (m_maxTh - m_minTh)
@@ -301,6 +321,10 @@ class RedQueueDisc : public QueueDisc
     uint32_t m_idle;         //!< 0/1 idle status
     double m_ptc;            //!< packet time constant in packets/second
     double m_qAvg;           //!< Average queue length
+    uint64_t m_qAvgFixed;    //!< Average queue length, with FIXED_POINT_SHIFT fractional bits
+    uint32_t m_wLog;         //!< Queue weight is 2^-m_wLog when using fixed point
+    int64_t m_pktTime;       //!< Transmission time of a packet (ns) when using fixed point
+    int64_t m_idlePktTime;   //!< Transmission time of an idle packet (ns) when using fixed point
     uint32_t m_count;        //!< Number of packets since last random number generation
     FengStatus m_fengStatus; //!< For use in Feng's Adaptive RED
     /**
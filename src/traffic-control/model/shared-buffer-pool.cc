@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-buffer-pool.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedBufferPool");
+
+NS_OBJECT_ENSURE_REGISTERED(SharedBufferPool);
+
+TypeId
+SharedBufferPool::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SharedBufferPool")
+            .SetParent<Object>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<SharedBufferPool>()
+            .AddAttribute("BufferSize",
+                          "The size of the shared buffer in bytes",
+                          UintegerValue(12 * 1024 * 1024),
+                          MakeUintegerAccessor(&SharedBufferPool::m_bufferSize),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Alpha",
+                          "The factor by which the free buffer space is multiplied to obtain "
+                          "the maximum length of the queue of a port and priority",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&SharedBufferPool::m_alpha),
+                          MakeDoubleChecker<double>(0))
+            .AddTraceSource("Occupancy",
+                            "Number of bytes stored in the shared buffer",
+                            MakeTraceSourceAccessor(&SharedBufferPool::m_used),
+                            "ns3::TracedValueCallback::Uint64");
+    return tid;
+}
+
+SharedBufferPool::SharedBufferPool()
+    : m_used(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SharedBufferPool::~SharedBufferPool()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+SharedBufferPool::AddPort()
+{
+    NS_LOG_FUNCTION(this);
+    m_ports.emplace_back();
+    return m_ports.size() - 1;
+}
+
+uint32_t
+SharedBufferPool::GetNPorts() const
+{
+    return m_ports.size();
+}
+
+bool
+SharedBufferPool::CheckAdmission(uint32_t port, uint8_t priority, uint32_t size) const
+{
+    NS_LOG_FUNCTION(this << port << +priority << size);
+    NS_ASSERT(port < m_ports.size() && priority < N_PRIORITIES);
+
+    if (m_used + size > m_bufferSize)
+    {
+        NS_LOG_LOGIC("Shared buffer full");
+        return false;
+    }
+    if (m_ports[port].queues[priority] + size > GetThreshold())
+    {
+        NS_LOG_LOGIC("Dynamic threshold exceeded by port " << port << " priority " << +priority);
+        return false;
+    }
+    return true;
+}
+
+void
+SharedBufferPool::Allocate(uint32_t port, uint8_t priority, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << port << +priority << size);
+    NS_ASSERT(port < m_ports.size() && priority < N_PRIORITIES);
+
+    Port& p = m_ports[port];
+    p.bytes += size;
+    p.queues[priority] += size;
+    m_used += size;
+}
+
+void
+SharedBufferPool::Release(uint32_t port, uint8_t priority, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << port << +priority << size);
+    NS_ASSERT(port < m_ports.size() && priority < N_PRIORITIES);
+
+    Port& p = m_ports[port];
+    NS_ASSERT_MSG(p.queues[priority] >= size, "Releasing bytes that were not allocated");
+    p.bytes -= size;
+    p.queues[priority] -= size;
+    m_used -= size;
+}
+
+uint64_t
+SharedBufferPool::GetBufferSize() const
+{
+    return m_bufferSize;
+}
+
+uint64_t
+SharedBufferPool::GetOccupancy() const
+{
+    return m_used;
+}
+
+uint64_t
+SharedBufferPool::GetPortOccupancy(uint32_t port) const
+{
+    NS_ASSERT(port < m_ports.size());
+    return m_ports[port].bytes;
+}
+
+uint64_t
+SharedBufferPool::GetQueueOccupancy(uint32_t port, uint8_t priority) const
+{
+    NS_ASSERT(port < m_ports.size() && priority < N_PRIORITIES);
+    return m_ports[port].queues[priority];
+}
+
+uint64_t
+SharedBufferPool::GetThreshold() const
+{
+    uint64_t used = m_used;
+    return used >= m_bufferSize ? 0 : static_cast<uint64_t>(m_alpha * (m_bufferSize - used));
+}
+
+} // namespace ns3
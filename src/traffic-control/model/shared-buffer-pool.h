@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHARED_BUFFER_POOL_H
+#define SHARED_BUFFER_POOL_H
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+
+#include <array>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Packet buffer shared by the ports of a switch
+ *
+ * A SharedBufferPool models the packet memory of a shared-buffer switch. The
+ * root queue discs installed on the ports of the switch are attached to the
+ * pool (see TrafficControlHelper::SetSharedBufferPool), which then accounts
+ * for the bytes stored by every port and priority. The priority of a packet
+ * is the value of its SocketPriorityTag (if any) modulo 16.
+ *
+ * A packet is admitted if it fits in the free buffer space and the queue of
+ * its port and priority does not exceed the Dynamic Threshold (A. K. Choudhury
+ * and E. L. Hahne, "Dynamic queue length thresholds for shared-memory packet
+ * switches", IEEE/ACM Trans. Networking, 1998), i.e., Alpha times the free
+ * buffer space. The occupancy counters are updated incrementally as packets
+ * are enqueued and dequeued, hence the admission decision takes constant time
+ * regardless of the number of ports.
+ */
+class SharedBufferPool : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SharedBufferPool();
+    ~SharedBufferPool() override;
+
+    static constexpr uint8_t N_PRIORITIES = 16; //!< number of priorities of each port
+
+    /**
+     * \brief Add a port drawing from this pool
+     * \return the index of the port
+     */
+    uint32_t AddPort();
+
+    /**
+     * \return the number of ports drawing from this pool
+     */
+    uint32_t GetNPorts() const;
+
+    /**
+     * \brief Check whether a packet can be stored in the buffer
+     * \param port the index of the port
+     * \param priority the priority of the packet
+     * \param size the size of the packet in bytes
+     * \return true if the packet is admitted
+     */
+    bool CheckAdmission(uint32_t port, uint8_t priority, uint32_t size) const;
+
+    /**
+     * \brief Account for a packet stored in the buffer
+     * \param port the index of the port
+     * \param priority the priority of the packet
+     * \param size the size of the packet in bytes
+     */
+    void Allocate(uint32_t port, uint8_t priority, uint32_t size);
+
+    /**
+     * \brief Account for a packet removed from the buffer
+     * \param port the index of the port
+     * \param priority the priority of the packet
+     * \param size the size of the packet in bytes
+     */
+    void Release(uint32_t port, uint8_t priority, uint32_t size);
+
+    /**
+     * \return the size of the buffer in bytes
+     */
+    uint64_t GetBufferSize() const;
+
+    /**
+     * \return the number of bytes stored in the buffer
+     */
+    uint64_t GetOccupancy() const;
+
+    /**
+     * \param port the index of the port
+     * \return the number of bytes stored in the buffer by the given port
+     */
+    uint64_t GetPortOccupancy(uint32_t port) const;
+
+    /**
+     * \param port the index of the port
+     * \param priority the priority
+     * \return the number of bytes stored in the buffer by the given port and priority
+     */
+    uint64_t GetQueueOccupancy(uint32_t port, uint8_t priority) const;
+
+    /**
+     * \return the current dynamic threshold in bytes
+     */
+    uint64_t GetThreshold() const;
+
+  private:
+    /// Occupancy counters of a port
+    struct Port
+    {
+        uint64_t bytes{0};                           //!< bytes stored by the port
+        std::array<uint64_t, N_PRIORITIES> queues{}; //!< bytes stored by each priority
+    };
+
+    uint64_t m_bufferSize;        //!< size of the buffer in bytes
+    double m_alpha;               //!< dynamic threshold factor
+    TracedValue<uint64_t> m_used; //!< bytes stored in the buffer
+    std::vector<Port> m_ports;    //!< occupancy counters of the ports
+};
+
+} // namespace ns3
+
+#endif /* SHARED_BUFFER_POOL_H */
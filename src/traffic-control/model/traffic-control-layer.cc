@@ -96,9 +96,9 @@ TrafficControlLayer::DoInitialize()
     // initialize the root queue discs
     for (auto& ndi : m_netDevices)
     {
-        if (ndi.second.m_rootQueueDisc)
+        if (ndi.m_rootQueueDisc)
         {
-            ndi.second.m_rootQueueDisc->Initialize();
+            ndi.m_rootQueueDisc->Initialize();
         }
     }
 
@@ -143,13 +143,13 @@ TrafficControlLayer::ScanDevices()
         Ptr<NetDeviceQueueInterface> ndqi = dev->GetObject<NetDeviceQueueInterface>();
         NS_LOG_DEBUG("Pointer to NetDeviceQueueInterface: " << ndqi);
 
-        auto ndi = m_netDevices.find(dev);
+        NetDeviceInfo* ndi = FindNetDeviceInfo(dev);
 
-        if (ndi != m_netDevices.end())
+        if (ndi)
         {
             NS_LOG_DEBUG("Device entry found; installing NetDeviceQueueInterface pointer "
                          << ndqi << " to internal map");
-            ndi->second.m_ndqi = ndqi;
+            ndi->m_ndqi = ndqi;
         }
         else if (ndqi)
         // if no entry for the device is found, it means that no queue disc has been
@@ -161,15 +161,15 @@ TrafficControlLayer::ScanDevices()
             NS_LOG_DEBUG("No device entry found; create entry for device and store pointer to "
                          "NetDeviceQueueInterface: "
                          << ndqi);
-            m_netDevices[dev] = {nullptr, ndqi, QueueDiscVector()};
-            ndi = m_netDevices.find(dev);
+            ndi = &AddNetDeviceInfo(dev);
+            ndi->m_ndqi = ndqi;
         }
 
         // if a queue disc is installed, set the wake callbacks on netdevice queues
-        if (ndi != m_netDevices.end() && ndi->second.m_rootQueueDisc)
+        if (ndi && ndi->m_rootQueueDisc)
         {
             NS_LOG_DEBUG("Setting the wake callbacks on NetDevice queues");
-            ndi->second.m_queueDiscsToWake.clear();
+            ndi->m_queueDiscsToWake.clear();
 
             if (ndqi)
             {
@@ -177,41 +177,48 @@ TrafficControlLayer::ScanDevices()
                 {
                     Ptr<QueueDisc> qd;
 
-                    if (ndi->second.m_rootQueueDisc->GetWakeMode() == QueueDisc::WAKE_ROOT)
+                    if (ndi->m_rootQueueDisc->GetWakeMode() == QueueDisc::WAKE_ROOT)
                     {
-                        qd = ndi->second.m_rootQueueDisc;
+                        qd = ndi->m_rootQueueDisc;
                     }
-                    else if (ndi->second.m_rootQueueDisc->GetWakeMode() == QueueDisc::WAKE_CHILD)
+                    else if (ndi->m_rootQueueDisc->GetWakeMode() == QueueDisc::WAKE_CHILD)
                     {
-                        NS_ABORT_MSG_IF(ndi->second.m_rootQueueDisc->GetNQueueDiscClasses() !=
+                        NS_ABORT_MSG_IF(ndi->m_rootQueueDisc->GetNQueueDiscClasses() !=
                                             ndqi->GetNTxQueues(),
                                         "The number of child queue discs does not match the number "
                                         "of netdevice queues");
 
-                        qd = ndi->second.m_rootQueueDisc->GetQueueDiscClass(i)->GetQueueDisc();
+                        qd = ndi->m_rootQueueDisc->GetQueueDiscClass(i)->GetQueueDisc();
                     }
                     else
                     {
                         NS_ABORT_MSG("Invalid wake mode");
                     }
 
-                    ndqi->GetTxQueue(i)->SetWakeCallback(MakeCallback(&QueueDisc::Run, qd));
-                    ndi->second.m_queueDiscsToWake.push_back(qd);
+                    ndi->m_queueDiscsToWake.push_back(qd);
                 }
+
+                // a single wake callback on the interface serves all the device queues
+                ndqi->SetWakeTxQueueCallback(
+                    [qds = ndi->m_queueDiscsToWake](std::size_t i) { qds[i]->Run(); });
             }
             else
             {
-                ndi->second.m_queueDiscsToWake.push_back(ndi->second.m_rootQueueDisc);
+                ndi->m_queueDiscsToWake.push_back(ndi->m_rootQueueDisc);
             }
 
             // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
             // into which packets are enqueued and dequeued by calling Run
-            for (auto& q : ndi->second.m_queueDiscsToWake)
+            for (auto& q : ndi->m_queueDiscsToWake)
             {
                 q->SetNetDeviceQueueInterface(ndqi);
                 q->SetSendCallback([dev](Ptr<QueueDiscItem> item) {
                     dev->Send(item->GetPacket(), item->GetAddress(), item->GetProtocol());
                 });
+                q->SetSendBatchCallback(
+                    [dev](const std::vector<Ptr<QueueDiscItem>>& items, std::vector<bool>& sent) {
+                        return dev->SendBatch(items, sent);
+                    });
             }
         }
     }
@@ -222,20 +229,20 @@ TrafficControlLayer::SetRootQueueDiscOnDevice(Ptr<NetDevice> device, Ptr<QueueDi
 {
     NS_LOG_FUNCTION(this << device << qDisc);
 
-    auto ndi = m_netDevices.find(device);
+    NetDeviceInfo* ndi = FindNetDeviceInfo(device);
 
-    if (ndi == m_netDevices.end())
+    if (!ndi)
     {
         // No entry found for this device. Create one.
-        m_netDevices[device] = {qDisc, nullptr, QueueDiscVector()};
+        AddNetDeviceInfo(device).m_rootQueueDisc = qDisc;
     }
     else
     {
-        NS_ABORT_MSG_IF(ndi->second.m_rootQueueDisc,
+        NS_ABORT_MSG_IF(ndi->m_rootQueueDisc,
                         "Cannot install a root queue disc on a device already having one. "
                         "Delete the existing queue disc first.");
 
-        ndi->second.m_rootQueueDisc = qDisc;
+        ndi->m_rootQueueDisc = qDisc;
     }
 }
 
@@ -244,13 +251,13 @@ TrafficControlLayer::GetRootQueueDiscOnDevice(Ptr<NetDevice> device) const
 {
     NS_LOG_FUNCTION(this << device);
 
-    auto ndi = m_netDevices.find(device);
+    const NetDeviceInfo* ndi = FindNetDeviceInfo(device);
 
-    if (ndi == m_netDevices.end())
+    if (!ndi)
     {
         return nullptr;
     }
-    return ndi->second.m_rootQueueDisc;
+    return ndi->m_rootQueueDisc;
 }
 
 Ptr<QueueDisc>
@@ -265,34 +272,63 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice(Ptr<NetDevice> device)
 {
     NS_LOG_FUNCTION(this << device);
 
-    auto ndi = m_netDevices.find(device);
+    NetDeviceInfo* ndi = FindNetDeviceInfo(device);
 
-    NS_ASSERT_MSG(ndi != m_netDevices.end() && ndi->second.m_rootQueueDisc,
-                  "No root queue disc installed on device " << device);
+    NS_ASSERT_MSG(ndi && ndi->m_rootQueueDisc, "No root queue disc installed on device " << device);
 
     // remove the root queue disc
-    ndi->second.m_rootQueueDisc = nullptr;
-    for (auto& q : ndi->second.m_queueDiscsToWake)
+    ndi->m_rootQueueDisc = nullptr;
+    for (auto& q : ndi->m_queueDiscsToWake)
     {
         q->SetNetDeviceQueueInterface(nullptr);
         q->SetSendCallback(nullptr);
+        q->SetSendBatchCallback(nullptr);
     }
-    ndi->second.m_queueDiscsToWake.clear();
+    ndi->m_queueDiscsToWake.clear();
 
-    Ptr<NetDeviceQueueInterface> ndqi = ndi->second.m_ndqi;
+    Ptr<NetDeviceQueueInterface> ndqi = ndi->m_ndqi;
     if (ndqi)
     {
-        // remove configured callbacks, if any
-        for (std::size_t i = 0; i < ndqi->GetNTxQueues(); i++)
-        {
-            ndqi->GetTxQueue(i)->SetWakeCallback(MakeNullCallback<void>());
-        }
+        // remove the configured callback, if any
+        ndqi->SetWakeTxQueueCallback(nullptr);
     }
     else
     {
         // remove the empty entry
-        m_netDevices.erase(ndi);
+        *ndi = NetDeviceInfo();
+    }
+}
+
+TrafficControlLayer::NetDeviceInfo*
+TrafficControlLayer::FindNetDeviceInfo(Ptr<NetDevice> device)
+{
+    uint32_t index = device->GetIfIndex();
+    if (index < m_netDevices.size() && m_netDevices[index].m_device == device)
+    {
+        return &m_netDevices[index];
+    }
+    return nullptr;
+}
+
+const TrafficControlLayer::NetDeviceInfo*
+TrafficControlLayer::FindNetDeviceInfo(Ptr<NetDevice> device) const
+{
+    return const_cast<TrafficControlLayer*>(this)->FindNetDeviceInfo(device);
+}
+
+TrafficControlLayer::NetDeviceInfo&
+TrafficControlLayer::AddNetDeviceInfo(Ptr<NetDevice> device)
+{
+    uint32_t index = device->GetIfIndex();
+    NS_ASSERT_MSG(!m_node || m_node->GetDevice(index) == device,
+                  "Device " << device << " does not belong to node " << m_node->GetId());
+    if (index >= m_netDevices.size())
+    {
+        m_netDevices.resize(index + 1);
     }
+    NS_ASSERT(!m_netDevices[index].m_device);
+    m_netDevices[index].m_device = device;
+    return m_netDevices[index];
 }
 
 void
@@ -365,34 +401,33 @@ TrafficControlLayer::Send(Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
     NS_LOG_DEBUG("Send packet to device " << device << " protocol number " << item->GetProtocol());
 
     Ptr<NetDeviceQueueInterface> devQueueIface;
-    auto ndi = m_netDevices.find(device);
+    NetDeviceInfo* ndi = FindNetDeviceInfo(device);
 
-    if (ndi != m_netDevices.end())
+    if (ndi)
     {
-        devQueueIface = ndi->second.m_ndqi;
+        devQueueIface = ndi->m_ndqi;
     }
 
     // determine the transmission queue of the device where the packet will be enqueued
     std::size_t txq = 0;
     if (devQueueIface && devQueueIface->GetNTxQueues() > 1)
     {
-        txq = devQueueIface->GetSelectQueueCallback()(item);
-        // otherwise, Linux determines the queue index by using a hash function
-        // and associates such index to the socket which the packet belongs to,
-        // so that subsequent packets of the same socket will be mapped to the
-        // same tx queue (__netdev_pick_tx function in net/core/dev.c). It is
-        // pointless to implement this in ns-3 because currently the multi-queue
-        // devices provide a select queue callback
+        // if the device provides no select queue callback, the queue index is
+        // determined by the flow hash of the packet, as Linux does (skb_tx_hash
+        // function in net/core/dev.c). The hash is cached in the item, hence the
+        // queue discs that classify the packet by its flow (e.g., FqCoDel) do not
+        // compute it again
+        txq = devQueueIface->SelectTxQueue(item);
     }
 
     NS_ASSERT(!devQueueIface || txq < devQueueIface->GetNTxQueues());
 
-    if (ndi == m_netDevices.end() || !ndi->second.m_rootQueueDisc)
+    if (!ndi || !ndi->m_rootQueueDisc)
     {
         // The device has no attached queue disc, thus add the header to the packet and
         // send it directly to the device if the selected queue is not stopped
         item->AddHeader();
-        if (!devQueueIface || !devQueueIface->GetTxQueue(txq)->IsStopped())
+        if (!devQueueIface || !devQueueIface->IsTxQueueStopped(txq))
         {
             // a single queue device makes no use of the priority tag
             if (!devQueueIface || devQueueIface->GetNTxQueues() == 1)
@@ -413,7 +448,7 @@ TrafficControlLayer::Send(Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
         // selected for the packet and try to dequeue packets from such queue disc
         item->SetTxQueueIndex(txq);
 
-        Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+        Ptr<QueueDisc> qDisc = ndi->m_queueDiscsToWake[txq];
         NS_ASSERT(qDisc);
         qDisc->Enqueue(item);
         qDisc->Run();
@@ -228,6 +228,7 @@ class TrafficControlLayer : public Object
      */
     struct NetDeviceInfo
     {
+        Ptr<NetDevice> m_device;             //!< the device (null if the entry is unused)
         Ptr<QueueDisc> m_rootQueueDisc;      //!< the root queue disc on the device
         Ptr<NetDeviceQueueInterface> m_ndqi; //!< the netdevice queue interface
         QueueDiscVector m_queueDiscsToWake;  //!< the vector of queue discs to wake
@@ -248,10 +249,32 @@ class TrafficControlLayer : public Object
      */
     Ptr<QueueDisc> GetRootQueueDiscOnDeviceByIndex(uint32_t index) const;
 
+    /**
+     * \brief Get the information stored for a device
+     * \param device the device
+     * \return the information stored for the device, or nullptr if there is none
+     */
+    NetDeviceInfo* FindNetDeviceInfo(Ptr<NetDevice> device);
+
+    /**
+     * \brief Get the information stored for a device
+     * \param device the device
+     * \return the information stored for the device, or nullptr if there is none
+     */
+    const NetDeviceInfo* FindNetDeviceInfo(Ptr<NetDevice> device) const;
+
+    /**
+     * \brief Create an entry for a device that has none
+     * \param device the device
+     * \return the entry created for the device
+     */
+    NetDeviceInfo& AddNetDeviceInfo(Ptr<NetDevice> device);
+
     /// The node this TrafficControlLayer object is aggregated to
     Ptr<Node> m_node;
-    /// Map storing the required information for each device with a queue disc installed
-    std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
+    /// The required information for each device with a queue disc installed, indexed by
+    /// the index of the device in the node's device list
+    std::vector<NetDeviceInfo> m_netDevices;
     ProtocolHandlerList m_handlers; //!< List of upper-layer handlers
 
     /**